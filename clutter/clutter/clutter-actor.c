@@ -699,6 +699,19 @@ struct _ClutterActorPrivate
   /* the cached transformation matrix; see apply_transform() */
   CoglMatrix transform;
 
+  /* the modelview used for the last paint, and the modelview of the
+   * parent it was composed from; see clutter_actor_apply_paint_modelview()
+   */
+  CoglMatrix paint_modelview;
+  CoglMatrix paint_parent_modelview;
+
+  /* the paint nodes emitted during the last paint, replayed as long as
+   * the actor doesn't queue a redraw or a relayout
+   */
+  ClutterPaintNode *paint_nodes;
+  guint8 paint_nodes_opacity;
+  float paint_nodes_resource_scale;
+
   float resource_scale;
 
   guint8 opacity;
@@ -847,6 +860,8 @@ struct _ClutterActorPrivate
   guint needs_paint_volume_update   : 1;
   guint had_effects_on_last_paint_volume_update : 1;
   guint needs_compute_resource_scale : 1;
+  guint paint_modelview_valid       : 1;
+  guint paint_nodes_valid           : 1;
 };
 
 enum
@@ -1088,6 +1103,12 @@ static void on_layout_manager_changed (ClutterLayoutManager *manager,
 
 static inline void clutter_actor_queue_compute_expand (ClutterActor *self);
 
+static void clutter_actor_invalidate_paint_nodes (ClutterActor *self);
+
+static void clutter_actor_allocate_internal (ClutterActor           *self,
+                                             const ClutterActorBox  *allocation,
+                                             ClutterAllocationFlags  flags);
+
 static inline void clutter_actor_set_margin_internal (ClutterActor *self,
                                                       gfloat        margin,
                                                       GParamSpec   *pspec);
@@ -1522,6 +1543,7 @@ clutter_actor_real_map (ClutterActor *self)
 
   stage = _clutter_actor_get_stage_internal (self);
   priv->pick_id = _clutter_stage_acquire_pick_id (CLUTTER_STAGE (stage), self);
+  clutter_stage_invalidate_pick (CLUTTER_STAGE (stage));
 
   CLUTTER_NOTE (ACTOR, "Pick id '%d' for actor '%s'",
                 priv->pick_id,
@@ -1632,7 +1654,10 @@ clutter_actor_real_unmap (ClutterActor *self)
       stage = CLUTTER_STAGE (_clutter_actor_get_stage_internal (self));
 
       if (stage != NULL)
-        _clutter_stage_release_pick_id (stage, priv->pick_id);
+        {
+          _clutter_stage_release_pick_id (stage, priv->pick_id);
+          clutter_stage_invalidate_pick (stage);
+        }
 
       priv->pick_id = -1;
 
@@ -2254,17 +2279,78 @@ static void
 clutter_actor_real_pick (ClutterActor       *self,
 			 const ClutterColor *color)
 {
-  CoglFramebuffer *framebuffer = cogl_get_draw_framebuffer ();
-
   /* the default implementation is just to paint a rectangle
    * with the same size of the actor using the passed color
    */
   if (clutter_actor_should_pick_paint (self))
+    {
+      ClutterActorBox box = {
+        .x1 = 0,
+        .y1 = 0,
+        .x2 = clutter_actor_box_get_width (&self->priv->allocation),
+        .y2 = clutter_actor_box_get_height (&self->priv->allocation),
+      };
+
+      clutter_actor_pick_box (self, &box);
+    }
+
+  /* XXX - this thoroughly sucks, but we need to maintain compatibility
+   * with existing container classes that override the pick() virtual
+   * and chain up to the default implementation - otherwise we'll end up
+   * painting our children twice.
+   *
+   * this has to go away for 2.0; hopefully along the pick() itself.
+   */
+  if (CLUTTER_ACTOR_GET_CLASS (self)->pick == clutter_actor_real_pick)
+    {
+      ClutterActor *iter;
+
+      for (iter = self->priv->first_child;
+           iter != NULL;
+           iter = iter->priv->next_sibling)
+        clutter_actor_paint (iter);
+    }
+}
+
+/**
+ * clutter_actor_pick_box:
+ * @self: The #ClutterActor being "pick" painted.
+ * @box: A rectangle in the actor's own local coordinates.
+ *
+ * Logs (does a virtual paint of) a rectangle for picking. Note that @box is
+ * in the actor's own local coordinates, so is usually {0,0,width,height}
+ * to include the whole actor. That is unless the actor has a shaped input
+ * region in which case you may wish to log the (multiple) smaller rectangles
+ * that make up the input region.
+ *
+ * Custom #ClutterActorClass.pick implementations should use this function
+ * instead of drawing in the pick color directly, so that the stage can
+ * pick them without reading back from the framebuffer.
+ */
+void
+clutter_actor_pick_box (ClutterActor          *self,
+                        const ClutterActorBox *box)
+{
+  ClutterStage *stage;
+
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+  g_return_if_fail (box != NULL);
+
+  if (box->x1 >= box->x2 || box->y1 >= box->y2)
+    return;
+
+  stage = (ClutterStage *) _clutter_actor_get_stage_internal (self);
+
+  if (_clutter_stage_is_logging_pick (stage))
+    {
+      _clutter_stage_log_pick (stage, box, self);
+    }
+  else
     {
       static CoglPipeline *default_pick_pipeline = NULL;
-      ClutterActorBox box = { 0, };
+      CoglFramebuffer *framebuffer = cogl_get_draw_framebuffer ();
       CoglPipeline *pick_pipeline;
-      float width, height;
+      ClutterColor color = { 0, };
 
       if (G_UNLIKELY (default_pick_pipeline == NULL))
         {
@@ -2277,41 +2363,20 @@ clutter_actor_real_pick (ClutterActor       *self,
       g_assert (default_pick_pipeline != NULL);
       pick_pipeline = cogl_pipeline_copy (default_pick_pipeline);
 
-      clutter_actor_get_allocation_box (self, &box);
-
-      width = box.x2 - box.x1;
-      height = box.y2 - box.y1;
-
+      _clutter_id_to_color (_clutter_actor_get_pick_id (self), &color);
       cogl_pipeline_set_color4ub (pick_pipeline,
-                                  color->red,
-                                  color->green,
-                                  color->blue,
-                                  color->alpha);
+                                  color.red,
+                                  color.green,
+                                  color.blue,
+                                  color.alpha);
 
       cogl_framebuffer_draw_rectangle (framebuffer,
                                        pick_pipeline,
-                                       0, 0,
-                                       width, height);
+                                       box->x1, box->y1,
+                                       box->x2, box->y2);
 
       cogl_object_unref (pick_pipeline);
     }
-
-  /* XXX - this thoroughly sucks, but we need to maintain compatibility
-   * with existing container classes that override the pick() virtual
-   * and chain up to the default implementation - otherwise we'll end up
-   * painting our children twice.
-   *
-   * this has to go away for 2.0; hopefully along the pick() itself.
-   */
-  if (CLUTTER_ACTOR_GET_CLASS (self)->pick == clutter_actor_real_pick)
-    {
-      ClutterActor *iter;
-
-      for (iter = self->priv->first_child;
-           iter != NULL;
-           iter = iter->priv->next_sibling)
-        clutter_actor_paint (iter);
-    }
 }
 
 /**
@@ -2554,6 +2619,16 @@ clutter_actor_set_allocation_internal (ClutterActor           *self,
                     _clutter_actor_get_debug_name (self));
 
       priv->transform_valid = FALSE;
+      clutter_actor_invalidate_paint_nodes (self);
+
+      /* the pick stacks recorded the old allocation */
+      if (CLUTTER_ACTOR_IS_MAPPED (self))
+        {
+          ClutterActor *stage = _clutter_actor_get_stage_internal (self);
+
+          if (stage != NULL)
+            clutter_stage_invalidate_pick (CLUTTER_STAGE (stage));
+        }
 
       g_object_notify_by_pspec (obj, obj_props[PROP_ALLOCATION]);
 
@@ -2796,6 +2871,84 @@ clutter_actor_needs_relayout (ClutterActor *self)
           priv->needs_allocation);
 }
 
+/* Whether a relayout queued by one of the children of @self can be
+ * confined to @self. This is the case when nothing @self reports to
+ * its parent depends on its children, so that the layout of the
+ * parent won't change, and we only need to allocate @self again with
+ * its current allocation.
+ */
+static gboolean
+clutter_actor_is_relayout_root (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (CLUTTER_ACTOR_IS_TOPLEVEL (self) || priv->parent == NULL)
+    return FALSE;
+
+  /* the preferred size must be fixed... */
+  if (!priv->min_width_set || !priv->natural_width_set ||
+      !priv->min_height_set || !priv->natural_height_set)
+    return FALSE;
+
+  /* ...and so must the expand flags, unless they are up to date */
+  if (priv->needs_compute_expand &&
+      (!priv->x_expand_set || !priv->y_expand_set))
+    return FALSE;
+
+  /* constraints can bind the allocation to any actor, children included */
+  if (priv->constraints != NULL &&
+      _clutter_meta_group_peek_metas (priv->constraints) != NULL)
+    return FALSE;
+
+  /* clones follow the relayout of their source */
+  if (priv->clones != NULL || priv->in_cloned_branch != 0)
+    return FALSE;
+
+  /* we can only allocate again what was allocated before */
+  if (priv->needs_width_request || priv->needs_height_request)
+    return FALSE;
+
+  return _clutter_actor_get_stage_internal (self) != NULL;
+}
+
+static void
+clutter_actor_queue_relayout_root (ClutterActor *self)
+{
+  ClutterActor *stage = _clutter_actor_get_stage_internal (self);
+  ClutterActor *iter;
+
+  CLUTTER_NOTE (LAYOUT, "Queueing relayout of the children of '%s'",
+                _clutter_actor_get_debug_name (self));
+
+  self->priv->needs_allocation = TRUE;
+
+  /* the paint volume of the ancestors includes the one of the children */
+  for (iter = self; iter != NULL; iter = iter->priv->parent)
+    iter->priv->needs_paint_volume_update = TRUE;
+
+  _clutter_stage_queue_relayout_root (CLUTTER_STAGE (stage), self);
+}
+
+/*
+ * _clutter_actor_allocate_relayout_root:
+ * @self: a #ClutterActor
+ *
+ * Allocates the children of a relayout root again, keeping the current
+ * allocation of @self; see clutter_actor_is_relayout_root().
+ */
+void
+_clutter_actor_allocate_relayout_root (ClutterActor *self)
+{
+  ClutterActorBox allocation;
+
+  /* the parent might have allocated it again in the meantime */
+  if (!self->priv->needs_allocation)
+    return;
+
+  allocation = self->priv->allocation;
+  clutter_actor_allocate_internal (self, &allocation, CLUTTER_ALLOCATION_NONE);
+}
+
 static void
 clutter_actor_real_queue_relayout (ClutterActor *self)
 {
@@ -2816,9 +2969,15 @@ clutter_actor_real_queue_relayout (ClutterActor *self)
   memset (priv->height_requests, 0,
           N_CACHED_SIZE_REQUESTS * sizeof (SizeRequest));
 
-  /* We need to go all the way up the hierarchy */
+  /* We need to go all the way up the hierarchy, unless we reach an
+   * actor whose own layout does not depend on its children */
   if (priv->parent != NULL)
-    _clutter_actor_queue_only_relayout (priv->parent);
+    {
+      if (clutter_actor_is_relayout_root (priv->parent))
+        clutter_actor_queue_relayout_root (priv->parent);
+      else
+        _clutter_actor_queue_only_relayout (priv->parent);
+    }
 }
 
 /**
@@ -3158,6 +3317,9 @@ clutter_actor_real_apply_transform (ClutterActor  *self,
 
   info = _clutter_actor_get_transform_info_or_defaults (self);
 
+  /* the modelview we painted with is stale as well */
+  priv->paint_modelview_valid = FALSE;
+
   /* compute the pivot point given the allocated size */
   pivot_x = (priv->allocation.x2 - priv->allocation.x1)
           * info->pivot.x;
@@ -3292,6 +3454,40 @@ _clutter_actor_apply_modelview_transform (ClutterActor  *self,
   CLUTTER_ACTOR_GET_CLASS (self)->apply_transform (self, matrix);
 }
 
+/* Applies the transforms associated with this actor to the modelview
+ * it is being painted with. The result is cached with the actor, so
+ * that as long as neither its transformation nor the modelview of its
+ * parent change, e.g. when the same scene is painted once per stage
+ * view, we can skip composing it again. */
+static void
+clutter_actor_apply_paint_modelview (ClutterActor *self,
+                                     CoglMatrix   *matrix)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  /* we can only tell when the default implementation changes its
+   * transformation */
+  if (CLUTTER_ACTOR_GET_CLASS (self)->apply_transform !=
+      clutter_actor_real_apply_transform)
+    {
+      _clutter_actor_apply_modelview_transform (self, matrix);
+      return;
+    }
+
+  if (priv->paint_modelview_valid &&
+      priv->transform_valid &&
+      cogl_matrix_equal (matrix, &priv->paint_parent_modelview))
+    {
+      *matrix = priv->paint_modelview;
+      return;
+    }
+
+  priv->paint_parent_modelview = *matrix;
+  _clutter_actor_apply_modelview_transform (self, matrix);
+  priv->paint_modelview = *matrix;
+  priv->paint_modelview_valid = TRUE;
+}
+
 /*
  * clutter_actor_apply_relative_transformation_matrix:
  * @self: The actor whose coordinate space you want to transform from.
@@ -3796,11 +3992,74 @@ clutter_actor_paint_node (ClutterActor     *actor,
     }
 #endif /* CLUTTER_ENABLE_DEBUG */
 
-  clutter_paint_node_paint (root);
-
   return TRUE;
 }
 
+static void
+clutter_actor_invalidate_paint_nodes (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  priv->paint_nodes_valid = FALSE;
+  g_clear_pointer (&priv->paint_nodes, clutter_paint_node_unref);
+}
+
+/* Returns the tree of paint nodes for the actor, or %NULL if the actor
+ * has nothing to paint through paint nodes.
+ *
+ * The tree is retained between paints, and only built again once the
+ * actor queues a redraw or a relayout, or when its paint opacity or
+ * resource scale changed; the paint nodes of an unchanged actor are
+ * simply replayed, without going through the content and the
+ * ::paint_node virtual function.
+ */
+static ClutterPaintNode *
+clutter_actor_get_paint_nodes (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterStage *stage;
+  ClutterPaintNode *root;
+  guint8 paint_opacity;
+  gboolean retain;
+
+  stage = (ClutterStage *) _clutter_actor_get_stage_internal (self);
+  paint_opacity = clutter_actor_get_paint_opacity_internal (self);
+
+  /* the stage clear node depends on the framebuffer being painted */
+  retain = !CLUTTER_ACTOR_IS_TOPLEVEL (self) &&
+           !(clutter_paint_debug_flags & CLUTTER_DEBUG_DISABLE_PAINT_NODE_CACHE);
+
+  if (retain &&
+      priv->paint_nodes_valid &&
+      priv->paint_nodes_opacity == paint_opacity &&
+      priv->paint_nodes_resource_scale == priv->resource_scale)
+    {
+      if (stage != NULL)
+        _clutter_stage_count_paint_nodes (stage, TRUE);
+
+      return priv->paint_nodes;
+    }
+
+  if (stage != NULL)
+    _clutter_stage_count_paint_nodes (stage, FALSE);
+
+  clutter_actor_invalidate_paint_nodes (self);
+
+  root = _clutter_dummy_node_new (self);
+  clutter_paint_node_set_name (root, "Root");
+
+  if (clutter_actor_paint_node (self, root))
+    priv->paint_nodes = root;
+  else
+    clutter_paint_node_unref (root);
+
+  priv->paint_nodes_valid = retain;
+  priv->paint_nodes_opacity = paint_opacity;
+  priv->paint_nodes_resource_scale = priv->resource_scale;
+
+  return priv->paint_nodes;
+}
+
 /**
  * clutter_actor_paint:
  * @self: A #ClutterActor
@@ -3825,6 +4084,7 @@ clutter_actor_paint (ClutterActor *self)
   ClutterActorPrivate *priv;
   ClutterPickMode pick_mode;
   gboolean clip_set = FALSE;
+  gboolean pick_clip_set = FALSE;
   ClutterStage *stage;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
@@ -3868,11 +4128,8 @@ clutter_actor_paint (ClutterActor *self)
     {
       CoglMatrix matrix;
 
-      /* XXX: It could be better to cache the modelview with the actor
-       * instead of progressively building up the transformations on
-       * the matrix stack every time we paint. */
       cogl_get_modelview_matrix (&matrix);
-      _clutter_actor_apply_modelview_transform (self, &matrix);
+      clutter_actor_apply_paint_modelview (self, &matrix);
 
 #ifdef CLUTTER_ENABLE_DEBUG
       /* Catch when out-of-band transforms have been made by actors not as part
@@ -3924,6 +4181,19 @@ clutter_actor_paint (ClutterActor *self)
                                             priv->clip.origin.x + priv->clip.size.width,
                                             priv->clip.origin.y + priv->clip.size.height);
       clip_set = TRUE;
+
+      if (_clutter_stage_is_logging_pick (stage))
+        {
+          ClutterActorBox clip_box = {
+            .x1 = priv->clip.origin.x,
+            .y1 = priv->clip.origin.y,
+            .x2 = priv->clip.origin.x + priv->clip.size.width,
+            .y2 = priv->clip.origin.y + priv->clip.size.height,
+          };
+
+          _clutter_stage_push_pick_clip (stage, &clip_box);
+          pick_clip_set = TRUE;
+        }
     }
   else if (priv->clip_to_allocation)
     {
@@ -3935,6 +4205,14 @@ clutter_actor_paint (ClutterActor *self)
 
       cogl_framebuffer_push_rectangle_clip (fb, 0, 0, width, height);
       clip_set = TRUE;
+
+      if (_clutter_stage_is_logging_pick (stage))
+        {
+          ClutterActorBox clip_box = { 0, 0, width, height };
+
+          _clutter_stage_push_pick_clip (stage, &clip_box);
+          pick_clip_set = TRUE;
+        }
     }
 
   if (pick_mode == CLUTTER_PICK_NONE)
@@ -4020,6 +4298,9 @@ done:
       cogl_framebuffer_pop_clip (fb);
     }
 
+  if (pick_clip_set)
+    _clutter_stage_pop_pick_clip (stage);
+
   cogl_pop_matrix ();
 
   /* paint sequence complete */
@@ -4061,21 +4342,16 @@ clutter_actor_continue_paint (ClutterActor *self)
     {
       if (_clutter_context_get_pick_mode () == CLUTTER_PICK_NONE)
         {
-          ClutterPaintNode *dummy;
+          ClutterPaintNode *root;
 
           /* XXX - this will go away in 2.0, when we can get rid of this
            * stuff and switch to a pure retained render tree of PaintNodes
            * for the entire frame, starting from the Stage; the paint()
            * virtual function can then be called directly.
            */
-          dummy = _clutter_dummy_node_new (self);
-          clutter_paint_node_set_name (dummy, "Root");
-
-          /* XXX - for 1.12, we use the return value of paint_node() to
-           * decide whether we should emit the ::paint signal.
-           */
-          clutter_actor_paint_node (self, dummy);
-          clutter_paint_node_unref (dummy);
+          root = clutter_actor_get_paint_nodes (self);
+          if (root != NULL)
+            clutter_paint_node_paint (root);
 
           /* XXX:2.0 - Call the paint() virtual directly */
           if (g_signal_has_handler_pending (self, actor_signals[PAINT],
@@ -4086,10 +4362,26 @@ clutter_actor_continue_paint (ClutterActor *self)
         }
       else
         {
+          ClutterStage *stage;
           ClutterColor col = { 0, };
+          gboolean custom_pick;
+          guint pick_position = 0;
+
+          stage = (ClutterStage *) _clutter_actor_get_stage_internal (self);
 
           _clutter_id_to_color (_clutter_actor_get_pick_id (self), &col);
 
+          /* Pick implementations other than the default one may paint a
+           * silhouette we can't know about; note where they start so we
+           * can check whether they logged their own geometry.
+           */
+          custom_pick =
+            g_signal_has_handler_pending (self, actor_signals[PICK], 0, TRUE) ||
+            CLUTTER_ACTOR_GET_CLASS (self)->pick != clutter_actor_real_pick;
+
+          if (custom_pick && _clutter_stage_is_logging_pick (stage))
+            pick_position = _clutter_stage_get_pick_stack_length (stage);
+
           /* Actor will then paint silhouette of itself in supplied
            * color.  See clutter_stage_get_actor_at_pos() for where
            * picking is enabled.
@@ -4101,6 +4393,26 @@ clutter_actor_continue_paint (ClutterActor *self)
             g_signal_emit (self, actor_signals[PICK], 0, &col);
           else
             CLUTTER_ACTOR_GET_CLASS (self)->pick (self, &col);
+
+          /* The stage never paints a silhouette of itself, so it doesn't
+           * need a fallback either.
+           */
+          if (custom_pick &&
+              _clutter_stage_is_logging_pick (stage) &&
+              !CLUTTER_ACTOR_IS_TOPLEVEL (self) &&
+              clutter_actor_should_pick_paint (self) &&
+              !_clutter_stage_has_pick_since (stage, pick_position, self))
+            {
+              ClutterActorBox box = {
+                .x1 = 0,
+                .y1 = 0,
+                .x2 = clutter_actor_box_get_width (&priv->allocation),
+                .y2 = clutter_actor_box_get_height (&priv->allocation),
+              };
+
+              _clutter_stage_log_pick_fallback (stage, pick_position,
+                                                &box, self);
+            }
         }
     }
   else
@@ -6025,6 +6337,8 @@ clutter_actor_dispose (GObject *object)
   g_clear_object (&priv->effects);
   g_clear_object (&priv->flatten_effect);
 
+  clutter_actor_invalidate_paint_nodes (self);
+
   if (priv->child_model != NULL)
     {
       if (priv->create_child_notify != NULL)
@@ -8859,6 +9173,13 @@ _clutter_actor_queue_redraw_full (ClutterActor             *self,
   if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
     return;
 
+  /* whatever changed might affect the paint nodes we retained, unless
+   * the redraw only concerns an effect, which has its own caching; do
+   * this before bailing out on unmapped actors, so that we don't replay
+   * stale paint nodes once the actor gets mapped again */
+  if (effect == NULL)
+    clutter_actor_invalidate_paint_nodes (self);
+
   /* we can ignore unmapped actors, unless they have at least one
    * mapped clone or they are inside a cloned branch of the scene
    * graph, as unmapped actors will simply be left unpainted.
@@ -14038,6 +14359,14 @@ clutter_actor_set_reactive (ClutterActor *actor,
   else
     CLUTTER_ACTOR_UNSET_FLAGS (actor, CLUTTER_ACTOR_REACTIVE);
 
+  if (CLUTTER_ACTOR_IS_MAPPED (actor))
+    {
+      ClutterActor *stage = _clutter_actor_get_stage_internal (actor);
+
+      if (stage != NULL)
+        clutter_stage_invalidate_pick (CLUTTER_STAGE (stage));
+    }
+
   g_object_notify_by_pspec (G_OBJECT (actor), obj_props[PROP_REACTIVE]);
 }
 
@@ -580,6 +580,9 @@ ClutterOffscreenRedirect        clutter_actor_get_offscreen_redirect
 CLUTTER_EXPORT
 gboolean                        clutter_actor_should_pick_paint                 (ClutterActor               *self);
 CLUTTER_EXPORT
+void                            clutter_actor_pick_box                          (ClutterActor               *self,
+                                                                                 const ClutterActorBox      *box);
+CLUTTER_EXPORT
 gboolean                        clutter_actor_is_in_clone_paint                 (ClutterActor               *self);
 CLUTTER_EXPORT
 gboolean                        clutter_actor_get_paint_box                     (ClutterActor               *self,
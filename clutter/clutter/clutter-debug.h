@@ -30,7 +30,8 @@ typedef enum
 typedef enum
 {
   CLUTTER_DEBUG_NOP_PICKING         = 1 << 0,
-  CLUTTER_DEBUG_DUMP_PICK_BUFFERS   = 1 << 1
+  CLUTTER_DEBUG_DUMP_PICK_BUFFERS   = 1 << 1,
+  CLUTTER_DEBUG_COLOR_PICKING       = 1 << 2
 } ClutterPickDebugFlag;
 
 typedef enum
@@ -44,6 +45,7 @@ typedef enum
   CLUTTER_DEBUG_CONTINUOUS_REDRAW       = 1 << 6,
   CLUTTER_DEBUG_PAINT_DEFORM_TILES      = 1 << 7,
   CLUTTER_DEBUG_PAINT_DAMAGE_REGION     = 1 << 8,
+  CLUTTER_DEBUG_DISABLE_PAINT_NODE_CACHE = 1 << 9,
 } ClutterDrawDebugFlag;
 
 #ifdef CLUTTER_ENABLE_DEBUG
@@ -1671,6 +1671,26 @@ typedef enum
   CLUTTER_INPUT_PANEL_STATE_TOGGLE,
 } ClutterInputPanelState;
 
+/**
+ * ClutterFrameInfoFlag:
+ * @CLUTTER_FRAME_INFO_FLAG_NONE: No flags set
+ * @CLUTTER_FRAME_INFO_FLAG_HW_CLOCK: The presentation time is a hardware
+ *   timestamp on the CLOCK_MONOTONIC clock
+ * @CLUTTER_FRAME_INFO_FLAG_ZERO_COPY: The frame was presented by scanning
+ *   out a client buffer directly
+ * @CLUTTER_FRAME_INFO_FLAG_VSYNC: The frame was presented in sync with the
+ *   vertical retrace
+ *
+ * Flags describing how a frame was presented.
+ */
+typedef enum
+{
+  CLUTTER_FRAME_INFO_FLAG_NONE      = 0,
+  CLUTTER_FRAME_INFO_FLAG_HW_CLOCK  = 1 << 0,
+  CLUTTER_FRAME_INFO_FLAG_ZERO_COPY = 1 << 1,
+  CLUTTER_FRAME_INFO_FLAG_VSYNC     = 1 << 2,
+} ClutterFrameInfoFlag;
+
 G_END_DECLS
 
 #endif /* __CLUTTER_ENUMS_H__ */
@@ -131,6 +131,7 @@ static const GDebugKey clutter_debug_keys[] = {
 static const GDebugKey clutter_pick_debug_keys[] = {
   { "nop-picking", CLUTTER_DEBUG_NOP_PICKING },
   { "dump-pick-buffers", CLUTTER_DEBUG_DUMP_PICK_BUFFERS },
+  { "color-picking", CLUTTER_DEBUG_COLOR_PICKING },
 };
 
 static const GDebugKey clutter_paint_debug_keys[] = {
@@ -143,6 +144,7 @@ static const GDebugKey clutter_paint_debug_keys[] = {
   { "continuous-redraw", CLUTTER_DEBUG_CONTINUOUS_REDRAW },
   { "paint-deform-tiles", CLUTTER_DEBUG_PAINT_DEFORM_TILES },
   { "damage-region", CLUTTER_DEBUG_PAINT_DAMAGE_REGION },
+  { "disable-paint-node-cache", CLUTTER_DEBUG_DISABLE_PAINT_NODE_CACHE },
 };
 
 static void
@@ -43,6 +43,21 @@ void clutter_stage_capture_into (ClutterStage          *stage,
                                  cairo_rectangle_int_t *rect,
                                  uint8_t               *data);
 
+CLUTTER_EXPORT
+CoglReadPixelsClosure * clutter_stage_capture_into_bitmap_async (ClutterStage           *stage,
+                                                                 cairo_rectangle_int_t  *rect,
+                                                                 CoglBitmap             *bitmap,
+                                                                 CoglReadPixelsCallback  callback,
+                                                                 gpointer                user_data,
+                                                                 GError                **error);
+
+CLUTTER_EXPORT
+void clutter_stage_capture_region_into (ClutterStage                *stage,
+                                        const cairo_rectangle_int_t *rect,
+                                        const cairo_region_t        *region,
+                                        uint8_t                     *data,
+                                        int                          stride);
+
 CLUTTER_EXPORT
 void clutter_stage_freeze_updates (ClutterStage *stage);
 
@@ -55,6 +70,12 @@ void clutter_stage_update_resource_scales (ClutterStage *stage);
 CLUTTER_EXPORT
 gboolean clutter_actor_has_damage (ClutterActor *actor);
 
+CLUTTER_EXPORT
+void clutter_stage_invalidate_pick (ClutterStage *stage);
+
+CLUTTER_EXPORT
+ClutterStageView * clutter_stage_get_current_view (ClutterStage *stage);
+
 #undef __CLUTTER_H_INSIDE__
 
 #endif /* __CLUTTER_MUTTER_H__ */
@@ -269,7 +269,6 @@ struct _ClutterDummyNode
   ClutterPaintNode parent_instance;
 
   ClutterActor *actor;
-  CoglFramebuffer *framebuffer;
 };
 
 G_DEFINE_TYPE (ClutterDummyNode, clutter_dummy_node, CLUTTER_TYPE_PAINT_NODE)
@@ -309,7 +308,9 @@ clutter_dummy_node_get_framebuffer (ClutterPaintNode *node)
 {
   ClutterDummyNode *dnode = (ClutterDummyNode *) node;
 
-  return dnode->framebuffer;
+  /* the actor may retain its paint nodes across frames and stage
+   * views, so always look up the framebuffer it's being painted on */
+  return _clutter_actor_get_active_framebuffer (dnode->actor);
 }
 
 static void
@@ -337,7 +338,6 @@ _clutter_dummy_node_new (ClutterActor *actor)
 
   dnode = (ClutterDummyNode *) res;
   dnode->actor = actor;
-  dnode->framebuffer = _clutter_actor_get_active_framebuffer (actor);
 
   return res;
 }
@@ -92,6 +92,12 @@ void                          _clutter_stage_queue_redraw_entry_invalidate (Clut
 
 CoglFramebuffer *_clutter_stage_get_active_framebuffer (ClutterStage *stage);
 
+void             _clutter_stage_count_paint_nodes       (ClutterStage *stage,
+                                                         gboolean      retained);
+
+void             _clutter_stage_queue_relayout_root     (ClutterStage *stage,
+                                                         ClutterActor *actor);
+
 gint32          _clutter_stage_acquire_pick_id          (ClutterStage *stage,
                                                          ClutterActor *actor);
 void            _clutter_stage_release_pick_id          (ClutterStage *stage,
@@ -99,6 +105,22 @@ void            _clutter_stage_release_pick_id          (ClutterStage *stage,
 ClutterActor *  _clutter_stage_get_actor_by_pick_id     (ClutterStage *stage,
                                                          gint32        pick_id);
 
+gboolean        _clutter_stage_is_logging_pick          (ClutterStage          *stage);
+void            _clutter_stage_log_pick                 (ClutterStage          *stage,
+                                                         const ClutterActorBox *box,
+                                                         ClutterActor          *actor);
+guint           _clutter_stage_get_pick_stack_length    (ClutterStage          *stage);
+gboolean        _clutter_stage_has_pick_since           (ClutterStage          *stage,
+                                                         guint                  position,
+                                                         ClutterActor          *actor);
+void            _clutter_stage_log_pick_fallback        (ClutterStage          *stage,
+                                                         guint                  position,
+                                                         const ClutterActorBox *box,
+                                                         ClutterActor          *actor);
+void            _clutter_stage_push_pick_clip           (ClutterStage          *stage,
+                                                         const ClutterActorBox *box);
+void            _clutter_stage_pop_pick_clip            (ClutterStage          *stage);
+
 void            _clutter_stage_add_pointer_drag_actor    (ClutterStage       *stage,
                                                           ClutterInputDevice *device,
                                                           ClutterActor       *actor);
@@ -132,6 +154,10 @@ void            _clutter_stage_presented                (ClutterStage      *stag
                                                          CoglFrameEvent     frame_event,
                                                          ClutterFrameInfo  *frame_info);
 
+void            _clutter_stage_view_presented           (ClutterStage      *stage,
+                                                         ClutterStageView  *view,
+                                                         ClutterFrameInfo  *frame_info);
+
 GList *         _clutter_stage_peek_stage_views         (ClutterStage *stage);
 
 G_END_DECLS
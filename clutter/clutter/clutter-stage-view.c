@@ -45,6 +45,8 @@ typedef struct _ClutterStageViewPrivate
   CoglOffscreen *offscreen;
   CoglPipeline *pipeline;
 
+  CoglScanout *next_scanout;
+
   guint dirty_viewport   : 1;
   guint dirty_projection : 1;
 } ClutterStageViewPrivate;
@@ -200,6 +202,35 @@ clutter_stage_view_get_offscreen_transformation_matrix (ClutterStageView *view,
   view_class->get_offscreen_transformation_matrix (view, matrix);
 }
 
+/**
+ * clutter_stage_view_assign_next_scanout:
+ * @view: a #ClutterStageView
+ * @scanout: a #CoglScanout
+ *
+ * Makes the next frame of @view present @scanout instead of the painted
+ * stage, if the onscreen framebuffer of @view can present it. The
+ * assignment only lasts for one frame, and has to be made again before
+ * every frame that should be presented this way.
+ */
+void
+clutter_stage_view_assign_next_scanout (ClutterStageView *view,
+                                        CoglScanout      *scanout)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+
+  g_set_object (&priv->next_scanout, scanout);
+}
+
+CoglScanout *
+clutter_stage_view_take_scanout (ClutterStageView *view)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+
+  return g_steal_pointer (&priv->next_scanout);
+}
+
 void
 clutter_stage_view_transform_to_onscreen (ClutterStageView *view,
                                           gfloat           *x,
@@ -304,6 +335,7 @@ clutter_stage_view_dispose (GObject *object)
   g_clear_pointer (&priv->framebuffer, cogl_object_unref);
   g_clear_pointer (&priv->offscreen, cogl_object_unref);
   g_clear_pointer (&priv->pipeline, cogl_object_unref);
+  g_clear_object (&priv->next_scanout);
 
   G_OBJECT_CLASS (clutter_stage_view_parent_class)->dispose (object);
 }
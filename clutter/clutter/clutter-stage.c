@@ -103,6 +103,35 @@ struct _ClutterStageQueueRedrawEntry
   ClutterPaintVolume clip;
 };
 
+typedef struct _PickRecord
+{
+  ClutterVertex vertex[4];
+  ClutterActor *actor;
+  int clip_stack_top;
+  guint needs_fallback : 1;
+} PickRecord;
+
+typedef struct _PickClipRecord
+{
+  int prev;
+  ClutterVertex vertex[4];
+} PickClipRecord;
+
+/* The pick stack of a view is kept around and reused for any pick on
+ * that view until the stage generation changes, i.e. until something
+ * queues a redraw or relayout, or actors are added or removed.
+ */
+typedef struct _PickStack
+{
+  GArray *records;
+  GArray *clips;
+  int clip_stack_top;
+
+  ClutterPickMode mode;
+  guint generation;
+  guint valid : 1;
+} PickStack;
+
 struct _ClutterStagePrivate
 {
   /* the stage implementation */
@@ -129,15 +158,29 @@ struct _ClutterStagePrivate
 
   GList *pending_queue_redraws;
 
+  /* actors that need to allocate their children again, without
+   * affecting the layout of their ancestors */
+  GHashTable *relayout_roots;
+
   CoglFramebuffer *active_framebuffer;
+  ClutterStageView *current_view;
 
   gint sync_delay;
 
   GTimer *fps_timer;
   gint32 timer_n_frames;
+  gint64 timer_paint_time_us;
+  guint timer_n_paint_nodes_retained;
+  guint timer_n_paint_nodes_built;
 
   ClutterIDPool *pick_id_pool;
 
+  PickStack *logging_pick_stack;
+  guint pick_generation;
+
+  /* layouts whose glyphs are being cached ahead of time */
+  GPtrArray *glyph_warmup_layouts;
+
 #ifdef CLUTTER_ENABLE_DEBUG
   gulong redraw_count;
 #endif /* CLUTTER_ENABLE_DEBUG */
@@ -192,6 +235,7 @@ enum
   DELETE_EVENT,
   AFTER_PAINT,
   PRESENTED,
+  VIEW_PRESENTED,
 
   LAST_SIGNAL
 };
@@ -672,7 +716,9 @@ clutter_stage_do_paint_view (ClutterStage                *stage,
 
   _clutter_stage_paint_volume_stack_free_all (stage);
   _clutter_stage_update_active_framebuffer (stage, framebuffer);
+  priv->current_view = view;
   clutter_actor_paint (CLUTTER_ACTOR (stage));
+  priv->current_view = NULL;
 }
 
 /* This provides a common point of entry for painting the scenegraph
@@ -685,10 +731,19 @@ _clutter_stage_paint_view (ClutterStage                *stage,
 {
   ClutterStagePrivate *priv = stage->priv;
 
+  gint64 paint_start_us = 0;
+
   if (!priv->impl)
     return;
 
+  if (G_UNLIKELY (priv->fps_timer != NULL))
+    paint_start_us = g_get_monotonic_time ();
+
   clutter_stage_do_paint_view (stage, view, clip);
+
+  if (G_UNLIKELY (priv->fps_timer != NULL))
+    priv->timer_paint_time_us += g_get_monotonic_time () - paint_start_us;
+
   g_signal_emit (stage, stage_signals[AFTER_PAINT], 0);
 }
 
@@ -1060,6 +1115,39 @@ _clutter_stage_needs_update (ClutterStage *stage)
   return priv->relayout_pending || priv->redraw_pending;
 }
 
+static void
+clutter_stage_allocate_relayout_roots (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  GHashTable *relayout_roots;
+  GHashTableIter iter;
+  gpointer key;
+
+  if (priv->relayout_roots == NULL)
+    return;
+
+  /* roots queued while allocating will be handled in the next relayout */
+  relayout_roots = priv->relayout_roots;
+  priv->relayout_roots = NULL;
+
+  g_hash_table_iter_init (&iter, relayout_roots);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      ClutterActor *root = key;
+
+      if (CLUTTER_ACTOR_IN_DESTRUCTION (root) ||
+          _clutter_actor_get_stage_internal (root) != CLUTTER_ACTOR (stage))
+        continue;
+
+      CLUTTER_NOTE (ACTOR, "Allocating relayout root '%s'",
+                    _clutter_actor_get_debug_name (root));
+
+      _clutter_actor_allocate_relayout_root (root);
+    }
+
+  g_hash_table_unref (relayout_roots);
+}
+
 void
 _clutter_stage_maybe_relayout (ClutterActor *actor)
 {
@@ -1098,6 +1186,8 @@ _clutter_stage_maybe_relayout (ClutterActor *actor)
       clutter_actor_allocate (CLUTTER_ACTOR (stage),
                               &box, CLUTTER_ALLOCATION_NONE);
 
+      clutter_stage_allocate_relayout_roots (stage);
+
       CLUTTER_UNSET_PRIVATE_FLAGS (stage, CLUTTER_IN_RELAYOUT);
     }
 }
@@ -1132,11 +1222,18 @@ clutter_stage_do_redraw (ClutterStage *stage)
 
       if (g_timer_elapsed (priv->fps_timer, NULL) >= 1.0)
         {
-          g_print ("*** FPS for %s: %i ***\n",
+          g_print ("*** FPS for %s: %i (paint: %.2f ms/frame, "
+                   "paint nodes: %u retained, %u built) ***\n",
                    _clutter_actor_get_debug_name (actor),
-                   priv->timer_n_frames);
+                   priv->timer_n_frames,
+                   priv->timer_paint_time_us / 1000.0 / priv->timer_n_frames,
+                   priv->timer_n_paint_nodes_retained,
+                   priv->timer_n_paint_nodes_built);
 
           priv->timer_n_frames = 0;
+          priv->timer_paint_time_us = 0;
+          priv->timer_n_paint_nodes_retained = 0;
+          priv->timer_n_paint_nodes_built = 0;
           g_timer_start (priv->fps_timer);
         }
     }
@@ -1270,6 +1367,8 @@ clutter_stage_real_queue_relayout (ClutterActor *self)
   ClutterStagePrivate *priv = stage->priv;
   ClutterActorClass *parent_class;
 
+  clutter_stage_invalidate_pick (stage);
+
   if (!priv->relayout_pending)
     {
       _clutter_stage_schedule_update (stage);
@@ -1431,12 +1530,234 @@ read_pixels_to_file (CoglFramebuffer *fb,
   read_count++;
 }
 
+static gboolean
+is_inside_quadrilateral (const ClutterVertex *vertex,
+                         float                x,
+                         float                y)
+{
+  gboolean has_positive = FALSE;
+  gboolean has_negative = FALSE;
+  int i;
+
+  /* The quadrilaterals are convex, so the point is inside if it lies on
+   * the same side of every edge, regardless of the winding order the
+   * transformation left the vertices in.
+   */
+  for (i = 0; i < 4; i++)
+    {
+      const ClutterVertex *a = &vertex[i];
+      const ClutterVertex *b = &vertex[(i + 1) % 4];
+      float cross;
+
+      cross = (b->x - a->x) * (y - a->y) - (b->y - a->y) * (x - a->x);
+      if (cross > 0.f)
+        has_positive = TRUE;
+      else if (cross < 0.f)
+        has_negative = TRUE;
+    }
+
+  return !(has_positive && has_negative);
+}
+
+static gboolean
+pick_record_contains_point (const PickStack  *pick_stack,
+                            const PickRecord *rec,
+                            float             x,
+                            float             y)
+{
+  int clip_index;
+
+  if (!is_inside_quadrilateral (rec->vertex, x, y))
+    return FALSE;
+
+  clip_index = rec->clip_stack_top;
+  while (clip_index >= 0)
+    {
+      const PickClipRecord *clip =
+        &g_array_index (pick_stack->clips, PickClipRecord, clip_index);
+
+      if (!is_inside_quadrilateral (clip->vertex, x, y))
+        return FALSE;
+
+      clip_index = clip->prev;
+    }
+
+  return TRUE;
+}
+
+static void
+clear_pick_stack (PickStack *pick_stack)
+{
+  g_array_set_size (pick_stack->records, 0);
+  g_array_set_size (pick_stack->clips, 0);
+  pick_stack->clip_stack_top = -1;
+  pick_stack->valid = FALSE;
+}
+
+static void
+pick_stack_free (PickStack *pick_stack)
+{
+  g_array_free (pick_stack->records, TRUE);
+  g_array_free (pick_stack->clips, TRUE);
+  g_slice_free (PickStack, pick_stack);
+}
+
+static PickStack *
+ensure_view_pick_stack (ClutterStageView *view)
+{
+  static GQuark pick_stack_quark = 0;
+  PickStack *pick_stack;
+
+  if (G_UNLIKELY (pick_stack_quark == 0))
+    pick_stack_quark = g_quark_from_static_string ("clutter-stage-pick-stack");
+
+  pick_stack = g_object_get_qdata (G_OBJECT (view), pick_stack_quark);
+  if (pick_stack == NULL)
+    {
+      pick_stack = g_slice_new0 (PickStack);
+      pick_stack->records = g_array_new (FALSE, FALSE, sizeof (PickRecord));
+      pick_stack->clips = g_array_new (FALSE, FALSE, sizeof (PickClipRecord));
+      pick_stack->clip_stack_top = -1;
+
+      g_object_set_qdata_full (G_OBJECT (view), pick_stack_quark,
+                               pick_stack,
+                               (GDestroyNotify) pick_stack_free);
+    }
+
+  return pick_stack;
+}
+
+static void
+log_view_pick_stack (ClutterStage     *stage,
+                     ClutterStageView *view,
+                     ClutterPickMode   mode,
+                     PickStack        *pick_stack)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  CoglFramebuffer *fb = clutter_stage_view_get_framebuffer (view);
+  ClutterMainContext *context;
+  guint generation;
+  gint dirty_x;
+  gint dirty_y;
+  float fb_scale;
+
+  /* Anything invalidating the pick while we're logging leaves the
+   * resulting stack stale right away.
+   */
+  generation = priv->pick_generation;
+
+  context = _clutter_context_get_default ();
+  fb_scale = clutter_stage_view_get_scale (view);
+
+  cogl_push_framebuffer (fb);
+
+  /* needed for when a context switch happens */
+  _clutter_stage_maybe_setup_viewport (stage, view);
+
+  /* Custom pick implementations may still draw into the framebuffer;
+   * confine that to the pixel the stage window will repaint anyway.
+   */
+  _clutter_stage_window_get_dirty_pixel (priv->impl, view, &dirty_x, &dirty_y);
+  cogl_framebuffer_push_scissor_clip (fb,
+                                      dirty_x * fb_scale,
+                                      dirty_y * fb_scale,
+                                      1, 1);
+
+  clear_pick_stack (pick_stack);
+
+  priv->logging_pick_stack = pick_stack;
+  context->pick_mode = mode;
+
+  clutter_stage_do_paint_view (stage, view, NULL);
+
+  context->pick_mode = CLUTTER_PICK_NONE;
+  priv->logging_pick_stack = NULL;
+
+  cogl_framebuffer_pop_clip (fb);
+  cogl_pop_framebuffer ();
+
+  pick_stack->mode = mode;
+  pick_stack->generation = generation;
+  pick_stack->valid = TRUE;
+}
+
+/*
+ * Picks by recording the transformed pick boxes and clips of every actor
+ * during a pick traversal and hit-testing them on the CPU, topmost first.
+ * Nothing is read back from the GPU; custom pick implementations that
+ * do not log their geometry using clutter_actor_pick_box() leave
+ * fallback records behind, and hitting one of those sets @needs_fallback.
+ *
+ * The recorded pick stack is cached per view, so as long as the stage
+ * generation doesn't change, picking again only repeats the hit-test.
+ */
 static ClutterActor *
-_clutter_stage_do_pick_on_view (ClutterStage     *stage,
-                                gint              x,
-                                gint              y,
-                                ClutterPickMode   mode,
-                                ClutterStageView *view)
+_clutter_stage_do_geometric_pick_on_view (ClutterStage     *stage,
+                                          gint              x,
+                                          gint              y,
+                                          ClutterPickMode   mode,
+                                          ClutterStageView *view,
+                                          gboolean         *needs_fallback)
+{
+  ClutterActor *actor = CLUTTER_ACTOR (stage);
+  ClutterStagePrivate *priv = stage->priv;
+  PickStack *pick_stack;
+  ClutterActor *retval;
+  int i;
+
+  pick_stack = ensure_view_pick_stack (view);
+
+  if (pick_stack->valid &&
+      pick_stack->mode == mode &&
+      pick_stack->generation == priv->pick_generation)
+    {
+      CLUTTER_NOTE (PICK, "Reusing cached pick stack for %i,%i", x, y);
+    }
+  else
+    {
+      CLUTTER_NOTE (PICK, "Performing geometric pick at %i,%i", x, y);
+      log_view_pick_stack (stage, view, mode, pick_stack);
+    }
+
+  retval = actor;
+  *needs_fallback = FALSE;
+
+  /* Sample at the pixel center, like the rasterizer would */
+  for (i = pick_stack->records->len - 1; i >= 0; i--)
+    {
+      const PickRecord *rec =
+        &g_array_index (pick_stack->records, PickRecord, i);
+
+      if (!pick_record_contains_point (pick_stack, rec, x + 0.5f, y + 0.5f))
+        continue;
+
+      if (rec->needs_fallback)
+        {
+          CLUTTER_NOTE (PICK, "Actor %s has a custom pick, falling back "
+                        "to color picking",
+                        _clutter_actor_get_debug_name (rec->actor));
+          *needs_fallback = TRUE;
+          retval = NULL;
+        }
+      else
+        {
+          retval = rec->actor;
+          CLUTTER_NOTE (PICK, "Picking actor %s",
+                        _clutter_actor_get_debug_name (retval));
+        }
+
+      break;
+    }
+
+  return retval;
+}
+
+static ClutterActor *
+_clutter_stage_do_color_pick_on_view (ClutterStage     *stage,
+                                      gint              x,
+                                      gint              y,
+                                      ClutterPickMode   mode,
+                                      ClutterStageView *view)
 {
   ClutterActor *actor = CLUTTER_ACTOR (stage);
   ClutterStagePrivate *priv = stage->priv;
@@ -1574,6 +1895,28 @@ _clutter_stage_do_pick_on_view (ClutterStage     *stage,
   return retval;
 }
 
+static ClutterActor *
+_clutter_stage_do_pick_on_view (ClutterStage     *stage,
+                                gint              x,
+                                gint              y,
+                                ClutterPickMode   mode,
+                                ClutterStageView *view)
+{
+  ClutterActor *retval;
+  gboolean needs_fallback;
+
+  if (G_UNLIKELY (clutter_pick_debug_flags & (CLUTTER_DEBUG_COLOR_PICKING |
+                                              CLUTTER_DEBUG_DUMP_PICK_BUFFERS)))
+    return _clutter_stage_do_color_pick_on_view (stage, x, y, mode, view);
+
+  retval = _clutter_stage_do_geometric_pick_on_view (stage, x, y, mode, view,
+                                                     &needs_fallback);
+  if (needs_fallback)
+    retval = _clutter_stage_do_color_pick_on_view (stage, x, y, mode, view);
+
+  return retval;
+}
+
 static ClutterStageView *
 get_view_at (ClutterStage *stage,
              int           x,
@@ -1836,6 +2179,84 @@ clutter_stage_get_property (GObject    *gobject,
     }
 }
 
+static const char glyph_warmup_text[] =
+  " !\"#$%&'()*+,-./0123456789:;<=>?@"
+  "ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`"
+  "abcdefghijklmnopqrstuvwxyz{|}~";
+
+static void
+glyph_cache_warmed_up (PangoLayout *layout,
+                       gpointer     user_data)
+{
+  ClutterStage *stage = user_data;
+
+  g_ptr_array_remove (stage->priv->glyph_warmup_layouts, layout);
+}
+
+/*
+ * Caches the glyphs of ASCII and of the sample text of the default
+ * language, in the default font at the scale of every view, so that
+ * showing text rarely has to rasterize and upload glyphs mid-frame.
+ */
+static void
+clutter_stage_warm_up_glyph_cache (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  GArray *scales;
+  gchar *text;
+  GList *l;
+
+  if (priv->impl == NULL)
+    return;
+
+  /* dropping the layouts cancels the warm-ups still in progress */
+  g_ptr_array_set_size (priv->glyph_warmup_layouts, 0);
+
+  text = g_strconcat (glyph_warmup_text,
+                      pango_language_get_sample_string (NULL),
+                      NULL);
+  scales = g_array_new (FALSE, FALSE, sizeof (float));
+
+  for (l = _clutter_stage_window_get_views (priv->impl); l; l = l->next)
+    {
+      float scale = clutter_stage_view_get_scale (l->data);
+      PangoLayout *layout;
+      guint i;
+
+      for (i = 0; i < scales->len; i++)
+        {
+          if (g_array_index (scales, float, i) == scale)
+            break;
+        }
+
+      if (i < scales->len)
+        continue;
+
+      g_array_append_val (scales, scale);
+
+      layout = clutter_actor_create_pango_layout (CLUTTER_ACTOR (stage), text);
+
+      if (scale != 1.0f)
+        {
+          PangoAttrList *attrs = pango_attr_list_new ();
+
+          pango_attr_list_insert (attrs, pango_attr_scale_new (scale));
+          pango_layout_set_attributes (layout, attrs);
+          pango_attr_list_unref (attrs);
+        }
+
+      CLUTTER_NOTE (MISC, "Warming up the glyph cache at scale %.2f", scale);
+
+      g_ptr_array_add (priv->glyph_warmup_layouts, layout);
+      cogl_pango_ensure_glyph_cache_for_layout_async (layout,
+                                                      glyph_cache_warmed_up,
+                                                      stage);
+    }
+
+  g_array_free (scales, TRUE);
+  g_free (text);
+}
+
 static void
 clutter_stage_dispose (GObject *object)
 {
@@ -1864,6 +2285,10 @@ clutter_stage_dispose (GObject *object)
                     (GDestroyNotify) free_queue_redraw_entry);
   priv->pending_queue_redraws = NULL;
 
+  g_clear_pointer (&priv->relayout_roots, g_hash_table_unref);
+
+  g_ptr_array_set_size (priv->glyph_warmup_layouts, 0);
+
   /* this will release the reference on the stage */
   stage_manager = clutter_stage_manager_get_default ();
   _clutter_stage_manager_remove_stage (stage_manager, stage);
@@ -1886,6 +2311,8 @@ clutter_stage_finalize (GObject *object)
 
   _clutter_id_pool_free (priv->pick_id_pool);
 
+  g_ptr_array_free (priv->glyph_warmup_layouts, TRUE);
+
   if (priv->fps_timer != NULL)
     g_timer_destroy (priv->fps_timer);
 
@@ -2268,6 +2695,25 @@ clutter_stage_class_init (ClutterStageClass *klass)
                   G_TYPE_NONE, 2,
                   G_TYPE_INT, G_TYPE_POINTER);
 
+  /**
+   * ClutterStage::view-presented: (skip)
+   * @stage: the stage that received the event
+   * @view: the #ClutterStageView that was presented
+   * @frame_info: a #ClutterFrameInfo
+   *
+   * Signals that a frame of @view was presented on its output. Unlike
+   * #ClutterStage::presented, this is emitted for every view, with the
+   * timing information of that view's output.
+   */
+  stage_signals[VIEW_PRESENTED] =
+    g_signal_new (I_("view-presented"),
+                  G_TYPE_FROM_CLASS (gobject_class),
+                  G_SIGNAL_RUN_LAST,
+                  0, NULL, NULL,
+                  _clutter_marshal_VOID__OBJECT_POINTER,
+                  G_TYPE_NONE, 2,
+                  CLUTTER_TYPE_STAGE_VIEW, G_TYPE_POINTER);
+
   klass->fullscreen = clutter_stage_real_fullscreen;
   klass->activate = clutter_stage_real_activate;
   klass->deactivate = clutter_stage_real_deactivate;
@@ -2376,6 +2822,14 @@ clutter_stage_init (ClutterStage *self)
   g_signal_connect (self, "notify::min-height",
                     G_CALLBACK (clutter_stage_notify_min_size), NULL);
 
+  priv->glyph_warmup_layouts = g_ptr_array_new_with_free_func (g_object_unref);
+  g_signal_connect_object (backend, "font-changed",
+                           G_CALLBACK (clutter_stage_warm_up_glyph_cache),
+                           self, G_CONNECT_SWAPPED);
+  g_signal_connect_object (backend, "resolution-changed",
+                           G_CALLBACK (clutter_stage_warm_up_glyph_cache),
+                           self, G_CONNECT_SWAPPED);
+
   _clutter_stage_set_viewport (self,
                                0, 0,
                                geom.width,
@@ -4208,6 +4662,8 @@ _clutter_stage_queue_actor_redraw (ClutterStage                 *stage,
   CLUTTER_NOTE (CLIPPING, "stage_queue_actor_redraw (actor=%s, clip=%p): ",
                 _clutter_actor_get_debug_name (actor), clip);
 
+  clutter_stage_invalidate_pick (stage);
+
   if (!priv->redraw_pending)
     {
       ClutterMasterClock *master_clock;
@@ -4468,6 +4924,62 @@ _clutter_stage_get_active_framebuffer (ClutterStage *stage)
   return stage->priv->active_framebuffer;
 }
 
+/*
+ * _clutter_stage_queue_relayout_root:
+ * @stage: a #ClutterStage
+ * @actor: a #ClutterActor whose layout doesn't depend on its children
+ *
+ * Queues a relayout confined to the children of @actor: on the next
+ * relayout, @actor will be allocated again with its current allocation,
+ * instead of going through the layout of the whole stage.
+ */
+void
+_clutter_stage_queue_relayout_root (ClutterStage *stage,
+                                    ClutterActor *actor)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  clutter_stage_invalidate_pick (stage);
+
+  if (priv->relayout_roots == NULL)
+    priv->relayout_roots = g_hash_table_new_full (NULL, NULL,
+                                                  g_object_unref,
+                                                  NULL);
+
+  if (!g_hash_table_contains (priv->relayout_roots, actor))
+    g_hash_table_add (priv->relayout_roots, g_object_ref (actor));
+
+  if (!priv->relayout_pending)
+    {
+      _clutter_stage_schedule_update (stage);
+      priv->relayout_pending = TRUE;
+    }
+}
+
+/*
+ * _clutter_stage_count_paint_nodes:
+ * @stage: a #ClutterStage
+ * @retained: whether the actor replayed the paint nodes from its
+ *   previous paint, or had to build them again
+ *
+ * Accounts for an actor painting its paint nodes, for the statistics
+ * printed when showing the FPS.
+ */
+void
+_clutter_stage_count_paint_nodes (ClutterStage *stage,
+                                  gboolean      retained)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  if (G_LIKELY (priv->fps_timer == NULL))
+    return;
+
+  if (retained)
+    priv->timer_n_paint_nodes_retained++;
+  else
+    priv->timer_n_paint_nodes_built++;
+}
+
 gint32
 _clutter_stage_acquire_pick_id (ClutterStage *stage,
                                 ClutterActor *actor)
@@ -4501,6 +5013,179 @@ _clutter_stage_get_actor_by_pick_id (ClutterStage *stage,
   return _clutter_id_pool_lookup (priv->pick_id_pool, pick_id);
 }
 
+gboolean
+_clutter_stage_is_logging_pick (ClutterStage *stage)
+{
+  return stage != NULL && stage->priv->logging_pick_stack != NULL;
+}
+
+/**
+ * clutter_stage_invalidate_pick:
+ * @stage: a #ClutterStage
+ *
+ * Bumps the stage generation, so that the pick stacks cached for each
+ * view are recorded again on the next pick. Queuing a redraw or a
+ * relayout, or changing the allocation of a mapped actor, does this
+ * implicitly; this function is only needed when the pickable shape of an
+ * actor changes without any of those.
+ */
+void
+clutter_stage_invalidate_pick (ClutterStage *stage)
+{
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  stage->priv->pick_generation++;
+}
+
+static void
+transform_pick_box (ClutterStage          *stage,
+                    const ClutterActorBox *box,
+                    ClutterVertex         *vertex)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  ClutterVertex local[4];
+  CoglMatrix modelview;
+
+  local[0] = (ClutterVertex) { box->x1, box->y1, 0.f };
+  local[1] = (ClutterVertex) { box->x2, box->y1, 0.f };
+  local[2] = (ClutterVertex) { box->x2, box->y2, 0.f };
+  local[3] = (ClutterVertex) { box->x1, box->y2, 0.f };
+
+  cogl_get_modelview_matrix (&modelview);
+
+  _clutter_util_fully_transform_vertices (&modelview,
+                                          &priv->projection,
+                                          priv->viewport,
+                                          local,
+                                          vertex,
+                                          4);
+}
+
+static void
+init_pick_record (ClutterStage          *stage,
+                  PickRecord            *rec,
+                  const ClutterActorBox *box,
+                  ClutterActor          *actor,
+                  gboolean               needs_fallback)
+{
+  transform_pick_box (stage, box, rec->vertex);
+  rec->actor = actor;
+  rec->clip_stack_top = stage->priv->logging_pick_stack->clip_stack_top;
+  rec->needs_fallback = needs_fallback;
+}
+
+/*
+ * _clutter_stage_log_pick:
+ * @stage: a #ClutterStage
+ * @box: the box to log, in the coordinate space of the current modelview
+ * @actor: the actor the box belongs to
+ *
+ * Records @box, transformed into stage coordinates, as a pickable area
+ * of @actor during a geometric pick traversal. Records logged later are
+ * stacked on top of earlier ones.
+ */
+void
+_clutter_stage_log_pick (ClutterStage          *stage,
+                         const ClutterActorBox *box,
+                         ClutterActor          *actor)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  PickRecord rec;
+
+  g_assert (priv->logging_pick_stack != NULL);
+
+  init_pick_record (stage, &rec, box, actor, FALSE);
+  g_array_append_val (priv->logging_pick_stack->records, rec);
+}
+
+guint
+_clutter_stage_get_pick_stack_length (ClutterStage *stage)
+{
+  return stage->priv->logging_pick_stack->records->len;
+}
+
+gboolean
+_clutter_stage_has_pick_since (ClutterStage *stage,
+                               guint         position,
+                               ClutterActor *actor)
+{
+  GArray *records = stage->priv->logging_pick_stack->records;
+  guint i;
+
+  for (i = position; i < records->len; i++)
+    {
+      PickRecord *rec = &g_array_index (records, PickRecord, i);
+
+      if (rec->actor == actor)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/*
+ * _clutter_stage_log_pick_fallback:
+ * @stage: a #ClutterStage
+ * @position: the position in the pick stack to insert the record at
+ * @box: the box to log, in the coordinate space of the current modelview
+ * @actor: the actor the box belongs to
+ *
+ * Records @box as an area whose exact shape is only known to a custom
+ * pick implementation of @actor. If such a record ends up being the
+ * topmost hit, the stage falls back to a color-id pick.
+ */
+void
+_clutter_stage_log_pick_fallback (ClutterStage          *stage,
+                                  guint                  position,
+                                  const ClutterActorBox *box,
+                                  ClutterActor          *actor)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  PickRecord rec;
+
+  g_assert (priv->logging_pick_stack != NULL);
+  g_assert (position <= priv->logging_pick_stack->records->len);
+
+  init_pick_record (stage, &rec, box, actor, TRUE);
+  g_array_insert_val (priv->logging_pick_stack->records, position, rec);
+}
+
+void
+_clutter_stage_push_pick_clip (ClutterStage          *stage,
+                               const ClutterActorBox *box)
+{
+  PickStack *pick_stack = stage->priv->logging_pick_stack;
+  PickClipRecord clip;
+
+  g_assert (pick_stack != NULL);
+
+  clip.prev = pick_stack->clip_stack_top;
+  transform_pick_box (stage, box, clip.vertex);
+
+  g_array_append_val (pick_stack->clips, clip);
+  pick_stack->clip_stack_top = pick_stack->clips->len - 1;
+}
+
+void
+_clutter_stage_pop_pick_clip (ClutterStage *stage)
+{
+  PickStack *pick_stack = stage->priv->logging_pick_stack;
+  const PickClipRecord *top;
+
+  g_assert (pick_stack != NULL);
+  g_assert (pick_stack->clip_stack_top >= 0);
+
+  /* Individual clip records are not freed. This is so they can be shared
+   * as part of a tree of different clip stacks used by different actors
+   * in the pick stack. All of them get cleared when the pick stack is
+   * recorded again.
+   */
+  top = &g_array_index (pick_stack->clips,
+                        PickClipRecord,
+                        pick_stack->clip_stack_top);
+  pick_stack->clip_stack_top = top->prev;
+}
+
 void
 _clutter_stage_add_pointer_drag_actor (ClutterStage       *stage,
                                        ClutterInputDevice *device,
@@ -4767,6 +5452,31 @@ _clutter_stage_presented (ClutterStage     *stage,
                  (int) frame_event, frame_info);
 }
 
+void
+_clutter_stage_view_presented (ClutterStage     *stage,
+                               ClutterStageView *view,
+                               ClutterFrameInfo *frame_info)
+{
+  g_signal_emit (stage, stage_signals[VIEW_PRESENTED], 0,
+                 view, frame_info);
+}
+
+/**
+ * clutter_stage_get_current_view: (skip)
+ * @stage: a #ClutterStage
+ *
+ * Gets the view that is currently being painted, if any. This is only
+ * meaningful while the stage is painting.
+ *
+ * Return value: (transfer none) (nullable): the #ClutterStageView being
+ *   painted, or %NULL
+ */
+ClutterStageView *
+clutter_stage_get_current_view (ClutterStage *stage)
+{
+  return stage->priv->current_view;
+}
+
 static void
 capture_view (ClutterStage          *stage,
               gboolean               paint,
@@ -5000,6 +5710,116 @@ clutter_stage_capture_into (ClutterStage          *stage,
   capture_view_into (stage, paint, view, rect, data, rect->width * bpp);
 }
 
+/**
+ * clutter_stage_capture_into_bitmap_async:
+ * @stage: a #ClutterStage
+ * @rect: the area of the stage to read back
+ * @bitmap: the #CoglBitmap to read into, sized to @rect in view pixels
+ * @callback: (scope notified): called once the pixels are available
+ * @user_data: (closure): data passed to @callback
+ * @error: return location for a #GError
+ *
+ * Starts reading back what the stage currently has within @rect without
+ * waiting for the GPU, see cogl_framebuffer_read_pixels_into_bitmap_async().
+ * Like clutter_stage_capture_into() without painting, this is only
+ * meaningful while the stage is being painted. @rect must not span more
+ * than one view.
+ *
+ * Returns: (transfer none): the pending read, or %NULL on failure
+ */
+CoglReadPixelsClosure *
+clutter_stage_capture_into_bitmap_async (ClutterStage           *stage,
+                                         cairo_rectangle_int_t  *rect,
+                                         CoglBitmap             *bitmap,
+                                         CoglReadPixelsCallback  callback,
+                                         gpointer                user_data,
+                                         GError                **error)
+{
+  ClutterStageView *view;
+  CoglFramebuffer *framebuffer;
+  cairo_rectangle_int_t view_layout;
+  float view_scale;
+
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
+
+  view = get_view_at_rect (stage, rect);
+  if (!view)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                   "No view at %d,%d %dx%d",
+                   rect->x, rect->y, rect->width, rect->height);
+      return NULL;
+    }
+
+  framebuffer = clutter_stage_view_get_framebuffer (view);
+  view_scale = clutter_stage_view_get_scale (view);
+  clutter_stage_view_get_layout (view, &view_layout);
+
+  return cogl_framebuffer_read_pixels_into_bitmap_async (framebuffer,
+                                                         roundf ((rect->x - view_layout.x) * view_scale),
+                                                         roundf ((rect->y - view_layout.y) * view_scale),
+                                                         COGL_READ_PIXELS_COLOR_BUFFER,
+                                                         bitmap,
+                                                         callback,
+                                                         user_data,
+                                                         error);
+}
+
+/**
+ * clutter_stage_capture_region_into:
+ * @stage: a #ClutterStage
+ * @rect: the area of the stage that @data covers
+ * @region: the parts of @rect to read back, in stage coordinates
+ * @data: the destination buffer
+ * @stride: the stride of @data
+ *
+ * Like clutter_stage_capture_into(), but only the pixels covered by
+ * @region are read back and written into @data; the rest of @data is
+ * left untouched. @rect must not span more than one view.
+ */
+void
+clutter_stage_capture_region_into (ClutterStage                *stage,
+                                   const cairo_rectangle_int_t *rect,
+                                   const cairo_region_t        *region,
+                                   uint8_t                     *data,
+                                   int                          stride)
+{
+  cairo_region_t *capture_region;
+  int n_rects;
+  int bpp = 4;
+  int i;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  capture_region = cairo_region_copy (region);
+  cairo_region_intersect_rectangle (capture_region, rect);
+
+  n_rects = cairo_region_num_rectangles (capture_region);
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t capture_rect;
+      ClutterStageView *view;
+      float view_scale;
+      int x, y;
+
+      cairo_region_get_rectangle (capture_region, i, &capture_rect);
+
+      view = get_view_at_rect (stage, &capture_rect);
+      if (!view)
+        continue;
+
+      view_scale = clutter_stage_view_get_scale (view);
+      x = (int) roundf ((capture_rect.x - rect->x) * view_scale);
+      y = (int) roundf ((capture_rect.y - rect->y) * view_scale);
+
+      capture_view_into (stage, FALSE, view, &capture_rect,
+                         data + y * stride + x * bpp,
+                         stride);
+    }
+
+  cairo_region_destroy (capture_region);
+}
+
 /**
  * clutter_stage_freeze_updates:
  *
@@ -5067,6 +5887,8 @@ void
 clutter_stage_update_resource_scales (ClutterStage *stage)
 {
   _clutter_actor_queue_update_resource_scale_recursive (CLUTTER_ACTOR (stage));
+
+  clutter_stage_warm_up_glyph_cache (stage);
 }
 
 gboolean
@@ -143,6 +143,9 @@ struct _ClutterFrameInfo
   int64_t frame_counter;
   int64_t presentation_time;
   float refresh_rate;
+
+  ClutterFrameInfoFlag flags;
+  unsigned int sequence;
 };
 
 typedef struct _ClutterCapture
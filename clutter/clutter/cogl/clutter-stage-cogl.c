@@ -55,6 +55,31 @@ typedef struct _ClutterStageViewCoglPrivate
 #define DAMAGE_HISTORY(x) ((x) & (DAMAGE_HISTORY_MAX - 1))
   cairo_rectangle_int_t damage_history[DAMAGE_HISTORY_MAX];
   unsigned int damage_index;
+
+  /*
+   * Swaps of this view that haven't been presented yet, and the area of
+   * the stage that needs repainting once they have, when frames are
+   * paced per view. Should a presentation never be reported, the pending
+   * swaps are dropped after a timeout.
+   */
+  int pending_swaps;
+  gboolean has_deferred_redraw;
+  cairo_rectangle_int_t deferred_redraw_clip;
+  ClutterStageCogl *pending_stage_cogl;
+  guint pending_swaps_timeout_id;
+
+  /*
+   * The refresh rate and last presentation time of this view's output,
+   * used to schedule updates when frames are paced per view.
+   */
+  float refresh_rate;
+  gint64 last_presentation_time;
+
+  /*
+   * Whether the last frame of this view presented a scanout buffer, and
+   * thus left the back buffers behind.
+   */
+  gboolean scanned_out;
 } ClutterStageViewCoglPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (ClutterStageViewCogl, clutter_stage_view_cogl,
@@ -77,12 +102,68 @@ enum
   PROP_LAST
 };
 
+/* Longer than any frame takes to be presented, even at low refresh rates */
+#define PENDING_SWAPS_TIMEOUT_MS 250
+
 static void
 clutter_stage_cogl_unrealize (ClutterStageWindow *stage_window)
 {
   CLUTTER_NOTE (BACKEND, "Unrealizing Cogl stage [%p]", stage_window);
 }
 
+static gint64
+presentation_time_to_monotonic (ClutterStageCogl *stage_cogl,
+                                gint64            presentation_time_cogl)
+{
+  ClutterBackend *backend = stage_cogl->backend;
+  CoglContext *context = clutter_backend_get_cogl_context (backend);
+  gint64 current_time_cogl = cogl_get_clock_time (context);
+  gint64 now = g_get_monotonic_time ();
+
+  return now + (presentation_time_cogl - current_time_cogl) / 1000;
+}
+
+static void
+clear_view_pending_swaps (ClutterStageCogl *stage_cogl,
+                          ClutterStageView *view)
+{
+  ClutterStageViewCogl *view_cogl = CLUTTER_STAGE_VIEW_COGL (view);
+  ClutterStageViewCoglPrivate *view_priv =
+    clutter_stage_view_cogl_get_instance_private (view_cogl);
+
+  view_priv->pending_swaps = 0;
+  view_priv->pending_stage_cogl = NULL;
+
+  if (view_priv->pending_swaps_timeout_id)
+    {
+      g_source_remove (view_priv->pending_swaps_timeout_id);
+      view_priv->pending_swaps_timeout_id = 0;
+    }
+
+  if (view_priv->has_deferred_redraw)
+    {
+      view_priv->has_deferred_redraw = FALSE;
+      clutter_actor_queue_redraw_with_clip (CLUTTER_ACTOR (stage_cogl->wrapper),
+                                            &view_priv->deferred_redraw_clip);
+    }
+}
+
+static gboolean
+pending_swaps_timeout (gpointer user_data)
+{
+  ClutterStageView *view = user_data;
+  ClutterStageViewCogl *view_cogl = CLUTTER_STAGE_VIEW_COGL (view);
+  ClutterStageViewCoglPrivate *view_priv =
+    clutter_stage_view_cogl_get_instance_private (view_cogl);
+
+  CLUTTER_NOTE (BACKEND, "Frame of view %p was never presented", view);
+
+  view_priv->pending_swaps_timeout_id = 0;
+  clear_view_pending_swaps (view_priv->pending_stage_cogl, view);
+
+  return G_SOURCE_REMOVE;
+}
+
 void
 _clutter_stage_cogl_presented (ClutterStageCogl *stage_cogl,
                                CoglFrameEvent    frame_event,
@@ -105,25 +186,130 @@ _clutter_stage_cogl_presented (ClutterStageCogl *stage_cogl,
     }
   else if (frame_event == COGL_FRAME_EVENT_COMPLETE)
     {
-      gint64 presentation_time_cogl = frame_info->presentation_time;
+      if (frame_info->presentation_time != 0)
+        stage_cogl->last_presentation_time =
+          presentation_time_to_monotonic (stage_cogl,
+                                          frame_info->presentation_time);
+
+      stage_cogl->refresh_rate = frame_info->refresh_rate;
 
-      if (presentation_time_cogl != 0)
+      /* Stage windows that don't report views separately present them
+       * all at once. */
+      if (!stage_cogl->paces_views)
         {
-          ClutterBackend *backend = stage_cogl->backend;
-          CoglContext *context = clutter_backend_get_cogl_context (backend);
-          gint64 current_time_cogl = cogl_get_clock_time (context);
-          gint64 now = g_get_monotonic_time ();
+          ClutterStageWindow *stage_window = CLUTTER_STAGE_WINDOW (stage_cogl);
+          GList *l;
 
-          stage_cogl->last_presentation_time =
-            now + (presentation_time_cogl - current_time_cogl) / 1000;
+          for (l = _clutter_stage_window_get_views (stage_window); l; l = l->next)
+            _clutter_stage_view_presented (stage_cogl->wrapper,
+                                           l->data, frame_info);
         }
-
-      stage_cogl->refresh_rate = frame_info->refresh_rate;
     }
 
   _clutter_stage_presented (stage_cogl->wrapper, frame_event, frame_info);
 }
 
+/**
+ * _clutter_stage_cogl_view_presented: (skip)
+ * @stage_cogl: a #ClutterStageCogl
+ * @view: the #ClutterStageView whose frame was presented
+ * @frame_event: the #CoglFrameEvent
+ * @frame_info: the #ClutterFrameInfo of the view's frame
+ *
+ * Notifies that a frame of a single view was presented, for stage
+ * windows pacing frames per view. Any repaint of the view that was
+ * held back while the frame was pending is queued again.
+ */
+void
+_clutter_stage_cogl_view_presented (ClutterStageCogl *stage_cogl,
+                                    ClutterStageView *view,
+                                    CoglFrameEvent    frame_event,
+                                    ClutterFrameInfo *frame_info)
+{
+  ClutterStageViewCogl *view_cogl = CLUTTER_STAGE_VIEW_COGL (view);
+  ClutterStageViewCoglPrivate *view_priv =
+    clutter_stage_view_cogl_get_instance_private (view_cogl);
+
+  if (frame_event == COGL_FRAME_EVENT_COMPLETE)
+    {
+      if (frame_info->presentation_time != 0)
+        view_priv->last_presentation_time =
+          presentation_time_to_monotonic (stage_cogl,
+                                          frame_info->presentation_time);
+
+      view_priv->refresh_rate = frame_info->refresh_rate;
+
+      _clutter_stage_view_presented (stage_cogl->wrapper, view, frame_info);
+      return;
+    }
+
+  if (view_priv->pending_swaps > 0)
+    view_priv->pending_swaps--;
+
+  if (view_priv->pending_swaps == 0)
+    clear_view_pending_swaps (stage_cogl, view);
+}
+
+/**
+ * _clutter_stage_cogl_reset_pending_frames: (skip)
+ * @stage_cogl: a #ClutterStageCogl
+ *
+ * Stops waiting for the presentation of frames still pending on any
+ * view, for stage windows pacing frames per view, and queues the repaints
+ * held back meanwhile. To be used when those frames may never be
+ * reported as presented, e.g. when the outputs are turned off or the
+ * views are rebuilt.
+ */
+void
+_clutter_stage_cogl_reset_pending_frames (ClutterStageCogl *stage_cogl)
+{
+  ClutterStageWindow *stage_window = CLUTTER_STAGE_WINDOW (stage_cogl);
+  GList *l;
+
+  for (l = _clutter_stage_window_get_views (stage_window); l; l = l->next)
+    clear_view_pending_swaps (stage_cogl, l->data);
+}
+
+static gboolean
+is_view_frame_pending (ClutterStageView *view)
+{
+  ClutterStageViewCogl *view_cogl = CLUTTER_STAGE_VIEW_COGL (view);
+  ClutterStageViewCoglPrivate *view_priv =
+    clutter_stage_view_cogl_get_instance_private (view_cogl);
+
+  return view_priv->pending_swaps > 0;
+}
+
+static void
+defer_view_redraw (ClutterStageCogl *stage_cogl,
+                   ClutterStageView *view)
+{
+  ClutterStageViewCogl *view_cogl = CLUTTER_STAGE_VIEW_COGL (view);
+  ClutterStageViewCoglPrivate *view_priv =
+    clutter_stage_view_cogl_get_instance_private (view_cogl);
+  cairo_rectangle_int_t view_rect;
+  cairo_rectangle_int_t redraw_clip;
+
+  clutter_stage_view_get_layout (view, &view_rect);
+
+  /* NB: a zero width redraw clip == full stage redraw */
+  if (stage_cogl->bounding_redraw_clip.width == 0)
+    redraw_clip = view_rect;
+  else if (!_clutter_util_rectangle_intersection (&stage_cogl->bounding_redraw_clip,
+                                                  &view_rect,
+                                                  &redraw_clip))
+    return;
+
+  if (view_priv->has_deferred_redraw)
+    _clutter_util_rectangle_union (&view_priv->deferred_redraw_clip,
+                                   &redraw_clip,
+                                   &view_priv->deferred_redraw_clip);
+  else
+    view_priv->deferred_redraw_clip = redraw_clip;
+
+  view_priv->has_deferred_redraw = TRUE;
+}
+
 static gboolean
 clutter_stage_cogl_realize (ClutterStageWindow *stage_window)
 {
@@ -144,14 +330,46 @@ clutter_stage_cogl_realize (ClutterStageWindow *stage_window)
   return TRUE;
 }
 
+static gint64
+calculate_update_time (gint64 last_presentation_time,
+                       float  refresh_rate,
+                       gint   sync_delay,
+                       gint64 now)
+{
+  gint64 refresh_interval;
+  gint64 update_time;
+
+  /* We only extrapolate presentation times for 150ms  - this is somewhat
+   * arbitrary. The reasons it might not be accurate for larger times are
+   * that the refresh interval might be wrong or the vertical refresh
+   * might be downclocked if nothing is going on onscreen.
+   */
+  if (last_presentation_time == 0||
+      last_presentation_time < now - 150000)
+    return now;
+
+  if (refresh_rate == 0.0)
+    refresh_rate = 60.0;
+
+  refresh_interval = (gint64) (0.5 + 1000000 / refresh_rate);
+  if (refresh_interval == 0)
+    refresh_interval = 16667; /* 1/60th second */
+
+  update_time = last_presentation_time + 1000 * sync_delay;
+
+  while (update_time < now)
+    update_time += refresh_interval;
+
+  return update_time;
+}
+
 static void
 clutter_stage_cogl_schedule_update (ClutterStageWindow *stage_window,
                                     gint                sync_delay)
 {
   ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
+  GList *views;
   gint64 now;
-  float refresh_rate;
-  gint64 refresh_interval;
 
   if (stage_cogl->update_time != -1)
     return;
@@ -164,30 +382,46 @@ clutter_stage_cogl_schedule_update (ClutterStageWindow *stage_window,
       return;
     }
 
-  /* We only extrapolate presentation times for 150ms  - this is somewhat
-   * arbitrary. The reasons it might not be accurate for larger times are
-   * that the refresh interval might be wrong or the vertical refresh
-   * might be downclocked if nothing is going on onscreen.
-   */
-  if (stage_cogl->last_presentation_time == 0||
-      stage_cogl->last_presentation_time < now - 150000)
+  views = _clutter_stage_window_get_views (stage_window);
+  if (stage_cogl->paces_views && views)
     {
-      stage_cogl->update_time = now;
-      return;
-    }
+      gboolean all_pending = TRUE;
+      GList *l;
 
-  refresh_rate = stage_cogl->refresh_rate;
-  if (refresh_rate == 0.0)
-    refresh_rate = 60.0;
+      for (l = views; l; l = l->next)
+        all_pending = all_pending && is_view_frame_pending (l->data);
 
-  refresh_interval = (gint64) (0.5 + 1000000 / refresh_rate);
-  if (refresh_interval == 0)
-    refresh_interval = 16667; /* 1/60th second */
+      /* Update when the first view that can take a new frame is due,
+       * each view going by the presentation times of its own output. */
+      for (l = views; l; l = l->next)
+        {
+          ClutterStageViewCogl *view_cogl = CLUTTER_STAGE_VIEW_COGL (l->data);
+          ClutterStageViewCoglPrivate *view_priv =
+            clutter_stage_view_cogl_get_instance_private (view_cogl);
+          gint64 view_update_time;
+
+          if (!all_pending && is_view_frame_pending (l->data))
+            continue;
+
+          view_update_time =
+            calculate_update_time (view_priv->last_presentation_time,
+                                   view_priv->refresh_rate,
+                                   sync_delay,
+                                   now);
+
+          if (stage_cogl->update_time == -1 ||
+              view_update_time < stage_cogl->update_time)
+            stage_cogl->update_time = view_update_time;
+        }
 
-  stage_cogl->update_time = stage_cogl->last_presentation_time + 1000 * sync_delay;
+      return;
+    }
 
-  while (stage_cogl->update_time < now)
-    stage_cogl->update_time += refresh_interval;
+  stage_cogl->update_time =
+    calculate_update_time (stage_cogl->last_presentation_time,
+                           stage_cogl->refresh_rate,
+                           sync_delay,
+                           now);
 }
 
 static gint64
@@ -198,6 +432,21 @@ clutter_stage_cogl_get_update_time (ClutterStageWindow *stage_window)
   if (stage_cogl->pending_swaps)
     return -1; /* in the future, indefinite */
 
+  if (stage_cogl->paces_views)
+    {
+      GList *l;
+
+      /* Only wait while no view at all is ready for a new frame */
+      for (l = _clutter_stage_window_get_views (stage_window); l; l = l->next)
+        {
+          if (!is_view_frame_pending (l->data))
+            break;
+        }
+
+      if (_clutter_stage_window_get_views (stage_window) && !l)
+        return -1;
+    }
+
   return stage_cogl->update_time;
 }
 
@@ -467,6 +716,32 @@ swap_framebuffer (ClutterStageWindow    *stage_window,
     }
 }
 
+static gboolean
+scanout_view (ClutterStageView *view,
+              CoglScanout      *scanout)
+{
+  CoglFramebuffer *framebuffer = clutter_stage_view_get_onscreen (view);
+  CoglOnscreen *onscreen;
+  GError *error = NULL;
+
+  if (!cogl_is_onscreen (framebuffer))
+    return FALSE;
+
+  onscreen = COGL_ONSCREEN (framebuffer);
+
+  CLUTTER_NOTE (BACKEND, "cogl_onscreen_direct_scanout (onscreen: %p)",
+                onscreen);
+
+  if (!cogl_onscreen_direct_scanout (onscreen, scanout, &error))
+    {
+      CLUTTER_NOTE (BACKEND, "Direct scanout failed: %s", error->message);
+      g_error_free (error);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
 static void
 paint_stage (ClutterStageCogl            *stage_cogl,
              ClutterStageView            *view,
@@ -612,6 +887,7 @@ clutter_stage_cogl_redraw_view (ClutterStageWindow *stage_window,
   float fb_scale;
   int subpixel_compensation = 0;
   int fb_width, fb_height;
+  CoglScanout *scanout;
 
   wrapper = CLUTTER_ACTOR (stage_cogl->wrapper);
 
@@ -642,6 +918,37 @@ clutter_stage_cogl_redraw_view (ClutterStageWindow *stage_window,
                     redraw_clip.height == view_rect.height);
     }
 
+  scanout = clutter_stage_view_take_scanout (view);
+  if (scanout)
+    {
+      gboolean did_scanout = FALSE;
+
+      /* Only present the scanout buffer when the view changed at all,
+       * like a painted frame would be. */
+      if (!have_clip || redraw_clip.width > 0)
+        did_scanout = scanout_view (view, scanout);
+
+      g_object_unref (scanout);
+
+      if (did_scanout)
+        {
+          view_priv->scanned_out = TRUE;
+          return TRUE;
+        }
+    }
+
+  if (view_priv->scanned_out)
+    {
+      /* The scanout buffer is still on screen until something in the view
+       * changes; once it does, none of the back buffer contents can be
+       * relied upon. */
+      if (have_clip && redraw_clip.width == 0)
+        return FALSE;
+
+      have_clip = FALSE;
+      view_priv->scanned_out = FALSE;
+    }
+
   may_use_clipped_redraw = FALSE;
   if (_clutter_stage_window_can_clip_redraws (stage_window) &&
       (can_blit_sub_buffer || has_buffer_age) &&
@@ -935,8 +1242,38 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
     {
       ClutterStageView *view = l->data;
 
-      swap_event =
-        clutter_stage_cogl_redraw_view (stage_window, view) || swap_event;
+      if (stage_cogl->paces_views)
+        {
+          ClutterStageViewCogl *view_cogl = CLUTTER_STAGE_VIEW_COGL (view);
+          ClutterStageViewCoglPrivate *view_priv =
+            clutter_stage_view_cogl_get_instance_private (view_cogl);
+
+          /* Painting a view whose previous frame is still pending would
+           * block until that frame is presented; paint it once it is,
+           * so that the other views can keep their own pace. */
+          if (view_priv->pending_swaps > 0)
+            {
+              defer_view_redraw (stage_cogl, view);
+              continue;
+            }
+
+          if (clutter_stage_cogl_redraw_view (stage_window, view))
+            {
+              view_priv->pending_swaps++;
+              view_priv->pending_stage_cogl = stage_cogl;
+
+              if (!view_priv->pending_swaps_timeout_id)
+                view_priv->pending_swaps_timeout_id =
+                  g_timeout_add (PENDING_SWAPS_TIMEOUT_MS,
+                                 pending_swaps_timeout,
+                                 view);
+            }
+        }
+      else
+        {
+          swap_event =
+            clutter_stage_cogl_redraw_view (stage_window, view) || swap_event;
+        }
     }
 
   _clutter_stage_window_finish_frame (stage_window);
@@ -1069,6 +1406,22 @@ _clutter_stage_cogl_init (ClutterStageCogl *stage)
   stage->update_time = -1;
 }
 
+static void
+clutter_stage_view_cogl_dispose (GObject *object)
+{
+  ClutterStageViewCogl *view_cogl = CLUTTER_STAGE_VIEW_COGL (object);
+  ClutterStageViewCoglPrivate *view_priv =
+    clutter_stage_view_cogl_get_instance_private (view_cogl);
+
+  if (view_priv->pending_swaps_timeout_id)
+    {
+      g_source_remove (view_priv->pending_swaps_timeout_id);
+      view_priv->pending_swaps_timeout_id = 0;
+    }
+
+  G_OBJECT_CLASS (clutter_stage_view_cogl_parent_class)->dispose (object);
+}
+
 static void
 clutter_stage_view_cogl_init (ClutterStageViewCogl *view_cogl)
 {
@@ -1077,4 +1430,7 @@ clutter_stage_view_cogl_init (ClutterStageViewCogl *view_cogl)
 static void
 clutter_stage_view_cogl_class_init (ClutterStageViewCoglClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = clutter_stage_view_cogl_dispose;
 }
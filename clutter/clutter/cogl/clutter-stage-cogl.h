@@ -66,6 +66,11 @@ struct _ClutterStageCogl
   /* TRUE if the current paint cycle has a clipped redraw. In that
      case bounding_redraw_clip specifies the the bounds. */
   guint using_clipped_redraw : 1;
+
+  /* TRUE if the presentation of every view is reported separately with
+     _clutter_stage_cogl_view_presented(), letting each view be painted
+     at the pace of its own output. */
+  guint paces_views : 1;
 };
 
 struct _ClutterStageCoglClass
@@ -81,6 +86,15 @@ void _clutter_stage_cogl_presented (ClutterStageCogl *stage_cogl,
                                     CoglFrameEvent    frame_event,
                                     ClutterFrameInfo *frame_info);
 
+CLUTTER_EXPORT
+void _clutter_stage_cogl_view_presented (ClutterStageCogl *stage_cogl,
+                                         ClutterStageView *view,
+                                         CoglFrameEvent    frame_event,
+                                         ClutterFrameInfo *frame_info);
+
+CLUTTER_EXPORT
+void _clutter_stage_cogl_reset_pending_frames (ClutterStageCogl *stage_cogl);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_STAGE_COGL_H__ */
@@ -36,6 +36,7 @@
 #include <unistd.h>
 
 #include <glib.h>
+#include <glib-unix.h>
 #include <libinput.h>
 
 #include "clutter-backend.h"
@@ -68,6 +69,12 @@
  */
 #define INITIAL_DEVICE_ID 2
 
+/*
+ * Number of libinput events the input thread may queue up before the main
+ * thread has to catch up. Must be a power of two.
+ */
+#define EVENT_RING_SIZE 1024
+
 typedef struct _ClutterEventFilter ClutterEventFilter;
 
 struct _ClutterEventFilter
@@ -79,10 +86,63 @@ struct _ClutterEventFilter
 
 typedef struct _ClutterEventSource  ClutterEventSource;
 
+typedef struct _ClutterEventRingEntry
+{
+  struct libinput_event *event;
+
+  /* Relative pointer motion is translated when the event is pulled out of
+   * libinput, and the pointer delta it applied to the input pointer */
+  gboolean is_motion;
+  uint64_t time_us;
+  double dx;
+  double dy;
+  double dx_unaccel;
+  double dy_unaccel;
+  float input_dx;
+  float input_dy;
+} ClutterEventRingEntry;
+
+/*
+ * Single producer, single consumer queue used to hand libinput events over
+ * from the input thread to the main thread. The head is only written by the
+ * input thread and the tail only by the main thread.
+ */
+typedef struct _ClutterEventRing
+{
+  ClutterEventRingEntry entries[EVENT_RING_SIZE];
+  gint head;
+  gint tail;
+} ClutterEventRing;
+
 struct _ClutterDeviceManagerEvdevPrivate
 {
   struct libinput *libinput;
 
+  /* libinput is not thread safe, every access to the libinput context and
+   * its devices and events must happen with this lock held */
+  GRecMutex libinput_lock;
+
+  GThread *input_thread;
+  GMainContext *input_context;
+  GMainLoop *input_loop;
+  ClutterEventRing event_ring;
+
+  /* The pointer position as seen by the input thread. It runs ahead of the
+   * main seat position by whatever motion is still queued in the event
+   * ring, and is clamped to the stage size. While inhibited, it is only
+   * moved once the main thread processed the motion. Protected by
+   * pointer_lock. */
+  GMutex pointer_lock;
+  float input_pointer_x;
+  float input_pointer_y;
+  float input_pointer_width;
+  float input_pointer_height;
+  gboolean input_pointer_inhibited;
+
+  ClutterCursorPositionCallback cursor_position_callback;
+  gpointer                      cursor_position_data;
+  GDestroyNotify                cursor_position_data_notify;
+
   ClutterStage *stage;
   gboolean released;
 
@@ -186,22 +246,69 @@ struct _ClutterEventSource
   GSource source;
 
   ClutterDeviceManagerEvdev *manager_evdev;
-  GPollFD event_poll_fd;
 };
 
 static void
 process_events (ClutterDeviceManagerEvdev *manager_evdev);
 
+static gboolean
+event_ring_is_empty (ClutterEventRing *ring)
+{
+  return g_atomic_int_get (&ring->head) == g_atomic_int_get (&ring->tail);
+}
+
+static gboolean
+event_ring_is_full (ClutterEventRing *ring)
+{
+  gint next = (ring->head + 1) & (EVENT_RING_SIZE - 1);
+
+  return next == g_atomic_int_get (&ring->tail);
+}
+
+static gboolean
+event_ring_push (ClutterEventRing      *ring,
+                 ClutterEventRingEntry *entry)
+{
+  gint head = ring->head;
+  gint next = (head + 1) & (EVENT_RING_SIZE - 1);
+
+  if (next == g_atomic_int_get (&ring->tail))
+    return FALSE;
+
+  ring->entries[head] = *entry;
+  g_atomic_int_set (&ring->head, next);
+
+  return TRUE;
+}
+
+static gboolean
+event_ring_pop (ClutterEventRing      *ring,
+                ClutterEventRingEntry *entry)
+{
+  gint tail = ring->tail;
+
+  if (tail == g_atomic_int_get (&ring->head))
+    return FALSE;
+
+  *entry = ring->entries[tail];
+  g_atomic_int_set (&ring->tail, (tail + 1) & (EVENT_RING_SIZE - 1));
+
+  return TRUE;
+}
+
 static gboolean
 clutter_event_prepare (GSource *source,
                        gint    *timeout)
 {
+  ClutterEventSource *event_source = (ClutterEventSource *) source;
+  ClutterDeviceManagerEvdevPrivate *priv = event_source->manager_evdev->priv;
   gboolean retval;
 
   _clutter_threads_acquire_lock ();
 
   *timeout = -1;
-  retval = clutter_events_pending ();
+  retval = (clutter_events_pending () ||
+            !event_ring_is_empty (&priv->event_ring));
 
   _clutter_threads_release_lock ();
 
@@ -212,12 +319,13 @@ static gboolean
 clutter_event_check (GSource *source)
 {
   ClutterEventSource *event_source = (ClutterEventSource *) source;
+  ClutterDeviceManagerEvdevPrivate *priv = event_source->manager_evdev->priv;
   gboolean retval;
 
   _clutter_threads_acquire_lock ();
 
-  retval = ((event_source->event_poll_fd.revents & G_IO_IN) ||
-            clutter_events_pending ());
+  retval = (clutter_events_pending () ||
+            !event_ring_is_empty (&priv->event_ring));
 
   _clutter_threads_release_lock ();
 
@@ -660,7 +768,10 @@ dispatch_libinput (ClutterDeviceManagerEvdev *manager_evdev)
 {
   ClutterDeviceManagerEvdevPrivate *priv = manager_evdev->priv;
 
+  g_rec_mutex_lock (&priv->libinput_lock);
   libinput_dispatch (priv->libinput);
+  g_rec_mutex_unlock (&priv->libinput_lock);
+
   process_events (manager_evdev);
 }
 
@@ -682,7 +793,9 @@ clutter_event_dispatch (GSource     *g_source,
   if (clutter_events_pending ())
     goto queue_event;
 
-  dispatch_libinput (manager_evdev);
+  /* The input thread already dispatched libinput, only pick up what it
+   * handed over to us */
+  process_events (manager_evdev);
 
  queue_event:
   event = clutter_event_get ();
@@ -726,10 +839,8 @@ static GSourceFuncs event_funcs = {
 static ClutterEventSource *
 clutter_event_source_new (ClutterDeviceManagerEvdev *manager_evdev)
 {
-  ClutterDeviceManagerEvdevPrivate *priv = manager_evdev->priv;
   GSource *source;
   ClutterEventSource *event_source;
-  gint fd;
 
   source = g_source_new (&event_funcs, sizeof (ClutterEventSource));
   event_source = (ClutterEventSource *) source;
@@ -737,13 +848,8 @@ clutter_event_source_new (ClutterDeviceManagerEvdev *manager_evdev)
   /* setup the source */
   event_source->manager_evdev = manager_evdev;
 
-  fd = libinput_get_fd (priv->libinput);
-  event_source->event_poll_fd.fd = fd;
-  event_source->event_poll_fd.events = G_IO_IN;
-
   /* and finally configure and attach the GSource */
   g_source_set_priority (source, CLUTTER_PRIORITY_EVENTS);
-  g_source_add_poll (source, &event_source->event_poll_fd);
   g_source_set_can_recurse (source, TRUE);
   g_source_attach (source, NULL);
 
@@ -757,10 +863,6 @@ clutter_event_source_free (ClutterEventSource *source)
 
   CLUTTER_NOTE (EVENT, "Removing GSource for evdev device manager");
 
-  /* ignore the return value of close, it's not like we can do something
-   * about it */
-  close (source->event_poll_fd.fd);
-
   g_source_destroy (g_source);
   g_source_unref (g_source);
 }
@@ -1274,32 +1376,6 @@ process_device_event (ClutterDeviceManagerEvdev *manager_evdev,
         break;
       }
 
-    case LIBINPUT_EVENT_POINTER_MOTION:
-      {
-        struct libinput_event_pointer *pointer_event =
-          libinput_event_get_pointer_event (event);
-        uint64_t time_us;
-        double dx;
-        double dy;
-        double dx_unaccel;
-        double dy_unaccel;
-
-        device = libinput_device_get_user_data (libinput_device);
-        time_us = libinput_event_pointer_get_time_usec (pointer_event);
-        dx = libinput_event_pointer_get_dx (pointer_event);
-        dy = libinput_event_pointer_get_dy (pointer_event);
-        dx_unaccel = libinput_event_pointer_get_dx_unaccelerated (pointer_event);
-        dy_unaccel = libinput_event_pointer_get_dy_unaccelerated (pointer_event);
-
-        clutter_seat_evdev_notify_relative_motion (seat_from_device (device),
-                                                   device,
-                                                   time_us,
-                                                   dx, dy,
-                                                   dx_unaccel, dy_unaccel);
-
-        break;
-      }
-
     case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
       {
         guint64 time_us;
@@ -1782,34 +1858,307 @@ filter_event (ClutterDeviceManagerEvdev *manager_evdev,
   return retval;
 }
 
+static void
+process_pointer_motion (ClutterDeviceManagerEvdev *manager_evdev,
+                        ClutterEventRingEntry     *entry)
+{
+  struct libinput_device *libinput_device =
+    libinput_event_get_device (entry->event);
+  ClutterInputDevice *device;
+
+  device = libinput_device_get_user_data (libinput_device);
+  clutter_seat_evdev_notify_relative_motion (seat_from_device (device),
+                                             device,
+                                             entry->time_us,
+                                             entry->dx, entry->dy,
+                                             entry->dx_unaccel,
+                                             entry->dy_unaccel);
+}
+
 static void
 process_event (ClutterDeviceManagerEvdev *manager_evdev,
-               struct libinput_event *event)
+               ClutterEventRingEntry     *entry)
 {
+  ClutterDeviceManagerEvdevPrivate *priv = manager_evdev->priv;
+  struct libinput_event *event = entry->event;
   gboolean retval;
+  gboolean handled;
 
   retval = filter_event (manager_evdev, event);
 
   if (retval != CLUTTER_EVENT_PROPAGATE)
     return;
 
-  if (process_base_event (manager_evdev, event))
+  /* Adding and removing devices configures them through libinput, while
+   * everything else only reads from the event itself */
+  g_rec_mutex_lock (&priv->libinput_lock);
+  handled = process_base_event (manager_evdev, event);
+  g_rec_mutex_unlock (&priv->libinput_lock);
+
+  if (handled)
+    return;
+
+  if (entry->is_motion)
+    process_pointer_motion (manager_evdev, entry);
+  else
+    process_device_event (manager_evdev, event);
+}
+
+static void
+move_input_pointer (ClutterDeviceManagerEvdev *manager_evdev,
+                    float                      x,
+                    float                      y)
+{
+  ClutterDeviceManagerEvdevPrivate *priv = manager_evdev->priv;
+
+  priv->input_pointer_x = x;
+  priv->input_pointer_y = y;
+
+  if (priv->cursor_position_callback)
+    priv->cursor_position_callback (x, y, priv->cursor_position_data);
+}
+
+/*
+ * Called with the libinput lock held, from whichever thread pulls the
+ * event out of libinput.
+ */
+static void
+translate_event (ClutterDeviceManagerEvdev *manager_evdev,
+                 struct libinput_event     *event,
+                 ClutterEventRingEntry     *entry)
+{
+  ClutterDeviceManagerEvdevPrivate *priv = manager_evdev->priv;
+  struct libinput_event_pointer *pointer_event;
+  float x, y;
+
+  *entry = (ClutterEventRingEntry) { .event = event };
+
+  if (libinput_event_get_type (event) != LIBINPUT_EVENT_POINTER_MOTION)
+    return;
+
+  pointer_event = libinput_event_get_pointer_event (event);
+
+  entry->is_motion = TRUE;
+  entry->time_us = libinput_event_pointer_get_time_usec (pointer_event);
+  entry->dx = libinput_event_pointer_get_dx (pointer_event);
+  entry->dy = libinput_event_pointer_get_dy (pointer_event);
+  entry->dx_unaccel =
+    libinput_event_pointer_get_dx_unaccelerated (pointer_event);
+  entry->dy_unaccel =
+    libinput_event_pointer_get_dy_unaccelerated (pointer_event);
+
+  g_mutex_lock (&priv->pointer_lock);
+
+  if (!priv->input_pointer_inhibited &&
+      priv->input_pointer_width > 0 && priv->input_pointer_height > 0)
+    {
+      x = CLAMP (priv->input_pointer_x + entry->dx,
+                 0.f, priv->input_pointer_width - 1);
+      y = CLAMP (priv->input_pointer_y + entry->dy,
+                 0.f, priv->input_pointer_height - 1);
+
+      entry->input_dx = x - priv->input_pointer_x;
+      entry->input_dy = y - priv->input_pointer_y;
+
+      if (entry->input_dx != 0.f || entry->input_dy != 0.f)
+        move_input_pointer (manager_evdev, x, y);
+    }
+
+  g_mutex_unlock (&priv->pointer_lock);
+}
+
+/*
+ * Carries over whatever the main thread did differently to the main seat
+ * pointer than the input thread did to the input pointer, e.g. filtering,
+ * constraining or warping it, while keeping the motion that is still in
+ * flight.
+ */
+void
+_clutter_device_manager_evdev_sync_input_pointer (ClutterDeviceManagerEvdev *manager_evdev,
+                                                  float                      prev_x,
+                                                  float                      prev_y,
+                                                  float                      input_dx,
+                                                  float                      input_dy)
+{
+  ClutterDeviceManagerEvdevPrivate *priv = manager_evdev->priv;
+  ClutterSeatEvdev *seat = priv->main_seat;
+  float dx, dy;
+
+  dx = (seat->pointer_x - prev_x) - input_dx;
+  dy = (seat->pointer_y - prev_y) - input_dy;
+  if (dx == 0.f && dy == 0.f)
+    return;
+
+  g_mutex_lock (&priv->pointer_lock);
+  move_input_pointer (manager_evdev,
+                      priv->input_pointer_x + dx,
+                      priv->input_pointer_y + dy);
+  g_mutex_unlock (&priv->pointer_lock);
+}
+
+static void
+update_input_pointer_bounds (ClutterDeviceManagerEvdev *manager_evdev)
+{
+  ClutterDeviceManagerEvdevPrivate *priv = manager_evdev->priv;
+  float width, height;
+
+  if (!priv->stage)
     return;
-  if (process_device_event (manager_evdev, event))
+
+  width = clutter_actor_get_width (CLUTTER_ACTOR (priv->stage));
+  height = clutter_actor_get_height (CLUTTER_ACTOR (priv->stage));
+  if (width == priv->input_pointer_width &&
+      height == priv->input_pointer_height)
     return;
+
+  g_mutex_lock (&priv->pointer_lock);
+  priv->input_pointer_width = width;
+  priv->input_pointer_height = height;
+  g_mutex_unlock (&priv->pointer_lock);
+}
+
+static gboolean
+next_event (ClutterDeviceManagerEvdev *manager_evdev,
+            ClutterEventRingEntry     *entry)
+{
+  ClutterDeviceManagerEvdevPrivate *priv = manager_evdev->priv;
+  struct libinput_event *event;
+
+  if (event_ring_pop (&priv->event_ring, entry))
+    return TRUE;
+
+  /* Events handed over by the input thread were pulled out of libinput
+   * before anything still queued there. The input thread only fills the
+   * ring with the lock held, so checking it again under the lock keeps
+   * the ordering.
+   */
+  g_rec_mutex_lock (&priv->libinput_lock);
+
+  if (event_ring_pop (&priv->event_ring, entry))
+    {
+      g_rec_mutex_unlock (&priv->libinput_lock);
+      return TRUE;
+    }
+
+  event = libinput_get_event (priv->libinput);
+  if (event)
+    translate_event (manager_evdev, event, entry);
+
+  g_rec_mutex_unlock (&priv->libinput_lock);
+
+  return event != NULL;
 }
 
 static void
 process_events (ClutterDeviceManagerEvdev *manager_evdev)
 {
+  ClutterDeviceManagerEvdevPrivate *priv = manager_evdev->priv;
+  ClutterEventRingEntry entry;
+
+  update_input_pointer_bounds (manager_evdev);
+
+  while (next_event (manager_evdev, &entry))
+    {
+      float prev_x = priv->main_seat->pointer_x;
+      float prev_y = priv->main_seat->pointer_y;
+
+      process_event (manager_evdev, &entry);
+      _clutter_device_manager_evdev_sync_input_pointer (manager_evdev,
+                                                        prev_x, prev_y,
+                                                        entry.input_dx,
+                                                        entry.input_dy);
+
+      g_rec_mutex_lock (&priv->libinput_lock);
+      libinput_event_destroy (entry.event);
+      g_rec_mutex_unlock (&priv->libinput_lock);
+    }
+}
+
+static gboolean
+input_thread_dispatch (gint         fd,
+                       GIOCondition condition,
+                       gpointer     user_data)
+{
+  ClutterDeviceManagerEvdev *manager_evdev = user_data;
   ClutterDeviceManagerEvdevPrivate *priv = manager_evdev->priv;
   struct libinput_event *event;
+  ClutterEventRingEntry entry;
+  gboolean queued = FALSE;
+
+  g_rec_mutex_lock (&priv->libinput_lock);
+
+  libinput_dispatch (priv->libinput);
 
-  while ((event = libinput_get_event (priv->libinput)))
+  /* Whatever doesn't fit in the ring stays in libinput's own queue, the
+   * main thread will pick it up after draining the ring.
+   */
+  while (!event_ring_is_full (&priv->event_ring) &&
+         (event = libinput_get_event (priv->libinput)))
     {
-      process_event(manager_evdev, event);
-      libinput_event_destroy(event);
+      translate_event (manager_evdev, event, &entry);
+      event_ring_push (&priv->event_ring, &entry);
+      queued = TRUE;
     }
+
+  g_rec_mutex_unlock (&priv->libinput_lock);
+
+  if (queued)
+    g_main_context_wakeup (NULL);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static gpointer
+input_thread_func (gpointer user_data)
+{
+  ClutterDeviceManagerEvdev *manager_evdev = user_data;
+  ClutterDeviceManagerEvdevPrivate *priv = manager_evdev->priv;
+  GSource *source;
+
+  g_main_context_push_thread_default (priv->input_context);
+
+  source = g_unix_fd_source_new (libinput_get_fd (priv->libinput), G_IO_IN);
+  g_source_set_callback (source, (GSourceFunc) input_thread_dispatch,
+                         manager_evdev, NULL);
+  g_source_attach (source, priv->input_context);
+  g_source_unref (source);
+
+  g_main_loop_run (priv->input_loop);
+
+  g_main_context_pop_thread_default (priv->input_context);
+
+  return NULL;
+}
+
+static void
+start_input_thread (ClutterDeviceManagerEvdev *manager_evdev)
+{
+  ClutterDeviceManagerEvdevPrivate *priv = manager_evdev->priv;
+
+  priv->input_context = g_main_context_new ();
+  priv->input_loop = g_main_loop_new (priv->input_context, FALSE);
+  priv->input_thread = g_thread_new ("clutter-evdev-input",
+                                     input_thread_func,
+                                     manager_evdev);
+}
+
+static void
+stop_input_thread (ClutterDeviceManagerEvdev *manager_evdev)
+{
+  ClutterDeviceManagerEvdevPrivate *priv = manager_evdev->priv;
+  ClutterEventRingEntry entry;
+
+  g_main_loop_quit (priv->input_loop);
+  g_thread_join (priv->input_thread);
+  priv->input_thread = NULL;
+
+  g_main_loop_unref (priv->input_loop);
+  priv->input_loop = NULL;
+  g_main_context_unref (priv->input_context);
+  priv->input_context = NULL;
+
+  while (event_ring_pop (&priv->event_ring, &entry))
+    libinput_event_destroy (entry.event);
 }
 
 static int
@@ -1963,10 +2312,15 @@ clutter_device_manager_evdev_constructed (GObject *gobject)
   priv->main_seat = clutter_seat_evdev_new (manager_evdev);
   priv->seats = g_slist_append (priv->seats, priv->main_seat);
 
+  priv->input_pointer_x = priv->main_seat->pointer_x;
+  priv->input_pointer_y = priv->main_seat->pointer_y;
+
   dispatch_libinput (manager_evdev);
 
   source = clutter_event_source_new (manager_evdev);
   priv->event_source = source;
+
+  start_input_thread (manager_evdev);
 }
 
 static void
@@ -2010,6 +2364,9 @@ clutter_device_manager_evdev_finalize (GObject *object)
   manager_evdev = CLUTTER_DEVICE_MANAGER_EVDEV (object);
   priv = manager_evdev->priv;
 
+  if (priv->input_thread != NULL)
+    stop_input_thread (manager_evdev);
+
   g_slist_free_full (priv->seats, (GDestroyNotify) clutter_seat_evdev_free);
   g_slist_free (priv->devices);
 
@@ -2019,11 +2376,17 @@ clutter_device_manager_evdev_finalize (GObject *object)
   if (priv->constrain_data_notify != NULL)
     priv->constrain_data_notify (priv->constrain_data);
 
+  if (priv->cursor_position_data_notify != NULL)
+    priv->cursor_position_data_notify (priv->cursor_position_data);
+
   if (priv->libinput != NULL)
     libinput_unref (priv->libinput);
 
   g_list_free (priv->free_device_ids);
 
+  g_rec_mutex_clear (&priv->libinput_lock);
+  g_mutex_clear (&priv->pointer_lock);
+
   G_OBJECT_CLASS (clutter_device_manager_evdev_parent_class)->finalize (object);
 }
 
@@ -2107,6 +2470,9 @@ clutter_device_manager_evdev_init (ClutterDeviceManagerEvdev *self)
 
   priv = self->priv = clutter_device_manager_evdev_get_instance_private (self);
 
+  g_rec_mutex_init (&priv->libinput_lock);
+  g_mutex_init (&priv->pointer_lock);
+
   priv->stage_manager = clutter_stage_manager_get_default ();
   g_object_ref (priv->stage_manager);
 
@@ -2207,6 +2573,22 @@ _clutter_device_manager_evdev_get_stage (ClutterDeviceManagerEvdev *manager_evde
   return priv->stage;
 }
 
+void
+_clutter_device_manager_evdev_lock_libinput (ClutterDeviceManagerEvdev *manager_evdev)
+{
+  ClutterDeviceManagerEvdevPrivate *priv = manager_evdev->priv;
+
+  g_rec_mutex_lock (&priv->libinput_lock);
+}
+
+void
+_clutter_device_manager_evdev_unlock_libinput (ClutterDeviceManagerEvdev *manager_evdev)
+{
+  ClutterDeviceManagerEvdevPrivate *priv = manager_evdev->priv;
+
+  g_rec_mutex_unlock (&priv->libinput_lock);
+}
+
 /**
  * clutter_evdev_release_devices:
  *
@@ -2247,7 +2629,10 @@ clutter_evdev_release_devices (void)
       return;
     }
 
+  g_rec_mutex_lock (&priv->libinput_lock);
   libinput_suspend (priv->libinput);
+  g_rec_mutex_unlock (&priv->libinput_lock);
+
   process_events (manager_evdev);
 
   priv->released = TRUE;
@@ -2323,13 +2708,54 @@ clutter_evdev_reclaim_devices (void)
       return;
     }
 
+  g_rec_mutex_lock (&priv->libinput_lock);
   libinput_resume (priv->libinput);
+  g_rec_mutex_unlock (&priv->libinput_lock);
+
   clutter_evdev_update_xkb_state (manager_evdev);
   process_events (manager_evdev);
 
   priv->released = FALSE;
 }
 
+/**
+ * clutter_evdev_lock_libinput:
+ *
+ * Libinput events are read on a separate input thread. Code outside of
+ * Clutter that accesses the libinput devices managed by Clutter, e.g. to
+ * change their configuration, must wrap those calls between
+ * clutter_evdev_lock_libinput() and clutter_evdev_unlock_libinput().
+ *
+ * The lock is recursive, and is already held while Clutter emits signals
+ * in response to libinput events, such as #ClutterDeviceManager::device-added.
+ *
+ * This function should only be called after clutter has been initialized.
+ */
+void
+clutter_evdev_lock_libinput (void)
+{
+  ClutterDeviceManager *manager = clutter_device_manager_get_default ();
+
+  g_return_if_fail (CLUTTER_IS_DEVICE_MANAGER_EVDEV (manager));
+
+  _clutter_device_manager_evdev_lock_libinput (CLUTTER_DEVICE_MANAGER_EVDEV (manager));
+}
+
+/**
+ * clutter_evdev_unlock_libinput:
+ *
+ * Releases the lock taken with clutter_evdev_lock_libinput().
+ */
+void
+clutter_evdev_unlock_libinput (void)
+{
+  ClutterDeviceManager *manager = clutter_device_manager_get_default ();
+
+  g_return_if_fail (CLUTTER_IS_DEVICE_MANAGER_EVDEV (manager));
+
+  _clutter_device_manager_evdev_unlock_libinput (CLUTTER_DEVICE_MANAGER_EVDEV (manager));
+}
+
 /**
  * clutter_evdev_set_device_callbacks: (skip)
  * @open_callback: the user replacement for open()
@@ -2558,6 +2984,77 @@ clutter_evdev_set_pointer_constrain_callback (ClutterDeviceManager            *e
   priv->constrain_data_notify = user_data_notify;
 }
 
+/**
+ * clutter_evdev_set_cursor_position_callback:
+ * @evdev: the #ClutterDeviceManager created by the evdev backend
+ * @callback: the callback
+ * @user_data: data to pass to the callback
+ * @user_data_notify: function to be called when removing the callback
+ *
+ * Sets a callback to be invoked whenever the pointer position changes,
+ * as soon as the motion is read from the input device and before the
+ * corresponding motion event is dispatched. See
+ * #ClutterCursorPositionCallback for the threading constraints.
+ *
+ * Stability: unstable
+ */
+void
+clutter_evdev_set_cursor_position_callback (ClutterDeviceManager          *evdev,
+                                            ClutterCursorPositionCallback  callback,
+                                            gpointer                       user_data,
+                                            GDestroyNotify                 user_data_notify)
+{
+  ClutterDeviceManagerEvdev *manager_evdev;
+  ClutterDeviceManagerEvdevPrivate *priv;
+  GDestroyNotify old_notify;
+  gpointer old_data;
+
+  g_return_if_fail (CLUTTER_IS_DEVICE_MANAGER_EVDEV (evdev));
+
+  manager_evdev = CLUTTER_DEVICE_MANAGER_EVDEV (evdev);
+  priv = manager_evdev->priv;
+
+  g_mutex_lock (&priv->pointer_lock);
+  old_notify = priv->cursor_position_data_notify;
+  old_data = priv->cursor_position_data;
+  priv->cursor_position_callback = callback;
+  priv->cursor_position_data = user_data;
+  priv->cursor_position_data_notify = user_data_notify;
+  g_mutex_unlock (&priv->pointer_lock);
+
+  if (old_notify)
+    old_notify (old_data);
+}
+
+/**
+ * clutter_evdev_set_cursor_position_inhibited:
+ * @evdev: the #ClutterDeviceManager created by the evdev backend
+ * @inhibited: whether the pointer must not be moved ahead of the main thread
+ *
+ * Stops the input thread from moving the pointer ahead of the motion
+ * events, e.g. while the pointer constrain callback or the relative motion
+ * filter could send it elsewhere. While inhibited, the cursor position
+ * callback is only invoked once the motion event was processed.
+ *
+ * Stability: unstable
+ */
+void
+clutter_evdev_set_cursor_position_inhibited (ClutterDeviceManager *evdev,
+                                             gboolean              inhibited)
+{
+  ClutterDeviceManagerEvdev *manager_evdev;
+  ClutterDeviceManagerEvdevPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_DEVICE_MANAGER_EVDEV (evdev));
+
+  manager_evdev = CLUTTER_DEVICE_MANAGER_EVDEV (evdev);
+  priv = manager_evdev->priv;
+
+  g_mutex_lock (&priv->pointer_lock);
+  priv->input_pointer_inhibited = inhibited;
+  g_mutex_unlock (&priv->pointer_lock);
+}
+
 void
 clutter_evdev_set_relative_motion_filter (ClutterDeviceManager       *evdev,
                                           ClutterRelativeMotionFilter filter,
@@ -2724,7 +3221,16 @@ clutter_evdev_warp_pointer (ClutterInputDevice   *pointer_device,
                             int                   x,
                             int                   y)
 {
+  ClutterDeviceManagerEvdev *manager_evdev =
+    CLUTTER_DEVICE_MANAGER_EVDEV (pointer_device->device_manager);
+  ClutterSeatEvdev *seat = manager_evdev->priv->main_seat;
+  float prev_x = seat->pointer_x;
+  float prev_y = seat->pointer_y;
+
   notify_absolute_motion (pointer_device, ms2us(time_), x, y, NULL);
+  _clutter_device_manager_evdev_sync_input_pointer (manager_evdev,
+                                                    prev_x, prev_y,
+                                                    0.f, 0.f);
 }
 
 /**
@@ -83,6 +83,15 @@ void _clutter_device_manager_evdev_filter_relative_motion (ClutterDeviceManagerE
 
 void _clutter_device_manager_evdev_dispatch (ClutterDeviceManagerEvdev *manager_evdev);
 
+void _clutter_device_manager_evdev_sync_input_pointer (ClutterDeviceManagerEvdev *manager_evdev,
+                                                       float                      prev_x,
+                                                       float                      prev_y,
+                                                       float                      input_dx,
+                                                       float                      input_dy);
+
+void _clutter_device_manager_evdev_lock_libinput   (ClutterDeviceManagerEvdev *manager_evdev);
+void _clutter_device_manager_evdev_unlock_libinput (ClutterDeviceManagerEvdev *manager_evdev);
+
 struct xkb_state * _clutter_device_manager_evdev_get_xkb_state (ClutterDeviceManagerEvdev *manager_evdev);
 
 static inline guint64
@@ -65,6 +65,11 @@ void  clutter_evdev_release_devices (void);
 CLUTTER_EXPORT
 void  clutter_evdev_reclaim_devices (void);
 
+CLUTTER_EXPORT
+void  clutter_evdev_lock_libinput   (void);
+CLUTTER_EXPORT
+void  clutter_evdev_unlock_libinput (void);
+
 /**
  * ClutterPointerConstrainCallback:
  * @device: the core pointer device
@@ -97,6 +102,31 @@ void  clutter_evdev_set_pointer_constrain_callback (ClutterDeviceManager
 						    gpointer                         user_data,
 						    GDestroyNotify                   user_data_notify);
 
+/**
+ * ClutterCursorPositionCallback:
+ * @x: the new X coordinate of the pointer
+ * @y: the new Y coordinate of the pointer
+ * @user_data: user data passed to this function
+ *
+ * This callback will be called whenever the pointer position changes,
+ * usually from the input thread before the motion event is dispatched,
+ * so that the cursor can follow the pointer without waiting for the main
+ * loop. It must be thread safe and must not call back into Clutter.
+ */
+typedef void (*ClutterCursorPositionCallback) (float    x,
+                                               float    y,
+                                               gpointer user_data);
+
+CLUTTER_EXPORT
+void  clutter_evdev_set_cursor_position_callback (ClutterDeviceManager          *evdev,
+                                                  ClutterCursorPositionCallback  callback,
+                                                  gpointer                       user_data,
+                                                  GDestroyNotify                 user_data_notify);
+
+CLUTTER_EXPORT
+void  clutter_evdev_set_cursor_position_inhibited (ClutterDeviceManager *evdev,
+                                                   gboolean              inhibited);
+
 typedef void (*ClutterRelativeMotionFilter) (ClutterInputDevice *device,
                                              float               x,
                                              float               y,
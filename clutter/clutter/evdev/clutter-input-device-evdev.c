@@ -78,7 +78,11 @@ clutter_input_device_evdev_finalize (GObject *object)
     CLUTTER_DEVICE_MANAGER_EVDEV (device->device_manager);
 
   if (device_evdev->libinput_device)
-    libinput_device_unref (device_evdev->libinput_device);
+    {
+      _clutter_device_manager_evdev_lock_libinput (manager_evdev);
+      libinput_device_unref (device_evdev->libinput_device);
+      _clutter_device_manager_evdev_unlock_libinput (manager_evdev);
+    }
 
   clutter_input_device_evdev_release_touch_slots (device_evdev,
                                                   g_get_monotonic_time ());
@@ -1437,7 +1441,9 @@ _clutter_input_device_evdev_update_leds (ClutterInputDeviceEvdev *device,
   if (!device->libinput_device)
     return;
 
+  _clutter_device_manager_evdev_lock_libinput (device->seat->manager_evdev);
   libinput_device_led_update (device->libinput_device, leds);
+  _clutter_device_manager_evdev_unlock_libinput (device->seat->manager_evdev);
 }
 
 ClutterInputDeviceType
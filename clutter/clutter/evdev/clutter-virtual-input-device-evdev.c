@@ -154,15 +154,23 @@ clutter_virtual_input_device_evdev_notify_relative_motion (ClutterVirtualInputDe
 {
   ClutterVirtualInputDeviceEvdev *virtual_evdev =
     CLUTTER_VIRTUAL_INPUT_DEVICE_EVDEV (virtual_device);
+  float prev_x, prev_y;
 
   if (time_us == CLUTTER_CURRENT_TIME)
     time_us = g_get_monotonic_time ();
 
+  prev_x = virtual_evdev->seat->pointer_x;
+  prev_y = virtual_evdev->seat->pointer_y;
+
   clutter_seat_evdev_notify_relative_motion (virtual_evdev->seat,
                                              virtual_evdev->device,
                                              time_us,
                                              dx, dy,
                                              dx, dy);
+
+  _clutter_device_manager_evdev_sync_input_pointer (virtual_evdev->seat->manager_evdev,
+                                                    prev_x, prev_y,
+                                                    0.f, 0.f);
 }
 
 static void
@@ -173,15 +181,23 @@ clutter_virtual_input_device_evdev_notify_absolute_motion (ClutterVirtualInputDe
 {
   ClutterVirtualInputDeviceEvdev *virtual_evdev =
     CLUTTER_VIRTUAL_INPUT_DEVICE_EVDEV (virtual_device);
+  float prev_x, prev_y;
 
   if (time_us == CLUTTER_CURRENT_TIME)
     time_us = g_get_monotonic_time ();
 
+  prev_x = virtual_evdev->seat->pointer_x;
+  prev_y = virtual_evdev->seat->pointer_y;
+
   clutter_seat_evdev_notify_absolute_motion (virtual_evdev->seat,
                                              virtual_evdev->device,
                                              time_us,
                                              x, y,
                                              NULL);
+
+  _clutter_device_manager_evdev_sync_input_pointer (virtual_evdev->seat->manager_evdev,
+                                                    prev_x, prev_y,
+                                                    0.f, 0.f);
 }
 
 static int
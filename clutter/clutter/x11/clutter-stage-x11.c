@@ -607,9 +607,15 @@ frame_cb (CoglOnscreen  *onscreen,
   ClutterFrameInfo clutter_frame_info = {
     .frame_counter = cogl_frame_info_get_frame_counter (frame_info),
     .presentation_time = cogl_frame_info_get_presentation_time (frame_info),
-    .refresh_rate = cogl_frame_info_get_refresh_rate (frame_info)
+    .refresh_rate = cogl_frame_info_get_refresh_rate (frame_info),
+    .sequence = cogl_frame_info_get_sequence (frame_info),
   };
 
+  if (cogl_frame_info_is_hw_clock (frame_info))
+    clutter_frame_info.flags |= CLUTTER_FRAME_INFO_FLAG_HW_CLOCK;
+  if (cogl_frame_info_is_vsync (frame_info))
+    clutter_frame_info.flags |= CLUTTER_FRAME_INFO_FLAG_VSYNC;
+
   _clutter_stage_cogl_presented (stage_cogl, frame_event, &clutter_frame_info);
 }
 
@@ -268,7 +268,9 @@ cogl_pango_glyph_cache_add_to_local_atlas (CoglPangoGlyphCache *cache,
   CoglAtlas *atlas = NULL;
   GSList *l;
 
-  /* Look for an atlas that can reserve the space */
+  /* Look for a page that can reserve the space. The pages have a
+     fixed size so that adding glyphs never causes the ones that are
+     already cached to be moved and redrawn */
   for (l = cache->atlases; l; l = l->next)
     if (_cogl_atlas_reserve_space (l->data,
                                    value->draw_width + 1,
@@ -279,12 +281,13 @@ cogl_pango_glyph_cache_add_to_local_atlas (CoglPangoGlyphCache *cache,
         break;
       }
 
-  /* If we couldn't find one then start a new atlas */
+  /* If we couldn't find one then start a new page */
   if (atlas == NULL)
     {
       atlas = _cogl_atlas_new (COGL_PIXEL_FORMAT_A_8,
                                COGL_ATLAS_CLEAR_TEXTURE |
-                               COGL_ATLAS_DISABLE_MIGRATION,
+                               COGL_ATLAS_DISABLE_MIGRATION |
+                               COGL_ATLAS_FIXED_SIZE,
                                cogl_pango_glyph_cache_update_position_cb);
       COGL_NOTE (ATLAS, "Created new atlas for glyphs: %p", atlas);
       /* If we still can't reserve space then something has gone
@@ -307,11 +310,12 @@ cogl_pango_glyph_cache_add_to_local_atlas (CoglPangoGlyphCache *cache,
   return TRUE;
 }
 
-CoglPangoGlyphCacheValue *
-cogl_pango_glyph_cache_lookup (CoglPangoGlyphCache *cache,
-                               gboolean             create,
-                               PangoFont           *font,
-                               PangoGlyph           glyph)
+static CoglPangoGlyphCacheValue *
+cogl_pango_glyph_cache_lookup_internal (CoglPangoGlyphCache *cache,
+                                        gboolean             create,
+                                        PangoFont           *font,
+                                        PangoGlyph           glyph,
+                                        gboolean            *created)
 {
   CoglPangoGlyphCacheKey lookup_key;
   CoglPangoGlyphCacheValue *value;
@@ -321,6 +325,8 @@ cogl_pango_glyph_cache_lookup (CoglPangoGlyphCache *cache,
 
   value = g_hash_table_lookup (cache->hash_table, &lookup_key);
 
+  *created = FALSE;
+
   if (create && value == NULL)
     {
       CoglPangoGlyphCacheKey *key;
@@ -328,6 +334,7 @@ cogl_pango_glyph_cache_lookup (CoglPangoGlyphCache *cache,
 
       value = g_slice_new (CoglPangoGlyphCacheValue);
       value->texture = NULL;
+      value->pending = FALSE;
 
       pango_font_get_glyph_extents (font, glyph, &ink_rect, NULL);
       pango_extents_to_pixels (&ink_rect, NULL);
@@ -367,11 +374,63 @@ cogl_pango_glyph_cache_lookup (CoglPangoGlyphCache *cache,
       key->glyph = glyph;
 
       g_hash_table_insert (cache->hash_table, key, value);
+
+      *created = TRUE;
+    }
+
+  return value;
+}
+
+CoglPangoGlyphCacheValue *
+cogl_pango_glyph_cache_lookup (CoglPangoGlyphCache *cache,
+                               gboolean             create,
+                               PangoFont           *font,
+                               PangoGlyph           glyph)
+{
+  CoglPangoGlyphCacheValue *value;
+  gboolean created;
+
+  value = cogl_pango_glyph_cache_lookup_internal (cache, create,
+                                                  font, glyph,
+                                                  &created);
+
+  /* If the glyph is needed before the warm-up has drawn it then it
+     will be drawn along with the other dirty glyphs instead */
+  if (create && value && value->pending)
+    {
+      value->pending = FALSE;
+      value->dirty = TRUE;
+      cache->has_dirty_glyphs = TRUE;
     }
 
   return value;
 }
 
+/* Reserves space for a glyph that isn't in the cache yet without
+ * marking it as dirty. The caller is expected to draw the glyph itself
+ * and clear the pending flag once it has done so. Returns NULL if the
+ * glyph was already cached or doesn't need to be drawn */
+CoglPangoGlyphCacheValue *
+_cogl_pango_glyph_cache_reserve_pending (CoglPangoGlyphCache *cache,
+                                         PangoFont           *font,
+                                         PangoGlyph           glyph)
+{
+  CoglPangoGlyphCacheValue *value;
+  gboolean created;
+
+  value = cogl_pango_glyph_cache_lookup_internal (cache, TRUE,
+                                                  font, glyph,
+                                                  &created);
+
+  if (!created || value == NULL || value->texture == NULL)
+    return NULL;
+
+  value->dirty = FALSE;
+  value->pending = TRUE;
+
+  return value;
+}
+
 static void
 _cogl_pango_glyph_cache_set_dirty_glyphs_cb (void *key_ptr,
                                              void *value_ptr,
@@ -59,6 +59,10 @@ struct _CoglPangoGlyphCacheValue
   /* This will be set to TRUE when the glyph atlas is reorganized
      which means the glyph will need to be redrawn */
   gboolean   dirty;
+
+  /* TRUE while the glyph has space reserved by an asynchronous
+     warm-up but hasn't been drawn yet */
+  gboolean   pending;
 };
 
 typedef void (* CoglPangoGlyphCacheDirtyFunc) (PangoFont *font,
@@ -81,6 +85,11 @@ cogl_pango_glyph_cache_lookup (CoglPangoGlyphCache *cache,
 void
 cogl_pango_glyph_cache_clear (CoglPangoGlyphCache *cache);
 
+CoglPangoGlyphCacheValue *
+_cogl_pango_glyph_cache_reserve_pending (CoglPangoGlyphCache *cache,
+                                         PangoFont           *font,
+                                         PangoGlyph           glyph);
+
 void
 _cogl_pango_glyph_cache_add_reorganize_callback (CoglPangoGlyphCache *cache,
                                                  GHookFunc func,
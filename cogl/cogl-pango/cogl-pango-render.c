@@ -80,6 +80,9 @@ struct _CoglPangoRenderer
 
   /* The current display list that is being built */
   CoglPangoDisplayList *display_list;
+
+  /* Glyph cache warm-ups that haven't completed yet */
+  GList *warmups;
 };
 
 struct _CoglPangoRendererClass
@@ -178,6 +181,7 @@ cogl_pango_renderer_draw_glyph (CoglPangoRenderer        *priv,
                                        &data);
 }
 
+static void cogl_pango_renderer_cancel_warmups (CoglPangoRenderer *priv);
 static void cogl_pango_renderer_dispose (GObject *object);
 static void cogl_pango_renderer_finalize (GObject *object);
 static void cogl_pango_renderer_draw_glyphs (PangoRenderer    *renderer,
@@ -202,9 +206,16 @@ static void cogl_pango_renderer_draw_trapezoid (PangoRenderer    *renderer,
 
 G_DEFINE_TYPE (CoglPangoRenderer, cogl_pango_renderer, PANGO_TYPE_RENDERER);
 
+/* The number of renderers that are alive. The warm-up thread pool is
+   freed along with the last one */
+static unsigned int n_renderers = 0;
+
+static GThreadPool *warmup_thread_pool = NULL;
+
 static void
 cogl_pango_renderer_init (CoglPangoRenderer *priv)
 {
+  n_renderers++;
 }
 
 static void
@@ -280,6 +291,8 @@ cogl_pango_renderer_dispose (GObject *object)
 {
   CoglPangoRenderer *priv = COGL_PANGO_RENDERER (object);
 
+  cogl_pango_renderer_cancel_warmups (priv);
+
   if (priv->ctx)
     {
       cogl_object_unref (priv->ctx);
@@ -298,6 +311,14 @@ cogl_pango_renderer_finalize (GObject *object)
   _cogl_pango_pipeline_cache_free (priv->no_mipmap_caches.pipeline_cache);
   _cogl_pango_pipeline_cache_free (priv->mipmap_caches.pipeline_cache);
 
+  /* Any warm-ups still in the pool have been cancelled by dispose so
+     waiting for them only lets them free themselves */
+  if (--n_renderers == 0 && warmup_thread_pool)
+    {
+      g_thread_pool_free (warmup_thread_pool, FALSE, TRUE);
+      warmup_thread_pool = NULL;
+    }
+
   G_OBJECT_CLASS (cogl_pango_renderer_parent_class)->finalize (object);
 }
 
@@ -561,56 +582,54 @@ cogl_pango_renderer_get_cached_glyph (PangoRenderer *renderer,
 }
 
 static void
-cogl_pango_renderer_set_dirty_glyph (PangoFont *font,
-                                     PangoGlyph glyph,
-                                     CoglPangoGlyphCacheValue *value)
+cogl_pango_renderer_get_glyph_formats (CoglTexture *texture,
+                                       cairo_format_t *format_cairo,
+                                       CoglPixelFormat *format_cogl)
 {
-  cairo_surface_t *surface;
-  cairo_t *cr;
-  cairo_scaled_font_t *scaled_font;
-  cairo_glyph_t cairo_glyph;
-  cairo_format_t format_cairo;
-  CoglPixelFormat format_cogl;
-
-  COGL_NOTE (PANGO, "redrawing glyph %i", glyph);
-
-  /* Glyphs that don't take up any space will end up without a
-     texture. These should never become dirty so they shouldn't end up
-     here */
-  _COGL_RETURN_IF_FAIL (value->texture != NULL);
-
-  if (_cogl_texture_get_format (value->texture) == COGL_PIXEL_FORMAT_A_8)
+  if (_cogl_texture_get_format (texture) == COGL_PIXEL_FORMAT_A_8)
     {
-      format_cairo = CAIRO_FORMAT_A8;
-      format_cogl = COGL_PIXEL_FORMAT_A_8;
+      *format_cairo = CAIRO_FORMAT_A8;
+      *format_cogl = COGL_PIXEL_FORMAT_A_8;
     }
   else
     {
-      format_cairo = CAIRO_FORMAT_ARGB32;
+      *format_cairo = CAIRO_FORMAT_ARGB32;
 
       /* Cairo stores the data in native byte order as ARGB but Cogl's
          pixel formats specify the actual byte order. Therefore we
          need to use a different format depending on the
          architecture */
 #if G_BYTE_ORDER == G_LITTLE_ENDIAN
-      format_cogl = COGL_PIXEL_FORMAT_BGRA_8888_PRE;
+      *format_cogl = COGL_PIXEL_FORMAT_BGRA_8888_PRE;
 #else
-      format_cogl = COGL_PIXEL_FORMAT_ARGB_8888_PRE;
+      *format_cogl = COGL_PIXEL_FORMAT_ARGB_8888_PRE;
 #endif
     }
+}
 
-  surface = cairo_image_surface_create (format_cairo,
-                                        value->draw_width,
-                                        value->draw_height);
+/* This only uses Cairo so it can be called from any thread */
+static cairo_surface_t *
+cogl_pango_renderer_rasterize_glyph (cairo_scaled_font_t *scaled_font,
+                                     PangoGlyph glyph,
+                                     cairo_format_t format,
+                                     int draw_x,
+                                     int draw_y,
+                                     int draw_width,
+                                     int draw_height)
+{
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  cairo_glyph_t cairo_glyph;
+
+  surface = cairo_image_surface_create (format, draw_width, draw_height);
   cr = cairo_create (surface);
 
-  scaled_font = pango_cairo_font_get_scaled_font (PANGO_CAIRO_FONT (font));
   cairo_set_scaled_font (cr, scaled_font);
 
   cairo_set_source_rgba (cr, 1.0, 1.0, 1.0, 1.0);
 
-  cairo_glyph.x = -value->draw_x;
-  cairo_glyph.y = -value->draw_y;
+  cairo_glyph.x = -draw_x;
+  cairo_glyph.y = -draw_y;
   /* The PangoCairo glyph numbers directly map to Cairo glyph
      numbers */
   cairo_glyph.index = glyph;
@@ -619,6 +638,14 @@ cogl_pango_renderer_set_dirty_glyph (PangoFont *font,
   cairo_destroy (cr);
   cairo_surface_flush (surface);
 
+  return surface;
+}
+
+static void
+cogl_pango_renderer_upload_glyph (CoglPangoGlyphCacheValue *value,
+                                  CoglPixelFormat format,
+                                  cairo_surface_t *surface)
+{
   /* Copy the glyph to the texture */
   cogl_texture_set_region (value->texture,
                            0, /* src_x */
@@ -629,9 +656,43 @@ cogl_pango_renderer_set_dirty_glyph (PangoFont *font,
                            value->draw_height, /* dst_height */
                            value->draw_width, /* width */
                            value->draw_height, /* height */
-                           format_cogl,
+                           format,
                            cairo_image_surface_get_stride (surface),
                            cairo_image_surface_get_data (surface));
+}
+
+static void
+cogl_pango_renderer_set_dirty_glyph (PangoFont *font,
+                                     PangoGlyph glyph,
+                                     CoglPangoGlyphCacheValue *value)
+{
+  cairo_surface_t *surface;
+  cairo_scaled_font_t *scaled_font;
+  cairo_format_t format_cairo;
+  CoglPixelFormat format_cogl;
+
+  COGL_NOTE (PANGO, "redrawing glyph %i", glyph);
+
+  /* Glyphs that don't take up any space will end up without a
+     texture. These should never become dirty so they shouldn't end up
+     here */
+  _COGL_RETURN_IF_FAIL (value->texture != NULL);
+
+  cogl_pango_renderer_get_glyph_formats (value->texture,
+                                         &format_cairo,
+                                         &format_cogl);
+
+  scaled_font = pango_cairo_font_get_scaled_font (PANGO_CAIRO_FONT (font));
+
+  surface = cogl_pango_renderer_rasterize_glyph (scaled_font,
+                                                 glyph,
+                                                 format_cairo,
+                                                 value->draw_x,
+                                                 value->draw_y,
+                                                 value->draw_width,
+                                                 value->draw_height);
+
+  cogl_pango_renderer_upload_glyph (value, format_cogl, surface);
 
   cairo_surface_destroy (surface);
 }
@@ -727,6 +788,400 @@ cogl_pango_ensure_glyph_cache_for_layout (PangoLayout *layout)
   _cogl_pango_set_dirty_glyphs (priv);
 }
 
+/* The number of glyphs uploaded by each dispatch of the idle handler
+   of a warm-up so that the main loop can still paint frames while a
+   large set of glyphs is uploaded */
+#define COGL_PANGO_WARMUP_UPLOAD_BATCH_SIZE 64
+
+typedef struct
+{
+  PangoFont *font;
+  PangoGlyph glyph;
+
+  /* Everything the rasterizing thread needs is copied here so that it
+     doesn't have to touch the glyph cache or the Pango font */
+  cairo_scaled_font_t *scaled_font;
+  cairo_format_t format;
+  int draw_x;
+  int draw_y;
+  int draw_width;
+  int draw_height;
+
+  cairo_surface_t *surface;
+} CoglPangoWarmupGlyph;
+
+/* A warm-up doesn't keep the layout or the renderer alive. It is
+ * cancelled if either of them goes away before it completes. All of
+ * the members are only used from the main thread except for the
+ * glyphs' rasterizing data and the ones protected by warmup_lock */
+typedef struct
+{
+  PangoLayout *layout;
+  CoglPangoRenderer *renderer;
+  CoglPangoGlyphCache *glyph_cache;
+
+  GArray *glyphs;
+  unsigned int n_uploaded;
+
+  GMainContext *main_context;
+
+  CoglPangoGlyphCacheWarmupCallback callback;
+  void *user_data;
+
+  /* Protected by warmup_lock. The rasterizing thread also polls
+     cancelled without the lock to stop early */
+  int cancelled;
+  GSource *upload_source;
+} CoglPangoWarmup;
+
+static GMutex warmup_lock;
+
+/* This can be called from the rasterizing thread once the warm-up has
+   been cancelled so it mustn't touch any of the Pango objects */
+static void
+cogl_pango_warmup_free (CoglPangoWarmup *warmup)
+{
+  unsigned int i;
+
+  for (i = 0; i < warmup->glyphs->len; i++)
+    {
+      CoglPangoWarmupGlyph *warmup_glyph =
+        &g_array_index (warmup->glyphs, CoglPangoWarmupGlyph, i);
+
+      if (warmup_glyph->surface)
+        cairo_surface_destroy (warmup_glyph->surface);
+      cairo_scaled_font_destroy (warmup_glyph->scaled_font);
+    }
+
+  g_array_free (warmup->glyphs, TRUE);
+  g_main_context_unref (warmup->main_context);
+
+  g_slice_free (CoglPangoWarmup, warmup);
+}
+
+static void cogl_pango_warmup_layout_destroyed_cb (void *user_data,
+                                                   GObject *layout);
+
+/* Releases everything the warm-up holds that belongs to the main
+   thread */
+static void
+cogl_pango_warmup_detach (CoglPangoWarmup *warmup)
+{
+  unsigned int i;
+
+  for (i = 0; i < warmup->glyphs->len; i++)
+    {
+      CoglPangoWarmupGlyph *warmup_glyph =
+        &g_array_index (warmup->glyphs, CoglPangoWarmupGlyph, i);
+
+      g_clear_object (&warmup_glyph->font);
+    }
+
+  if (warmup->layout)
+    {
+      g_object_weak_unref (G_OBJECT (warmup->layout),
+                           cogl_pango_warmup_layout_destroyed_cb,
+                           warmup);
+      warmup->layout = NULL;
+    }
+
+  warmup->renderer->warmups = g_list_remove (warmup->renderer->warmups,
+                                             warmup);
+}
+
+static void
+cogl_pango_warmup_cancel (CoglPangoWarmup *warmup)
+{
+  gboolean free_now = FALSE;
+
+  cogl_pango_warmup_detach (warmup);
+
+  g_mutex_lock (&warmup_lock);
+
+  g_atomic_int_set (&warmup->cancelled, TRUE);
+
+  /* If the upload is already queued then nothing else refers to the
+     warm-up. Otherwise the rasterizing thread will free it */
+  if (warmup->upload_source)
+    {
+      g_source_destroy (warmup->upload_source);
+      g_source_unref (warmup->upload_source);
+      warmup->upload_source = NULL;
+      free_now = TRUE;
+    }
+
+  g_mutex_unlock (&warmup_lock);
+
+  if (free_now)
+    cogl_pango_warmup_free (warmup);
+}
+
+static void
+cogl_pango_warmup_layout_destroyed_cb (void *user_data,
+                                       GObject *layout)
+{
+  CoglPangoWarmup *warmup = user_data;
+
+  /* The weak reference is already gone */
+  warmup->layout = NULL;
+
+  COGL_NOTE (PANGO, "dropping warm-up for destroyed layout %p", layout);
+
+  cogl_pango_warmup_cancel (warmup);
+}
+
+static void
+cogl_pango_renderer_cancel_warmups (CoglPangoRenderer *priv)
+{
+  while (priv->warmups)
+    cogl_pango_warmup_cancel (priv->warmups->data);
+}
+
+static gboolean
+cogl_pango_warmup_upload_cb (void *user_data)
+{
+  CoglPangoWarmup *warmup = user_data;
+  PangoLayout *layout = warmup->layout;
+  unsigned int end = MIN (warmup->n_uploaded +
+                          COGL_PANGO_WARMUP_UPLOAD_BATCH_SIZE,
+                          warmup->glyphs->len);
+
+  for (; warmup->n_uploaded < end; warmup->n_uploaded++)
+    {
+      CoglPangoWarmupGlyph *warmup_glyph =
+        &g_array_index (warmup->glyphs, CoglPangoWarmupGlyph,
+                        warmup->n_uploaded);
+      CoglPangoGlyphCacheValue *value;
+      cairo_format_t format_cairo;
+      CoglPixelFormat format_cogl;
+
+      value = cogl_pango_glyph_cache_lookup (warmup->glyph_cache,
+                                             FALSE,
+                                             warmup_glyph->font,
+                                             warmup_glyph->glyph);
+
+      /* The glyph may have already been drawn because a layout needed
+         it or the cache may have been cleared in the meantime */
+      if (value == NULL || !value->pending)
+        continue;
+
+      value->pending = FALSE;
+
+      cogl_pango_renderer_get_glyph_formats (value->texture,
+                                             &format_cairo,
+                                             &format_cogl);
+
+      /* If the cache was cleared and the glyph was reserved again by
+         another warm-up it could have ended up in a texture with a
+         different format */
+      if (format_cairo == warmup_glyph->format)
+        cogl_pango_renderer_upload_glyph (value,
+                                          format_cogl,
+                                          warmup_glyph->surface);
+      else
+        cogl_pango_renderer_set_dirty_glyph (warmup_glyph->font,
+                                             warmup_glyph->glyph,
+                                             value);
+    }
+
+  if (warmup->n_uploaded < warmup->glyphs->len)
+    return G_SOURCE_CONTINUE;
+
+  COGL_NOTE (PANGO, "uploaded %u warmed up glyphs", warmup->glyphs->len);
+
+  /* Keep the layout alive for the callback now that the warm-up no
+     longer watches it */
+  g_object_ref (layout);
+
+  cogl_pango_warmup_detach (warmup);
+
+  g_mutex_lock (&warmup_lock);
+  g_source_unref (warmup->upload_source);
+  warmup->upload_source = NULL;
+  g_mutex_unlock (&warmup_lock);
+
+  if (warmup->callback)
+    warmup->callback (layout, warmup->user_data);
+
+  g_object_unref (layout);
+
+  cogl_pango_warmup_free (warmup);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Must be called with warmup_lock held */
+static void
+cogl_pango_warmup_queue_upload (CoglPangoWarmup *warmup)
+{
+  GSource *source;
+
+  source = g_idle_source_new ();
+  g_source_set_name (source, "CoglPango glyph cache warm-up");
+  g_source_set_callback (source, cogl_pango_warmup_upload_cb, warmup, NULL);
+  g_source_attach (source, warmup->main_context);
+
+  warmup->upload_source = source;
+}
+
+static void
+cogl_pango_warmup_thread_func (void *data,
+                               void *user_data)
+{
+  CoglPangoWarmup *warmup = data;
+  gboolean cancelled;
+  unsigned int i;
+
+  for (i = 0; i < warmup->glyphs->len; i++)
+    {
+      CoglPangoWarmupGlyph *warmup_glyph =
+        &g_array_index (warmup->glyphs, CoglPangoWarmupGlyph, i);
+
+      if (g_atomic_int_get (&warmup->cancelled))
+        break;
+
+      warmup_glyph->surface =
+        cogl_pango_renderer_rasterize_glyph (warmup_glyph->scaled_font,
+                                             warmup_glyph->glyph,
+                                             warmup_glyph->format,
+                                             warmup_glyph->draw_x,
+                                             warmup_glyph->draw_y,
+                                             warmup_glyph->draw_width,
+                                             warmup_glyph->draw_height);
+    }
+
+  g_mutex_lock (&warmup_lock);
+
+  cancelled = warmup->cancelled;
+  if (!cancelled)
+    cogl_pango_warmup_queue_upload (warmup);
+
+  g_mutex_unlock (&warmup_lock);
+
+  /* The main thread has already released the Pango objects */
+  if (cancelled)
+    cogl_pango_warmup_free (warmup);
+}
+
+static void
+cogl_pango_warmup_reserve_layout_line (CoglPangoWarmup *warmup,
+                                       PangoLayoutLine *line)
+{
+  GSList *l;
+
+  for (l = line->runs; l; l = l->next)
+    {
+      PangoLayoutRun *run = l->data;
+      PangoFont *font = run->item->analysis.font;
+      PangoGlyphString *glyphs = run->glyphs;
+      int i;
+
+      for (i = 0; i < glyphs->num_glyphs; i++)
+        {
+          PangoGlyph glyph = glyphs->glyphs[i].glyph;
+          CoglPangoGlyphCacheValue *value;
+          CoglPangoWarmupGlyph warmup_glyph;
+          CoglPixelFormat format_cogl;
+
+          /* Only the glyphs that weren't cached yet are returned
+             here. Their space is reserved now but they won't be
+             drawn until the upload unless a layout needs them */
+          value = _cogl_pango_glyph_cache_reserve_pending (warmup->glyph_cache,
+                                                           font,
+                                                           glyph);
+          if (value == NULL)
+            continue;
+
+          warmup_glyph.font = g_object_ref (font);
+          warmup_glyph.glyph = glyph;
+          warmup_glyph.scaled_font =
+            cairo_scaled_font_reference (pango_cairo_font_get_scaled_font
+                                         (PANGO_CAIRO_FONT (font)));
+          cogl_pango_renderer_get_glyph_formats (value->texture,
+                                                 &warmup_glyph.format,
+                                                 &format_cogl);
+          warmup_glyph.draw_x = value->draw_x;
+          warmup_glyph.draw_y = value->draw_y;
+          warmup_glyph.draw_width = value->draw_width;
+          warmup_glyph.draw_height = value->draw_height;
+          warmup_glyph.surface = NULL;
+
+          g_array_append_val (warmup->glyphs, warmup_glyph);
+        }
+    }
+}
+
+void
+cogl_pango_ensure_glyph_cache_for_layout_async (PangoLayout *layout,
+                                                CoglPangoGlyphCacheWarmupCallback callback,
+                                                void *user_data)
+{
+  PangoContext *context;
+  CoglPangoRenderer *priv;
+  CoglPangoWarmup *warmup;
+  PangoLayoutIter *iter;
+
+  _COGL_RETURN_IF_FAIL (PANGO_IS_LAYOUT (layout));
+
+  context = pango_layout_get_context (layout);
+  priv = cogl_pango_get_renderer_from_context (context);
+
+  warmup = g_slice_new0 (CoglPangoWarmup);
+  warmup->layout = layout;
+  warmup->renderer = priv;
+  warmup->glyph_cache = (priv->use_mipmapping ?
+                         priv->mipmap_caches.glyph_cache :
+                         priv->no_mipmap_caches.glyph_cache);
+  warmup->glyphs = g_array_new (FALSE, FALSE, sizeof (CoglPangoWarmupGlyph));
+  warmup->main_context = g_main_context_ref_thread_default ();
+  warmup->callback = callback;
+  warmup->user_data = user_data;
+
+  if ((iter = pango_layout_get_iter (layout)))
+    {
+      do
+        {
+          PangoLayoutLine *line;
+
+          line = pango_layout_iter_get_line_readonly (iter);
+
+          cogl_pango_warmup_reserve_layout_line (warmup, line);
+        }
+      while (pango_layout_iter_next_line (iter));
+
+      pango_layout_iter_free (iter);
+    }
+
+  COGL_NOTE (PANGO, "warming up %u glyphs", warmup->glyphs->len);
+
+  g_object_weak_ref (G_OBJECT (layout),
+                     cogl_pango_warmup_layout_destroyed_cb,
+                     warmup);
+  priv->warmups = g_list_prepend (priv->warmups, warmup);
+
+  if (warmup->glyphs->len == 0)
+    {
+      g_mutex_lock (&warmup_lock);
+      cogl_pango_warmup_queue_upload (warmup);
+      g_mutex_unlock (&warmup_lock);
+      return;
+    }
+
+  if (G_UNLIKELY (warmup_thread_pool == NULL))
+    {
+      /* This can't fail if exclusive == FALSE. A single thread is
+         enough because the warm-ups are only meant to run in the
+         background */
+      warmup_thread_pool =
+        g_thread_pool_new (cogl_pango_warmup_thread_func, NULL,
+                           1,
+                           FALSE,
+                           NULL);
+    }
+
+  g_thread_pool_push (warmup_thread_pool, warmup, NULL);
+}
+
 static void
 cogl_pango_renderer_set_color_for_part (PangoRenderer   *renderer,
                                         PangoRenderPart  part)
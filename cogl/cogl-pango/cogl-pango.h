@@ -132,6 +132,52 @@ cogl_pango_font_map_clear_glyph_cache (CoglPangoFontMap *font_map);
 void
 cogl_pango_ensure_glyph_cache_for_layout (PangoLayout *layout);
 
+/**
+ * CoglPangoGlyphCacheWarmupCallback:
+ * @layout: The #PangoLayout passed to
+ *   cogl_pango_ensure_glyph_cache_for_layout_async()
+ * @user_data: The private data passed to
+ *   cogl_pango_ensure_glyph_cache_for_layout_async()
+ *
+ * The callback prototype used with
+ * cogl_pango_ensure_glyph_cache_for_layout_async() for notification
+ * that the glyphs of the layout have been uploaded.
+ *
+ * Stability: unstable
+ */
+typedef void (* CoglPangoGlyphCacheWarmupCallback) (PangoLayout *layout,
+                                                    void *user_data);
+
+/**
+ * cogl_pango_ensure_glyph_cache_for_layout_async:
+ * @layout: A #PangoLayout
+ * @callback: (scope async) (nullable): A #CoglPangoGlyphCacheWarmupCallback
+ *   to call once the glyphs have been uploaded
+ * @user_data: (closure): Private data that will be passed to the callback
+ *
+ * Like cogl_pango_ensure_glyph_cache_for_layout(), but the glyphs
+ * that aren't cached yet are rasterized in a separate thread and then
+ * uploaded a batch at a time from the main loop. This can be used to
+ * warm up the glyph cache with the characters that are likely to be
+ * used, for example for each font and scale of the user interface,
+ * without stalling the painting of frames.
+ *
+ * Layouts can still be drawn while the warm-up is in progress. Any
+ * glyphs they need that haven't been uploaded yet will be drawn
+ * immediately as if this function had not been called.
+ *
+ * The warm-up doesn't keep @layout or its renderer alive. If either
+ * of them is destroyed first, the warm-up is dropped and @callback is
+ * never called. Destroying @layout is therefore also the way to cancel
+ * it.
+ *
+ * Stability: unstable
+ */
+void
+cogl_pango_ensure_glyph_cache_for_layout_async (PangoLayout *layout,
+                                                CoglPangoGlyphCacheWarmupCallback callback,
+                                                void *user_data);
+
 /**
  * cogl_pango_font_map_set_use_mipmapping:
  * @font_map: a #CoglPangoFontMap
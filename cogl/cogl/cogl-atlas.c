@@ -398,6 +398,14 @@ _cogl_atlas_reserve_space (CoglAtlas             *atlas,
       return TRUE;
     }
 
+  /* A fixed size atlas is never reorganized once it has a texture so
+     that its users never have to move or redraw what it contains */
+  if (atlas->map && (atlas->flags & COGL_ATLAS_FIXED_SIZE))
+    {
+      COGL_NOTE (ATLAS, "%p: Fixed size atlas is full", atlas);
+      return FALSE;
+    }
+
   /* If we make it here then we need to reorganize the atlas. First
      we'll notify any users of the atlas that this is going to happen
      so that for example in CoglAtlasTexture it can notify that the
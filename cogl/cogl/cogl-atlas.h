@@ -41,7 +41,10 @@ typedef void
 typedef enum
 {
   COGL_ATLAS_CLEAR_TEXTURE     = (1 << 0),
-  COGL_ATLAS_DISABLE_MIGRATION = (1 << 1)
+  COGL_ATLAS_DISABLE_MIGRATION = (1 << 1),
+  /* The texture is created once at the initial size and the atlas
+     fails to reserve space instead of growing or reorganizing */
+  COGL_ATLAS_FIXED_SIZE        = (1 << 2)
 } CoglAtlasFlags;
 
 typedef struct _CoglAtlas CoglAtlas;
@@ -82,6 +82,10 @@ struct _CoglAttribute
     } constant;
   } d;
 
+  /* When non-zero the attribute advances once per this many instances
+     instead of once per vertex */
+  int instance_divisor;
+
   int immutable_ref;
 };
 
@@ -136,5 +140,9 @@ _cogl_flush_attributes_state (CoglFramebuffer *framebuffer,
 int
 _cogl_attribute_get_n_components (CoglAttribute *attribute);
 
+void
+_cogl_attribute_set_instance_divisor (CoglAttribute *attribute,
+                                      int divisor);
+
 #endif /* __COGL_ATTRIBUTE_PRIVATE_H */
 
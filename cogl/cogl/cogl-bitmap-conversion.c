@@ -37,6 +37,8 @@
 
 #include <string.h>
 
+#include <test-fixtures/test-unit.h>
+
 #define component_type uint8_t
 #define component_size 8
 /* We want to specially optimise the packing when we are converting
@@ -289,6 +291,366 @@ _cogl_bitmap_premult_unpacked_span_16 (uint16_t *data,
     }
 }
 
+/* Direct conversions between the 32-bit formats with 8 bits per
+ * component. These swizzle and (un)premultiply each row in a single
+ * pass instead of going through an intermediate RGBA row. On x86 the
+ * span function is picked at runtime between the generic, SSE4.1 and
+ * AVX2 versions. */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+  (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define COGL_USE_X86_SIMD_CONVERSION
+#include <immintrin.h>
+#endif
+
+typedef enum
+{
+  COGL_ALPHA_OP_NONE,
+  COGL_ALPHA_OP_PREMULT,
+  COGL_ALPHA_OP_UNPREMULT,
+} CoglAlphaOp;
+
+typedef struct _CoglDirectConversion CoglDirectConversion;
+
+typedef void (* CoglDirectConvertSpanFunc) (const CoglDirectConversion *conversion,
+                                            const uint8_t              *src,
+                                            uint8_t                    *dst,
+                                            int                         width);
+
+struct _CoglDirectConversion
+{
+  /* For each byte of four destination pixels, the source byte */
+  uint8_t shuffle[16];
+  /* The destination alpha byte of each of four pixels, four times */
+  uint8_t alpha_broadcast[16];
+  /* 0xff at the destination alpha bytes of four pixels */
+  uint8_t alpha_mask[16];
+
+  int alpha_index;
+  CoglAlphaOp alpha_op;
+
+  CoglDirectConvertSpanFunc convert_span;
+};
+
+static void
+_cogl_direct_convert_span_generic (const CoglDirectConversion *conversion,
+                                   const uint8_t              *src,
+                                   uint8_t                    *dst,
+                                   int                         width)
+{
+  const uint8_t *shuffle = conversion->shuffle;
+  int alpha_index = conversion->alpha_index;
+
+  /* The pixel is built in a temporary so that src can be dst */
+  while (width-- > 0)
+    {
+      uint8_t pixel[4];
+
+      pixel[0] = src[shuffle[0]];
+      pixel[1] = src[shuffle[1]];
+      pixel[2] = src[shuffle[2]];
+      pixel[3] = src[shuffle[3]];
+
+      switch (conversion->alpha_op)
+        {
+        case COGL_ALPHA_OP_NONE:
+          break;
+        case COGL_ALPHA_OP_PREMULT:
+          if (alpha_index == 3)
+            _cogl_premult_alpha_last (pixel);
+          else
+            _cogl_premult_alpha_first (pixel);
+          break;
+        case COGL_ALPHA_OP_UNPREMULT:
+          if (pixel[alpha_index] == 0)
+            _cogl_unpremult_alpha_0 (pixel);
+          else if (alpha_index == 3)
+            _cogl_unpremult_alpha_last (pixel);
+          else
+            _cogl_unpremult_alpha_first (pixel);
+          break;
+        }
+
+      memcpy (dst, pixel, 4);
+      src += 4;
+      dst += 4;
+    }
+}
+
+#ifdef COGL_USE_X86_SIMD_CONVERSION
+
+__attribute__ ((target ("sse4.1")))
+static inline __m128i
+_cogl_premult_four_pixels_sse41 (__m128i pixels,
+                                 __m128i alpha_broadcast,
+                                 __m128i alpha_mask)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i half = _mm_set1_epi16 (128);
+  __m128i alpha = _mm_shuffle_epi8 (pixels, alpha_broadcast);
+  __m128i lo = _mm_unpacklo_epi8 (pixels, zero);
+  __m128i hi = _mm_unpackhi_epi8 (pixels, zero);
+
+  /* The same as MULT(): t = c * a + 128, c = ((t >> 8) + t) >> 8 */
+  lo = _mm_add_epi16 (_mm_mullo_epi16 (lo, _mm_unpacklo_epi8 (alpha, zero)),
+                      half);
+  hi = _mm_add_epi16 (_mm_mullo_epi16 (hi, _mm_unpackhi_epi8 (alpha, zero)),
+                      half);
+  lo = _mm_srli_epi16 (_mm_add_epi16 (_mm_srli_epi16 (lo, 8), lo), 8);
+  hi = _mm_srli_epi16 (_mm_add_epi16 (_mm_srli_epi16 (hi, 8), hi), 8);
+
+  return _mm_blendv_epi8 (_mm_packus_epi16 (lo, hi), pixels, alpha_mask);
+}
+
+__attribute__ ((target ("sse4.1")))
+static inline __m128i
+_cogl_unpremult_pixel_sse41 (__m128i pixel,
+                             __m128i alpha)
+{
+  __m128 c = _mm_cvtepi32_ps (_mm_cvtepu8_epi32 (pixel));
+  __m128 a = _mm_cvtepi32_ps (_mm_cvtepu8_epi32 (alpha));
+  __m128i q;
+
+  /* c * 255 / a is small enough for the correctly rounded quotient to
+   * truncate to the same value as the integer division, and division
+   * by a zero alpha ends up as 0 after the masking. Keeping the low
+   * byte wraps the way storing into a byte does. */
+  q = _mm_cvttps_epi32 (_mm_div_ps (_mm_mul_ps (c, _mm_set1_ps (255.0f)), a));
+
+  return _mm_and_si128 (q, _mm_set1_epi32 (0xff));
+}
+
+__attribute__ ((target ("sse4.1")))
+static inline __m128i
+_cogl_unpremult_four_pixels_sse41 (__m128i pixels,
+                                   __m128i alpha_broadcast,
+                                   __m128i alpha_mask)
+{
+  __m128i alpha = _mm_shuffle_epi8 (pixels, alpha_broadcast);
+  __m128i p0, p1, p2, p3;
+
+  p0 = _cogl_unpremult_pixel_sse41 (pixels, alpha);
+  p1 = _cogl_unpremult_pixel_sse41 (_mm_srli_si128 (pixels, 4),
+                                    _mm_srli_si128 (alpha, 4));
+  p2 = _cogl_unpremult_pixel_sse41 (_mm_srli_si128 (pixels, 8),
+                                    _mm_srli_si128 (alpha, 8));
+  p3 = _cogl_unpremult_pixel_sse41 (_mm_srli_si128 (pixels, 12),
+                                    _mm_srli_si128 (alpha, 12));
+
+  return _mm_blendv_epi8 (_mm_packus_epi16 (_mm_packus_epi32 (p0, p1),
+                                            _mm_packus_epi32 (p2, p3)),
+                          pixels, alpha_mask);
+}
+
+__attribute__ ((target ("sse4.1")))
+static void
+_cogl_direct_convert_span_sse41 (const CoglDirectConversion *conversion,
+                                 const uint8_t              *src,
+                                 uint8_t                    *dst,
+                                 int                         width)
+{
+  const __m128i shuffle =
+    _mm_loadu_si128 ((const __m128i *) conversion->shuffle);
+  const __m128i alpha_broadcast =
+    _mm_loadu_si128 ((const __m128i *) conversion->alpha_broadcast);
+  const __m128i alpha_mask =
+    _mm_loadu_si128 ((const __m128i *) conversion->alpha_mask);
+
+  while (width >= 4)
+    {
+      __m128i pixels;
+
+      pixels = _mm_loadu_si128 ((const __m128i *) src);
+      pixels = _mm_shuffle_epi8 (pixels, shuffle);
+
+      switch (conversion->alpha_op)
+        {
+        case COGL_ALPHA_OP_NONE:
+          break;
+        case COGL_ALPHA_OP_PREMULT:
+          pixels = _cogl_premult_four_pixels_sse41 (pixels,
+                                                    alpha_broadcast,
+                                                    alpha_mask);
+          break;
+        case COGL_ALPHA_OP_UNPREMULT:
+          pixels = _cogl_unpremult_four_pixels_sse41 (pixels,
+                                                      alpha_broadcast,
+                                                      alpha_mask);
+          break;
+        }
+
+      _mm_storeu_si128 ((__m128i *) dst, pixels);
+
+      src += 4 * 4;
+      dst += 4 * 4;
+      width -= 4;
+    }
+
+  _cogl_direct_convert_span_generic (conversion, src, dst, width);
+}
+
+__attribute__ ((target ("avx2")))
+static void
+_cogl_direct_convert_span_avx2 (const CoglDirectConversion *conversion,
+                                const uint8_t              *src,
+                                uint8_t                    *dst,
+                                int                         width)
+{
+  /* Byte shuffles work within 128-bit lanes, which is what we want
+   * with the four pixel masks repeated in both lanes. */
+  const __m256i shuffle =
+    _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i *) conversion->shuffle));
+  const __m256i alpha_broadcast =
+    _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i *) conversion->alpha_broadcast));
+  const __m256i alpha_mask =
+    _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i *) conversion->alpha_mask));
+  const __m256i zero = _mm256_setzero_si256 ();
+  const __m256i half = _mm256_set1_epi16 (128);
+
+  while (width >= 8)
+    {
+      __m256i pixels;
+      __m256i alpha, lo, hi;
+      __m128i lo_half, hi_half;
+
+      pixels = _mm256_loadu_si256 ((const __m256i *) src);
+      pixels = _mm256_shuffle_epi8 (pixels, shuffle);
+
+      switch (conversion->alpha_op)
+        {
+        case COGL_ALPHA_OP_NONE:
+          break;
+        case COGL_ALPHA_OP_PREMULT:
+          alpha = _mm256_shuffle_epi8 (pixels, alpha_broadcast);
+          lo = _mm256_unpacklo_epi8 (pixels, zero);
+          hi = _mm256_unpackhi_epi8 (pixels, zero);
+          lo = _mm256_add_epi16 (_mm256_mullo_epi16 (lo, _mm256_unpacklo_epi8 (alpha, zero)),
+                                 half);
+          hi = _mm256_add_epi16 (_mm256_mullo_epi16 (hi, _mm256_unpackhi_epi8 (alpha, zero)),
+                                 half);
+          lo = _mm256_srli_epi16 (_mm256_add_epi16 (_mm256_srli_epi16 (lo, 8), lo), 8);
+          hi = _mm256_srli_epi16 (_mm256_add_epi16 (_mm256_srli_epi16 (hi, 8), hi), 8);
+          pixels = _mm256_blendv_epi8 (_mm256_packus_epi16 (lo, hi),
+                                       pixels, alpha_mask);
+          break;
+        case COGL_ALPHA_OP_UNPREMULT:
+          /* Dividing is done four pixels at a time anyway */
+          lo_half =
+            _cogl_unpremult_four_pixels_sse41 (_mm256_castsi256_si128 (pixels),
+                                               _mm256_castsi256_si128 (alpha_broadcast),
+                                               _mm256_castsi256_si128 (alpha_mask));
+          hi_half =
+            _cogl_unpremult_four_pixels_sse41 (_mm256_extracti128_si256 (pixels, 1),
+                                               _mm256_castsi256_si128 (alpha_broadcast),
+                                               _mm256_castsi256_si128 (alpha_mask));
+          pixels = _mm256_inserti128_si256 (_mm256_castsi128_si256 (lo_half),
+                                            hi_half, 1);
+          break;
+        }
+
+      _mm256_storeu_si256 ((__m256i *) dst, pixels);
+
+      src += 8 * 4;
+      dst += 8 * 4;
+      width -= 8;
+    }
+
+  _cogl_direct_convert_span_sse41 (conversion, src, dst, width);
+}
+
+#endif /* COGL_USE_X86_SIMD_CONVERSION */
+
+static CoglDirectConvertSpanFunc
+_cogl_get_direct_convert_span_func (void)
+{
+#ifdef COGL_USE_X86_SIMD_CONVERSION
+  __builtin_cpu_init ();
+
+  if (__builtin_cpu_supports ("avx2"))
+    return _cogl_direct_convert_span_avx2;
+  if (__builtin_cpu_supports ("sse4.1"))
+    return _cogl_direct_convert_span_sse41;
+#endif
+
+  return _cogl_direct_convert_span_generic;
+}
+
+/* Gets the position in memory of the red, green, blue and alpha bytes */
+static gboolean
+_cogl_get_8888_component_positions (CoglPixelFormat format,
+                                    int            *positions)
+{
+  static const int rgba[4] = { 0, 1, 2, 3 };
+  static const int bgra[4] = { 2, 1, 0, 3 };
+  static const int argb[4] = { 1, 2, 3, 0 };
+  static const int abgr[4] = { 3, 2, 1, 0 };
+  const int *order;
+
+  switch (format & ~COGL_PREMULT_BIT)
+    {
+    case COGL_PIXEL_FORMAT_RGBA_8888:
+      order = rgba;
+      break;
+    case COGL_PIXEL_FORMAT_BGRA_8888:
+      order = bgra;
+      break;
+    case COGL_PIXEL_FORMAT_ARGB_8888:
+      order = argb;
+      break;
+    case COGL_PIXEL_FORMAT_ABGR_8888:
+      order = abgr;
+      break;
+    default:
+      return FALSE;
+    }
+
+  memcpy (positions, order, sizeof (int) * 4);
+
+  return TRUE;
+}
+
+static gboolean
+_cogl_direct_conversion_init (CoglDirectConversion *conversion,
+                              CoglPixelFormat       src_format,
+                              CoglPixelFormat       dst_format)
+{
+  int src_positions[4];
+  int dst_positions[4];
+  int pixel, component;
+
+  if (!_cogl_get_8888_component_positions (src_format, src_positions) ||
+      !_cogl_get_8888_component_positions (dst_format, dst_positions))
+    return FALSE;
+
+  memset (conversion, 0, sizeof (CoglDirectConversion));
+
+  conversion->alpha_index = dst_positions[3];
+
+  for (pixel = 0; pixel < 4; pixel++)
+    {
+      for (component = 0; component < 4; component++)
+        {
+          conversion->shuffle[pixel * 4 + dst_positions[component]] =
+            pixel * 4 + src_positions[component];
+          conversion->alpha_broadcast[pixel * 4 + component] =
+            pixel * 4 + conversion->alpha_index;
+        }
+
+      conversion->alpha_mask[pixel * 4 + conversion->alpha_index] = 0xff;
+    }
+
+  if ((src_format & COGL_PREMULT_BIT) == (dst_format & COGL_PREMULT_BIT))
+    conversion->alpha_op = COGL_ALPHA_OP_NONE;
+  else if (dst_format & COGL_PREMULT_BIT)
+    conversion->alpha_op = COGL_ALPHA_OP_PREMULT;
+  else
+    conversion->alpha_op = COGL_ALPHA_OP_UNPREMULT;
+
+  conversion->convert_span = _cogl_get_direct_convert_span_func ();
+
+  return TRUE;
+}
+
 static gboolean
 _cogl_bitmap_can_fast_premult (CoglPixelFormat format)
 {
@@ -358,6 +720,49 @@ _cogl_bitmap_needs_short_temp_buffer (CoglPixelFormat format)
   return FALSE;
 }
 
+static gboolean
+_cogl_bitmap_convert_direct (CoglBitmap                 *src_bmp,
+                             CoglBitmap                 *dst_bmp,
+                             const CoglDirectConversion *conversion,
+                             CoglError                 **error)
+{
+  uint8_t *src_data;
+  uint8_t *dst_data;
+  int src_rowstride;
+  int dst_rowstride;
+  int width, height;
+  int y;
+
+  src_rowstride = cogl_bitmap_get_rowstride (src_bmp);
+  dst_rowstride = cogl_bitmap_get_rowstride (dst_bmp);
+  width = cogl_bitmap_get_width (src_bmp);
+  height = cogl_bitmap_get_height (src_bmp);
+
+  src_data = _cogl_bitmap_map (src_bmp, COGL_BUFFER_ACCESS_READ, 0, error);
+  if (src_data == NULL)
+    return FALSE;
+  dst_data = _cogl_bitmap_map (dst_bmp,
+                               COGL_BUFFER_ACCESS_WRITE,
+                               COGL_BUFFER_MAP_HINT_DISCARD,
+                               error);
+  if (dst_data == NULL)
+    {
+      _cogl_bitmap_unmap (src_bmp);
+      return FALSE;
+    }
+
+  for (y = 0; y < height; y++)
+    conversion->convert_span (conversion,
+                              src_data + y * src_rowstride,
+                              dst_data + y * dst_rowstride,
+                              width);
+
+  _cogl_bitmap_unmap (src_bmp);
+  _cogl_bitmap_unmap (dst_bmp);
+
+  return TRUE;
+}
+
 gboolean
 _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
                                   CoglBitmap *dst_bmp,
@@ -376,6 +781,7 @@ _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
   CoglPixelFormat dst_format;
   gboolean use_16;
   gboolean need_premult;
+  CoglDirectConversion conversion;
 
   src_format = cogl_bitmap_get_format (src_bmp);
   src_rowstride = cogl_bitmap_get_rowstride (src_bmp);
@@ -393,6 +799,13 @@ _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
        dst_format != COGL_PIXEL_FORMAT_A_8 &&
        (src_format & dst_format & COGL_A_BIT));
 
+  /* Swizzling and (un)premultiplying between the 32-bit formats can
+     be done in a single pass without the temporary row */
+  if (((src_format & ~COGL_PREMULT_BIT) != (dst_format & ~COGL_PREMULT_BIT) ||
+       need_premult) &&
+      _cogl_direct_conversion_init (&conversion, src_format, dst_format))
+    return _cogl_bitmap_convert_direct (src_bmp, dst_bmp, &conversion, error);
+
   /* If the base format is the same then we can just copy the bitmap
      instead */
   if ((src_format & ~COGL_PREMULT_BIT) == (dst_format & ~COGL_PREMULT_BIT) &&
@@ -620,8 +1033,9 @@ _cogl_bitmap_unpremult (CoglBitmap *bmp,
 {
   uint8_t *p, *data;
   uint16_t *tmp_row;
-  int x,y;
+  int y;
   CoglPixelFormat format;
+  CoglDirectConversion conversion;
   int width, height;
   int rowstride;
 
@@ -638,9 +1052,10 @@ _cogl_bitmap_unpremult (CoglBitmap *bmp,
     return FALSE;
 
   /* If we can't directly unpremult the data inline then we'll
-     allocate a temporary row and unpack the data. This assumes if we
-      can fast premult then we can also fast unpremult */
-  if (_cogl_bitmap_can_fast_premult (format))
+     allocate a temporary row and unpack the data. */
+  if (_cogl_direct_conversion_init (&conversion,
+                                    format,
+                                    format & ~COGL_PREMULT_BIT))
     tmp_row = NULL;
   else
     tmp_row = g_malloc (sizeof (uint16_t) * 4 * width);
@@ -656,21 +1071,7 @@ _cogl_bitmap_unpremult (CoglBitmap *bmp,
           _cogl_pack_16 (format, tmp_row, p, width);
         }
       else
-        {
-          if (format & COGL_AFIRST_BIT)
-            {
-              for (x = 0; x < width; x++)
-                {
-                  if (p[0] == 0)
-                    _cogl_unpremult_alpha_0 (p);
-                  else
-                    _cogl_unpremult_alpha_first (p);
-                  p += 4;
-                }
-            }
-          else
-            _cogl_bitmap_unpremult_unpacked_span_8 (p, width);
-        }
+        conversion.convert_span (&conversion, p, p, width);
     }
 
   g_free (tmp_row);
@@ -688,8 +1089,9 @@ _cogl_bitmap_premult (CoglBitmap *bmp,
 {
   uint8_t *p, *data;
   uint16_t *tmp_row;
-  int x,y;
+  int y;
   CoglPixelFormat format;
+  CoglDirectConversion conversion;
   int width, height;
   int rowstride;
 
@@ -707,7 +1109,9 @@ _cogl_bitmap_premult (CoglBitmap *bmp,
 
   /* If we can't directly premult the data inline then we'll allocate
      a temporary row and unpack the data. */
-  if (_cogl_bitmap_can_fast_premult (format))
+  if (_cogl_direct_conversion_init (&conversion,
+                                    format & ~COGL_PREMULT_BIT,
+                                    format | COGL_PREMULT_BIT))
     tmp_row = NULL;
   else
     tmp_row = g_malloc (sizeof (uint16_t) * 4 * width);
@@ -723,18 +1127,7 @@ _cogl_bitmap_premult (CoglBitmap *bmp,
           _cogl_pack_16 (format, tmp_row, p, width);
         }
       else
-        {
-          if (format & COGL_AFIRST_BIT)
-            {
-              for (x = 0; x < width; x++)
-                {
-                  _cogl_premult_alpha_first (p);
-                  p += 4;
-                }
-            }
-          else
-            _cogl_bitmap_premult_unpacked_span_8 (p, width);
-        }
+        conversion.convert_span (&conversion, p, p, width);
     }
 
   g_free (tmp_row);
@@ -745,3 +1138,155 @@ _cogl_bitmap_premult (CoglBitmap *bmp,
 
   return TRUE;
 }
+
+#ifdef ENABLE_UNIT_TESTS
+
+static void
+convert_span_reference (CoglPixelFormat  src_format,
+                        CoglPixelFormat  dst_format,
+                        const uint8_t   *src,
+                        uint8_t         *dst,
+                        uint8_t         *tmp_row,
+                        int              width)
+{
+  _cogl_unpack_8 (src_format, src, tmp_row, width);
+
+  if ((src_format & COGL_PREMULT_BIT) != (dst_format & COGL_PREMULT_BIT))
+    {
+      if (dst_format & COGL_PREMULT_BIT)
+        _cogl_bitmap_premult_unpacked_span_8 (tmp_row, width);
+      else
+        _cogl_bitmap_unpremult_unpacked_span_8 (tmp_row, width);
+    }
+
+  _cogl_pack_8 (dst_format, tmp_row, dst, width);
+}
+
+UNIT_TEST (check_direct_bitmap_conversion,
+           0 /* no requirements */,
+           0 /* no failure cases */)
+{
+  static const CoglPixelFormat formats[] =
+    {
+      COGL_PIXEL_FORMAT_RGBA_8888,
+      COGL_PIXEL_FORMAT_BGRA_8888,
+      COGL_PIXEL_FORMAT_ARGB_8888,
+      COGL_PIXEL_FORMAT_ABGR_8888,
+      COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+      COGL_PIXEL_FORMAT_BGRA_8888_PRE,
+      COGL_PIXEL_FORMAT_ARGB_8888_PRE,
+      COGL_PIXEL_FORMAT_ABGR_8888_PRE,
+    };
+  struct
+  {
+    const char *name;
+    CoglDirectConvertSpanFunc convert_span;
+    gboolean supported;
+  } spans[] =
+    {
+      { "generic", _cogl_direct_convert_span_generic, TRUE },
+#ifdef COGL_USE_X86_SIMD_CONVERSION
+      { "sse4.1", _cogl_direct_convert_span_sse41,
+        __builtin_cpu_supports ("sse4.1") },
+      { "avx2", _cogl_direct_convert_span_avx2,
+        __builtin_cpu_supports ("avx2") },
+#endif
+    };
+  /* An odd width to cover the leftover pixels of the SIMD versions */
+  const int width = 37;
+  uint8_t src[37 * 4];
+  uint8_t expected[37 * 4];
+  uint8_t result[37 * 4];
+  uint8_t tmp_row[37 * 4];
+  int i, j, k;
+
+  for (i = 0; i < width * 4; i++)
+    src[i] = g_random_int_range (0, 256);
+  /* Make sure zero alpha is covered whichever byte is alpha */
+  src[0] = src[3] = 0;
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++)
+    for (j = 0; j < G_N_ELEMENTS (formats); j++)
+      {
+        CoglDirectConversion conversion;
+
+        g_assert (_cogl_direct_conversion_init (&conversion,
+                                                formats[i],
+                                                formats[j]));
+
+        convert_span_reference (formats[i], formats[j],
+                                src, expected, tmp_row, width);
+
+        for (k = 0; k < G_N_ELEMENTS (spans); k++)
+          {
+            if (!spans[k].supported)
+              continue;
+
+            spans[k].convert_span (&conversion, src, result, width);
+            g_assert (memcmp (result, expected, sizeof (result)) == 0);
+
+            /* Converting in place should give the same result */
+            memcpy (result, src, sizeof (result));
+            spans[k].convert_span (&conversion, result, result, width);
+            g_assert (memcmp (result, expected, sizeof (result)) == 0);
+          }
+      }
+
+  /* Compare against the unpacking path on a 1080p image when asked to
+   * be verbose */
+  if (cogl_test_verbose ())
+    {
+      const int bench_width = 1920, bench_height = 1080;
+      uint8_t *bench_src = g_malloc (bench_width * bench_height * 4);
+      uint8_t *bench_dst = g_malloc (bench_width * bench_height * 4);
+      uint8_t *bench_tmp = g_malloc (bench_width * 4);
+      CoglDirectConversion conversion;
+      GTimer *timer = g_timer_new ();
+      int y;
+
+      for (i = 0; i < bench_width * bench_height * 4; i++)
+        bench_src[i] = g_random_int_range (0, 256);
+
+      for (i = 0; i < 4; i++)
+        for (j = 4; j < G_N_ELEMENTS (formats); j++)
+          {
+            _cogl_direct_conversion_init (&conversion, formats[i], formats[j]);
+
+            g_timer_start (timer);
+            for (y = 0; y < bench_height; y++)
+              convert_span_reference (formats[i], formats[j],
+                                      bench_src + y * bench_width * 4,
+                                      bench_dst + y * bench_width * 4,
+                                      bench_tmp,
+                                      bench_width);
+            g_print ("%d -> %d: unpacked %.3fms",
+                     formats[i], formats[j],
+                     g_timer_elapsed (timer, NULL) * 1000.0);
+
+            for (k = 0; k < G_N_ELEMENTS (spans); k++)
+              {
+                if (!spans[k].supported)
+                  continue;
+
+                g_timer_start (timer);
+                for (y = 0; y < bench_height; y++)
+                  spans[k].convert_span (&conversion,
+                                         bench_src + y * bench_width * 4,
+                                         bench_dst + y * bench_width * 4,
+                                         bench_width);
+                g_print (", %s %.3fms",
+                         spans[k].name,
+                         g_timer_elapsed (timer, NULL) * 1000.0);
+              }
+
+            g_print ("\n");
+          }
+
+      g_timer_destroy (timer);
+      g_free (bench_tmp);
+      g_free (bench_dst);
+      g_free (bench_src);
+    }
+}
+
+#endif /* ENABLE_UNIT_TESTS */
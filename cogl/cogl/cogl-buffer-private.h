@@ -69,7 +69,8 @@ typedef enum _CoglBufferFlags
   COGL_BUFFER_FLAG_NONE            = 0,
   COGL_BUFFER_FLAG_BUFFER_OBJECT   = 1UL << 0,  /* real openGL buffer object */
   COGL_BUFFER_FLAG_MAPPED          = 1UL << 1,
-  COGL_BUFFER_FLAG_MAPPED_FALLBACK = 1UL << 2
+  COGL_BUFFER_FLAG_MAPPED_FALLBACK = 1UL << 2,
+  COGL_BUFFER_FLAG_PERSISTENT      = 1UL << 3   /* mapped for its lifetime */
 } CoglBufferFlags;
 
 typedef enum
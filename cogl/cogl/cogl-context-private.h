@@ -62,6 +62,7 @@
 #include "cogl-path/cogl-path-types.h"
 #include "cogl-private.h"
 #include "winsys/cogl-winsys-private.h"
+#include "driver/gl/cogl-program-binary-cache-private.h"
 
 typedef struct
 {
@@ -125,6 +126,8 @@ struct _CoglContext
   CoglBitmask       enable_builtin_attributes_tmp;
   CoglBitmask       enable_texcoord_attributes_tmp;
   CoglBitmask       enable_custom_attributes_tmp;
+  /* Generic attribute locations whose instance divisor isn't 0 */
+  CoglBitmask       instanced_custom_attributes;
   CoglBitmask       changed_bits_tmp;
 
   gboolean          legacy_backface_culling_enabled;
@@ -166,6 +169,7 @@ struct _CoglContext
   int               legacy_state_set;
 
   CoglPipelineCache *pipeline_cache;
+  CoglProgramBinaryCache *program_binary_cache;
 
   /* Textures */
   CoglTexture2D *default_gl_texture_2d_tex;
@@ -180,6 +184,17 @@ struct _CoglContext
   GArray           *journal_flush_attributes_array;
   GArray           *journal_clip_bounds;
 
+  /* If the driver supports persistently mapped buffers then all of the
+     journals stream their vertices into this ring buffer. It stays
+     mapped for its whole lifetime. Each flush appends a fenced region
+     to journal_stream_regions and a region is only overwritten once
+     its fence has signalled */
+  CoglAttributeBuffer *journal_stream_buffer;
+  uint8_t          *journal_stream_data;
+  size_t            journal_stream_offset;
+  GQueue            journal_stream_regions;
+  gboolean          journal_stream_failed;
+
   GArray           *polygon_vertices;
 
   /* Some simple caching, to minimize state changes... */
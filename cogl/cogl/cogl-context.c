@@ -343,6 +343,7 @@ cogl_context_new (CoglDisplay *display,
   context->journal_flush_attributes_array =
     g_array_new (TRUE, FALSE, sizeof (CoglAttribute *));
   context->journal_clip_bounds = NULL;
+  g_queue_init (&context->journal_stream_regions);
 
   context->polygon_vertices = g_array_new (FALSE, FALSE, sizeof (float));
 
@@ -356,6 +357,7 @@ cogl_context_new (CoglDisplay *display,
   _cogl_bitmask_init (&context->enable_texcoord_attributes_tmp);
   _cogl_bitmask_init (&context->enabled_custom_attributes);
   _cogl_bitmask_init (&context->enable_custom_attributes_tmp);
+  _cogl_bitmask_init (&context->instanced_custom_attributes);
   _cogl_bitmask_init (&context->changed_bits_tmp);
 
   context->max_texture_units = -1;
@@ -379,6 +381,7 @@ cogl_context_new (CoglDisplay *display,
   context->legacy_depth_test_enabled = FALSE;
 
   context->pipeline_cache = _cogl_pipeline_cache_new ();
+  context->program_binary_cache = _cogl_program_binary_cache_new (context);
 
   for (i = 0; i < COGL_BUFFER_BIND_TARGET_COUNT; i++)
     context->current_buffer[i] = NULL;
@@ -550,6 +553,7 @@ _cogl_context_free (CoglContext *context)
     g_array_free (context->journal_flush_attributes_array, TRUE);
   if (context->journal_clip_bounds)
     g_array_free (context->journal_clip_bounds, TRUE);
+  _cogl_journal_free_stream_buffer (context);
 
   if (context->polygon_vertices)
     g_array_free (context->polygon_vertices, TRUE);
@@ -586,6 +590,7 @@ _cogl_context_free (CoglContext *context)
   _cogl_bitmask_destroy (&context->enable_texcoord_attributes_tmp);
   _cogl_bitmask_destroy (&context->enabled_custom_attributes);
   _cogl_bitmask_destroy (&context->enable_custom_attributes_tmp);
+  _cogl_bitmask_destroy (&context->instanced_custom_attributes);
   _cogl_bitmask_destroy (&context->changed_bits_tmp);
 
   if (context->current_modelview_entry)
@@ -597,6 +602,9 @@ _cogl_context_free (CoglContext *context)
 
   _cogl_pipeline_cache_free (context->pipeline_cache);
 
+  if (context->program_binary_cache)
+    _cogl_program_binary_cache_free (context->program_binary_cache);
+
   _cogl_sampler_cache_free (context->sampler_cache);
 
   _cogl_destroy_texture_units ();
@@ -177,6 +177,12 @@ OPT (DISABLE_FAST_READ_PIXEL,
      N_("Disable read pixel optimization"),
      N_("Disable optimization for reading 1px for simple "
         "scenes of opaque rectangles"))
+OPT (DISABLE_INSTANCING,
+     N_("Root Cause"),
+     "disable-instancing",
+     N_("Disable instanced rectangles"),
+     N_("Draw rectangles in the journal as four vertices each instead of "
+        "as one instance each"))
 OPT (CLIPPING,
      N_("Cogl Tracing"),
      "clipping",
@@ -112,6 +112,17 @@ struct _CoglDriverVtable
                                            int n_attributes,
                                            CoglDrawFlags flags);
 
+  void
+  (* framebuffer_draw_instanced_attributes) (CoglFramebuffer *framebuffer,
+                                             CoglPipeline *pipeline,
+                                             CoglVerticesMode mode,
+                                             int first_vertex,
+                                             int n_vertices,
+                                             int n_instances,
+                                             CoglAttribute **attributes,
+                                             int n_attributes,
+                                             CoglDrawFlags flags);
+
   gboolean
   (* framebuffer_read_pixels_into_bitmap) (CoglFramebuffer *framebuffer,
                                            int x,
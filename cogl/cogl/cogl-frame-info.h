@@ -141,6 +141,51 @@ cogl_frame_info_get_output (CoglFrameInfo *info);
  */
 int64_t cogl_frame_info_get_global_frame_counter (CoglFrameInfo *info);
 
+/**
+ * cogl_frame_info_get_sequence:
+ * @info: a #CoglFrameInfo object
+ *
+ * Gets the display hardware's vertical retrace counter at the time the
+ * frame was presented, or 0 if it is not known.
+ *
+ * Return value: the retrace counter value
+ */
+unsigned int cogl_frame_info_get_sequence (CoglFrameInfo *info);
+
+/**
+ * cogl_frame_info_is_hw_clock:
+ * @info: a #CoglFrameInfo object
+ *
+ * Gets whether the presentation time was taken by the display hardware
+ * or driver at the moment of presentation, on the CLOCK_MONOTONIC
+ * clock, rather than estimated afterwards.
+ *
+ * Return value: %TRUE if the presentation time comes from the hardware
+ */
+gboolean cogl_frame_info_is_hw_clock (CoglFrameInfo *info);
+
+/**
+ * cogl_frame_info_is_zero_copy:
+ * @info: a #CoglFrameInfo object
+ *
+ * Gets whether the frame was presented by scanning out a buffer
+ * directly, see cogl_onscreen_direct_scanout().
+ *
+ * Return value: %TRUE if no copy of the presented buffer was made
+ */
+gboolean cogl_frame_info_is_zero_copy (CoglFrameInfo *info);
+
+/**
+ * cogl_frame_info_is_vsync:
+ * @info: a #CoglFrameInfo object
+ *
+ * Gets whether the frame was presented in sync with the vertical
+ * retrace of the display, and thus without tearing.
+ *
+ * Return value: %TRUE if the frame was presented on vertical retrace
+ */
+gboolean cogl_frame_info_is_vsync (CoglFrameInfo *info);
+
 G_END_DECLS
 
 #endif /* __COGL_FRAME_INFO_H */
@@ -462,6 +462,21 @@ _cogl_framebuffer_draw_indexed_attributes (CoglFramebuffer *framebuffer,
                                            int n_attributes,
                                            CoglDrawFlags flags);
 
+/* Draws n_instances copies of the vertices. Attributes with a
+ * non-zero instance divisor advance once per instance instead of once
+ * per vertex. This must only be used if the context has the
+ * COGL_PRIVATE_FEATURE_INSTANCED_ARRAYS feature. */
+void
+_cogl_framebuffer_draw_instanced_attributes (CoglFramebuffer *framebuffer,
+                                             CoglPipeline *pipeline,
+                                             CoglVerticesMode mode,
+                                             int first_vertex,
+                                             int n_vertices,
+                                             int n_instances,
+                                             CoglAttribute **attributes,
+                                             int n_attributes,
+                                             CoglDrawFlags flags);
+
 gboolean
 _cogl_framebuffer_try_creating_gl_fbo (CoglContext *ctx,
                                        CoglTexture *texture,
@@ -52,6 +52,8 @@
 #include "cogl-primitives-private.h"
 #include "cogl-error-private.h"
 #include "cogl-gtype-private.h"
+#include "cogl-fence.h"
+#include "cogl-poll-private.h"
 #include "driver/gl/cogl-texture-gl-private.h"
 #include "winsys/cogl-winsys-private.h"
 
@@ -1448,6 +1450,237 @@ cogl_framebuffer_read_pixels (CoglFramebuffer *framebuffer,
   return ret;
 }
 
+struct _CoglReadPixelsClosure
+{
+  CoglFramebuffer *framebuffer;
+  CoglBitmap *bitmap;
+
+  /* If the pixels can't be read straight into @bitmap they are read
+   * into this pixel buffer instead and converted once the GPU is done
+   * with it */
+  CoglBitmap *staging;
+  gboolean flip;
+
+  /* Exactly one of these is set while the read is pending */
+  CoglFenceClosure *fence;
+  CoglClosure *idle;
+
+  CoglReadPixelsCallback callback;
+  void *user_data;
+};
+
+static void
+_cogl_read_pixels_closure_free (CoglReadPixelsClosure *closure)
+{
+  if (closure->staging)
+    cogl_object_unref (closure->staging);
+  cogl_object_unref (closure->bitmap);
+  cogl_object_unref (closure->framebuffer);
+  g_slice_free (CoglReadPixelsClosure, closure);
+}
+
+static gboolean
+_cogl_read_pixels_flip_rows (CoglBitmap *bitmap,
+                             CoglError **error)
+{
+  int rowstride = cogl_bitmap_get_rowstride (bitmap);
+  int height = cogl_bitmap_get_height (bitmap);
+  uint8_t *temprow;
+  uint8_t *pixels;
+  int y;
+
+  pixels = _cogl_bitmap_map (bitmap,
+                             COGL_BUFFER_ACCESS_READ |
+                             COGL_BUFFER_ACCESS_WRITE,
+                             0, /* hints */
+                             error);
+  if (pixels == NULL)
+    return FALSE;
+
+  temprow = g_alloca (rowstride * sizeof (uint8_t));
+
+  for (y = 0; y < height / 2; y++)
+    {
+      uint8_t *top = pixels + y * rowstride;
+      uint8_t *bottom = pixels + (height - y - 1) * rowstride;
+
+      memcpy (temprow, top, rowstride);
+      memcpy (top, bottom, rowstride);
+      memcpy (bottom, temprow, rowstride);
+    }
+
+  _cogl_bitmap_unmap (bitmap);
+
+  return TRUE;
+}
+
+static void
+_cogl_read_pixels_closure_complete (CoglReadPixelsClosure *closure)
+{
+  if (closure->staging)
+    {
+      CoglError *error = NULL;
+
+      /* The GPU has finished writing the staging buffer, so mapping it
+       * for the conversion doesn't stall */
+      if (!_cogl_bitmap_convert_into_bitmap (closure->staging,
+                                             closure->bitmap,
+                                             &error) ||
+          (closure->flip &&
+           !_cogl_read_pixels_flip_rows (closure->bitmap, &error)))
+        {
+          g_warning ("Failed to convert read back pixels: %s",
+                     error->message);
+          cogl_error_free (error);
+        }
+    }
+
+  closure->callback (closure->framebuffer,
+                     closure->bitmap,
+                     closure->user_data);
+  _cogl_read_pixels_closure_free (closure);
+}
+
+static void
+_cogl_read_pixels_fence_cb (CoglFence *fence,
+                            void *user_data)
+{
+  CoglReadPixelsClosure *closure = user_data;
+
+  /* The fence closure is freed by the caller once we return */
+  closure->fence = NULL;
+  _cogl_read_pixels_closure_complete (closure);
+}
+
+static void
+_cogl_read_pixels_idle_cb (void *user_data)
+{
+  CoglReadPixelsClosure *closure = user_data;
+
+  _cogl_closure_disconnect (closure->idle);
+  closure->idle = NULL;
+  _cogl_read_pixels_closure_complete (closure);
+}
+
+CoglReadPixelsClosure *
+cogl_framebuffer_read_pixels_into_bitmap_async (CoglFramebuffer *framebuffer,
+                                                int x,
+                                                int y,
+                                                CoglReadPixelsFlags source,
+                                                CoglBitmap *bitmap,
+                                                CoglReadPixelsCallback callback,
+                                                void *user_data,
+                                                CoglError **error)
+{
+  CoglContext *ctx;
+  CoglReadPixelsClosure *closure;
+
+  _COGL_RETURN_VAL_IF_FAIL (cogl_is_framebuffer (framebuffer), NULL);
+  _COGL_RETURN_VAL_IF_FAIL (callback != NULL, NULL);
+
+  ctx = cogl_framebuffer_get_context (framebuffer);
+
+  closure = g_slice_new0 (CoglReadPixelsClosure);
+  closure->framebuffer = cogl_object_ref (framebuffer);
+  closure->bitmap = cogl_object_ref (bitmap);
+  closure->callback = callback;
+  closure->user_data = user_data;
+
+  /* Reading into a pixel buffer only queues a copy on the GPU; it's
+   * mapping the buffer afterwards that would block, so that is what the
+   * fence lets the caller avoid. Any conversion or flip that the
+   * synchronous read would do on the CPU has to wait for the fence as
+   * well, so if @bitmap isn't already in the layout glReadPixels()
+   * produces, read into a staging pixel buffer that is. */
+  if (_cogl_has_private_feature (ctx, COGL_PRIVATE_FEATURE_PBOS))
+    {
+      CoglPixelFormat format = cogl_bitmap_get_format (bitmap);
+      CoglPixelFormat read_format;
+      GLenum gl_intformat, gl_format, gl_type;
+      int width = cogl_bitmap_get_width (bitmap);
+      gboolean any_format;
+
+      any_format =
+        _cogl_has_private_feature (ctx,
+                                   COGL_PRIVATE_FEATURE_READ_PIXELS_ANY_FORMAT);
+
+      read_format = ctx->driver_vtable->pixel_format_to_gl (ctx,
+                                                            format,
+                                                            &gl_intformat,
+                                                            &gl_format,
+                                                            &gl_type);
+      if (!any_format &&
+          (gl_format != GL_RGBA || gl_type != GL_UNSIGNED_BYTE))
+        read_format = COGL_PIXEL_FORMAT_RGBA_8888;
+
+      if (COGL_PIXEL_FORMAT_CAN_HAVE_PREMULT (read_format))
+        read_format = ((read_format & ~COGL_PREMULT_BIT) |
+                       (framebuffer->internal_format & COGL_PREMULT_BIT));
+
+      /* NB: All offscreen rendering is done upside down so there is no
+       * need to flip in this case... */
+      closure->flip =
+        (!cogl_is_offscreen (framebuffer) &&
+         (source & COGL_READ_PIXELS_NO_FLIP) == 0 &&
+         !_cogl_has_private_feature (ctx,
+                                     COGL_PRIVATE_FEATURE_MESA_PACK_INVERT));
+
+      if (read_format != format ||
+          closure->flip ||
+          !cogl_bitmap_get_buffer (bitmap) ||
+          (!any_format && cogl_bitmap_get_rowstride (bitmap) != 4 * width))
+        {
+          closure->staging =
+            cogl_bitmap_new_with_size (ctx,
+                                       width,
+                                       cogl_bitmap_get_height (bitmap),
+                                       read_format);
+          if (closure->staging && closure->flip)
+            source |= COGL_READ_PIXELS_NO_FLIP;
+        }
+    }
+
+  if (!_cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                  x, y, source,
+                                                  closure->staging ?
+                                                  closure->staging : bitmap,
+                                                  error))
+    {
+      _cogl_read_pixels_closure_free (closure);
+      return NULL;
+    }
+
+  if (closure->staging || cogl_bitmap_get_buffer (bitmap))
+    closure->fence =
+      cogl_framebuffer_add_fence_callback (framebuffer,
+                                           _cogl_read_pixels_fence_cb,
+                                           closure);
+
+  /* Either the read was synchronous anyway, or there is no way to tell
+   * when the GPU is done with it; report back from the main loop. Any
+   * conversion of the staging buffer then stalls in the callback. */
+  if (!closure->fence)
+    closure->idle =
+      _cogl_poll_renderer_add_idle (ctx->display->renderer,
+                                    _cogl_read_pixels_idle_cb,
+                                    closure,
+                                    NULL);
+
+  return closure;
+}
+
+void
+cogl_framebuffer_cancel_read_pixels (CoglReadPixelsClosure *closure)
+{
+  if (closure->fence)
+    cogl_framebuffer_cancel_fence_callback (closure->framebuffer,
+                                            closure->fence);
+  else if (closure->idle)
+    _cogl_closure_disconnect (closure->idle);
+
+  _cogl_read_pixels_closure_free (closure);
+}
+
 void
 _cogl_blit_framebuffer (CoglFramebuffer *src,
                         CoglFramebuffer *dest,
@@ -2343,6 +2576,32 @@ _cogl_framebuffer_draw_indexed_attributes (CoglFramebuffer *framebuffer,
     }
 }
 
+void
+_cogl_framebuffer_draw_instanced_attributes (CoglFramebuffer *framebuffer,
+                                             CoglPipeline *pipeline,
+                                             CoglVerticesMode mode,
+                                             int first_vertex,
+                                             int n_vertices,
+                                             int n_instances,
+                                             CoglAttribute **attributes,
+                                             int n_attributes,
+                                             CoglDrawFlags flags)
+{
+  CoglContext *ctx = framebuffer->context;
+
+  /* The wireframe debug mode can't expand instances into lines so the
+   * journal doesn't use instancing when it is enabled */
+  ctx->driver_vtable->framebuffer_draw_instanced_attributes (framebuffer,
+                                                             pipeline,
+                                                             mode,
+                                                             first_vertex,
+                                                             n_vertices,
+                                                             n_instances,
+                                                             attributes,
+                                                             n_attributes,
+                                                             flags);
+}
+
 /* XXX: deprecated */
 void
 cogl_framebuffer_draw_indexed_attributes (CoglFramebuffer *framebuffer,
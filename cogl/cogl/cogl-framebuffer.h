@@ -1756,6 +1756,93 @@ cogl_framebuffer_read_pixels_into_bitmap (CoglFramebuffer *framebuffer,
                                           CoglReadPixelsFlags source,
                                           CoglBitmap *bitmap);
 
+/**
+ * CoglReadPixelsClosure:
+ *
+ * An opaque type representing a pending asynchronous read started with
+ * cogl_framebuffer_read_pixels_into_bitmap_async().
+ *
+ * Stability: unstable
+ */
+typedef struct _CoglReadPixelsClosure CoglReadPixelsClosure;
+
+/**
+ * CoglReadPixelsCallback:
+ * @framebuffer: The #CoglFramebuffer that was read from
+ * @bitmap: The #CoglBitmap that now holds the pixels
+ * @user_data: The private data passed to
+ *   cogl_framebuffer_read_pixels_into_bitmap_async()
+ *
+ * The callback prototype used with
+ * cogl_framebuffer_read_pixels_into_bitmap_async() for notification
+ * that the GPU has finished writing the pixels into the bitmap.
+ *
+ * Stability: unstable
+ */
+typedef void (* CoglReadPixelsCallback) (CoglFramebuffer *framebuffer,
+                                         CoglBitmap *bitmap,
+                                         void *user_data);
+
+/**
+ * cogl_framebuffer_read_pixels_into_bitmap_async:
+ * @framebuffer: A #CoglFramebuffer
+ * @x: The x position to read from
+ * @y: The y position to read from
+ * @source: Identifies which auxillary buffer you want to read
+ *          (only COGL_READ_PIXELS_COLOR_BUFFER supported currently)
+ * @bitmap: The bitmap to store the results in.
+ * @callback: (scope notified): A #CoglReadPixelsCallback to be called
+ *            once the pixels are available
+ * @user_data: (closure): Private data that will be passed to the callback
+ *
+ * Like cogl_framebuffer_read_pixels_into_bitmap(), but without waiting
+ * for the GPU to finish rendering. The GPU copies the pixels into a
+ * pixel buffer on its own time and @callback is called once that copy
+ * has completed. If @bitmap is itself backed by a pixel buffer in the
+ * format the driver reads in, for instance because it was created with
+ * cogl_bitmap_new_with_size(), the pixels are copied straight into it;
+ * otherwise they are copied into a temporary buffer and any format
+ * conversion, premultiplication or vertical flip is done just before
+ * @callback is called, when it no longer has to wait for the GPU.
+ *
+ * If the driver doesn't support pixel buffers the read happens
+ * synchronously. If it can't tell when the copy has completed, the
+ * conversion stalls until it has. In both cases @callback is called
+ * from the main loop. Either way, @callback is never called before
+ * this function returns.
+ *
+ * The framebuffer and the bitmap are kept alive until the callback has
+ * been called or the read has been cancelled.
+ *
+ * Return value: (transfer none): A #CoglReadPixelsClosure that can be
+ *   passed to cogl_framebuffer_cancel_read_pixels(), or %NULL if the
+ *   read couldn't be started. It is freed automatically after
+ *   @callback returns.
+ * Stability: unstable
+ */
+CoglReadPixelsClosure *
+cogl_framebuffer_read_pixels_into_bitmap_async (CoglFramebuffer *framebuffer,
+                                                int x,
+                                                int y,
+                                                CoglReadPixelsFlags source,
+                                                CoglBitmap *bitmap,
+                                                CoglReadPixelsCallback callback,
+                                                void *user_data,
+                                                CoglError **error);
+
+/**
+ * cogl_framebuffer_cancel_read_pixels:
+ * @closure: The #CoglReadPixelsClosure returned from
+ *           cogl_framebuffer_read_pixels_into_bitmap_async()
+ *
+ * Cancels a pending asynchronous read; its callback will not be called.
+ * The contents of the bitmap are undefined afterwards.
+ *
+ * Stability: unstable
+ */
+void
+cogl_framebuffer_cancel_read_pixels (CoglReadPixelsClosure *closure);
+
 /**
  * cogl_framebuffer_read_pixels:
  * @framebuffer: A #CoglFramebuffer
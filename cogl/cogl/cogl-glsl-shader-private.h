@@ -36,6 +36,11 @@ _cogl_glsl_shader_set_source_with_boilerplate (CoglContext *ctx,
                                                CoglPipeline *pipeline,
                                                GLsizei count_in,
                                                const char **strings_in,
-                                               const GLint *lengths_in);
+                                               const GLint *lengths_in,
+                                               char **source_hash_out);
+
+void
+_cogl_glsl_shader_compile (CoglContext *ctx,
+                           GLuint shader_gl_handle);
 
 #endif /* _COGL_GLSL_SHADER_PRIVATE_H_ */
@@ -80,7 +80,8 @@ _cogl_glsl_shader_set_source_with_boilerplate (CoglContext *ctx,
                                                CoglPipeline *pipeline,
                                                GLsizei count_in,
                                                const char **strings_in,
-                                               const GLint *lengths_in)
+                                               const GLint *lengths_in,
+                                               char **source_hash_out)
 {
   const char *vertex_boilerplate;
   const char *fragment_boilerplate;
@@ -191,8 +192,46 @@ _cogl_glsl_shader_set_source_with_boilerplate (CoglContext *ctx,
       g_string_free (buf, TRUE);
     }
 
+  /* The hash identifies the complete source, including the
+     boilerplate, for looking up cached program binaries */
+  if (source_hash_out)
+    {
+      GChecksum *checksum = g_checksum_new (G_CHECKSUM_SHA1);
+      int i;
+
+      for (i = 0; i < count; i++)
+        g_checksum_update (checksum,
+                           (const guchar *) strings[i],
+                           lengths[i]);
+
+      *source_hash_out = g_strdup (g_checksum_get_string (checksum));
+      g_checksum_free (checksum);
+    }
+
   GE( ctx, glShaderSource (shader_gl_handle, count,
                            (const char **) strings, lengths) );
 
   g_free (version_string);
 }
+
+void
+_cogl_glsl_shader_compile (CoglContext *ctx,
+                           GLuint shader_gl_handle)
+{
+  GLint compile_status;
+
+  GE( ctx, glCompileShader (shader_gl_handle) );
+  GE( ctx, glGetShaderiv (shader_gl_handle, GL_COMPILE_STATUS,
+                          &compile_status) );
+
+  if (!compile_status)
+    {
+      GLint len = 0;
+      char *shader_log;
+
+      GE( ctx, glGetShaderiv (shader_gl_handle, GL_INFO_LOG_LENGTH, &len) );
+      shader_log = g_alloca (len);
+      GE( ctx, glGetShaderInfoLog (shader_gl_handle, len, &len, shader_log) );
+      g_warning ("Shader compilation failed:\n%s", shader_log);
+    }
+}
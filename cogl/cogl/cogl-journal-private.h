@@ -37,6 +37,17 @@
 #include "cogl-fence-private.h"
 
 #define COGL_JOURNAL_VBO_POOL_SIZE 8
+#define COGL_JOURNAL_STREAM_BUFFER_SIZE (4 * 1024 * 1024)
+
+/* A range of the context's journal stream buffer that was used by a
+   flush along with the fence that signals when the GPU has finished
+   reading it */
+typedef struct _CoglJournalStreamRegion
+{
+  size_t start;
+  size_t end;
+  void *fence;
+} CoglJournalStreamRegion;
 
 typedef struct _CoglJournal
 {
@@ -64,6 +75,10 @@ typedef struct _CoglJournal
      order */
   unsigned int next_vbo_in_pool;
 
+  /* The per-vertex corner positions shared by all of the instances
+     when drawing instanced rectangles */
+  CoglAttribute *instance_corners;
+
   int fast_read_pixel_count;
 
   CoglList pending_fences;
@@ -81,6 +96,9 @@ typedef struct _CoglJournalEntry
   /* Offset into ctx->logged_vertices */
   size_t                   array_offset;
   int                      n_layers;
+  /* Whether the entry is uploaded as a single instance record instead
+     of four vertices. This is decided at the start of each flush */
+  gboolean                 instanced;
 } CoglJournalEntry;
 
 CoglJournal *
@@ -101,6 +119,9 @@ _cogl_journal_flush (CoglJournal *journal);
 void
 _cogl_journal_discard (CoglJournal *journal);
 
+void
+_cogl_journal_free_stream_buffer (CoglContext *ctx);
+
 gboolean
 _cogl_journal_all_entries_within_bounds (CoglJournal *journal,
                                          float clip_x0,
@@ -35,6 +35,7 @@
 #include "cogl-journal-private.h"
 #include "cogl-texture-private.h"
 #include "cogl-pipeline-private.h"
+#include "cogl-pipeline-state-private.h"
 #include "cogl-framebuffer-private.h"
 #include "cogl-profile.h"
 #include "cogl-attribute-private.h"
@@ -42,12 +43,20 @@
 #include "cogl-private.h"
 #include "cogl1-context.h"
 #include "driver/gl/cogl-pipeline-opengl-private.h"
+#include "driver/gl/cogl-buffer-gl-private.h"
 #include "deprecated/cogl-vertex-buffer-private.h"
 
 #include <string.h>
 #include <gmodule.h>
 #include <math.h>
 
+#if defined(__GNUC__) && \
+  (defined(__SSE__) || defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define COGL_JOURNAL_USE_VECTOR_TRANSFORM
+/* Four floats that the compiler keeps in a single SSE or NEON register */
+typedef float CoglJournalVec4 __attribute__ ((vector_size (16)));
+#endif
+
 /* XXX NB:
  * The data logged in logged_vertices is formatted as follows:
  *
@@ -91,11 +100,54 @@
   (POS_STRIDE + COLOR_STRIDE + \
    TEX_STRIDE * (N_LAYERS < MIN_LAYER_PADING ? MIN_LAYER_PADING : N_LAYERS))
 
+/* XXX NB:
+ * When the GPU supports instanced arrays, quads whose pipeline has no
+ * vertex snippets are instead uploaded as one instance record each:
+ *    3 GLfloats for the transformed top left corner
+ *    4 RGBA GLubytes,
+ *    3 GLfloats for the transformed vector from the left to the right edge
+ *    3 GLfloats for the transformed vector from the top to the bottom edge
+ *    4 GLfloats per layer for the top left and bottom right tex coords
+ *
+ * These are expanded into four vertices by a vertex snippet using a
+ * shared attribute with the corners of a unit square. An instance
+ * record is always smaller than four vertices so the size of the
+ * vertex array reserved when logging is enough for either.
+ */
+#define INSTANCE_ORIGIN_OFFSET 0 /* in 32bit words */
+#define INSTANCE_COLOR_OFFSET  3
+#define INSTANCE_X_EDGE_OFFSET 4
+#define INSTANCE_Y_EDGE_OFFSET 7
+#define INSTANCE_TEX_OFFSET    10
+#define INSTANCE_TEX_STRIDE    4
+#define GET_JOURNAL_INSTANCE_STRIDE_FOR_N_LAYERS(N_LAYERS) \
+  (INSTANCE_TEX_OFFSET + INSTANCE_TEX_STRIDE * (N_LAYERS))
+/* An instanced draw uses 5 vertex attributes plus one per layer. GL 3.3
+   and GLES 3 guarantee 16 but rectangles with more than a few layers
+   are rare so there's little point in generating more variants */
+#define COGL_JOURNAL_MAX_INSTANCED_LAYERS 4
+
 /* If a batch is longer than this threshold then we'll assume it's not
    worth doing software clipping and it's cheaper to program the GPU
    to do the clip */
 #define COGL_JOURNAL_HARDWARE_CLIP_THRESHOLD 8
 
+/* The columns of a modelview matrix that are needed to transform the
+   2D positions logged in the journal. The z and w input components are
+   always 0 and 1 so the third column never contributes */
+typedef struct _CoglJournalTransform
+{
+#ifdef COGL_JOURNAL_USE_VECTOR_TRANSFORM
+  CoglJournalVec4 x_axis;
+  CoglJournalVec4 y_axis;
+  CoglJournalVec4 translation;
+#else
+  float x_axis[3];
+  float y_axis[3];
+  float translation[3];
+#endif
+} CoglJournalTransform;
+
 typedef struct _CoglJournalFlushState
 {
   CoglContext *ctx;
@@ -126,6 +178,16 @@ static void _cogl_journal_free (CoglJournal *journal);
 
 COGL_OBJECT_INTERNAL_DEFINE (Journal, journal);
 
+#ifdef GL_ARB_sync
+static void
+free_stream_region (CoglContext *ctx,
+                    CoglJournalStreamRegion *region)
+{
+  ctx->glDeleteSync (region->fence);
+  g_slice_free (CoglJournalStreamRegion, region);
+}
+#endif
+
 static void
 _cogl_journal_free (CoglJournal *journal)
 {
@@ -140,6 +202,9 @@ _cogl_journal_free (CoglJournal *journal)
     if (journal->vbo_pool[i])
       cogl_object_unref (journal->vbo_pool[i]);
 
+  if (journal->instance_corners)
+    cogl_object_unref (journal->instance_corners);
+
   g_slice_free (CoglJournal, journal);
 }
 
@@ -164,6 +229,27 @@ _cogl_journal_new (CoglFramebuffer *framebuffer)
   return _cogl_journal_object_new (journal);
 }
 
+void
+_cogl_journal_free_stream_buffer (CoglContext *ctx)
+{
+  if (ctx->journal_stream_buffer == NULL)
+    return;
+
+#ifdef GL_ARB_sync
+  {
+    CoglJournalStreamRegion *region;
+
+    while ((region = g_queue_pop_head (&ctx->journal_stream_regions)))
+      free_stream_region (ctx, region);
+  }
+#endif
+
+  /* Deleting the buffer implicitly unmaps it */
+  cogl_object_unref (ctx->journal_stream_buffer);
+  ctx->journal_stream_buffer = NULL;
+  ctx->journal_stream_data = NULL;
+}
+
 static void
 _cogl_journal_dump_logged_quad (uint8_t *data, int n_layers)
 {
@@ -577,6 +663,286 @@ compare_entry_layer_numbers (CoglJournalEntry *entry0, CoglJournalEntry *entry1)
     return FALSE;
 }
 
+static CoglUserDataKey instanced_pipeline_key;
+
+static void
+instanced_pipeline_destroyed_cb (CoglPipeline *weak_pipeline,
+                                 void *user_data)
+{
+  CoglPipeline *original_pipeline = user_data;
+
+  cogl_object_set_user_data (COGL_OBJECT (original_pipeline),
+                             &instanced_pipeline_key, NULL, NULL);
+
+  cogl_object_unref (weak_pipeline);
+}
+
+static CoglSnippet *
+get_instanced_snippet (int n_layers)
+{
+  /* The snippets are cached so that pipelines with the same number of
+   * layers can share programs from the pipeline cache */
+  static CoglSnippet *snippets[COGL_JOURNAL_MAX_INSTANCED_LAYERS + 1];
+
+  if (snippets[n_layers] == NULL)
+    {
+      GString *declarations = g_string_new (NULL);
+      GString *source = g_string_new (NULL);
+      int i;
+
+      g_string_append (declarations,
+                       "attribute vec2 _cogl_journal_corner;\n"
+                       "attribute vec3 _cogl_journal_origin;\n"
+                       "attribute vec3 _cogl_journal_x_edge;\n"
+                       "attribute vec3 _cogl_journal_y_edge;\n");
+      g_string_append (source,
+                       "  cogl_position_out =\n"
+                       "    cogl_modelview_projection_matrix *\n"
+                       "    vec4 (_cogl_journal_origin +\n"
+                       "          _cogl_journal_corner.x *"
+                       " _cogl_journal_x_edge +\n"
+                       "          _cogl_journal_corner.y *"
+                       " _cogl_journal_y_edge,\n"
+                       "          1.0);\n"
+                       "  cogl_color_out = cogl_color_in;\n");
+
+      for (i = 0; i < n_layers; i++)
+        {
+          g_string_append_printf (declarations,
+                                  "attribute vec4 _cogl_journal_tex_rect%i;\n",
+                                  i);
+          g_string_append_printf (source,
+                                  "  cogl_tex_coord%i_out =\n"
+                                  "    cogl_transform_layer%i "
+                                  "(cogl_texture_matrix%i,\n"
+                                  "      vec4 (mix (_cogl_journal_tex_rect%i.xy,\n"
+                                  "                 _cogl_journal_tex_rect%i.zw,\n"
+                                  "                 _cogl_journal_corner),\n"
+                                  "            0.0, 1.0));\n",
+                                  i, i, i, i, i);
+        }
+
+      snippets[n_layers] = cogl_snippet_new (COGL_SNIPPET_HOOK_VERTEX,
+                                             declarations->str,
+                                             NULL);
+      cogl_snippet_set_replace (snippets[n_layers], source->str);
+
+      g_string_free (declarations, TRUE);
+      g_string_free (source, TRUE);
+    }
+
+  return snippets[n_layers];
+}
+
+/* Returns a weak copy of the pipeline whose vertex processing expands
+ * the journal's instance records into rectangles. The copy is cached
+ * on the pipeline until the pipeline changes */
+static CoglPipeline *
+get_instanced_pipeline (CoglPipeline *pipeline,
+                        int n_layers)
+{
+  CoglPipeline *instanced_pipeline =
+    cogl_object_get_user_data (COGL_OBJECT (pipeline),
+                               &instanced_pipeline_key);
+
+  if (!instanced_pipeline)
+    {
+      instanced_pipeline =
+        _cogl_pipeline_weak_copy (pipeline,
+                                  instanced_pipeline_destroyed_cb,
+                                  pipeline);
+
+      cogl_object_set_user_data (COGL_OBJECT (pipeline),
+                                 &instanced_pipeline_key, instanced_pipeline,
+                                 NULL);
+
+      cogl_pipeline_add_snippet (instanced_pipeline,
+                                 get_instanced_snippet (n_layers));
+    }
+
+  return instanced_pipeline;
+}
+
+static CoglAttribute *
+get_instance_corners (CoglJournal *journal,
+                      CoglContext *ctx)
+{
+  if (journal->instance_corners == NULL)
+    {
+      /* The corners are in the same order as the four vertices of a
+       * non-instanced quad so that the winding is the same */
+      static const float corners[] = { 0, 0, 0, 1, 1, 1, 1, 0 };
+      CoglAttributeBuffer *buffer =
+        cogl_attribute_buffer_new (ctx, sizeof (corners), corners);
+
+      journal->instance_corners =
+        cogl_attribute_new (buffer,
+                            "_cogl_journal_corner",
+                            sizeof (float) * 2,
+                            0,
+                            2,
+                            COGL_ATTRIBUTE_TYPE_FLOAT);
+
+      cogl_object_unref (buffer);
+    }
+
+  return journal->instance_corners;
+}
+
+static CoglAttribute *
+create_instance_attribute (CoglJournalFlushState *state,
+                           const char *name,
+                           size_t offset,
+                           int n_components,
+                           CoglAttributeType type)
+{
+  CoglAttribute *attribute =
+    cogl_attribute_new (state->attribute_buffer,
+                        name,
+                        state->stride,
+                        offset,
+                        n_components,
+                        type);
+
+  _cogl_attribute_set_instance_divisor (attribute, 1);
+
+  return attribute;
+}
+
+/* At this point we have a run of instanced quads with compatible
+ * pipelines which can be drawn with a single draw call */
+static void
+_cogl_journal_flush_instanced_pipeline_and_entries (
+                                          CoglJournalEntry *batch_start,
+                                          int               batch_len,
+                                          void             *data)
+{
+  CoglJournalFlushState *state = data;
+  CoglContext *ctx = state->ctx;
+  CoglFramebuffer *framebuffer = state->journal->framebuffer;
+  CoglAttribute *attributes[5 + COGL_JOURNAL_MAX_INSTANCED_LAYERS];
+  int n_attributes = 0;
+  size_t offset;
+  int i;
+  CoglDrawFlags draw_flags = (COGL_DRAW_SKIP_JOURNAL_FLUSH |
+                              COGL_DRAW_SKIP_PIPELINE_VALIDATION |
+                              COGL_DRAW_SKIP_FRAMEBUFFER_FLUSH |
+                              COGL_DRAW_SKIP_LEGACY_STATE);
+  static const char *tex_rect_names[] = {
+      "_cogl_journal_tex_rect0",
+      "_cogl_journal_tex_rect1",
+      "_cogl_journal_tex_rect2",
+      "_cogl_journal_tex_rect3"
+  };
+  COGL_STATIC_TIMER (time_flush_instanced_pipeline_entries,
+                     "flush: instances+pipeline+entries", /* parent */
+                     "flush: instanced pipeline+entries",
+                     "The time spent flushing instanced pipeline + entries",
+                     0 /* no application private data */);
+
+  G_STATIC_ASSERT (G_N_ELEMENTS (tex_rect_names) ==
+                   COGL_JOURNAL_MAX_INSTANCED_LAYERS);
+
+  COGL_TIMER_START (_cogl_uprof_context,
+                    time_flush_instanced_pipeline_entries);
+
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_BATCHING)))
+    g_print ("BATCHING:    instanced pipeline batch len = %d\n", batch_len);
+
+  state->pipeline = get_instanced_pipeline (batch_start->pipeline,
+                                            batch_start->n_layers);
+
+  /* There's no base instance for glDrawArraysInstanced so the
+     attributes are created with the offset of the first instance */
+  offset = state->array_offset + state->current_vertex * state->stride;
+
+  attributes[n_attributes++] = get_instance_corners (state->journal, ctx);
+  attributes[n_attributes++] =
+    create_instance_attribute (state, "cogl_color_in",
+                               offset + INSTANCE_COLOR_OFFSET * 4,
+                               4, COGL_ATTRIBUTE_TYPE_UNSIGNED_BYTE);
+  attributes[n_attributes++] =
+    create_instance_attribute (state, "_cogl_journal_origin",
+                               offset + INSTANCE_ORIGIN_OFFSET * 4,
+                               3, COGL_ATTRIBUTE_TYPE_FLOAT);
+  attributes[n_attributes++] =
+    create_instance_attribute (state, "_cogl_journal_x_edge",
+                               offset + INSTANCE_X_EDGE_OFFSET * 4,
+                               3, COGL_ATTRIBUTE_TYPE_FLOAT);
+  attributes[n_attributes++] =
+    create_instance_attribute (state, "_cogl_journal_y_edge",
+                               offset + INSTANCE_Y_EDGE_OFFSET * 4,
+                               3, COGL_ATTRIBUTE_TYPE_FLOAT);
+
+  for (i = 0; i < batch_start->n_layers; i++)
+    attributes[n_attributes++] =
+      create_instance_attribute (state, tex_rect_names[i],
+                                 offset +
+                                 (INSTANCE_TEX_OFFSET +
+                                  INSTANCE_TEX_STRIDE * i) * 4,
+                                 4, COGL_ATTRIBUTE_TYPE_FLOAT);
+
+  if (!_cogl_pipeline_get_real_blend_enabled (state->pipeline))
+    draw_flags |= COGL_DRAW_COLOR_ATTRIBUTE_IS_OPAQUE;
+
+  _cogl_framebuffer_draw_instanced_attributes (framebuffer,
+                                               state->pipeline,
+                                               COGL_VERTICES_MODE_TRIANGLE_FAN,
+                                               0, 4, /* the corners */
+                                               batch_len,
+                                               attributes,
+                                               n_attributes,
+                                               draw_flags);
+
+  /* The first attribute is the shared corners */
+  for (i = 1; i < n_attributes; i++)
+    cogl_object_unref (attributes[i]);
+
+  state->current_vertex += batch_len;
+
+  COGL_TIMER_STOP (_cogl_uprof_context,
+                   time_flush_instanced_pipeline_entries);
+}
+
+/* At this point we know the batch is made of instanced quads with the
+ * same number of layers so they share the same instance stride */
+static void
+_cogl_journal_flush_instances_and_entries (CoglJournalEntry *batch_start,
+                                           int               batch_len,
+                                           void             *data)
+{
+  CoglJournalFlushState *state = data;
+  COGL_STATIC_TIMER (time_flush_instances_entries,
+                     "flush: clip+vbo+texcoords+pipeline+entries", /* parent */
+                     "flush: instances+pipeline+entries",
+                     "The time spent flushing instance offsets + "
+                     "pipeline + entries",
+                     0 /* no application private data */);
+
+  COGL_TIMER_START (_cogl_uprof_context, time_flush_instances_entries);
+
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_BATCHING)))
+    g_print ("BATCHING:   instance offset batch len = %d\n", batch_len);
+
+  state->stride =
+    GET_JOURNAL_INSTANCE_STRIDE_FOR_N_LAYERS (batch_start->n_layers) *
+    sizeof (float);
+
+  /* While flushing instances current_vertex counts instances */
+  state->current_vertex = 0;
+
+  batch_and_call (batch_start,
+                  batch_len,
+                  compare_entry_pipelines,
+                  _cogl_journal_flush_instanced_pipeline_and_entries,
+                  data);
+
+  /* progress forward through the VBO containing all our instances */
+  state->array_offset += state->stride * batch_len;
+
+  COGL_TIMER_STOP (_cogl_uprof_context, time_flush_instances_entries);
+}
+
 /* At this point we know the stride has changed from the previous batch
  * of journal entries */
 static void
@@ -596,6 +962,14 @@ _cogl_journal_flush_vbo_offsets_and_entries (CoglJournalEntry *batch_start,
                      "pipeline + entries",
                      0 /* no application private data */);
 
+  if (batch_start->instanced)
+    {
+      _cogl_journal_flush_instances_and_entries (batch_start,
+                                                 batch_len,
+                                                 data);
+      return;
+    }
+
   COGL_TIMER_START (_cogl_uprof_context,
                     time_flush_vbo_texcoord_pipeline_entries);
 
@@ -691,9 +1065,13 @@ compare_entry_strides (CoglJournalEntry *entry0, CoglJournalEntry *entry1)
    * whenever the stride changes. */
   /* TODO: We should be padding the n_layers == 1 case as if it were
    * n_layers == 2 so we can reduce the need to split batches. */
-  if (entry0->n_layers == entry1->n_layers ||
-      (entry0->n_layers <= MIN_LAYER_PADING &&
-       entry1->n_layers <= MIN_LAYER_PADING))
+  if (entry0->instanced != entry1->instanced)
+    return FALSE;
+  else if (entry0->instanced)
+    return entry0->n_layers == entry1->n_layers;
+  else if (entry0->n_layers == entry1->n_layers ||
+           (entry0->n_layers <= MIN_LAYER_PADING &&
+            entry1->n_layers <= MIN_LAYER_PADING))
     return TRUE;
   else
     return FALSE;
@@ -1080,31 +1458,330 @@ create_attribute_buffer (CoglJournal *journal,
   return cogl_object_ref (vbo);
 }
 
+#ifdef GL_ARB_sync
+
+/* Releases the regions of the stream buffer which overlap the given
+ * range, waiting for the GPU to finish reading them if necessary */
+static void
+retire_stream_regions (CoglContext *ctx,
+                       size_t start,
+                       size_t end)
+{
+  GQueue *regions = &ctx->journal_stream_regions;
+  CoglJournalStreamRegion *region, *last_overlap = NULL;
+  GList *l;
+  COGL_STATIC_COUNTER (journal_stream_wait_counter,
+                       "journal stream buffer wait counter",
+                       "Increments each time a journal flush has to wait "
+                       "for the GPU before reusing the stream buffer",
+                       0 /* no application private data */);
+  COGL_STATIC_TIMER (stream_wait_timer,
+                     "Journal Flush", /* parent */
+                     "flush: stream buffer wait",
+                     "The time spent waiting for the GPU to release part "
+                     "of the journal stream buffer",
+                     0 /* no application private data */);
+
+  /* Drop the regions which the GPU has already finished with so that
+     the queue doesn't keep growing when the flushes are small */
+  while ((region = g_queue_peek_head (regions)))
+    {
+      GLenum status = ctx->glClientWaitSync (region->fence, 0, 0);
+
+      if (status != GL_ALREADY_SIGNALED &&
+          status != GL_CONDITION_SATISFIED)
+        break;
+
+      g_queue_pop_head (regions);
+      free_stream_region (ctx, region);
+    }
+
+  for (l = regions->head; l; l = l->next)
+    {
+      region = l->data;
+
+      if (region->start < end && start < region->end)
+        last_overlap = region;
+    }
+
+  if (last_overlap == NULL)
+    return;
+
+  COGL_COUNTER_INC (_cogl_uprof_context, journal_stream_wait_counter);
+  COGL_TIMER_START (_cogl_uprof_context, stream_wait_timer);
+
+  /* The fences are signalled in the order they were submitted so
+     waiting for the newest overlapping region also retires all of the
+     regions before it */
+  while (ctx->glClientWaitSync (last_overlap->fence,
+                                GL_SYNC_FLUSH_COMMANDS_BIT,
+                                G_GUINT64_CONSTANT (1000000000)) ==
+         GL_TIMEOUT_EXPIRED)
+    ;
+
+  COGL_TIMER_STOP (_cogl_uprof_context, stream_wait_timer);
+
+  do
+    {
+      region = g_queue_pop_head (regions);
+      free_stream_region (ctx, region);
+    }
+  while (region != last_overlap);
+}
+
+/* Reserves n_bytes of the context's persistently mapped stream buffer
+ * which is shared by all of the journals. Returns NULL if the stream
+ * buffer can't be used, in which case the caller should fall back to
+ * the journal's VBO pool. The stream buffer is only mapped for writing,
+ * so it is not used while the journal is being dumped */
+static CoglAttributeBuffer *
+map_stream_region (CoglContext *ctx,
+                   size_t n_bytes,
+                   size_t *offset,
+                   float **data)
+{
+  size_t start;
+
+  if (ctx->journal_stream_failed ||
+      G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_JOURNAL)) ||
+      n_bytes > COGL_JOURNAL_STREAM_BUFFER_SIZE ||
+      !_cogl_has_private_feature (ctx, COGL_PRIVATE_FEATURE_BUFFER_STORAGE))
+    return NULL;
+
+  if (ctx->journal_stream_buffer == NULL)
+    {
+      CoglAttributeBuffer *stream_buffer;
+      CoglError *ignore_error = NULL;
+
+      stream_buffer =
+        cogl_attribute_buffer_new_with_size (ctx,
+                                             COGL_JOURNAL_STREAM_BUFFER_SIZE);
+      ctx->journal_stream_data =
+        _cogl_buffer_gl_map_persistent (COGL_BUFFER (stream_buffer),
+                                        &ignore_error);
+
+      if (ctx->journal_stream_data == NULL)
+        {
+          if (ignore_error)
+            cogl_error_free (ignore_error);
+          cogl_object_unref (stream_buffer);
+          ctx->journal_stream_failed = TRUE;
+          return NULL;
+        }
+
+      ctx->journal_stream_buffer = stream_buffer;
+    }
+
+  /* Keep each flush's vertices 16-byte aligned and wrap around to the
+     start of the buffer if they won't fit in the remaining space */
+  start = (ctx->journal_stream_offset + 15) & ~(size_t) 15;
+  if (start + n_bytes > COGL_JOURNAL_STREAM_BUFFER_SIZE)
+    start = 0;
+
+  retire_stream_regions (ctx, start, start + n_bytes);
+
+  ctx->journal_stream_offset = start + n_bytes;
+
+  *offset = start;
+  *data = (float *) (ctx->journal_stream_data + start);
+
+  return cogl_object_ref (ctx->journal_stream_buffer);
+}
+
+/* Called once the draw calls reading a region of the stream buffer
+ * have been submitted so that the region won't be reused until the
+ * GPU has finished with it. The region is passed explicitly because
+ * another journal may have streamed its own vertices in the meantime
+ * if flushing this one caused it to be flushed */
+static void
+fence_stream_region (CoglContext *ctx,
+                     size_t start,
+                     size_t n_bytes)
+{
+  CoglJournalStreamRegion *region;
+  GLsync fence;
+
+  fence = ctx->glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+  if (fence == NULL)
+    {
+      /* Without a fence there's no way to know when the region is free
+         again so stop using the stream buffer altogether */
+      ctx->glFinish ();
+      ctx->journal_stream_failed = TRUE;
+      return;
+    }
+
+  region = g_slice_new (CoglJournalStreamRegion);
+  region->start = start;
+  region->end = start + n_bytes;
+  region->fence = fence;
+
+  g_queue_push_tail (&ctx->journal_stream_regions, region);
+}
+
+#endif /* GL_ARB_sync */
+
+static void
+init_transform (CoglJournalTransform *transform,
+                const CoglMatrix *matrix)
+{
+#ifdef COGL_JOURNAL_USE_VECTOR_TRANSFORM
+  transform->x_axis =
+    (CoglJournalVec4) { matrix->xx, matrix->yx, matrix->zx, 0.0f };
+  transform->y_axis =
+    (CoglJournalVec4) { matrix->xy, matrix->yy, matrix->zy, 0.0f };
+  transform->translation =
+    (CoglJournalVec4) { matrix->xw, matrix->yw, matrix->zw, 0.0f };
+#else
+  transform->x_axis[0] = matrix->xx;
+  transform->x_axis[1] = matrix->yx;
+  transform->x_axis[2] = matrix->zx;
+  transform->y_axis[0] = matrix->xy;
+  transform->y_axis[1] = matrix->yy;
+  transform->y_axis[2] = matrix->zy;
+  transform->translation[0] = matrix->xw;
+  transform->translation[1] = matrix->yw;
+  transform->translation[2] = matrix->zw;
+#endif
+}
+
+/* Writes the transformed positions of the four corners of the
+ * rectangle (x0, y0) (x1, y1). Each corner is the sum of a term
+ * depending only on x and a term depending only on y so the corners
+ * can share them instead of doing a full matrix multiply each */
+static inline void
+transform_quad (const CoglJournalTransform *transform,
+                float x0,
+                float y0,
+                float x1,
+                float y1,
+                float *vout,
+                size_t vb_stride)
+{
+#ifdef COGL_JOURNAL_USE_VECTOR_TRANSFORM
+  CoglJournalVec4 x0_term = transform->x_axis * x0;
+  CoglJournalVec4 x1_term = transform->x_axis * x1;
+  CoglJournalVec4 y0_term = transform->y_axis * y0 + transform->translation;
+  CoglJournalVec4 y1_term = transform->y_axis * y1 + transform->translation;
+  CoglJournalVec4 corner;
+
+  /* Each store also writes a fourth float over the start of the
+     vertex's color so the color has to be written afterwards */
+  corner = x0_term + y0_term;
+  memcpy (vout, &corner, sizeof (corner));
+  corner = x0_term + y1_term;
+  memcpy (vout + vb_stride, &corner, sizeof (corner));
+  corner = x1_term + y1_term;
+  memcpy (vout + vb_stride * 2, &corner, sizeof (corner));
+  corner = x1_term + y0_term;
+  memcpy (vout + vb_stride * 3, &corner, sizeof (corner));
+#else
+  int i;
+
+  for (i = 0; i < 3; i++)
+    {
+      float x0_term = transform->x_axis[i] * x0;
+      float x1_term = transform->x_axis[i] * x1;
+      float y0_term = transform->y_axis[i] * y0 + transform->translation[i];
+      float y1_term = transform->y_axis[i] * y1 + transform->translation[i];
+
+      vout[i] = x0_term + y0_term;
+      vout[vb_stride + i] = x0_term + y1_term;
+      vout[vb_stride * 2 + i] = x1_term + y1_term;
+      vout[vb_stride * 3 + i] = x1_term + y0_term;
+    }
+#endif
+}
+
+/* Writes the instance record fields describing the transformed
+ * rectangle (x0, y0) (x1, y1) as its top left corner and the vectors
+ * along its two edges */
+static inline void
+transform_instance (const CoglJournalTransform *transform,
+                    float x0,
+                    float y0,
+                    float x1,
+                    float y1,
+                    float *vout)
+{
+#ifdef COGL_JOURNAL_USE_VECTOR_TRANSFORM
+  CoglJournalVec4 origin = (transform->x_axis * x0 +
+                            transform->y_axis * y0 +
+                            transform->translation);
+  CoglJournalVec4 x_edge = transform->x_axis * (x1 - x0);
+  CoglJournalVec4 y_edge = transform->y_axis * (y1 - y0);
+
+  /* As with the vertices each store writes a fourth float over the
+     next field so they have to be written in order and before the
+     color and texture coordinates */
+  memcpy (vout + INSTANCE_ORIGIN_OFFSET, &origin, sizeof (origin));
+  memcpy (vout + INSTANCE_X_EDGE_OFFSET, &x_edge, sizeof (x_edge));
+  memcpy (vout + INSTANCE_Y_EDGE_OFFSET, &y_edge, sizeof (y_edge));
+#else
+  int i;
+
+  for (i = 0; i < 3; i++)
+    {
+      vout[INSTANCE_ORIGIN_OFFSET + i] = (transform->x_axis[i] * x0 +
+                                          transform->y_axis[i] * y0 +
+                                          transform->translation[i]);
+      vout[INSTANCE_X_EDGE_OFFSET + i] = transform->x_axis[i] * (x1 - x0);
+      vout[INSTANCE_Y_EDGE_OFFSET + i] = transform->y_axis[i] * (y1 - y0);
+    }
+#endif
+}
+
 static CoglAttributeBuffer *
 upload_vertices (CoglJournal *journal,
                  const CoglJournalEntry *entries,
                  int n_entries,
                  size_t needed_vbo_len,
-                 GArray *vertices)
+                 GArray *vertices,
+                 size_t *array_offset)
 {
-  CoglAttributeBuffer *attribute_buffer;
+  CoglAttributeBuffer *attribute_buffer = NULL;
   CoglBuffer *buffer;
   const float *vin;
   float *vout;
   int entry_num;
   int i;
   CoglMatrixEntry *last_modelview_entry = NULL;
-  CoglMatrix modelview;
+  CoglJournalTransform transform;
+  COGL_STATIC_TIMER (upload_timer,
+                     "Journal Flush", /* parent */
+                     "flush: upload vertices",
+                     "The time spent transforming and uploading the "
+                     "journal's vertices",
+                     0 /* no application private data */);
 
   g_assert (needed_vbo_len);
 
-  attribute_buffer = create_attribute_buffer (journal, needed_vbo_len * 4);
-  buffer = COGL_BUFFER (attribute_buffer);
-  cogl_buffer_set_update_hint (buffer, COGL_BUFFER_UPDATE_HINT_DYNAMIC);
+  COGL_TIMER_START (_cogl_uprof_context, upload_timer);
+
+  *array_offset = 0;
+
+#ifdef GL_ARB_sync
+  attribute_buffer = map_stream_region (journal->framebuffer->context,
+                                        needed_vbo_len * 4,
+                                        array_offset,
+                                        &vout);
+#endif
+
+  if (attribute_buffer == NULL)
+    {
+      attribute_buffer = create_attribute_buffer (journal,
+                                                  needed_vbo_len * 4);
+      buffer = COGL_BUFFER (attribute_buffer);
+      cogl_buffer_set_update_hint (buffer, COGL_BUFFER_UPDATE_HINT_DYNAMIC);
+
+      vout = _cogl_buffer_map_range_for_fill_or_fallback (buffer,
+                                                          0, /* offset */
+                                                          needed_vbo_len * 4);
+    }
+  else
+    buffer = COGL_BUFFER (attribute_buffer);
 
-  vout = _cogl_buffer_map_range_for_fill_or_fallback (buffer,
-                                                      0, /* offset */
-                                                      needed_vbo_len * 4);
   vin = &g_array_index (vertices, float, 0);
 
   /* Expand the number of vertices from 2 to 4 while uploading */
@@ -1114,12 +1791,47 @@ upload_vertices (CoglJournal *journal,
       size_t vb_stride = GET_JOURNAL_VB_STRIDE_FOR_N_LAYERS (entry->n_layers);
       size_t array_stride =
         GET_JOURNAL_ARRAY_STRIDE_FOR_N_LAYERS (entry->n_layers);
+      const float *color = vin;
 
-      /* Copy the color to all four of the vertices */
-      for (i = 0; i < 4; i++)
-        memcpy (vout + vb_stride * i + POS_STRIDE, vin, 4);
       vin++;
 
+      /* Consecutive entries usually share a modelview so the matrix
+         only needs to be fetched at the start of each run */
+      if (SW_TRANSFORM && entry->modelview_entry != last_modelview_entry)
+        {
+          CoglMatrix modelview;
+
+          cogl_matrix_entry_get (entry->modelview_entry, &modelview);
+          init_transform (&transform, &modelview);
+          last_modelview_entry = entry->modelview_entry;
+        }
+
+      if (entry->instanced)
+        {
+          transform_instance (&transform,
+                              vin[0], vin[1],
+                              vin[array_stride], vin[array_stride + 1],
+                              vout);
+
+          memcpy (vout + INSTANCE_COLOR_OFFSET, color, 4);
+
+          for (i = 0; i < entry->n_layers; i++)
+            {
+              const float *tin = vin + 2 + i * 2;
+              float *tout =
+                vout + INSTANCE_TEX_OFFSET + INSTANCE_TEX_STRIDE * i;
+
+              tout[0] = tin[0];
+              tout[1] = tin[1];
+              tout[2] = tin[array_stride];
+              tout[3] = tin[array_stride + 1];
+            }
+
+          vin += array_stride * 2;
+          vout += GET_JOURNAL_INSTANCE_STRIDE_FOR_N_LAYERS (entry->n_layers);
+          continue;
+        }
+
       if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_SOFTWARE_TRANSFORM)))
         {
           vout[vb_stride * 0] = vin[0];
@@ -1132,29 +1844,14 @@ upload_vertices (CoglJournal *journal,
           vout[vb_stride * 3 + 1] = vin[1];
         }
       else
-        {
-          float v[8];
-
-          v[0] = vin[0];
-          v[1] = vin[1];
-          v[2] = vin[0];
-          v[3] = vin[array_stride + 1];
-          v[4] = vin[array_stride];
-          v[5] = vin[array_stride + 1];
-          v[6] = vin[array_stride];
-          v[7] = vin[1];
-
-          if (entry->modelview_entry != last_modelview_entry)
-            cogl_matrix_entry_get (entry->modelview_entry, &modelview);
-          cogl_matrix_transform_points (&modelview,
-                                        2, /* n_components */
-                                        sizeof (float) * 2, /* stride_in */
-                                        v, /* points_in */
-                                        /* strideout */
-                                        vb_stride * sizeof (float),
-                                        vout, /* points_out */
-                                        4 /* n_points */);
-        }
+        transform_quad (&transform,
+                        vin[0], vin[1],
+                        vin[array_stride], vin[array_stride + 1],
+                        vout, vb_stride);
+
+      /* Copy the color to all four of the vertices */
+      for (i = 0; i < 4; i++)
+        memcpy (vout + vb_stride * i + POS_STRIDE, color, 4);
 
       for (i = 0; i < entry->n_layers; i++)
         {
@@ -1175,7 +1872,12 @@ upload_vertices (CoglJournal *journal,
       vout += vb_stride * 4;
     }
 
-  _cogl_buffer_unmap_for_fill_or_fallback (buffer);
+  /* The stream buffer stays mapped and is coherent so there's nothing
+     to flush */
+  if (!(buffer->flags & COGL_BUFFER_FLAG_PERSISTENT))
+    _cogl_buffer_unmap_for_fill_or_fallback (buffer);
+
+  COGL_TIMER_STOP (_cogl_uprof_context, upload_timer);
 
   return attribute_buffer;
 }
@@ -1287,6 +1989,85 @@ post_fences (CoglJournal *journal)
     }
 }
 
+static gboolean
+check_sequential_layer_cb (CoglPipeline *pipeline,
+                           int layer_index,
+                           void *user_data)
+{
+  int *n_layers = user_data;
+
+  if (layer_index != *n_layers)
+    return FALSE;
+
+  (*n_layers)++;
+
+  return TRUE;
+}
+
+static gboolean
+can_instance_pipeline (CoglPipeline *pipeline,
+                       int n_layers)
+{
+  int n_sequential_layers = 0;
+
+  if (n_layers > COGL_JOURNAL_MAX_INSTANCED_LAYERS)
+    return FALSE;
+
+  /* The instanced vertex snippet replaces all of the generated vertex
+     processing so it can't be used if the application has its own */
+  if (_cogl_pipeline_get_user_program (pipeline) ||
+      _cogl_pipeline_has_non_layer_vertex_snippets (pipeline))
+    return FALSE;
+
+  /* The snippets are shared between pipelines so they assume that
+     the layer indices match the layer numbers */
+  cogl_pipeline_foreach_layer (pipeline,
+                               check_sequential_layer_cb,
+                               &n_sequential_layers);
+
+  return n_sequential_layers == n_layers;
+}
+
+/* Marks the entries that will be uploaded as instance records and
+ * expanded to quads on the GPU */
+static void
+mark_instanced_entries (CoglJournal *journal)
+{
+  CoglContext *ctx = journal->framebuffer->context;
+  CoglPipeline *last_pipeline = NULL;
+  gboolean last_result = FALSE;
+  int i;
+
+  if (!_cogl_has_private_feature (ctx, COGL_PRIVATE_FEATURE_INSTANCED_ARRAYS) ||
+      !_cogl_has_private_feature (ctx, COGL_PRIVATE_FEATURE_GL_PROGRAMMABLE))
+    return;
+
+  /* The instance records are always transformed in software and the
+     debug modes that inspect or modify the journal's vertices only
+     understand the normal layout */
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_INSTANCING) ||
+                  COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_SOFTWARE_TRANSFORM) ||
+                  COGL_DEBUG_ENABLED (COGL_DEBUG_RECTANGLES) ||
+                  COGL_DEBUG_ENABLED (COGL_DEBUG_WIREFRAME) ||
+                  COGL_DEBUG_ENABLED (COGL_DEBUG_JOURNAL)))
+    return;
+
+  for (i = 0; i < journal->entries->len; i++)
+    {
+      CoglJournalEntry *entry =
+        &g_array_index (journal->entries, CoglJournalEntry, i);
+
+      if (entry->pipeline != last_pipeline)
+        {
+          last_pipeline = entry->pipeline;
+          last_result = can_instance_pipeline (entry->pipeline,
+                                               entry->n_layers);
+        }
+
+      entry->instanced = last_result;
+    }
+}
+
 /* XXX NB: When _cogl_journal_flush() returns all state relating
  * to pipelines, all glEnable flags and current matrix state
  * is undefined.
@@ -1297,6 +2078,7 @@ _cogl_journal_flush (CoglJournal *journal)
   CoglFramebuffer *framebuffer;
   CoglContext *ctx;
   CoglJournalFlushState state;
+  size_t vertices_offset;
   int i;
   COGL_STATIC_TIMER (flush_timer,
                      "Mainloop", /* parent */
@@ -1362,6 +2144,8 @@ _cogl_journal_flush (CoglJournal *journal)
                       &state); /* data */
     }
 
+  mark_instanced_entries (journal);
+
   /* We upload the vertices after the clip stack pass in case it
      modifies the entries */
   state.attribute_buffer =
@@ -1369,8 +2153,9 @@ _cogl_journal_flush (CoglJournal *journal)
                      &g_array_index (journal->entries, CoglJournalEntry, 0),
                      journal->entries->len,
                      journal->needed_vbo_len,
-                     journal->vertices);
-  state.array_offset = 0;
+                     journal->vertices,
+                     &state.array_offset);
+  vertices_offset = state.array_offset;
 
   /* batch_and_call() batches a list of journal entries according to some
    * given criteria and calls a callback once for each determined batch.
@@ -1401,6 +2186,11 @@ _cogl_journal_flush (CoglJournal *journal)
                   _cogl_journal_flush_clip_stacks_and_entries, /* callback */
                   &state); /* data */
 
+#ifdef GL_ARB_sync
+  if (state.attribute_buffer == ctx->journal_stream_buffer)
+    fence_stream_region (ctx, vertices_offset, journal->needed_vbo_len * 4);
+#endif
+
   for (i = 0; i < state.attributes->len; i++)
     cogl_object_unref (g_array_index (state.attributes, CoglAttribute *, i));
   g_array_set_size (state.attributes, 0);
@@ -1525,6 +2315,7 @@ _cogl_journal_log_quad (CoglJournal  *journal,
 
   entry->n_layers = n_layers;
   entry->array_offset = next_vert;
+  entry->instanced = FALSE;
 
   final_pipeline = pipeline;
 
@@ -40,6 +40,7 @@
 #include "cogl1-context.h"
 #include "cogl-closure-list-private.h"
 #include "cogl-poll-private.h"
+#include "cogl-error-private.h"
 #include "cogl-gtype-private.h"
 
 #ifdef COGL_HAS_X11_SUPPORT
@@ -345,6 +346,48 @@ cogl_onscreen_swap_buffers (CoglOnscreen *onscreen)
   cogl_onscreen_swap_buffers_with_damage (onscreen, NULL, 0);
 }
 
+gboolean
+cogl_onscreen_direct_scanout (CoglOnscreen *onscreen,
+                              CoglScanout *scanout,
+                              CoglError **error)
+{
+  CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
+  const CoglWinsysVtable *winsys;
+  CoglFrameInfo *info;
+
+  _COGL_RETURN_VAL_IF_FAIL (framebuffer->type == COGL_FRAMEBUFFER_TYPE_ONSCREEN,
+                            FALSE);
+
+  winsys = _cogl_framebuffer_get_winsys (framebuffer);
+
+  /* Without frame events nothing would tell when the scanout buffer is
+   * no longer in use, so only allow it together with them. */
+  if (!winsys->onscreen_direct_scanout ||
+      !_cogl_winsys_has_feature (COGL_WINSYS_FEATURE_SYNC_AND_COMPLETE_EVENT))
+    {
+      _cogl_set_error (error,
+                       COGL_SYSTEM_ERROR,
+                       COGL_SYSTEM_ERROR_UNSUPPORTED,
+                       "Direct scanout not supported");
+      return FALSE;
+    }
+
+  info = _cogl_frame_info_new ();
+  info->frame_counter = onscreen->frame_counter;
+  g_queue_push_tail (&onscreen->pending_frame_infos, info);
+
+  if (!winsys->onscreen_direct_scanout (onscreen, scanout, error))
+    {
+      g_queue_pop_tail (&onscreen->pending_frame_infos);
+      cogl_object_unref (info);
+      return FALSE;
+    }
+
+  onscreen->frame_counter++;
+
+  return TRUE;
+}
+
 void
 cogl_onscreen_swap_region (CoglOnscreen *onscreen,
                            const int *rectangles,
@@ -42,6 +42,7 @@
 #include <cogl/cogl-framebuffer.h>
 #include <cogl/cogl-frame-info.h>
 #include <cogl/cogl-object.h>
+#include <cogl/cogl-scanout.h>
 
 #include <glib-object.h>
 
@@ -348,6 +349,32 @@ cogl_onscreen_swap_buffers_with_damage (CoglOnscreen *onscreen,
                                         const int *rectangles,
                                         int n_rectangles);
 
+/**
+ * cogl_onscreen_direct_scanout:
+ * @onscreen: A #CoglOnscreen framebuffer
+ * @scanout: The #CoglScanout to present
+ * @error: A #CoglError to report failures
+ *
+ * Presents @scanout in place of the contents of @onscreen for the next
+ * frame, without rendering anything. This is like
+ * cogl_onscreen_swap_buffers() in that it completes a frame and results
+ * in frame events being dispatched for it, but the contents of the back
+ * buffer are left untouched and are not presented.
+ *
+ * Whether a given @scanout can be presented depends on the window
+ * system and the current output configuration; on failure nothing is
+ * presented, and the frame should be rendered and swapped as usual.
+ *
+ * Return value: %TRUE if @scanout is going to be presented, %FALSE
+ *               otherwise.
+ *
+ * Stability: unstable
+ */
+gboolean
+cogl_onscreen_direct_scanout (CoglOnscreen *onscreen,
+                              CoglScanout *scanout,
+                              CoglError **error);
+
 /**
  * cogl_onscreen_swap_region:
  * @onscreen: A #CoglOnscreen framebuffer
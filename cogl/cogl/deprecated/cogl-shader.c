@@ -196,6 +196,7 @@ _cogl_shader_compile_real (CoglHandle handle,
                                                  1,
                                                  (const char **)
                                                   &shader->source,
+                                                 NULL,
                                                  NULL);
 
   GE (ctx, glCompileShader (shader->gl_handle));
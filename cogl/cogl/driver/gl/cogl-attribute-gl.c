@@ -180,6 +180,20 @@ setup_generic_buffered_attribute (CoglContext *context,
                                       base + attribute->d.buffered.offset) );
   _cogl_bitmask_set (&context->enable_custom_attributes_tmp,
                      attrib_location, TRUE);
+
+  /* The divisor is only reset when a location that was last used for
+   * an instanced attribute is reused so that non-instanced drawing
+   * doesn't need any extra GL calls */
+  if (attribute->instance_divisor != 0 ||
+      _cogl_bitmask_get (&context->instanced_custom_attributes,
+                         attrib_location))
+    {
+      GE( context, glVertexAttribDivisor (attrib_location,
+                                          attribute->instance_divisor) );
+      _cogl_bitmask_set (&context->instanced_custom_attributes,
+                         attrib_location,
+                         attribute->instance_divisor != 0);
+    }
 }
 
 static void
@@ -53,6 +53,10 @@ _cogl_buffer_gl_map_range (CoglBuffer *buffer,
                            CoglBufferMapHint hints,
                            CoglError **error);
 
+void *
+_cogl_buffer_gl_map_persistent (CoglBuffer *buffer,
+                                CoglError **error);
+
 void
 _cogl_buffer_gl_unmap (CoglBuffer *buffer);
 
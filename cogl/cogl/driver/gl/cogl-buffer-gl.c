@@ -76,6 +76,12 @@
 #ifndef GL_MAP_INVALIDATE_BUFFER_BIT
 #define GL_MAP_INVALIDATE_BUFFER_BIT 0x0008
 #endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
 
 void
 _cogl_buffer_gl_create (CoglBuffer *buffer)
@@ -332,6 +338,62 @@ _cogl_buffer_gl_map_range (CoglBuffer *buffer,
   return data;
 }
 
+void *
+_cogl_buffer_gl_map_persistent (CoglBuffer *buffer,
+                                CoglError **error)
+{
+  CoglContext *ctx = buffer->context;
+  GLbitfield gl_flags = (GL_MAP_WRITE_BIT |
+                         GL_MAP_PERSISTENT_BIT |
+                         GL_MAP_COHERENT_BIT);
+  GLenum gl_target;
+  void *data;
+
+  _COGL_RETURN_VAL_IF_FAIL (ctx->glBufferStorage != NULL, NULL);
+  _COGL_RETURN_VAL_IF_FAIL (buffer->flags & COGL_BUFFER_FLAG_BUFFER_OBJECT,
+                            NULL);
+  /* The storage allocated by glBufferStorage is immutable so it can
+   * only be created once */
+  _COGL_RETURN_VAL_IF_FAIL (!buffer->store_created, NULL);
+
+  _cogl_buffer_bind_no_create (buffer, buffer->last_target);
+
+  gl_target = convert_bind_target_to_gl_target (buffer->last_target);
+
+  /* Clear any GL errors */
+  _cogl_gl_util_clear_gl_errors (ctx);
+
+  ctx->glBufferStorage (gl_target, buffer->size, NULL, gl_flags);
+
+  if (_cogl_gl_util_catch_out_of_memory (ctx, error))
+    {
+      _cogl_buffer_gl_unbind (buffer);
+      return NULL;
+    }
+
+  buffer->store_created = TRUE;
+
+  data = ctx->glMapBufferRange (gl_target, 0, buffer->size, gl_flags);
+
+  if (_cogl_gl_util_catch_out_of_memory (ctx, error))
+    {
+      _cogl_buffer_gl_unbind (buffer);
+      return NULL;
+    }
+
+  _cogl_buffer_gl_unbind (buffer);
+
+  _COGL_RETURN_VAL_IF_FAIL (data != NULL, NULL);
+
+  /* The mapping stays valid until the buffer is deleted, which
+   * implicitly unmaps it, so this doesn't set the MAPPED flag that
+   * would otherwise prevent the buffer from being drawn with */
+  buffer->flags |= COGL_BUFFER_FLAG_PERSISTENT;
+  buffer->data = data;
+
+  return data;
+}
+
 void
 _cogl_buffer_gl_unmap (CoglBuffer *buffer)
 {
@@ -1172,6 +1172,25 @@ _cogl_framebuffer_gl_draw_attributes (CoglFramebuffer *framebuffer,
       glDrawArrays ((GLenum)mode, first_vertex, n_vertices));
 }
 
+void
+_cogl_framebuffer_gl_draw_instanced_attributes (CoglFramebuffer *framebuffer,
+                                                CoglPipeline *pipeline,
+                                                CoglVerticesMode mode,
+                                                int first_vertex,
+                                                int n_vertices,
+                                                int n_instances,
+                                                CoglAttribute **attributes,
+                                                int n_attributes,
+                                                CoglDrawFlags flags)
+{
+  _cogl_flush_attributes_state (framebuffer, pipeline, flags,
+                                attributes, n_attributes);
+
+  GE (framebuffer->context,
+      glDrawArraysInstanced ((GLenum)mode, first_vertex, n_vertices,
+                             n_instances));
+}
+
 static size_t
 sizeof_index_type (CoglIndicesType type)
 {
@@ -53,6 +53,7 @@
 #include "driver/gl/cogl-pipeline-fragend-glsl-private.h"
 #include "driver/gl/cogl-pipeline-vertend-glsl-private.h"
 #include "driver/gl/cogl-pipeline-progend-glsl-private.h"
+#include "driver/gl/cogl-program-binary-cache-private.h"
 #include "deprecated/cogl-program-private.h"
 
 /* These are used to generalise updating some uniforms that are
@@ -320,12 +321,12 @@ dirty_program_state (CoglPipeline *pipeline)
                              NULL);
 }
 
-static void
+static gboolean
 link_program (GLint gl_program)
 {
   GLint link_status;
 
-  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+  _COGL_GET_CONTEXT (ctx, FALSE);
 
   GE( ctx, glLinkProgram (gl_program) );
 
@@ -349,6 +350,24 @@ link_program (GLint gl_program)
 
       g_free (log);
     }
+
+  return link_status;
+}
+
+/* Identifies a generated program by the sources of its shaders */
+static char *
+get_binary_cache_key (CoglPipeline *pipeline)
+{
+  const char *vertex_hash;
+  const char *fragment_hash;
+
+  vertex_hash = _cogl_pipeline_vertend_glsl_get_source_hash (pipeline);
+  fragment_hash = _cogl_pipeline_fragend_glsl_get_source_hash (pipeline);
+
+  if (vertex_hash == NULL || fragment_hash == NULL)
+    return NULL;
+
+  return g_strconcat (vertex_hash, ":", fragment_hash, NULL);
 }
 
 typedef struct
@@ -665,6 +684,7 @@ _cogl_pipeline_progend_glsl_end (CoglPipeline *pipeline,
   UpdateUniformsState state;
   CoglProgram *user_program;
   CoglPipelineCacheEntry *cache_entry = NULL;
+  char *binary_cache_key = NULL;
 
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
 
@@ -731,10 +751,40 @@ _cogl_pipeline_progend_glsl_end (CoglPipeline *pipeline,
       program_state->program = 0;
     }
 
+  /* Generated programs can be recreated from a binary cached on disk
+     without compiling any shaders */
+  if (program_state->program == 0 &&
+      user_program == NULL &&
+      ctx->program_binary_cache)
+    {
+      binary_cache_key = get_binary_cache_key (pipeline);
+
+      if (binary_cache_key)
+        {
+          program_state->program =
+            _cogl_program_binary_cache_load (ctx->program_binary_cache,
+                                             binary_cache_key);
+          if (program_state->program)
+            program_changed = TRUE;
+        }
+    }
+
   if (program_state->program == 0)
     {
       GLuint backend_shader;
       GSList *l;
+      int64_t link_start_us;
+      gboolean link_status;
+
+      COGL_STATIC_TIMER (progend_glsl_link_timer,
+                         "Material Flush", /* parent */
+                         "GLSL program link",
+                         "The time spent compiling and linking GLSL "
+                         "programs",
+                         0 /* no application private data */);
+
+      COGL_TIMER_START (_cogl_uprof_context, progend_glsl_link_timer);
+      link_start_us = g_get_monotonic_time ();
 
       GE_RET( program_state->program, ctx, glCreateProgram () );
 
@@ -769,11 +819,22 @@ _cogl_pipeline_progend_glsl_end (CoglPipeline *pipeline,
       GE( ctx, glBindAttribLocation (program_state->program,
                                      0, "cogl_position_in"));
 
-      link_program (program_state->program);
+      link_status = link_program (program_state->program);
+
+      COGL_TIMER_STOP (_cogl_uprof_context, progend_glsl_link_timer);
+
+      if (link_status && binary_cache_key)
+        _cogl_program_binary_cache_store (ctx->program_binary_cache,
+                                          binary_cache_key,
+                                          program_state->program,
+                                          g_get_monotonic_time () -
+                                          link_start_us);
 
       program_changed = TRUE;
     }
 
+  g_free (binary_cache_key);
+
   gl_program = program_state->program;
 
   _cogl_use_fragment_program (gl_program, COGL_PIPELINE_PROGRAM_TYPE_GLSL);
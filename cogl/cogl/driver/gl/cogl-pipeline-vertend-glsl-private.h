@@ -41,5 +41,8 @@ extern const CoglPipelineVertend _cogl_pipeline_glsl_vertend;
 GLuint
 _cogl_pipeline_vertend_glsl_get_shader (CoglPipeline *pipeline);
 
+const char *
+_cogl_pipeline_vertend_glsl_get_source_hash (CoglPipeline *pipeline);
+
 #endif /* __COGL_PIPELINE_VERTEND_GLSL_PRIVATE_H */
 
@@ -58,6 +58,11 @@ typedef struct
   unsigned int ref_count;
 
   GLuint gl_shader;
+  /* The source is compiled the first time the shader is needed for
+     linking a program, which can be never if a cached binary of the
+     program is found */
+  unsigned int gl_shader_compiled : 1;
+  char *source_hash;
   GString *header, *source;
 
   CoglPipelineCacheEntry *cache_entry;
@@ -99,6 +104,7 @@ destroy_shader_state (void *user_data,
     {
       if (shader_state->gl_shader)
         GE( ctx, glDeleteShader (shader_state->gl_shader) );
+      g_free (shader_state->source_hash);
 
       g_slice_free (CoglPipelineShaderState, shader_state);
     }
@@ -139,10 +145,29 @@ _cogl_pipeline_vertend_glsl_get_shader (CoglPipeline *pipeline)
 {
   CoglPipelineShaderState *shader_state = get_shader_state (pipeline);
 
+  _COGL_GET_CONTEXT (ctx, 0);
+
+  if (!shader_state)
+    return 0;
+
+  if (shader_state->gl_shader && !shader_state->gl_shader_compiled)
+    {
+      _cogl_glsl_shader_compile (ctx, shader_state->gl_shader);
+      shader_state->gl_shader_compiled = TRUE;
+    }
+
+  return shader_state->gl_shader;
+}
+
+const char *
+_cogl_pipeline_vertend_glsl_get_source_hash (CoglPipeline *pipeline)
+{
+  CoglPipelineShaderState *shader_state = get_shader_state (pipeline);
+
   if (shader_state)
-    return shader_state->gl_shader;
+    return shader_state->source_hash;
   else
-    return 0;
+    return NULL;
 }
 
 static CoglPipelineSnippetList *
@@ -280,6 +305,8 @@ _cogl_pipeline_vertend_glsl_start (CoglPipeline *pipeline,
             {
               GE( ctx, glDeleteShader (shader_state->gl_shader) );
               shader_state->gl_shader = 0;
+              shader_state->gl_shader_compiled = FALSE;
+              g_clear_pointer (&shader_state->source_hash, g_free);
             }
           return;
         }
@@ -419,7 +446,6 @@ _cogl_pipeline_vertend_glsl_end (CoglPipeline *pipeline,
     {
       const char *source_strings[2];
       GLint lengths[2];
-      GLint compile_status;
       GLuint shader;
       CoglPipelineSnippetData snippet_data;
       CoglPipelineSnippetList *vertex_snippets;
@@ -528,25 +554,13 @@ _cogl_pipeline_vertend_glsl_end (CoglPipeline *pipeline,
                                                      shader, GL_VERTEX_SHADER,
                                                      pipeline,
                                                      2, /* count */
-                                                     source_strings, lengths);
-
-      GE( ctx, glCompileShader (shader) );
-      GE( ctx, glGetShaderiv (shader, GL_COMPILE_STATUS, &compile_status) );
-
-      if (!compile_status)
-        {
-          GLint len = 0;
-          char *shader_log;
-
-          GE( ctx, glGetShaderiv (shader, GL_INFO_LOG_LENGTH, &len) );
-          shader_log = g_alloca (len);
-          GE( ctx, glGetShaderInfoLog (shader, len, &len, shader_log) );
-          g_warning ("Shader compilation failed:\n%s", shader_log);
-        }
+                                                     source_strings, lengths,
+                                                     &shader_state->source_hash);
 
       shader_state->header = NULL;
       shader_state->source = NULL;
       shader_state->gl_shader = shader;
+      shader_state->gl_shader_compiled = FALSE;
     }
 
 #ifdef HAVE_COGL_GL
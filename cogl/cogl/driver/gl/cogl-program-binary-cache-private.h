@@ -0,0 +1,74 @@
+/*
+ * Cogl
+ *
+ * A Low Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2019 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef __COGL_PROGRAM_BINARY_CACHE_PRIVATE_H
+#define __COGL_PROGRAM_BINARY_CACHE_PRIVATE_H
+
+#include "cogl-context.h"
+#include "cogl-gl-header.h"
+
+typedef struct _CoglProgramBinaryCache CoglProgramBinaryCache;
+
+CoglProgramBinaryCache *
+_cogl_program_binary_cache_new (CoglContext *context);
+
+void
+_cogl_program_binary_cache_free (CoglProgramBinaryCache *cache);
+
+/*
+ * _cogl_program_binary_cache_load:
+ * @cache: A #CoglProgramBinaryCache
+ * @key: A string identifying the sources of the program
+ *
+ * Creates a GL program from the binary stored for @key.
+ *
+ * Return value: A linked GL program or 0 if there is no usable
+ *   binary for @key
+ */
+GLuint
+_cogl_program_binary_cache_load (CoglProgramBinaryCache *cache,
+                                 const char *key);
+
+/*
+ * _cogl_program_binary_cache_store:
+ * @cache: A #CoglProgramBinaryCache
+ * @key: A string identifying the sources of the program
+ * @program: A successfully linked GL program
+ * @link_time_us: The time it took to compile and link @program
+ *
+ * Stores the binary of @program so that later loads of @key can skip
+ * compiling it.
+ */
+void
+_cogl_program_binary_cache_store (CoglProgramBinaryCache *cache,
+                                  const char *key,
+                                  GLuint program,
+                                  int64_t link_time_us);
+
+#endif /* __COGL_PROGRAM_BINARY_CACHE_PRIVATE_H */
@@ -0,0 +1,438 @@
+/*
+ * Cogl
+ *
+ * A Low Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2019 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+/*
+ * Keeps the binaries of linked GLSL programs on disk so that the
+ * programs can be recreated without compiling any shaders the next
+ * time the same code is generated. Binaries are only valid for the
+ * driver that produced them, so the files are named after a hash of
+ * both the program sources and the GL vendor, renderer and version
+ * strings. The directory is kept under a maximum size by removing the
+ * least recently used binaries.
+ */
+
+#include "cogl-config.h"
+
+#include <string.h>
+#include <sys/stat.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "cogl-context-private.h"
+#include "cogl-private.h"
+#include "cogl-profile.h"
+#include "cogl-debug.h"
+#include "driver/gl/cogl-util-gl-private.h"
+#include "driver/gl/cogl-program-binary-cache-private.h"
+
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+
+#define PROGRAM_BINARY_MAGIC 0x42474f43 /* "COGB" */
+#define PROGRAM_BINARY_VERSION 1
+
+/* Once the binaries take up more than this the least recently used
+ * ones are removed until they take up less than three quarters of it */
+#define PROGRAM_BINARY_CACHE_MAX_SIZE (32 * 1024 * 1024)
+
+typedef struct
+{
+  uint32_t magic;
+  uint32_t version;
+  uint32_t format;
+  uint32_t length;
+} CoglProgramBinaryHeader;
+
+typedef struct
+{
+  char *filename;
+  goffset size;
+  int64_t last_used;
+} CoglProgramBinaryEntry;
+
+struct _CoglProgramBinaryCache
+{
+  CoglContext *context;
+
+  char *path;
+  char *driver_id;
+
+  /* Hash table of the binaries on disk, by file name */
+  GHashTable *entries;
+  goffset total_size;
+
+  unsigned int n_hits;
+  unsigned int n_misses;
+  int64_t link_time_us;
+};
+
+static void
+entry_free (CoglProgramBinaryEntry *entry)
+{
+  g_free (entry->filename);
+  g_slice_free (CoglProgramBinaryEntry, entry);
+}
+
+static void
+add_entry (CoglProgramBinaryCache *cache,
+           const char *filename,
+           goffset size,
+           int64_t last_used)
+{
+  CoglProgramBinaryEntry *entry;
+
+  entry = g_hash_table_lookup (cache->entries, filename);
+  if (entry)
+    {
+      cache->total_size -= entry->size;
+    }
+  else
+    {
+      entry = g_slice_new0 (CoglProgramBinaryEntry);
+      entry->filename = g_strdup (filename);
+      g_hash_table_insert (cache->entries, entry->filename, entry);
+    }
+
+  entry->size = size;
+  entry->last_used = last_used;
+  cache->total_size += size;
+}
+
+static void
+remove_entry (CoglProgramBinaryCache *cache,
+              CoglProgramBinaryEntry *entry)
+{
+  char *path;
+
+  path = g_build_filename (cache->path, entry->filename, NULL);
+  g_unlink (path);
+  g_free (path);
+
+  cache->total_size -= entry->size;
+  g_hash_table_remove (cache->entries, entry->filename);
+}
+
+static int
+compare_entries_by_age (gconstpointer a,
+                        gconstpointer b)
+{
+  const CoglProgramBinaryEntry *entry_a = a;
+  const CoglProgramBinaryEntry *entry_b = b;
+
+  if (entry_a->last_used < entry_b->last_used)
+    return -1;
+  else if (entry_a->last_used > entry_b->last_used)
+    return 1;
+  else
+    return 0;
+}
+
+static void
+evict_entries (CoglProgramBinaryCache *cache)
+{
+  GList *entries, *l;
+
+  if (cache->total_size <= PROGRAM_BINARY_CACHE_MAX_SIZE)
+    return;
+
+  entries = g_hash_table_get_values (cache->entries);
+  entries = g_list_sort (entries, compare_entries_by_age);
+
+  for (l = entries; l; l = l->next)
+    {
+      if (cache->total_size <= PROGRAM_BINARY_CACHE_MAX_SIZE / 4 * 3)
+        break;
+
+      remove_entry (cache, l->data);
+    }
+
+  g_list_free (entries);
+}
+
+static void
+scan_directory (CoglProgramBinaryCache *cache)
+{
+  GDir *dir;
+  const char *filename;
+
+  dir = g_dir_open (cache->path, 0, NULL);
+  if (!dir)
+    return;
+
+  while ((filename = g_dir_read_name (dir)))
+    {
+      GStatBuf stat_buf;
+      char *path;
+
+      if (!g_str_has_suffix (filename, ".bin"))
+        continue;
+
+      path = g_build_filename (cache->path, filename, NULL);
+      if (g_stat (path, &stat_buf) == 0)
+        add_entry (cache, filename, stat_buf.st_size, stat_buf.st_mtime);
+      g_free (path);
+    }
+
+  g_dir_close (dir);
+}
+
+CoglProgramBinaryCache *
+_cogl_program_binary_cache_new (CoglContext *context)
+{
+  CoglProgramBinaryCache *cache;
+  char *path;
+
+  if (!_cogl_has_private_feature (context,
+                                  COGL_PRIVATE_FEATURE_PROGRAM_BINARY) ||
+      COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_PROGRAM_CACHES))
+    return NULL;
+
+  path = g_build_filename (g_get_user_cache_dir (),
+                           "cogl", "program-binaries",
+                           NULL);
+  if (g_mkdir_with_parents (path, 0700) != 0)
+    {
+      g_free (path);
+      return NULL;
+    }
+
+  cache = g_new0 (CoglProgramBinaryCache, 1);
+  cache->context = context;
+  cache->path = path;
+  cache->driver_id =
+    g_strdup_printf ("%s\n%s\n%s\n%d",
+                     (const char *) context->glGetString (GL_VENDOR),
+                     (const char *) context->glGetString (GL_RENDERER),
+                     (const char *) context->glGetString (GL_VERSION),
+                     PROGRAM_BINARY_VERSION);
+  cache->entries = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                          NULL,
+                                          (GDestroyNotify) entry_free);
+
+  scan_directory (cache);
+  evict_entries (cache);
+
+  return cache;
+}
+
+void
+_cogl_program_binary_cache_free (CoglProgramBinaryCache *cache)
+{
+  COGL_NOTE (PERFORMANCE,
+             "Program binary cache: %u hits, %u misses, "
+             "%.1fms spent compiling",
+             cache->n_hits,
+             cache->n_misses,
+             cache->link_time_us / 1000.0);
+
+  g_hash_table_destroy (cache->entries);
+  g_free (cache->driver_id);
+  g_free (cache->path);
+  g_free (cache);
+}
+
+static char *
+get_filename (CoglProgramBinaryCache *cache,
+              const char *key)
+{
+  GChecksum *checksum;
+  char *filename;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA1);
+  g_checksum_update (checksum, (const guchar *) cache->driver_id, -1);
+  g_checksum_update (checksum, (const guchar *) "\n", 1);
+  g_checksum_update (checksum, (const guchar *) key, -1);
+  filename = g_strconcat (g_checksum_get_string (checksum), ".bin", NULL);
+  g_checksum_free (checksum);
+
+  return filename;
+}
+
+static void
+count_miss (CoglProgramBinaryCache *cache)
+{
+  COGL_STATIC_COUNTER (program_binary_cache_miss_counter,
+                       "program binary cache miss counter",
+                       "Increments each time a GLSL program has to be "
+                       "compiled because no binary of it was cached",
+                       0 /* no application private data */);
+  COGL_COUNTER_INC (_cogl_uprof_context, program_binary_cache_miss_counter);
+
+  cache->n_misses++;
+}
+
+GLuint
+_cogl_program_binary_cache_load (CoglProgramBinaryCache *cache,
+                                 const char *key)
+{
+  CoglContext *ctx = cache->context;
+  CoglProgramBinaryEntry *entry;
+  CoglProgramBinaryHeader header;
+  char *filename;
+  char *path;
+  char *contents = NULL;
+  gsize length;
+  GLuint program = 0;
+  GLint link_status = FALSE;
+
+  COGL_STATIC_COUNTER (program_binary_cache_hit_counter,
+                       "program binary cache hit counter",
+                       "Increments each time a GLSL program is created "
+                       "from a cached binary",
+                       0 /* no application private data */);
+
+  filename = get_filename (cache, key);
+  entry = g_hash_table_lookup (cache->entries, filename);
+  g_free (filename);
+
+  if (!entry)
+    {
+      count_miss (cache);
+      return 0;
+    }
+
+  path = g_build_filename (cache->path, entry->filename, NULL);
+
+  if (!g_file_get_contents (path, &contents, &length, NULL) ||
+      length < sizeof (header))
+    goto fail;
+
+  memcpy (&header, contents, sizeof (header));
+  if (header.magic != PROGRAM_BINARY_MAGIC ||
+      header.version != PROGRAM_BINARY_VERSION ||
+      header.length != length - sizeof (header))
+    goto fail;
+
+  GE_RET( program, ctx, glCreateProgram () );
+
+  /* The driver is allowed to reject binaries, for example after it
+   * has been updated, which shows up as an error or a failed link */
+  _cogl_gl_util_clear_gl_errors (ctx);
+  ctx->glProgramBinary (program,
+                        header.format,
+                        contents + sizeof (header),
+                        header.length);
+  if (_cogl_gl_util_get_error (ctx) == GL_NO_ERROR)
+    GE( ctx, glGetProgramiv (program, GL_LINK_STATUS, &link_status) );
+
+  if (!link_status)
+    goto fail;
+
+  /* Bump the modification time so that the binary counts as recently
+   * used next time the directory is scanned */
+  g_utime (path, NULL);
+  entry->last_used = g_get_real_time () / G_USEC_PER_SEC;
+
+  COGL_COUNTER_INC (_cogl_uprof_context, program_binary_cache_hit_counter);
+  cache->n_hits++;
+
+  g_free (contents);
+  g_free (path);
+
+  return program;
+
+fail:
+  COGL_NOTE (PERFORMANCE, "Discarding unusable program binary %s", path);
+
+  if (program)
+    GE( ctx, glDeleteProgram (program) );
+
+  remove_entry (cache, entry);
+  count_miss (cache);
+
+  g_free (contents);
+  g_free (path);
+
+  return 0;
+}
+
+void
+_cogl_program_binary_cache_store (CoglProgramBinaryCache *cache,
+                                  const char *key,
+                                  GLuint program,
+                                  int64_t link_time_us)
+{
+  CoglContext *ctx = cache->context;
+  CoglProgramBinaryHeader header;
+  GLint binary_length = 0;
+  GLsizei written = 0;
+  GLenum binary_format;
+  char *filename;
+  char *path;
+  char *contents;
+  GError *error = NULL;
+
+  cache->link_time_us += link_time_us;
+
+  GE( ctx, glGetProgramiv (program, GL_PROGRAM_BINARY_LENGTH,
+                           &binary_length) );
+  if (binary_length <= 0)
+    return;
+
+  contents = g_malloc (sizeof (header) + binary_length);
+  GE( ctx, glGetProgramBinary (program,
+                               binary_length,
+                               &written,
+                               &binary_format,
+                               contents + sizeof (header)) );
+  if (written <= 0)
+    {
+      g_free (contents);
+      return;
+    }
+
+  header.magic = PROGRAM_BINARY_MAGIC;
+  header.version = PROGRAM_BINARY_VERSION;
+  header.format = binary_format;
+  header.length = written;
+  memcpy (contents, &header, sizeof (header));
+
+  filename = get_filename (cache, key);
+  path = g_build_filename (cache->path, filename, NULL);
+
+  if (g_file_set_contents (path, contents, sizeof (header) + written, &error))
+    {
+      add_entry (cache,
+                 filename,
+                 sizeof (header) + written,
+                 g_get_real_time () / G_USEC_PER_SEC);
+      evict_entries (cache);
+    }
+  else
+    {
+      COGL_NOTE (PERFORMANCE, "Failed to store program binary: %s",
+                 error->message);
+      g_error_free (error);
+    }
+
+  g_free (path);
+  g_free (filename);
+  g_free (contents);
+}
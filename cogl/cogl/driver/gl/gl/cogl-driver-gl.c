@@ -44,6 +44,10 @@
 #include "driver/gl/cogl-clip-stack-gl-private.h"
 #include "driver/gl/cogl-buffer-gl-private.h"
 
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
 static gboolean
 _cogl_driver_pixel_format_from_gl_internal (CoglContext *context,
                                             GLenum gl_int_format,
@@ -578,6 +582,17 @@ _cogl_driver_update_features (CoglContext *ctx,
     COGL_FLAGS_SET (private_features,
                     COGL_PRIVATE_FEATURE_SAMPLER_OBJECTS, TRUE);
 
+  if (ctx->glProgramBinary)
+    {
+      GLint n_binary_formats = 0;
+
+      GE( ctx, glGetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS,
+                              &n_binary_formats) );
+      if (n_binary_formats > 0)
+        COGL_FLAGS_SET (private_features,
+                        COGL_PRIVATE_FEATURE_PROGRAM_BINARY, TRUE);
+    }
+
   if (COGL_CHECK_GL_VERSION (gl_major, gl_minor, 3, 3) ||
       _cogl_check_extension ("GL_ARB_texture_swizzle", gl_extensions) ||
       _cogl_check_extension ("GL_EXT_texture_swizzle", gl_extensions))
@@ -629,6 +644,16 @@ _cogl_driver_update_features (CoglContext *ctx,
   if (ctx->glFenceSync)
     COGL_FLAGS_SET (ctx->features, COGL_FEATURE_ID_FENCE, TRUE);
 
+  /* Persistently mapped buffers are only useful to us if we can also
+   * fence the regions of them that the GPU is still reading from */
+  if (ctx->glBufferStorage && ctx->glMapBufferRange && ctx->glFenceSync)
+    COGL_FLAGS_SET (private_features,
+                    COGL_PRIVATE_FEATURE_BUFFER_STORAGE, TRUE);
+
+  if (ctx->glDrawArraysInstanced && ctx->glVertexAttribDivisor)
+    COGL_FLAGS_SET (private_features,
+                    COGL_PRIVATE_FEATURE_INSTANCED_ARRAYS, TRUE);
+
   if (COGL_CHECK_GL_VERSION (gl_major, gl_minor, 3, 0) ||
       _cogl_check_extension ("GL_ARB_texture_rg", gl_extensions))
     COGL_FLAGS_SET (ctx->features,
@@ -671,6 +696,7 @@ _cogl_driver_gl =
     _cogl_framebuffer_gl_discard_buffers,
     _cogl_framebuffer_gl_draw_attributes,
     _cogl_framebuffer_gl_draw_indexed_attributes,
+    _cogl_framebuffer_gl_draw_instanced_attributes,
     _cogl_framebuffer_gl_read_pixels_into_bitmap,
     _cogl_texture_2d_gl_free,
     _cogl_texture_2d_gl_can_create,
@@ -55,6 +55,9 @@
 #ifndef GL_RG8
 #define GL_RG8 0x822B
 #endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
 
 static gboolean
 _cogl_driver_pixel_format_from_gl_internal (CoglContext *context,
@@ -392,10 +395,25 @@ _cogl_driver_update_features (CoglContext *context,
                      COGL_FEATURE_ID_MAP_BUFFER_FOR_READ, TRUE);
     }
 
+  if (context->glDrawArraysInstanced && context->glVertexAttribDivisor)
+    COGL_FLAGS_SET (private_features,
+                    COGL_PRIVATE_FEATURE_INSTANCED_ARRAYS, TRUE);
+
   if (context->glEGLImageTargetTexture2D)
     COGL_FLAGS_SET (private_features,
                     COGL_PRIVATE_FEATURE_TEXTURE_2D_FROM_EGL_IMAGE, TRUE);
 
+  if (context->glProgramBinary)
+    {
+      GLint n_binary_formats = 0;
+
+      GE( context, glGetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS,
+                                  &n_binary_formats) );
+      if (n_binary_formats > 0)
+        COGL_FLAGS_SET (private_features,
+                        COGL_PRIVATE_FEATURE_PROGRAM_BINARY, TRUE);
+    }
+
   if (_cogl_check_extension ("GL_OES_packed_depth_stencil", gl_extensions))
     COGL_FLAGS_SET (private_features,
                     COGL_PRIVATE_FEATURE_OES_PACKED_DEPTH_STENCIL, TRUE);
@@ -450,6 +468,7 @@ _cogl_driver_gles =
     _cogl_framebuffer_gl_discard_buffers,
     _cogl_framebuffer_gl_draw_attributes,
     _cogl_framebuffer_gl_draw_indexed_attributes,
+    _cogl_framebuffer_gl_draw_instanced_attributes,
     _cogl_framebuffer_gl_read_pixels_into_bitmap,
     _cogl_texture_2d_gl_free,
     _cogl_texture_2d_gl_can_create,
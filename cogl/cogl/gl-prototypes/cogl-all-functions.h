@@ -290,6 +290,17 @@ COGL_EXT_FUNCTION (void, glDeleteSync,
 COGL_EXT_END ()
 #endif
 
+COGL_EXT_BEGIN (buffer_storage, 4, 4,
+                0, /* not in either GLES */
+                "ARB:\0",
+                "buffer_storage\0")
+COGL_EXT_FUNCTION (void, glBufferStorage,
+                   (GLenum target,
+                    GLsizeiptr size,
+                    const GLvoid *data,
+                    GLbitfield flags))
+COGL_EXT_END ()
+
 COGL_EXT_BEGIN (draw_buffers, 2, 0,
                 COGL_EXT_IN_GLES3,
                 "ARB\0EXT\0",
@@ -298,6 +309,43 @@ COGL_EXT_FUNCTION (void, glDrawBuffers,
                    (GLsizei n, const GLenum *bufs))
 COGL_EXT_END ()
 
+COGL_EXT_BEGIN (draw_instanced, 3, 1,
+                COGL_EXT_IN_GLES3,
+                "ARB\0EXT\0",
+                "draw_instanced\0")
+COGL_EXT_FUNCTION (void, glDrawArraysInstanced,
+                   (GLenum mode,
+                    GLint first,
+                    GLsizei count,
+                    GLsizei primcount))
+COGL_EXT_END ()
+
+COGL_EXT_BEGIN (instanced_arrays, 3, 3,
+                COGL_EXT_IN_GLES3,
+                "ARB\0",
+                "instanced_arrays\0")
+COGL_EXT_FUNCTION (void, glVertexAttribDivisor,
+                   (GLuint index,
+                    GLuint divisor))
+COGL_EXT_END ()
+
+COGL_EXT_BEGIN (get_program_binary, 4, 1,
+                COGL_EXT_IN_GLES3,
+                "ARB:\0OES\0",
+                "get_program_binary\0")
+COGL_EXT_FUNCTION (void, glGetProgramBinary,
+                   (GLuint program,
+                    GLsizei bufSize,
+                    GLsizei *length,
+                    GLenum *binaryFormat,
+                    void *binary))
+COGL_EXT_FUNCTION (void, glProgramBinary,
+                   (GLuint program,
+                    GLenum binaryFormat,
+                    const void *binary,
+                    GLint length))
+COGL_EXT_END ()
+
 COGL_EXT_BEGIN (robustness, 255, 255,
                 0,
                 "ARB\0",
@@ -123,6 +123,11 @@ typedef struct _CoglWinsysVtable
                                         const int *rectangles,
                                         int n_rectangles);
 
+  gboolean
+  (*onscreen_direct_scanout) (CoglOnscreen *onscreen,
+                              CoglScanout *scanout,
+                              CoglError **error);
+
   void
   (*onscreen_set_visibility) (CoglOnscreen *onscreen,
                               gboolean visibility);
@@ -75,6 +75,7 @@
 
 #ifdef HAVE_NATIVE_BACKEND
 #include "backends/native/meta-backend-native.h"
+#include "backends/native/meta-backend-native-private.h"
 #endif
 
 #define META_IDLE_MONITOR_CORE_DEVICE 0
@@ -1202,6 +1203,12 @@ meta_backend_set_client_pointer_constraint (MetaBackend           *backend,
   g_clear_object (&priv->client_pointer_constraint);
   if (constraint)
     priv->client_pointer_constraint = g_object_ref (constraint);
+
+#ifdef HAVE_NATIVE_BACKEND
+  if (META_IS_BACKEND_NATIVE (backend))
+    meta_backend_native_update_cursor_position_inhibited (
+      META_BACKEND_NATIVE (backend));
+#endif
 }
 
 /* Mutter is responsible for pulling events off the X queue, so Clutter
@@ -142,6 +142,26 @@ meta_renderer_get_views (MetaRenderer *renderer)
   return priv->views;
 }
 
+/**
+ * meta_renderer_has_view:
+ * @renderer: a #MetaRenderer object
+ * @view: a #ClutterStageView, which may already have been destroyed
+ *
+ * Checks whether @view is still one of the views of @renderer. Only the
+ * pointer is compared, so this may be used for views that were remembered
+ * across a rebuild of the views.
+ *
+ * Returns: %TRUE if @view is one of the current views of @renderer.
+ */
+gboolean
+meta_renderer_has_view (MetaRenderer     *renderer,
+                        ClutterStageView *view)
+{
+  MetaRendererPrivate *priv = meta_renderer_get_instance_private (renderer);
+
+  return g_list_find (priv->views, view) != NULL;
+}
+
 MetaRendererView *
 meta_renderer_get_view_from_logical_monitor (MetaRenderer       *renderer,
                                              MetaLogicalMonitor *logical_monitor)
@@ -55,6 +55,9 @@ void meta_renderer_set_legacy_view (MetaRenderer     *renderer,
 META_EXPORT_TEST
 GList * meta_renderer_get_views (MetaRenderer *renderer);
 
+gboolean meta_renderer_has_view (MetaRenderer     *renderer,
+                                 ClutterStageView *view);
+
 MetaRendererView * meta_renderer_get_view_from_logical_monitor (MetaRenderer       *renderer,
                                                                 MetaLogicalMonitor *logical_monitor);
 
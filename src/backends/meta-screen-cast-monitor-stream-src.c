@@ -25,6 +25,7 @@
 #include "backends/meta-screen-cast-monitor-stream-src.h"
 
 #include <spa/buffer/meta.h>
+#include <string.h>
 
 #include "backends/meta-backend-private.h"
 #include "backends/meta-cursor-tracker-private.h"
@@ -42,6 +43,10 @@ struct _MetaScreenCastMonitorStreamSrc
 
   gboolean cursor_bitmap_invalid;
 
+  CoglBitmap *readback_bitmap;
+  CoglReadPixelsClosure *readback;
+  gboolean readback_ready;
+
   gulong actors_painted_handler_id;
   gulong paint_handler_id;
   gulong cursor_moved_handler_id;
@@ -85,6 +90,19 @@ get_monitor (MetaScreenCastMonitorStreamSrc *monitor_src)
   return meta_screen_cast_monitor_stream_get_monitor (monitor_stream);
 }
 
+static float
+get_stream_scale (MetaScreenCastMonitorStreamSrc *monitor_src)
+{
+  MetaMonitor *monitor = get_monitor (monitor_src);
+  MetaLogicalMonitor *logical_monitor =
+    meta_monitor_get_logical_monitor (monitor);
+
+  if (meta_is_stage_views_scaled ())
+    return logical_monitor->scale;
+  else
+    return 1.0;
+}
+
 static void
 meta_screen_cast_monitor_stream_src_get_specs (MetaScreenCastStreamSrc *src,
                                                int                     *width,
@@ -101,24 +119,61 @@ meta_screen_cast_monitor_stream_src_get_specs (MetaScreenCastStreamSrc *src,
   monitor = get_monitor (monitor_src);
   logical_monitor = meta_monitor_get_logical_monitor (monitor);
   mode = meta_monitor_get_current_mode (monitor);
-
-  if (meta_is_stage_views_scaled ())
-    scale = logical_monitor->scale;
-  else
-    scale = 1.0;
+  scale = get_stream_scale (monitor_src);
 
   *width = (int) roundf (logical_monitor->rect.width * scale);
   *height = (int) roundf (logical_monitor->rect.height * scale);
   *frame_rate = meta_monitor_mode_get_refresh_rate (mode);
 }
 
-static void
-stage_painted (ClutterActor                   *actor,
-               MetaScreenCastMonitorStreamSrc *monitor_src)
+static gboolean
+add_stage_damage (MetaScreenCastMonitorStreamSrc *monitor_src)
 {
   MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (monitor_src);
+  ClutterStage *stage = get_stage (monitor_src);
+  MetaMonitor *monitor;
+  MetaLogicalMonitor *logical_monitor;
+  cairo_rectangle_int_t redraw_clip;
+  MetaRectangle damage_rect;
+  cairo_region_t *damage;
+  gboolean has_damage;
+  float scale;
 
-  meta_screen_cast_stream_src_maybe_record_frame (src);
+  monitor = get_monitor (monitor_src);
+  logical_monitor = meta_monitor_get_logical_monitor (monitor);
+  scale = get_stream_scale (monitor_src);
+
+  clutter_stage_get_redraw_clip_bounds (stage, &redraw_clip);
+
+  /* An empty region still tells the stream this frame's content is known
+   * to be unchanged. */
+  damage = cairo_region_create ();
+
+  if (meta_rectangle_intersect (&redraw_clip, &logical_monitor->rect,
+                                &damage_rect))
+    {
+      int x1, y1, x2, y2;
+
+      x1 = (int) floorf ((damage_rect.x - logical_monitor->rect.x) * scale);
+      y1 = (int) floorf ((damage_rect.y - logical_monitor->rect.y) * scale);
+      x2 = (int) ceilf ((damage_rect.x + damage_rect.width -
+                         logical_monitor->rect.x) * scale);
+      y2 = (int) ceilf ((damage_rect.y + damage_rect.height -
+                         logical_monitor->rect.y) * scale);
+
+      cairo_region_union_rectangle (damage, &(cairo_rectangle_int_t) {
+        .x = x1,
+        .y = y1,
+        .width = x2 - x1,
+        .height = y2 - y1,
+      });
+    }
+
+  meta_screen_cast_stream_src_add_damage (src, damage);
+  has_damage = !cairo_region_is_empty (damage);
+  cairo_region_destroy (damage);
+
+  return has_damage;
 }
 
 static MetaBackend *
@@ -133,6 +188,100 @@ get_backend (MetaScreenCastMonitorStreamSrc *monitor_src)
   return meta_screen_cast_get_backend (screen_cast);
 }
 
+static void
+on_readback_done (CoglFramebuffer *framebuffer,
+                  CoglBitmap      *bitmap,
+                  void            *user_data)
+{
+  MetaScreenCastMonitorStreamSrc *monitor_src = user_data;
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (monitor_src);
+
+  monitor_src->readback = NULL;
+  monitor_src->readback_ready = TRUE;
+
+  meta_screen_cast_stream_src_maybe_record_frame (src);
+}
+
+static void
+cancel_readback (MetaScreenCastMonitorStreamSrc *monitor_src)
+{
+  g_clear_pointer (&monitor_src->readback,
+                   cogl_framebuffer_cancel_read_pixels);
+  monitor_src->readback_ready = FALSE;
+}
+
+static gboolean
+start_readback (MetaScreenCastMonitorStreamSrc *monitor_src)
+{
+  MetaBackend *backend = get_backend (monitor_src);
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+  CoglContext *cogl_context = clutter_backend_get_cogl_context (clutter_backend);
+  ClutterStage *stage = get_stage (monitor_src);
+  MetaMonitor *monitor;
+  MetaLogicalMonitor *logical_monitor;
+  float scale;
+  int width, height;
+  GError *error = NULL;
+
+  monitor = get_monitor (monitor_src);
+  logical_monitor = meta_monitor_get_logical_monitor (monitor);
+  scale = get_stream_scale (monitor_src);
+  width = (int) roundf (logical_monitor->rect.width * scale);
+  height = (int) roundf (logical_monitor->rect.height * scale);
+
+  /* A read from an earlier paint that hasn't completed yet is superseded;
+   * the GPU orders the copies into the shared buffer for us. */
+  cancel_readback (monitor_src);
+
+  if (monitor_src->readback_bitmap &&
+      (cogl_bitmap_get_width (monitor_src->readback_bitmap) != width ||
+       cogl_bitmap_get_height (monitor_src->readback_bitmap) != height))
+    g_clear_pointer (&monitor_src->readback_bitmap, cogl_object_unref);
+
+  if (!monitor_src->readback_bitmap)
+    monitor_src->readback_bitmap =
+      cogl_bitmap_new_with_size (cogl_context, width, height,
+                                 CLUTTER_CAIRO_FORMAT_ARGB32);
+
+  monitor_src->readback =
+    clutter_stage_capture_into_bitmap_async (stage,
+                                             &logical_monitor->rect,
+                                             monitor_src->readback_bitmap,
+                                             on_readback_done,
+                                             monitor_src,
+                                             &error);
+  if (!monitor_src->readback)
+    {
+      g_warning ("Failed to start reading back monitor contents: %s",
+                 error->message);
+      g_error_free (error);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+stage_painted (ClutterActor                   *actor,
+               MetaScreenCastMonitorStreamSrc *monitor_src)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (monitor_src);
+  gboolean has_damage;
+
+  has_damage = add_stage_damage (monitor_src);
+
+  /* Queue a copy of the frame on the GPU and hand it to PipeWire once that
+   * completed, rather than stalling the paint on reading it back. */
+  if (has_damage && start_readback (monitor_src))
+    return;
+
+  /* The pending read will record the frame once it completes. */
+  if (monitor_src->readback)
+    return;
+
+  meta_screen_cast_stream_src_maybe_record_frame (src);
+}
+
 static gboolean
 is_cursor_in_stream (MetaScreenCastMonitorStreamSrc *monitor_src)
 {
@@ -293,6 +442,9 @@ meta_screen_cast_monitor_stream_src_disable (MetaScreenCastStreamSrc *src)
 
   stage = get_stage (monitor_src);
 
+  cancel_readback (monitor_src);
+  g_clear_pointer (&monitor_src->readback_bitmap, cogl_object_unref);
+
   if (monitor_src->actors_painted_handler_id)
     {
       g_signal_handler_disconnect (stage,
@@ -323,15 +475,98 @@ meta_screen_cast_monitor_stream_src_disable (MetaScreenCastStreamSrc *src)
     }
 }
 
+static void
+copy_readback_rect (MetaScreenCastMonitorStreamSrc *monitor_src,
+                    const uint8_t                  *readback_data,
+                    uint8_t                        *data,
+                    int                             stride,
+                    const cairo_rectangle_int_t    *rect)
+{
+  int readback_stride = cogl_bitmap_get_rowstride (monitor_src->readback_bitmap);
+  int bpp = 4;
+  int y;
+
+  for (y = rect->y; y < rect->y + rect->height; y++)
+    {
+      memcpy (data + y * stride + rect->x * bpp,
+              readback_data + y * readback_stride + rect->x * bpp,
+              rect->width * bpp);
+    }
+}
+
+static gboolean
+record_frame_from_readback (MetaScreenCastMonitorStreamSrc *monitor_src,
+                            uint8_t                        *data,
+                            const cairo_region_t           *redraw_region)
+{
+  CoglBitmap *bitmap = monitor_src->readback_bitmap;
+  CoglBuffer *buffer = COGL_BUFFER (cogl_bitmap_get_buffer (bitmap));
+  cairo_rectangle_int_t frame_rect;
+  const uint8_t *readback_data;
+  int stride;
+
+  frame_rect = (cairo_rectangle_int_t) {
+    .width = cogl_bitmap_get_width (bitmap),
+    .height = cogl_bitmap_get_height (bitmap),
+  };
+  stride = frame_rect.width * 4;
+
+  readback_data = cogl_buffer_map (buffer, COGL_BUFFER_ACCESS_READ, 0);
+  if (!readback_data)
+    return FALSE;
+
+  if (!redraw_region)
+    {
+      copy_readback_rect (monitor_src, readback_data, data, stride,
+                          &frame_rect);
+    }
+  else
+    {
+      cairo_region_t *copy_region;
+      int n_rects;
+      int i;
+
+      copy_region = cairo_region_copy (redraw_region);
+      cairo_region_intersect_rectangle (copy_region, &frame_rect);
+
+      n_rects = cairo_region_num_rectangles (copy_region);
+      for (i = 0; i < n_rects; i++)
+        {
+          cairo_rectangle_int_t rect;
+
+          cairo_region_get_rectangle (copy_region, i, &rect);
+          copy_readback_rect (monitor_src, readback_data, data, stride,
+                              &rect);
+        }
+
+      cairo_region_destroy (copy_region);
+    }
+
+  cogl_buffer_unmap (buffer);
+
+  monitor_src->readback_ready = FALSE;
+
+  return TRUE;
+}
+
 static gboolean
 meta_screen_cast_monitor_stream_src_record_frame (MetaScreenCastStreamSrc *src,
-                                                  uint8_t                 *data)
+                                                  uint8_t                 *data,
+                                                  const cairo_region_t    *redraw_region)
 {
   MetaScreenCastMonitorStreamSrc *monitor_src =
     META_SCREEN_CAST_MONITOR_STREAM_SRC (src);
   ClutterStage *stage;
   MetaMonitor *monitor;
   MetaLogicalMonitor *logical_monitor;
+  cairo_region_t *stage_region;
+  float scale;
+  int stride;
+  int n_rects;
+  int i;
+
+  if (monitor_src->readback_ready)
+    return record_frame_from_readback (monitor_src, data, redraw_region);
 
   stage = get_stage (monitor_src);
   if (!clutter_stage_is_redraw_queued (stage))
@@ -339,7 +574,43 @@ meta_screen_cast_monitor_stream_src_record_frame (MetaScreenCastStreamSrc *src,
 
   monitor = get_monitor (monitor_src);
   logical_monitor = meta_monitor_get_logical_monitor (monitor);
-  clutter_stage_capture_into (stage, FALSE, &logical_monitor->rect, data);
+
+  if (!redraw_region)
+    {
+      clutter_stage_capture_into (stage, FALSE, &logical_monitor->rect, data);
+      return TRUE;
+    }
+
+  scale = get_stream_scale (monitor_src);
+  stride = (int) roundf (logical_monitor->rect.width * scale) * 4;
+
+  /* The redraw region is in stream pixels; map it back onto the stage,
+   * rounding outwards so that no damaged pixel is left behind. */
+  stage_region = cairo_region_create ();
+  n_rects = cairo_region_num_rectangles (redraw_region);
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+      int x1, y1, x2, y2;
+
+      cairo_region_get_rectangle (redraw_region, i, &rect);
+
+      x1 = (int) floorf (rect.x / scale);
+      y1 = (int) floorf (rect.y / scale);
+      x2 = (int) ceilf ((rect.x + rect.width) / scale);
+      y2 = (int) ceilf ((rect.y + rect.height) / scale);
+
+      cairo_region_union_rectangle (stage_region, &(cairo_rectangle_int_t) {
+        .x = logical_monitor->rect.x + x1,
+        .y = logical_monitor->rect.y + y1,
+        .width = x2 - x1,
+        .height = y2 - y1,
+      });
+    }
+
+  clutter_stage_capture_region_into (stage, &logical_monitor->rect,
+                                     stage_region, data, stride);
+  cairo_region_destroy (stage_region);
 
   return TRUE;
 }
@@ -25,11 +25,13 @@
 #include "backends/meta-screen-cast-stream-src.h"
 
 #include <errno.h>
+#include <linux/dma-buf.h>
 #include <pipewire/pipewire.h>
 #include <spa/param/props.h>
 #include <spa/param/format-utils.h>
 #include <spa/param/video/format-utils.h>
 #include <stdint.h>
+#include <sys/ioctl.h>
 #include <sys/mman.h>
 
 #include "backends/meta-screen-cast-session.h"
@@ -45,6 +47,13 @@
   (sizeof (struct spa_meta_cursor) + \
    sizeof (struct spa_meta_bitmap) + width * height * 4)
 
+/* PipeWire 0.2 has no damage metadata of its own, so describe it the way
+ * later versions do: an array of regions, terminated by an empty one. */
+#define META_SPA_TYPE_META__VideoDamage SPA_TYPE_META_BASE "VideoDamage"
+
+#define MAX_DAMAGE_REGIONS 16
+#define DAMAGE_META_SIZE (sizeof (MetaSpaMetaRegion) * MAX_DAMAGE_REGIONS)
+
 enum
 {
   PROP_0,
@@ -69,8 +78,27 @@ typedef struct _MetaSpaType
   struct spa_type_format_video format_video;
   struct spa_type_video_format video_format;
   uint32_t meta_cursor;
+  uint32_t meta_video_damage;
 } MetaSpaType;
 
+typedef struct _MetaSpaMetaRegion
+{
+  struct spa_point position;
+  struct spa_rectangle size;
+} MetaSpaMetaRegion;
+
+typedef struct _MetaScreenCastStreamBuffer
+{
+  struct pw_buffer *pipewire_buffer;
+
+  uint8_t *map;
+  size_t map_size;
+
+  /* Parts of the buffer that are out of date relative to the most recently
+   * recorded frame. */
+  cairo_region_t *stale_region;
+} MetaScreenCastStreamBuffer;
+
 typedef struct _MetaPipeWireSource
 {
   GSource base;
@@ -96,6 +124,11 @@ typedef struct _MetaScreenCastStreamSrcPrivate
   MetaSpaType spa_type;
   struct spa_video_info_raw video_format;
 
+  GList *buffers;
+
+  /* Damage accumulated since the last recorded frame, or NULL if unknown. */
+  cairo_region_t *frame_damage;
+
   uint64_t last_frame_timestamp_us;
 
   int stream_width;
@@ -141,12 +174,16 @@ meta_screen_cast_stream_src_get_videocrop (MetaScreenCastStreamSrc *src,
 
 static gboolean
 meta_screen_cast_stream_src_record_frame (MetaScreenCastStreamSrc *src,
-                                          uint8_t                 *data)
+                                          uint8_t                 *data,
+                                          const cairo_region_t    *redraw_region)
 {
   MetaScreenCastStreamSrcClass *klass =
     META_SCREEN_CAST_STREAM_SRC_GET_CLASS (src);
 
-  return klass->record_frame (src, data);
+  if (redraw_region && cairo_region_is_empty (redraw_region))
+    return FALSE;
+
+  return klass->record_frame (src, data, redraw_region);
 }
 
 static void
@@ -412,6 +449,287 @@ maybe_record_cursor (MetaScreenCastStreamSrc *src,
   g_assert_not_reached ();
 }
 
+static void
+get_frame_rect (MetaScreenCastStreamSrc *src,
+                cairo_rectangle_int_t   *frame_rect)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  *frame_rect = (cairo_rectangle_int_t) {
+    .width = priv->video_format.size.width,
+    .height = priv->video_format.size.height,
+  };
+}
+
+static void
+meta_screen_cast_stream_buffer_free (MetaScreenCastStreamBuffer *stream_buffer)
+{
+  if (stream_buffer->map)
+    munmap (stream_buffer->map, stream_buffer->map_size);
+  cairo_region_destroy (stream_buffer->stale_region);
+  g_free (stream_buffer);
+}
+
+static void
+maybe_map_buffer (MetaScreenCastStreamSrc    *src,
+                  MetaScreenCastStreamBuffer *stream_buffer)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  struct spa_data *spa_data = &stream_buffer->pipewire_buffer->buffer->datas[0];
+  size_t map_size;
+  uint8_t *map;
+
+  if (spa_data->data)
+    return;
+
+  if (spa_data->type != priv->pipewire_type->data.MemFd &&
+      spa_data->type != priv->pipewire_type->data.DmaBuf)
+    return;
+
+  map_size = spa_data->maxsize + spa_data->mapoffset;
+  map = mmap (NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+              spa_data->fd, 0);
+  if (map == MAP_FAILED)
+    {
+      g_warning ("Failed to mmap pipewire stream buffer: %s",
+                 strerror (errno));
+      return;
+    }
+
+  stream_buffer->map = map;
+  stream_buffer->map_size = map_size;
+}
+
+static void
+on_stream_add_buffer (void             *data,
+                      struct pw_buffer *buffer)
+{
+  MetaScreenCastStreamSrc *src = data;
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  MetaScreenCastStreamBuffer *stream_buffer;
+  cairo_rectangle_int_t frame_rect;
+
+  get_frame_rect (src, &frame_rect);
+
+  stream_buffer = g_new0 (MetaScreenCastStreamBuffer, 1);
+  stream_buffer->pipewire_buffer = buffer;
+  stream_buffer->stale_region = cairo_region_create_rectangle (&frame_rect);
+
+  buffer->user_data = stream_buffer;
+  priv->buffers = g_list_prepend (priv->buffers, stream_buffer);
+
+  /* Buffers live until PipeWire removes them, so map them once up front
+   * instead of on every frame. */
+  maybe_map_buffer (src, stream_buffer);
+}
+
+static void
+on_stream_remove_buffer (void             *data,
+                         struct pw_buffer *buffer)
+{
+  MetaScreenCastStreamSrc *src = data;
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  MetaScreenCastStreamBuffer *stream_buffer = buffer->user_data;
+
+  priv->buffers = g_list_remove (priv->buffers, stream_buffer);
+  meta_screen_cast_stream_buffer_free (stream_buffer);
+  buffer->user_data = NULL;
+}
+
+void
+meta_screen_cast_stream_src_add_damage (MetaScreenCastStreamSrc *src,
+                                        const cairo_region_t    *region)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  if (!priv->frame_damage)
+    priv->frame_damage = cairo_region_copy (region);
+  else
+    cairo_region_union (priv->frame_damage, region);
+}
+
+static cairo_region_t *
+get_redraw_region (MetaScreenCastStreamSrc    *src,
+                   MetaScreenCastStreamBuffer *stream_buffer)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  cairo_region_t *redraw_region;
+
+  /* Sources that don't report damage get the whole frame redrawn. */
+  if (!priv->frame_damage)
+    return NULL;
+
+  /* Nothing changed since the last frame; there is nothing to send. */
+  if (cairo_region_is_empty (priv->frame_damage))
+    return cairo_region_create ();
+
+  redraw_region = cairo_region_copy (stream_buffer->stale_region);
+  cairo_region_union (redraw_region, priv->frame_damage);
+
+  return redraw_region;
+}
+
+static void
+update_stale_regions (MetaScreenCastStreamSrc    *src,
+                      MetaScreenCastStreamBuffer *recorded_buffer)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  cairo_rectangle_int_t frame_rect;
+  GList *l;
+
+  get_frame_rect (src, &frame_rect);
+
+  for (l = priv->buffers; l; l = l->next)
+    {
+      MetaScreenCastStreamBuffer *stream_buffer = l->data;
+
+      if (stream_buffer == recorded_buffer)
+        {
+          cairo_region_destroy (stream_buffer->stale_region);
+          stream_buffer->stale_region = cairo_region_create ();
+        }
+      else if (priv->frame_damage)
+        {
+          cairo_region_union (stream_buffer->stale_region,
+                              priv->frame_damage);
+        }
+      else
+        {
+          cairo_region_union_rectangle (stream_buffer->stale_region,
+                                        &frame_rect);
+        }
+    }
+}
+
+static void
+set_meta_region (MetaSpaMetaRegion           *spa_meta_region,
+                 const cairo_rectangle_int_t *rect)
+{
+  spa_meta_region->position.x = rect->x;
+  spa_meta_region->position.y = rect->y;
+  spa_meta_region->size.width = rect->width;
+  spa_meta_region->size.height = rect->height;
+}
+
+static void
+add_damage_metadata (MetaScreenCastStreamSrc *src,
+                     struct spa_buffer       *spa_buffer)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  MetaSpaMetaRegion *spa_meta_regions;
+  cairo_rectangle_int_t rect;
+  int n_rects;
+  int i;
+
+  spa_meta_regions = spa_buffer_find_meta (spa_buffer,
+                                           priv->spa_type.meta_video_damage);
+  if (!spa_meta_regions)
+    return;
+
+  if (!priv->frame_damage)
+    {
+      get_frame_rect (src, &rect);
+      set_meta_region (&spa_meta_regions[0], &rect);
+      n_rects = 1;
+    }
+  else
+    {
+      n_rects = cairo_region_num_rectangles (priv->frame_damage);
+      if (n_rects >= MAX_DAMAGE_REGIONS)
+        {
+          cairo_region_get_extents (priv->frame_damage, &rect);
+          set_meta_region (&spa_meta_regions[0], &rect);
+          n_rects = 1;
+        }
+      else
+        {
+          for (i = 0; i < n_rects; i++)
+            {
+              cairo_region_get_rectangle (priv->frame_damage, i, &rect);
+              set_meta_region (&spa_meta_regions[i], &rect);
+            }
+        }
+    }
+
+  spa_meta_regions[n_rects] = (MetaSpaMetaRegion) { 0 };
+}
+
+static void
+sync_dma_buf (int      fd,
+              uint64_t start_or_end)
+{
+  struct dma_buf_sync sync = { 0 };
+
+  sync.flags = start_or_end | DMA_BUF_SYNC_WRITE;
+
+  while (TRUE)
+    {
+      int ret;
+
+      ret = ioctl (fd, DMA_BUF_IOCTL_SYNC, &sync);
+      if (ret == -1 && (errno == EINTR || errno == EAGAIN))
+        continue;
+      else if (ret == -1)
+        g_warning ("Failed to synchronize DMA buffer: %s", g_strerror (errno));
+
+      break;
+    }
+}
+
+static gboolean
+record_frame_to_memory (MetaScreenCastStreamSrc    *src,
+                        MetaScreenCastStreamBuffer *stream_buffer,
+                        const cairo_region_t       *redraw_region)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  struct spa_buffer *spa_buffer = stream_buffer->pipewire_buffer->buffer;
+  gboolean is_dma_buf = FALSE;
+  uint8_t *data;
+  gboolean recorded;
+
+  if (spa_buffer->datas[0].data)
+    {
+      data = spa_buffer->datas[0].data;
+    }
+  else if (stream_buffer->map)
+    {
+      data = SPA_MEMBER (stream_buffer->map,
+                         spa_buffer->datas[0].mapoffset,
+                         uint8_t);
+      is_dma_buf =
+        spa_buffer->datas[0].type == priv->pipewire_type->data.DmaBuf;
+    }
+  else
+    {
+      g_warning ("Unhandled spa buffer type: %d", spa_buffer->datas[0].type);
+      return FALSE;
+    }
+
+  /* CPU access to a mapped DMA buffer must be bracketed, so that caches
+   * are flushed for the devices that read from it. */
+  if (is_dma_buf)
+    sync_dma_buf (spa_buffer->datas[0].fd, DMA_BUF_SYNC_START);
+
+  recorded = meta_screen_cast_stream_src_record_frame (src, data,
+                                                       redraw_region);
+
+  maybe_record_cursor (src, spa_buffer, data);
+
+  if (is_dma_buf)
+    sync_dma_buf (spa_buffer->datas[0].fd, DMA_BUF_SYNC_END);
+
+  return recorded;
+}
+
 void
 meta_screen_cast_stream_src_maybe_record_frame (MetaScreenCastStreamSrc *src)
 {
@@ -420,8 +738,9 @@ meta_screen_cast_stream_src_maybe_record_frame (MetaScreenCastStreamSrc *src)
   MetaRectangle crop_rect;
   struct pw_buffer *buffer;
   struct spa_buffer *spa_buffer;
-  uint8_t *map = NULL;
-  uint8_t *data;
+  MetaScreenCastStreamBuffer *stream_buffer;
+  cairo_region_t *redraw_region;
+  gboolean recorded;
   uint64_t now_us;
 
   now_us = g_get_monotonic_time ();
@@ -442,32 +761,15 @@ meta_screen_cast_stream_src_maybe_record_frame (MetaScreenCastStreamSrc *src)
     }
 
   spa_buffer = buffer->buffer;
+  stream_buffer = buffer->user_data;
 
-  if (spa_buffer->datas[0].data)
-    {
-      data = spa_buffer->datas[0].data;
-    }
-  else if (spa_buffer->datas[0].type == priv->pipewire_type->data.MemFd)
-    {
-      map = mmap (NULL, spa_buffer->datas[0].maxsize + spa_buffer->datas[0].mapoffset,
-                  PROT_READ | PROT_WRITE, MAP_SHARED,
-                  spa_buffer->datas[0].fd, 0);
-      if (map == MAP_FAILED)
-        {
-          g_warning ("Failed to mmap pipewire stream buffer: %s\n",
-                     strerror (errno));
-          return;
-        }
+  redraw_region = get_redraw_region (src, stream_buffer);
 
-      data = SPA_MEMBER (map, spa_buffer->datas[0].mapoffset, uint8_t);
-    }
-  else
-    {
-      g_warning ("Unhandled spa buffer type: %d", spa_buffer->datas[0].type);
-      return;
-    }
+  recorded = record_frame_to_memory (src, stream_buffer, redraw_region);
+
+  g_clear_pointer (&redraw_region, cairo_region_destroy);
 
-  if (meta_screen_cast_stream_src_record_frame (src, data))
+  if (recorded)
     {
       struct spa_meta_video_crop *spa_meta_video_crop;
 
@@ -493,19 +795,19 @@ meta_screen_cast_stream_src_maybe_record_frame (MetaScreenCastStreamSrc *src)
               spa_meta_video_crop->height = priv->stream_height;
             }
         }
+
+      add_damage_metadata (src, spa_buffer);
+
+      update_stale_regions (src, stream_buffer);
+      g_clear_pointer (&priv->frame_damage, cairo_region_destroy);
     }
   else
     {
       spa_buffer->datas[0].chunk->size = 0;
     }
 
-  maybe_record_cursor (src, spa_buffer, data);
-
   priv->last_frame_timestamp_us = now_us;
 
-  if (map)
-    munmap (map, spa_buffer->datas[0].maxsize + spa_buffer->datas[0].mapoffset);
-
   pw_stream_queue_buffer (priv->pipewire_stream, buffer);
 }
 
@@ -592,7 +894,7 @@ on_stream_format_changed (void                 *data,
   uint8_t params_buffer[1024];
   int32_t width, height, stride, size;
   struct spa_pod_builder pod_builder;
-  const struct spa_pod *params[3];
+  const struct spa_pod *params[4];
   const int bpp = 4;
 
   if (!format)
@@ -632,6 +934,12 @@ on_stream_format_changed (void                 *data,
     ":", pipewire_type->param_meta.type, "I", priv->spa_type.meta_cursor,
     ":", pipewire_type->param_meta.size, "i", CURSOR_META_SIZE (64, 64));
 
+  params[3] = spa_pod_builder_object (
+    &pod_builder,
+    pipewire_type->param.idMeta, pipewire_type->param_meta.Meta,
+    ":", pipewire_type->param_meta.type, "I", priv->spa_type.meta_video_damage,
+    ":", pipewire_type->param_meta.size, "i", DAMAGE_META_SIZE);
+
   pw_stream_finish_format (priv->pipewire_stream, 0,
                            params, G_N_ELEMENTS (params));
 }
@@ -640,6 +948,8 @@ static const struct pw_stream_events stream_events = {
   PW_VERSION_STREAM_EVENTS,
   .state_changed = on_stream_state_changed,
   .format_changed = on_stream_format_changed,
+  .add_buffer = on_stream_add_buffer,
+  .remove_buffer = on_stream_remove_buffer,
 };
 
 static struct pw_stream *
@@ -802,6 +1112,8 @@ init_spa_type (MetaSpaType         *type,
   spa_type_format_video_map (map, &type->format_video);
   spa_type_video_format_map (map, &type->video_format);
   type->meta_cursor = spa_type_map_get_id(map, SPA_TYPE_META__Cursor);
+  type->meta_video_damage = spa_type_map_get_id (map,
+                                                 META_SPA_TYPE_META__VideoDamage);
 }
 
 static MetaPipeWireSource *
@@ -912,6 +1224,10 @@ meta_screen_cast_stream_src_finalize (GObject *object)
     meta_screen_cast_stream_src_disable (src);
 
   g_clear_pointer (&priv->pipewire_stream, pw_stream_destroy);
+  g_list_free_full (priv->buffers,
+                    (GDestroyNotify) meta_screen_cast_stream_buffer_free);
+  priv->buffers = NULL;
+  g_clear_pointer (&priv->frame_damage, cairo_region_destroy);
   g_clear_pointer (&priv->pipewire_remote, pw_remote_destroy);
   g_clear_pointer (&priv->pipewire_core, pw_core_destroy);
   g_source_destroy (&priv->pipewire_source->base);
@@ -264,6 +264,8 @@ experimental_features_handler (GVariant *features_variant,
         features |= META_EXPERIMENTAL_FEATURE_SCALE_MONITOR_FRAMEBUFFER;
       else if (g_str_equal (feature, "kms-modifiers"))
         features |= META_EXPERIMENTAL_FEATURE_KMS_MODIFIERS;
+      else if (g_str_equal (feature, "xwayland-on-demand"))
+        features |= META_EXPERIMENTAL_FEATURE_XWAYLAND_ON_DEMAND;
       else
         g_info ("Unknown experimental feature '%s'\n", feature);
     }
@@ -43,6 +43,9 @@ void              meta_stage_update_cursor_overlay   (MetaStage   *stage,
 void meta_stage_set_active (MetaStage *stage,
                             gboolean   is_active);
 
+gboolean meta_stage_has_visible_overlays (MetaStage   *stage,
+                                          ClutterRect *rect);
+
 G_END_DECLS
 
 #endif /* META_STAGE_PRIVATE_H */
@@ -308,6 +308,34 @@ meta_stage_update_cursor_overlay (MetaStage   *stage,
   queue_redraw_for_overlay (stage, overlay);
 }
 
+/**
+ * meta_stage_has_visible_overlays:
+ * @stage: a #MetaStage
+ * @rect: an area of the stage, in stage coordinates
+ *
+ * Returns whether any overlay, such as a cursor not shown using a hardware
+ * cursor plane, is painted on top of the given area of the stage.
+ */
+gboolean
+meta_stage_has_visible_overlays (MetaStage   *stage,
+                                 ClutterRect *rect)
+{
+  GList *l;
+
+  for (l = stage->overlays; l; l = l->next)
+    {
+      MetaOverlay *overlay = l->data;
+
+      if (!overlay->enabled)
+        continue;
+
+      if (clutter_rect_intersection (&overlay->current_rect, rect, NULL))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
 void
 meta_stage_set_active (MetaStage *stage,
                        gboolean   is_active)
@@ -321,6 +321,85 @@ relative_motion_filter (ClutterInputDevice *device,
   *dy = new_dy;
 }
 
+static void
+cursor_position_callback (float    x,
+                          float    y,
+                          gpointer user_data)
+{
+  MetaCursorRendererNative *cursor_renderer_native = user_data;
+
+  meta_cursor_renderer_native_set_input_position (cursor_renderer_native,
+                                                  x, y);
+}
+
+static gboolean
+is_relative_motion_filtered (MetaMonitorManager *monitor_manager)
+{
+  GList *l;
+
+  if (meta_is_stage_views_scaled ())
+    return FALSE;
+
+  for (l = meta_monitor_manager_get_logical_monitors (monitor_manager);
+       l;
+       l = l->next)
+    {
+      MetaLogicalMonitor *logical_monitor = l->data;
+
+      if (logical_monitor->scale != 1.0)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/*
+ * The input thread moves the cursor by the raw motion, before barriers,
+ * the client pointer constraint and the relative motion filter had a say.
+ * While any of them may apply, the cursor only follows the motion events.
+ */
+void
+meta_backend_native_update_cursor_position_inhibited (MetaBackendNative *native)
+{
+  MetaBackend *backend = META_BACKEND (native);
+  MetaBackendNativePrivate *priv =
+    meta_backend_native_get_instance_private (native);
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+  ClutterDeviceManager *manager = clutter_device_manager_get_default ();
+  gboolean inhibited;
+
+  if (!manager)
+    return;
+
+  inhibited =
+    meta_barrier_manager_native_has_barriers (priv->barrier_manager) ||
+    meta_backend_get_client_pointer_constraint (backend) ||
+    (monitor_manager && is_relative_motion_filtered (monitor_manager));
+
+  clutter_evdev_set_cursor_position_inhibited (manager, inhibited);
+}
+
+static void
+on_monitors_changed (MetaMonitorManager *monitor_manager,
+                     MetaBackendNative  *native)
+{
+  meta_backend_native_update_cursor_position_inhibited (native);
+}
+
+static void
+on_power_save_changed (MetaMonitorManager *monitor_manager,
+                       MetaBackend        *backend)
+{
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+  MetaStageNative *stage_native;
+
+  /* Flips that were pending when the outputs were turned off or on may
+   * never complete */
+  stage_native = meta_clutter_backend_native_get_stage_native (clutter_backend);
+  _clutter_stage_cogl_reset_pending_frames (CLUTTER_STAGE_COGL (stage_native));
+}
+
 static ClutterBackend *
 meta_backend_native_create_clutter_backend (MetaBackend *backend)
 {
@@ -331,13 +410,30 @@ static void
 meta_backend_native_post_init (MetaBackend *backend)
 {
   ClutterDeviceManager *manager = clutter_device_manager_get_default ();
+  MetaCursorRenderer *cursor_renderer;
 
   META_BACKEND_CLASS (meta_backend_native_parent_class)->post_init (backend);
 
+  cursor_renderer = meta_backend_get_cursor_renderer (backend);
+
   clutter_evdev_set_pointer_constrain_callback (manager, pointer_constrain_callback,
                                                 NULL, NULL);
   clutter_evdev_set_relative_motion_filter (manager, relative_motion_filter,
                                             meta_backend_get_monitor_manager (backend));
+  clutter_evdev_set_cursor_position_callback (manager, cursor_position_callback,
+                                              g_object_ref (cursor_renderer),
+                                              g_object_unref);
+
+  g_signal_connect_object (meta_backend_get_monitor_manager (backend),
+                           "monitors-changed-internal",
+                           G_CALLBACK (on_monitors_changed),
+                           backend, 0);
+  g_signal_connect_object (meta_backend_get_monitor_manager (backend),
+                           "power-save-mode-changed",
+                           G_CALLBACK (on_power_save_changed),
+                           backend, 0);
+  meta_backend_native_update_cursor_position_inhibited (
+    META_BACKEND_NATIVE (backend));
 }
 
 static MetaMonitorManager *
@@ -552,6 +552,9 @@ _meta_barrier_impl_native_destroy (MetaBarrierImpl *impl)
 
   g_hash_table_remove (self->manager->barriers, self);
   self->is_active = FALSE;
+
+  meta_backend_native_update_cursor_position_inhibited (
+    META_BACKEND_NATIVE (meta_get_backend ()));
 }
 
 MetaBarrierImpl *
@@ -571,6 +574,8 @@ meta_barrier_impl_native_new (MetaBarrier *barrier)
   self->manager = manager;
   g_hash_table_add (manager->barriers, self);
 
+  meta_backend_native_update_cursor_position_inhibited (native);
+
   return META_BARRIER_IMPL (self);
 }
 
@@ -589,6 +594,12 @@ meta_barrier_impl_native_init (MetaBarrierImplNative *self)
 {
 }
 
+gboolean
+meta_barrier_manager_native_has_barriers (MetaBarrierManagerNative *manager)
+{
+  return g_hash_table_size (manager->barriers) > 0;
+}
+
 MetaBarrierManagerNative *
 meta_barrier_manager_native_new (void)
 {
@@ -38,10 +38,78 @@
 #define ALL_TRANSFORMS (META_MONITOR_TRANSFORM_FLIPPED_270 + 1)
 #define ALL_TRANSFORMS_MASK ((1 << ALL_TRANSFORMS) - 1)
 
+typedef enum _MetaKmsPlaneProp
+{
+  META_KMS_PLANE_PROP_FB_ID,
+  META_KMS_PLANE_PROP_CRTC_ID,
+  META_KMS_PLANE_PROP_SRC_X,
+  META_KMS_PLANE_PROP_SRC_Y,
+  META_KMS_PLANE_PROP_SRC_W,
+  META_KMS_PLANE_PROP_SRC_H,
+  META_KMS_PLANE_PROP_CRTC_X,
+  META_KMS_PLANE_PROP_CRTC_Y,
+  META_KMS_PLANE_PROP_CRTC_W,
+  META_KMS_PLANE_PROP_CRTC_H,
+
+  META_KMS_PLANE_N_PROPS
+} MetaKmsPlaneProp;
+
+static const char *kms_plane_prop_names[META_KMS_PLANE_N_PROPS] = {
+  [META_KMS_PLANE_PROP_FB_ID] = "FB_ID",
+  [META_KMS_PLANE_PROP_CRTC_ID] = "CRTC_ID",
+  [META_KMS_PLANE_PROP_SRC_X] = "SRC_X",
+  [META_KMS_PLANE_PROP_SRC_Y] = "SRC_Y",
+  [META_KMS_PLANE_PROP_SRC_W] = "SRC_W",
+  [META_KMS_PLANE_PROP_SRC_H] = "SRC_H",
+  [META_KMS_PLANE_PROP_CRTC_X] = "CRTC_X",
+  [META_KMS_PLANE_PROP_CRTC_Y] = "CRTC_Y",
+  [META_KMS_PLANE_PROP_CRTC_W] = "CRTC_W",
+  [META_KMS_PLANE_PROP_CRTC_H] = "CRTC_H",
+};
+
+typedef struct _MetaCrtcKmsPlane
+{
+  uint32_t id;
+
+  /* 0 for properties the plane doesn't have */
+  uint32_t prop_ids[META_KMS_PLANE_N_PROPS];
+
+  /* uint32_t DRM formats; only known for overlay planes */
+  GArray *formats;
+} MetaCrtcKmsPlane;
+
 typedef struct _MetaCrtcKms
 {
   unsigned int index;
   uint32_t primary_plane_id;
+  MetaCrtcKmsPlane primary_plane;
+  GList *overlay_planes;
+  MetaCrtcKmsPlane *cursor_plane;
+
+  /* CRTC properties needed for atomic mode setting; 0 if missing */
+  uint32_t mode_id_prop_id;
+  uint32_t active_prop_id;
+
+  /* The cursor plane state, and whether it changed since it was last
+   * committed */
+  uint32_t cursor_fb_id;
+  int cursor_width;
+  int cursor_height;
+  int cursor_x;
+  int cursor_y;
+  gboolean cursor_dirty;
+
+  /* Whether a flip or a cursor-only commit is waiting for its event */
+  gboolean flip_pending;
+  gboolean cursor_commit_pending;
+
+  /* The overlay assignment to use in the next flip, if any */
+  gboolean has_overlay_assignment;
+  MetaCrtcKmsPlaneAssignment overlay_assignment;
+
+  /* The overlay plane scanning out a client buffer, as of the last flip */
+  MetaCrtcKmsPlane *active_overlay_plane;
+
   uint32_t rotation_prop_id;
   uint32_t rotation_map[ALL_TRANSFORMS];
   uint32_t all_hw_transforms;
@@ -118,6 +186,10 @@ meta_crtc_kms_apply_transform (MetaCrtc *crtc)
   if (!meta_crtc_kms_is_transform_handled (crtc, META_MONITOR_TRANSFORM_NORMAL))
     return;
 
+  /* With atomic mode setting the rotation is part of the mode set */
+  if (meta_gpu_kms_is_atomic (gpu_kms))
+    return;
+
   if (drmModeObjectSetProperty (kms_fd,
                                 crtc_kms->primary_plane_id,
                                 DRM_MODE_OBJECT_PLANE,
@@ -166,6 +238,596 @@ find_property_index (MetaGpu                    *gpu,
   return -1;
 }
 
+static void
+init_plane_props (MetaGpu                    *gpu,
+                  drmModeObjectPropertiesPtr  props,
+                  MetaCrtcKmsPlane           *plane)
+{
+  int i;
+
+  for (i = 0; i < META_KMS_PLANE_N_PROPS; i++)
+    {
+      drmModePropertyPtr prop;
+      int idx;
+
+      idx = find_property_index (gpu, props, kms_plane_prop_names[i], &prop);
+      if (idx < 0)
+        continue;
+
+      plane->prop_ids[i] = props->props[idx];
+      drmModeFreeProperty (prop);
+    }
+}
+
+static gboolean
+plane_has_all_props (MetaCrtcKmsPlane *plane)
+{
+  int i;
+
+  for (i = 0; i < META_KMS_PLANE_N_PROPS; i++)
+    {
+      if (plane->prop_ids[i] == 0)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+meta_crtc_kms_plane_free (MetaCrtcKmsPlane *plane)
+{
+  g_clear_pointer (&plane->formats, g_array_unref);
+  g_free (plane);
+}
+
+static void
+add_plane_property (drmModeAtomicReq *req,
+                    MetaCrtcKmsPlane *plane,
+                    MetaKmsPlaneProp  prop,
+                    uint64_t          value)
+{
+  drmModeAtomicAddProperty (req, plane->id, plane->prop_ids[prop], value);
+}
+
+static void
+add_plane_off_to_request (drmModeAtomicReq *req,
+                          MetaCrtcKmsPlane *plane)
+{
+  add_plane_property (req, plane, META_KMS_PLANE_PROP_FB_ID, 0);
+  add_plane_property (req, plane, META_KMS_PLANE_PROP_CRTC_ID, 0);
+}
+
+static MetaCrtcKmsPlane *
+find_overlay_plane (MetaCrtcKms *crtc_kms,
+                    uint32_t     drm_format)
+{
+  GList *l;
+
+  for (l = crtc_kms->overlay_planes; l; l = l->next)
+    {
+      MetaCrtcKmsPlane *plane = l->data;
+      unsigned int i;
+
+      for (i = 0; i < plane->formats->len; i++)
+        {
+          if (g_array_index (plane->formats, uint32_t, i) == drm_format)
+            return plane;
+        }
+    }
+
+  return NULL;
+}
+
+/**
+ * meta_crtc_kms_supports_atomic_flip:
+ * @crtc: a #MetaCrtc object that has to be a #MetaCrtcKms
+ *
+ * Returns TRUE if the CRTC's primary plane exposes all the properties
+ * needed to flip it with an atomic commit.
+ */
+gboolean
+meta_crtc_kms_supports_atomic_flip (MetaCrtc *crtc)
+{
+  MetaCrtcKms *crtc_kms = crtc->driver_private;
+
+  return (crtc_kms->primary_plane.id != 0 &&
+          plane_has_all_props (&crtc_kms->primary_plane));
+}
+
+/**
+ * meta_crtc_kms_has_overlay_plane:
+ * @crtc: a #MetaCrtc object that has to be a #MetaCrtcKms
+ * @drm_format: a DRM pixel format
+ *
+ * Returns TRUE if the CRTC has an overlay plane that can scan out
+ * buffers of the given format.
+ */
+gboolean
+meta_crtc_kms_has_overlay_plane (MetaCrtc *crtc,
+                                 uint32_t  drm_format)
+{
+  MetaCrtcKms *crtc_kms = crtc->driver_private;
+
+  return find_overlay_plane (crtc_kms, drm_format) != NULL;
+}
+
+/**
+ * meta_crtc_kms_assign_overlay:
+ * @crtc: a #MetaCrtc object that has to be a #MetaCrtcKms
+ * @assignment: (nullable): the buffer to scan out on an overlay plane
+ *
+ * Sets the buffer to put on an overlay plane, above the primary plane,
+ * with the next atomic flip of the CRTC. The assignment is consumed by
+ * that flip. If the driver rejects it, the flip happens without it; use
+ * meta_crtc_kms_is_overlay_active() afterwards to find out whether the
+ * buffer was actually scanned out.
+ */
+void
+meta_crtc_kms_assign_overlay (MetaCrtc                         *crtc,
+                              const MetaCrtcKmsPlaneAssignment *assignment)
+{
+  MetaCrtcKms *crtc_kms = crtc->driver_private;
+
+  if (assignment)
+    {
+      crtc_kms->overlay_assignment = *assignment;
+      crtc_kms->has_overlay_assignment = TRUE;
+    }
+  else
+    {
+      crtc_kms->has_overlay_assignment = FALSE;
+    }
+}
+
+/**
+ * meta_crtc_kms_has_overlay_assignment:
+ * @crtc: a #MetaCrtc object that has to be a #MetaCrtcKms
+ *
+ * Returns TRUE if the next flip of the CRTC has a buffer assigned to an
+ * overlay plane that can scan it out.
+ */
+gboolean
+meta_crtc_kms_has_overlay_assignment (MetaCrtc *crtc)
+{
+  MetaCrtcKms *crtc_kms = crtc->driver_private;
+
+  return (crtc_kms->has_overlay_assignment &&
+          find_overlay_plane (crtc_kms,
+                              crtc_kms->overlay_assignment.drm_format));
+}
+
+/**
+ * meta_crtc_kms_is_overlay_active:
+ * @crtc: a #MetaCrtc object that has to be a #MetaCrtcKms
+ *
+ * Returns TRUE if the last flip of the CRTC put a buffer on an overlay
+ * plane.
+ */
+gboolean
+meta_crtc_kms_is_overlay_active (MetaCrtc *crtc)
+{
+  MetaCrtcKms *crtc_kms = crtc->driver_private;
+
+  return crtc_kms->active_overlay_plane != NULL;
+}
+
+/**
+ * meta_crtc_kms_add_flip_to_request:
+ * @crtc: a #MetaCrtc object that has to be a #MetaCrtcKms
+ * @req: the atomic request to add to
+ * @fb_id: the framebuffer to put on the primary plane
+ * @with_overlay: whether to include the pending overlay assignment
+ *
+ * Adds the plane state of a flip of the CRTC to @req. Overlay planes
+ * that were in use but aren't any longer are turned off.
+ *
+ * Returns TRUE if the pending overlay assignment was added.
+ */
+gboolean
+meta_crtc_kms_add_flip_to_request (MetaCrtc         *crtc,
+                                   drmModeAtomicReq *req,
+                                   uint32_t          fb_id,
+                                   gboolean          with_overlay)
+{
+  MetaCrtcKms *crtc_kms = crtc->driver_private;
+  MetaCrtcKmsPlane *primary_plane = &crtc_kms->primary_plane;
+  MetaCrtcKmsPlane *overlay_plane = NULL;
+
+  add_plane_property (req, primary_plane, META_KMS_PLANE_PROP_FB_ID, fb_id);
+  add_plane_property (req, primary_plane, META_KMS_PLANE_PROP_CRTC_ID,
+                      crtc->crtc_id);
+
+  if (with_overlay && crtc_kms->has_overlay_assignment)
+    {
+      MetaCrtcKmsPlaneAssignment *assignment = &crtc_kms->overlay_assignment;
+
+      overlay_plane = find_overlay_plane (crtc_kms, assignment->drm_format);
+    }
+
+  if (overlay_plane)
+    {
+      MetaCrtcKmsPlaneAssignment *assignment = &crtc_kms->overlay_assignment;
+
+      add_plane_property (req, overlay_plane, META_KMS_PLANE_PROP_FB_ID,
+                          assignment->fb_id);
+      add_plane_property (req, overlay_plane, META_KMS_PLANE_PROP_CRTC_ID,
+                          crtc->crtc_id);
+
+      /* Source coordinates are in 16.16 fixed point */
+      add_plane_property (req, overlay_plane, META_KMS_PLANE_PROP_SRC_X,
+                          (uint64_t) assignment->src_rect.x << 16);
+      add_plane_property (req, overlay_plane, META_KMS_PLANE_PROP_SRC_Y,
+                          (uint64_t) assignment->src_rect.y << 16);
+      add_plane_property (req, overlay_plane, META_KMS_PLANE_PROP_SRC_W,
+                          (uint64_t) assignment->src_rect.width << 16);
+      add_plane_property (req, overlay_plane, META_KMS_PLANE_PROP_SRC_H,
+                          (uint64_t) assignment->src_rect.height << 16);
+      add_plane_property (req, overlay_plane, META_KMS_PLANE_PROP_CRTC_X,
+                          assignment->dst_rect.x);
+      add_plane_property (req, overlay_plane, META_KMS_PLANE_PROP_CRTC_Y,
+                          assignment->dst_rect.y);
+      add_plane_property (req, overlay_plane, META_KMS_PLANE_PROP_CRTC_W,
+                          assignment->dst_rect.width);
+      add_plane_property (req, overlay_plane, META_KMS_PLANE_PROP_CRTC_H,
+                          assignment->dst_rect.height);
+    }
+
+  if (crtc_kms->active_overlay_plane &&
+      crtc_kms->active_overlay_plane != overlay_plane)
+    add_plane_off_to_request (req, crtc_kms->active_overlay_plane);
+
+  /* Cursor changes that couldn't be committed on their own go along */
+  meta_crtc_kms_add_cursor_to_request (crtc, req);
+
+  return overlay_plane != NULL;
+}
+
+/**
+ * meta_crtc_kms_flip_committed:
+ * @crtc: a #MetaCrtc object that has to be a #MetaCrtcKms
+ * @with_overlay: whether the committed flip included the overlay assignment
+ *
+ * Updates the overlay and cursor plane state after a flip built with
+ * meta_crtc_kms_add_flip_to_request() was committed, and consumes the
+ * pending overlay assignment.
+ */
+void
+meta_crtc_kms_flip_committed (MetaCrtc *crtc,
+                              gboolean  with_overlay)
+{
+  MetaCrtcKms *crtc_kms = crtc->driver_private;
+
+  crtc_kms->cursor_dirty = FALSE;
+  crtc_kms->flip_pending = TRUE;
+
+  if (with_overlay)
+    {
+      crtc_kms->active_overlay_plane =
+        find_overlay_plane (crtc_kms,
+                            crtc_kms->overlay_assignment.drm_format);
+    }
+  else
+    {
+      crtc_kms->active_overlay_plane = NULL;
+    }
+
+  crtc_kms->has_overlay_assignment = FALSE;
+}
+
+/**
+ * meta_crtc_kms_flipped_legacy:
+ * @crtc: a #MetaCrtc object that has to be a #MetaCrtcKms
+ *
+ * Notes that the CRTC was flipped without an atomic commit, turning off
+ * any overlay plane still showing a client buffer, as the legacy flip
+ * leaves it alone.
+ */
+void
+meta_crtc_kms_flipped_legacy (MetaCrtc *crtc)
+{
+  MetaCrtcKms *crtc_kms = crtc->driver_private;
+
+  crtc_kms->has_overlay_assignment = FALSE;
+
+  if (crtc_kms->active_overlay_plane)
+    {
+      MetaGpuKms *gpu_kms = META_GPU_KMS (meta_crtc_get_gpu (crtc));
+      int kms_fd = meta_gpu_kms_get_fd (gpu_kms);
+
+      if (drmModeSetPlane (kms_fd, crtc_kms->active_overlay_plane->id,
+                           crtc->crtc_id, 0, 0,
+                           0, 0, 0, 0,
+                           0, 0, 0, 0) != 0)
+        g_warning ("Failed to turn off overlay plane: %m");
+
+      crtc_kms->active_overlay_plane = NULL;
+    }
+}
+
+/**
+ * meta_crtc_kms_supports_atomic_mode_set:
+ * @crtc: a #MetaCrtc object that has to be a #MetaCrtcKms
+ *
+ * Returns TRUE if the CRTC and its primary plane expose all the
+ * properties needed to set a mode with an atomic commit.
+ */
+gboolean
+meta_crtc_kms_supports_atomic_mode_set (MetaCrtc *crtc)
+{
+  MetaCrtcKms *crtc_kms = crtc->driver_private;
+
+  return (meta_crtc_kms_supports_atomic_flip (crtc) &&
+          crtc_kms->mode_id_prop_id != 0 &&
+          crtc_kms->active_prop_id != 0);
+}
+
+/**
+ * meta_crtc_kms_add_mode_set_to_request:
+ * @crtc: a #MetaCrtc object that has to be a #MetaCrtcKms
+ * @req: the atomic request to add to
+ * @mode_blob_id: the property blob holding the mode, or 0 to disable
+ * @mode: (nullable): the mode in @mode_blob_id
+ * @x: the x offset into the framebuffer
+ * @y: the y offset into the framebuffer
+ * @fb_id: the framebuffer to put on the primary plane
+ *
+ * Adds the CRTC and plane state of a mode set to @req. When disabling
+ * the CRTC, all of its planes are turned off as well.
+ */
+void
+meta_crtc_kms_add_mode_set_to_request (MetaCrtc              *crtc,
+                                       drmModeAtomicReq      *req,
+                                       uint32_t               mode_blob_id,
+                                       const drmModeModeInfo *mode,
+                                       int                    x,
+                                       int                    y,
+                                       uint32_t               fb_id)
+{
+  MetaCrtcKms *crtc_kms = crtc->driver_private;
+  MetaCrtcKmsPlane *primary_plane = &crtc_kms->primary_plane;
+  MetaMonitorTransform hw_transform;
+  int src_width, src_height;
+
+  drmModeAtomicAddProperty (req, crtc->crtc_id,
+                            crtc_kms->mode_id_prop_id, mode_blob_id);
+  drmModeAtomicAddProperty (req, crtc->crtc_id,
+                            crtc_kms->active_prop_id, mode ? 1 : 0);
+
+  if (!mode)
+    {
+      add_plane_off_to_request (req, primary_plane);
+
+      if (crtc_kms->active_overlay_plane)
+        add_plane_off_to_request (req, crtc_kms->active_overlay_plane);
+      crtc_kms->active_overlay_plane = NULL;
+      crtc_kms->has_overlay_assignment = FALSE;
+
+      if (crtc_kms->cursor_plane)
+        add_plane_off_to_request (req, crtc_kms->cursor_plane);
+      crtc_kms->cursor_fb_id = 0;
+      crtc_kms->cursor_dirty = FALSE;
+      return;
+    }
+
+  if (crtc_kms->all_hw_transforms & (1 << crtc->transform))
+    hw_transform = crtc->transform;
+  else
+    hw_transform = META_MONITOR_TRANSFORM_NORMAL;
+
+  if (meta_monitor_transform_is_rotated (hw_transform))
+    {
+      src_width = mode->vdisplay;
+      src_height = mode->hdisplay;
+    }
+  else
+    {
+      src_width = mode->hdisplay;
+      src_height = mode->vdisplay;
+    }
+
+  add_plane_property (req, primary_plane, META_KMS_PLANE_PROP_FB_ID, fb_id);
+  add_plane_property (req, primary_plane, META_KMS_PLANE_PROP_CRTC_ID,
+                      crtc->crtc_id);
+  /* Source coordinates are in 16.16 fixed point */
+  add_plane_property (req, primary_plane, META_KMS_PLANE_PROP_SRC_X,
+                      (uint64_t) x << 16);
+  add_plane_property (req, primary_plane, META_KMS_PLANE_PROP_SRC_Y,
+                      (uint64_t) y << 16);
+  add_plane_property (req, primary_plane, META_KMS_PLANE_PROP_SRC_W,
+                      (uint64_t) src_width << 16);
+  add_plane_property (req, primary_plane, META_KMS_PLANE_PROP_SRC_H,
+                      (uint64_t) src_height << 16);
+  add_plane_property (req, primary_plane, META_KMS_PLANE_PROP_CRTC_X, 0);
+  add_plane_property (req, primary_plane, META_KMS_PLANE_PROP_CRTC_Y, 0);
+  add_plane_property (req, primary_plane, META_KMS_PLANE_PROP_CRTC_W,
+                      mode->hdisplay);
+  add_plane_property (req, primary_plane, META_KMS_PLANE_PROP_CRTC_H,
+                      mode->vdisplay);
+
+  if (crtc_kms->rotation_prop_id)
+    drmModeAtomicAddProperty (req, primary_plane->id,
+                              crtc_kms->rotation_prop_id,
+                              crtc_kms->rotation_map[hw_transform]);
+}
+
+/**
+ * meta_crtc_kms_has_cursor_plane:
+ * @crtc: a #MetaCrtc object that has to be a #MetaCrtcKms
+ *
+ * Returns TRUE if the CRTC has a cursor plane that can be updated with
+ * atomic commits.
+ */
+gboolean
+meta_crtc_kms_has_cursor_plane (MetaCrtc *crtc)
+{
+  MetaCrtcKms *crtc_kms = crtc->driver_private;
+
+  return crtc_kms->cursor_plane != NULL;
+}
+
+/**
+ * meta_crtc_kms_set_cursor:
+ * @crtc: a #MetaCrtc object that has to be a #MetaCrtcKms
+ * @fb_id: the framebuffer holding the cursor image, or 0 to hide it
+ * @width: the width of the framebuffer
+ * @height: the height of the framebuffer
+ *
+ * Sets the image of the cursor plane. The change is only recorded; it
+ * takes effect with the next atomic commit that includes the cursor
+ * plane, see meta_gpu_kms_update_cursor().
+ */
+void
+meta_crtc_kms_set_cursor (MetaCrtc *crtc,
+                          uint32_t  fb_id,
+                          int       width,
+                          int       height)
+{
+  MetaCrtcKms *crtc_kms = crtc->driver_private;
+
+  if (crtc_kms->cursor_fb_id == fb_id &&
+      crtc_kms->cursor_width == width &&
+      crtc_kms->cursor_height == height)
+    return;
+
+  crtc_kms->cursor_fb_id = fb_id;
+  crtc_kms->cursor_width = width;
+  crtc_kms->cursor_height = height;
+  crtc_kms->cursor_dirty = TRUE;
+}
+
+/**
+ * meta_crtc_kms_move_cursor:
+ * @crtc: a #MetaCrtc object that has to be a #MetaCrtcKms
+ * @x: the x position of the cursor, in CRTC pixels
+ * @y: the y position of the cursor, in CRTC pixels
+ *
+ * Sets the position of the cursor plane, like meta_crtc_kms_set_cursor().
+ */
+void
+meta_crtc_kms_move_cursor (MetaCrtc *crtc,
+                           int       x,
+                           int       y)
+{
+  MetaCrtcKms *crtc_kms = crtc->driver_private;
+
+  if (crtc_kms->cursor_x == x && crtc_kms->cursor_y == y)
+    return;
+
+  crtc_kms->cursor_x = x;
+  crtc_kms->cursor_y = y;
+  crtc_kms->cursor_dirty = TRUE;
+}
+
+/**
+ * meta_crtc_kms_add_cursor_to_request:
+ * @crtc: a #MetaCrtc object that has to be a #MetaCrtcKms
+ * @req: the atomic request to add to
+ *
+ * Adds the cursor plane state to @req if it changed since it was last
+ * committed.
+ *
+ * Returns TRUE if anything was added.
+ */
+gboolean
+meta_crtc_kms_add_cursor_to_request (MetaCrtc         *crtc,
+                                     drmModeAtomicReq *req)
+{
+  MetaCrtcKms *crtc_kms = crtc->driver_private;
+  MetaCrtcKmsPlane *plane = crtc_kms->cursor_plane;
+
+  if (!plane || !crtc_kms->cursor_dirty)
+    return FALSE;
+
+  if (crtc_kms->cursor_fb_id == 0)
+    {
+      add_plane_off_to_request (req, plane);
+      return TRUE;
+    }
+
+  add_plane_property (req, plane, META_KMS_PLANE_PROP_FB_ID,
+                      crtc_kms->cursor_fb_id);
+  add_plane_property (req, plane, META_KMS_PLANE_PROP_CRTC_ID, crtc->crtc_id);
+  add_plane_property (req, plane, META_KMS_PLANE_PROP_SRC_X, 0);
+  add_plane_property (req, plane, META_KMS_PLANE_PROP_SRC_Y, 0);
+  add_plane_property (req, plane, META_KMS_PLANE_PROP_SRC_W,
+                      (uint64_t) crtc_kms->cursor_width << 16);
+  add_plane_property (req, plane, META_KMS_PLANE_PROP_SRC_H,
+                      (uint64_t) crtc_kms->cursor_height << 16);
+  /* CRTC_X and CRTC_Y are signed, the cursor may hang off the top left */
+  add_plane_property (req, plane, META_KMS_PLANE_PROP_CRTC_X,
+                      (uint64_t) (int64_t) crtc_kms->cursor_x);
+  add_plane_property (req, plane, META_KMS_PLANE_PROP_CRTC_Y,
+                      (uint64_t) (int64_t) crtc_kms->cursor_y);
+  add_plane_property (req, plane, META_KMS_PLANE_PROP_CRTC_W,
+                      crtc_kms->cursor_width);
+  add_plane_property (req, plane, META_KMS_PLANE_PROP_CRTC_H,
+                      crtc_kms->cursor_height);
+
+  return TRUE;
+}
+
+/**
+ * meta_crtc_kms_cursor_committed:
+ * @crtc: a #MetaCrtc object that has to be a #MetaCrtcKms
+ *
+ * Notes that the cursor plane state added by
+ * meta_crtc_kms_add_cursor_to_request() was committed.
+ */
+void
+meta_crtc_kms_cursor_committed (MetaCrtc *crtc)
+{
+  MetaCrtcKms *crtc_kms = crtc->driver_private;
+
+  crtc_kms->cursor_dirty = FALSE;
+  crtc_kms->cursor_commit_pending = TRUE;
+}
+
+/**
+ * meta_crtc_kms_commit_completed:
+ * @crtc: a #MetaCrtc object that has to be a #MetaCrtcKms
+ *
+ * Notes that the event of the last atomic flip or cursor-only commit on
+ * @crtc arrived, i.e. the CRTC is ready for the next commit.
+ */
+void
+meta_crtc_kms_commit_completed (MetaCrtc *crtc)
+{
+  MetaCrtcKms *crtc_kms = crtc->driver_private;
+
+  crtc_kms->flip_pending = FALSE;
+  crtc_kms->cursor_commit_pending = FALSE;
+}
+
+/**
+ * meta_crtc_kms_is_commit_pending:
+ * @crtc: a #MetaCrtc object that has to be a #MetaCrtcKms
+ *
+ * Returns TRUE if an atomic flip or cursor-only commit on @crtc is still
+ * waiting for its event.
+ */
+gboolean
+meta_crtc_kms_is_commit_pending (MetaCrtc *crtc)
+{
+  MetaCrtcKms *crtc_kms = crtc->driver_private;
+
+  return crtc_kms->flip_pending || crtc_kms->cursor_commit_pending;
+}
+
+/**
+ * meta_crtc_kms_is_cursor_dirty:
+ * @crtc: a #MetaCrtc object that has to be a #MetaCrtcKms
+ *
+ * Returns TRUE if the cursor plane state changed since it was last
+ * committed.
+ */
+gboolean
+meta_crtc_kms_is_cursor_dirty (MetaCrtc *crtc)
+{
+  MetaCrtcKms *crtc_kms = crtc->driver_private;
+
+  return crtc_kms->cursor_plane && crtc_kms->cursor_dirty;
+}
+
 /**
  * meta_crtc_kms_get_modifiers:
  * @crtc: a #MetaCrtc object that has to be a #MetaCrtcKms
@@ -384,8 +1046,9 @@ parse_transforms (MetaCrtc          *crtc,
 }
 
 static gboolean
-is_primary_plane (MetaGpu                   *gpu,
-                  drmModeObjectPropertiesPtr props)
+get_plane_type (MetaGpu                    *gpu,
+                drmModeObjectPropertiesPtr  props,
+                uint64_t                   *type)
 {
   drmModePropertyPtr prop;
   int idx;
@@ -395,7 +1058,38 @@ is_primary_plane (MetaGpu                   *gpu,
     return FALSE;
 
   drmModeFreeProperty (prop);
-  return props->prop_values[idx] == DRM_PLANE_TYPE_PRIMARY;
+  *type = props->prop_values[idx];
+  return TRUE;
+}
+
+static gboolean
+is_primary_plane (MetaGpu                   *gpu,
+                  drmModeObjectPropertiesPtr props)
+{
+  uint64_t type;
+
+  return (get_plane_type (gpu, props, &type) &&
+          type == DRM_PLANE_TYPE_PRIMARY);
+}
+
+static gboolean
+is_overlay_plane (MetaGpu                   *gpu,
+                  drmModeObjectPropertiesPtr props)
+{
+  uint64_t type;
+
+  return (get_plane_type (gpu, props, &type) &&
+          type == DRM_PLANE_TYPE_OVERLAY);
+}
+
+static gboolean
+is_cursor_plane (MetaGpu                   *gpu,
+                 drmModeObjectPropertiesPtr props)
+{
+  uint64_t type;
+
+  return (get_plane_type (gpu, props, &type) &&
+          type == DRM_PLANE_TYPE_CURSOR);
 }
 
 static void
@@ -436,6 +1130,9 @@ init_crtc_rotations (MetaCrtc *crtc,
               int rotation_idx, fmts_idx;
 
               crtc_kms->primary_plane_id = drm_plane->plane_id;
+              crtc_kms->primary_plane.id = drm_plane->plane_id;
+              init_plane_props (gpu, props, &crtc_kms->primary_plane);
+
               rotation_idx = find_property_index (gpu, props,
                                                   "rotation", &prop);
               if (rotation_idx >= 0)
@@ -461,6 +1158,44 @@ init_crtc_rotations (MetaCrtc *crtc,
                                           drm_plane->count_formats);
                 }
             }
+          else if (props && is_overlay_plane (gpu, props))
+            {
+              MetaCrtcKmsPlane *plane;
+
+              plane = g_new0 (MetaCrtcKmsPlane, 1);
+              plane->id = drm_plane->plane_id;
+              init_plane_props (gpu, props, plane);
+
+              if (plane_has_all_props (plane))
+                {
+                  plane->formats = g_array_sized_new (FALSE, FALSE,
+                                                      sizeof (uint32_t),
+                                                      drm_plane->count_formats);
+                  g_array_append_vals (plane->formats,
+                                       drm_plane->formats,
+                                       drm_plane->count_formats);
+                  crtc_kms->overlay_planes =
+                    g_list_append (crtc_kms->overlay_planes, plane);
+                }
+              else
+                {
+                  meta_crtc_kms_plane_free (plane);
+                }
+            }
+          else if (props && is_cursor_plane (gpu, props) &&
+                   !crtc_kms->cursor_plane)
+            {
+              MetaCrtcKmsPlane *plane;
+
+              plane = g_new0 (MetaCrtcKmsPlane, 1);
+              plane->id = drm_plane->plane_id;
+              init_plane_props (gpu, props, plane);
+
+              if (plane_has_all_props (plane))
+                crtc_kms->cursor_plane = plane;
+              else
+                meta_crtc_kms_plane_free (plane);
+            }
 
           if (props)
             drmModeFreeObjectProperties (props);
@@ -482,12 +1217,48 @@ init_crtc_rotations (MetaCrtc *crtc,
     }
 }
 
+static void
+init_crtc_props (MetaCrtc *crtc,
+                 MetaGpu  *gpu)
+{
+  MetaCrtcKms *crtc_kms = crtc->driver_private;
+  MetaGpuKms *gpu_kms = META_GPU_KMS (gpu);
+  drmModeObjectPropertiesPtr props;
+  drmModePropertyPtr prop;
+  int idx;
+
+  props = drmModeObjectGetProperties (meta_gpu_kms_get_fd (gpu_kms),
+                                      crtc->crtc_id,
+                                      DRM_MODE_OBJECT_CRTC);
+  if (!props)
+    return;
+
+  idx = find_property_index (gpu, props, "MODE_ID", &prop);
+  if (idx >= 0)
+    {
+      crtc_kms->mode_id_prop_id = props->props[idx];
+      drmModeFreeProperty (prop);
+    }
+
+  idx = find_property_index (gpu, props, "ACTIVE", &prop);
+  if (idx >= 0)
+    {
+      crtc_kms->active_prop_id = props->props[idx];
+      drmModeFreeProperty (prop);
+    }
+
+  drmModeFreeObjectProperties (props);
+}
+
 static void
 meta_crtc_destroy_notify (MetaCrtc *crtc)
 {
   MetaCrtcKms *crtc_kms = crtc->driver_private;
 
   g_hash_table_destroy (crtc_kms->formats_modifiers);
+  g_list_free_full (crtc_kms->overlay_planes,
+                    (GDestroyNotify) meta_crtc_kms_plane_free);
+  g_clear_pointer (&crtc_kms->cursor_plane, meta_crtc_kms_plane_free);
   g_free (crtc->driver_private);
 }
 
@@ -541,6 +1312,7 @@ meta_create_kms_crtc (MetaGpuKms   *gpu_kms,
   crtc->driver_notify = (GDestroyNotify) meta_crtc_destroy_notify;
 
   init_crtc_rotations (crtc, gpu);
+  init_crtc_props (crtc, gpu);
 
   return crtc;
 }
@@ -29,12 +29,24 @@
 #include "backends/meta-backend-types.h"
 #include "backends/meta-crtc.h"
 #include "backends/native/meta-gpu-kms.h"
+#include "meta/boxes.h"
 
 typedef struct _MetaDrmFormatBuf
 {
   char s[5];
 } MetaDrmFormatBuf;
 
+typedef struct _MetaCrtcKmsPlaneAssignment
+{
+  uint32_t fb_id;
+  uint32_t drm_format;
+
+  /* In buffer pixels */
+  MetaRectangle src_rect;
+  /* In CRTC pixels */
+  MetaRectangle dst_rect;
+} MetaCrtcKmsPlaneAssignment;
+
 const char *
 meta_drm_format_to_string (MetaDrmFormatBuf *tmp,
                            uint32_t          format);
@@ -54,6 +66,60 @@ gboolean
 meta_crtc_kms_supports_format (MetaCrtc *crtc,
                                uint32_t  drm_format);
 
+gboolean meta_crtc_kms_supports_atomic_flip (MetaCrtc *crtc);
+
+gboolean meta_crtc_kms_has_overlay_plane (MetaCrtc *crtc,
+                                          uint32_t  drm_format);
+
+void meta_crtc_kms_assign_overlay (MetaCrtc                         *crtc,
+                                   const MetaCrtcKmsPlaneAssignment *assignment);
+
+gboolean meta_crtc_kms_has_overlay_assignment (MetaCrtc *crtc);
+
+gboolean meta_crtc_kms_is_overlay_active (MetaCrtc *crtc);
+
+gboolean meta_crtc_kms_add_flip_to_request (MetaCrtc         *crtc,
+                                            drmModeAtomicReq *req,
+                                            uint32_t          fb_id,
+                                            gboolean          with_overlay);
+
+void meta_crtc_kms_flip_committed (MetaCrtc *crtc,
+                                   gboolean  with_overlay);
+
+void meta_crtc_kms_flipped_legacy (MetaCrtc *crtc);
+
+gboolean meta_crtc_kms_supports_atomic_mode_set (MetaCrtc *crtc);
+
+void meta_crtc_kms_add_mode_set_to_request (MetaCrtc              *crtc,
+                                            drmModeAtomicReq      *req,
+                                            uint32_t               mode_blob_id,
+                                            const drmModeModeInfo *mode,
+                                            int                    x,
+                                            int                    y,
+                                            uint32_t               fb_id);
+
+gboolean meta_crtc_kms_has_cursor_plane (MetaCrtc *crtc);
+
+void meta_crtc_kms_set_cursor (MetaCrtc *crtc,
+                               uint32_t  fb_id,
+                               int       width,
+                               int       height);
+
+void meta_crtc_kms_move_cursor (MetaCrtc *crtc,
+                                int       x,
+                                int       y);
+
+gboolean meta_crtc_kms_add_cursor_to_request (MetaCrtc         *crtc,
+                                              drmModeAtomicReq *req);
+
+void meta_crtc_kms_cursor_committed (MetaCrtc *crtc);
+
+void meta_crtc_kms_commit_completed (MetaCrtc *crtc);
+
+gboolean meta_crtc_kms_is_commit_pending (MetaCrtc *crtc);
+
+gboolean meta_crtc_kms_is_cursor_dirty (MetaCrtc *crtc);
+
 MetaCrtc * meta_create_kms_crtc (MetaGpuKms   *gpu_kms,
                                  drmModeCrtc  *drm_crtc,
                                  unsigned int  crtc_index);
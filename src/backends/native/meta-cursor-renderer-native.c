@@ -29,6 +29,7 @@
 #include <string.h>
 #include <gbm.h>
 #include <xf86drm.h>
+#include <xf86drmMode.h>
 #include <errno.h>
 
 #include "backends/meta-backend-private.h"
@@ -37,6 +38,7 @@
 #include "backends/meta-monitor.h"
 #include "backends/meta-monitor-manager-private.h"
 #include "backends/meta-output.h"
+#include "backends/native/meta-crtc-kms.h"
 #include "backends/native/meta-renderer-native.h"
 #include "core/boxes-private.h"
 #include "meta/boxes.h"
@@ -84,12 +86,33 @@ struct _MetaCursorRendererNativePrivate
 
   MetaCursorSprite *last_cursor;
   guint animation_timeout_id;
+
+  /* The CRTCs showing the cursor on their atomic cursor plane, which the
+   * input thread moves along with the pointer before the main loop gets
+   * to the motion event. Protected by input_lock. */
+  GMutex input_lock;
+  GArray *input_crtcs;
+  ClutterRect input_cursor_rect;
+  gboolean has_input_position;
+  float input_x;
+  float input_y;
 };
 typedef struct _MetaCursorRendererNativePrivate MetaCursorRendererNativePrivate;
 
+typedef struct _MetaCursorInputCrtc
+{
+  MetaGpuKms *gpu_kms;
+  MetaCrtc *crtc;
+  ClutterRect crtc_rect;
+  float scale;
+} MetaCursorInputCrtc;
+
 typedef struct _MetaCursorRendererNativeGpuData
 {
   gboolean hw_cursor_broken;
+  /* Whether the cursor was last set on the cursor plane with atomic
+   * commits, rather than with the legacy cursor ioctls */
+  gboolean atomic;
 
   uint64_t cursor_width;
   uint64_t cursor_height;
@@ -115,6 +138,12 @@ typedef struct _MetaCursorNativePrivate
   GHashTable *gpu_states;
 } MetaCursorNativePrivate;
 
+typedef struct _MetaCursorBoFb
+{
+  int kms_fd;
+  uint32_t fb_id;
+} MetaCursorBoFb;
+
 static GQuark quark_cursor_renderer_native_gpu_data = 0;
 
 G_DEFINE_TYPE_WITH_PRIVATE (MetaCursorRendererNative, meta_cursor_renderer_native, META_TYPE_CURSOR_RENDERER);
@@ -169,6 +198,9 @@ meta_cursor_renderer_native_finalize (GObject *object)
   if (priv->animation_timeout_id)
     g_source_remove (priv->animation_timeout_id);
 
+  g_array_free (priv->input_crtcs, TRUE);
+  g_mutex_clear (&priv->input_lock);
+
   G_OBJECT_CLASS (meta_cursor_renderer_native_parent_class)->finalize (object);
 }
 
@@ -210,6 +242,103 @@ set_pending_cursor_sprite_gbm_bo (MetaCursorSprite *cursor_sprite,
   cursor_gpu_state->pending_bo_state = META_CURSOR_GBM_BO_STATE_SET;
 }
 
+static void
+disable_hw_cursor (MetaCursorRendererNative        *native,
+                   MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data,
+                   const char                      *reason)
+{
+  MetaCursorRendererNativePrivate *priv =
+    meta_cursor_renderer_native_get_instance_private (native);
+
+  g_warning ("%s, drawing cursor with OpenGL from now on", reason);
+  priv->has_hw_cursor = FALSE;
+  cursor_renderer_gpu_data->hw_cursor_broken = TRUE;
+}
+
+static void
+cursor_bo_fb_destroy (struct gbm_bo *bo,
+                      void          *user_data)
+{
+  MetaCursorBoFb *bo_fb = user_data;
+
+  drmModeRmFB (bo_fb->kms_fd, bo_fb->fb_id);
+  g_free (bo_fb);
+}
+
+static uint32_t
+ensure_cursor_bo_fb_id (MetaGpuKms    *gpu_kms,
+                        struct gbm_bo *bo)
+{
+  MetaCursorBoFb *bo_fb;
+  uint32_t handles[4] = { 0 };
+  uint32_t pitches[4] = { 0 };
+  uint32_t offsets[4] = { 0 };
+  uint32_t fb_id;
+  int kms_fd;
+
+  bo_fb = gbm_bo_get_user_data (bo);
+  if (bo_fb)
+    return bo_fb->fb_id;
+
+  kms_fd = meta_gpu_kms_get_fd (gpu_kms);
+  handles[0] = gbm_bo_get_handle (bo).u32;
+  pitches[0] = gbm_bo_get_stride (bo);
+
+  if (drmModeAddFB2 (kms_fd,
+                     gbm_bo_get_width (bo),
+                     gbm_bo_get_height (bo),
+                     gbm_bo_get_format (bo),
+                     handles, pitches, offsets,
+                     &fb_id, 0) != 0)
+    return 0;
+
+  bo_fb = g_new0 (MetaCursorBoFb, 1);
+  bo_fb->kms_fd = kms_fd;
+  bo_fb->fb_id = fb_id;
+  gbm_bo_set_user_data (bo, bo_fb, cursor_bo_fb_destroy);
+
+  return fb_id;
+}
+
+static void
+set_crtc_cursor_plane (MetaCursorRendererNative *native,
+                       MetaCrtc                 *crtc,
+                       struct gbm_bo            *bo)
+{
+  MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data;
+  MetaGpuKms *gpu_kms;
+  uint32_t fb_id = 0;
+
+  gpu_kms = META_GPU_KMS (meta_crtc_get_gpu (crtc));
+  cursor_renderer_gpu_data =
+    meta_cursor_renderer_native_gpu_data_from_gpu (gpu_kms);
+
+  if (!meta_crtc_kms_has_cursor_plane (crtc))
+    {
+      if (bo)
+        disable_hw_cursor (native, cursor_renderer_gpu_data,
+                           "No cursor plane available");
+      return;
+    }
+
+  if (bo)
+    {
+      fb_id = ensure_cursor_bo_fb_id (gpu_kms, bo);
+      if (!fb_id)
+        {
+          disable_hw_cursor (native, cursor_renderer_gpu_data,
+                             "Failed to add cursor framebuffer");
+          return;
+        }
+    }
+
+  meta_gpu_kms_lock_cursor (gpu_kms);
+  meta_crtc_kms_set_cursor (crtc, fb_id,
+                            cursor_renderer_gpu_data->cursor_width,
+                            cursor_renderer_gpu_data->cursor_height);
+  meta_gpu_kms_unlock_cursor (gpu_kms);
+}
+
 static void
 set_crtc_cursor (MetaCursorRendererNative *native,
                  MetaCrtc                 *crtc,
@@ -250,18 +379,22 @@ set_crtc_cursor (MetaCursorRendererNative *native,
       handle = gbm_bo_get_handle (bo);
       meta_cursor_sprite_get_hotspot (cursor_sprite, &hot_x, &hot_y);
 
-      if (drmModeSetCursor2 (kms_fd, crtc->crtc_id, handle.u32,
-                             cursor_renderer_gpu_data->cursor_width,
-                             cursor_renderer_gpu_data->cursor_height,
-                             hot_x, hot_y) < 0)
+      if (meta_gpu_kms_is_atomic (gpu_kms))
+        {
+          set_crtc_cursor_plane (native, crtc, bo);
+        }
+      else if (drmModeSetCursor2 (kms_fd, crtc->crtc_id, handle.u32,
+                                  cursor_renderer_gpu_data->cursor_width,
+                                  cursor_renderer_gpu_data->cursor_height,
+                                  hot_x, hot_y) < 0)
         {
           if (errno != EACCES)
             {
-              g_warning ("drmModeSetCursor2 failed with (%s), "
-                         "drawing cursor with OpenGL from now on",
-                         strerror (errno));
-              priv->has_hw_cursor = FALSE;
-              cursor_renderer_gpu_data->hw_cursor_broken = TRUE;
+              g_autofree char *reason = NULL;
+
+              reason = g_strdup_printf ("drmModeSetCursor2 failed with (%s)",
+                                        strerror (errno));
+              disable_hw_cursor (native, cursor_renderer_gpu_data, reason);
             }
         }
 
@@ -276,7 +409,10 @@ set_crtc_cursor (MetaCursorRendererNative *native,
     {
       if (priv->hw_state_invalidated || crtc->cursor_renderer_private != NULL)
         {
-          drmModeSetCursor2 (kms_fd, crtc->crtc_id, 0, 0, 0, 0, 0);
+          if (meta_gpu_kms_is_atomic (gpu_kms))
+            set_crtc_cursor_plane (native, crtc, NULL);
+          else
+            drmModeSetCursor2 (kms_fd, crtc->crtc_id, 0, 0, 0, 0, 0);
           crtc->cursor_renderer_private = NULL;
         }
     }
@@ -305,6 +441,7 @@ update_monitor_crtc_cursor (MetaMonitor         *monitor,
   MetaCursorRendererNativePrivate *priv =
     meta_cursor_renderer_native_get_instance_private (cursor_renderer_native);
   MetaCrtc *crtc;
+  MetaGpuKms *gpu_kms;
   MetaMonitorTransform transform;
   ClutterRect scaled_crtc_rect;
   float scale;
@@ -345,13 +482,13 @@ update_monitor_crtc_cursor (MetaMonitor         *monitor,
   };
 
   crtc = meta_output_get_assigned_crtc (monitor_crtc_mode->output);
+  gpu_kms = META_GPU_KMS (meta_monitor_get_gpu (monitor));
 
   if (priv->has_hw_cursor &&
       clutter_rect_intersection (&scaled_crtc_rect,
                                  &data->in_local_cursor_rect,
                                  NULL))
     {
-      MetaGpuKms *gpu_kms;
       int kms_fd;
       float crtc_cursor_x, crtc_cursor_y;
 
@@ -359,16 +496,36 @@ update_monitor_crtc_cursor (MetaMonitor         *monitor,
                        crtc,
                        data->in_cursor_sprite);
 
-      gpu_kms = META_GPU_KMS (meta_monitor_get_gpu (monitor));
       kms_fd = meta_gpu_kms_get_fd (gpu_kms);
       crtc_cursor_x = (data->in_local_cursor_rect.origin.x -
                        scaled_crtc_rect.origin.x) * scale;
       crtc_cursor_y = (data->in_local_cursor_rect.origin.y -
                        scaled_crtc_rect.origin.y) * scale;
-      drmModeMoveCursor (kms_fd,
-                         crtc->crtc_id,
-                         floorf (crtc_cursor_x),
-                         floorf (crtc_cursor_y));
+      if (meta_gpu_kms_is_atomic (gpu_kms))
+        {
+          MetaCursorInputCrtc input_crtc;
+
+          meta_gpu_kms_lock_cursor (gpu_kms);
+          meta_crtc_kms_move_cursor (crtc,
+                                     floorf (crtc_cursor_x),
+                                     floorf (crtc_cursor_y));
+          meta_gpu_kms_unlock_cursor (gpu_kms);
+
+          input_crtc = (MetaCursorInputCrtc) {
+            .gpu_kms = gpu_kms,
+            .crtc = g_object_ref (crtc),
+            .crtc_rect = scaled_crtc_rect,
+            .scale = scale
+          };
+          input_crtc.crtc_rect.origin.x += data->in_logical_monitor->rect.x;
+          input_crtc.crtc_rect.origin.y += data->in_logical_monitor->rect.y;
+          g_array_append_val (priv->input_crtcs, input_crtc);
+        }
+      else
+        drmModeMoveCursor (kms_fd,
+                           crtc->crtc_id,
+                           floorf (crtc_cursor_x),
+                           floorf (crtc_cursor_y));
 
       data->out_painted = data->out_painted || TRUE;
     }
@@ -377,6 +534,29 @@ update_monitor_crtc_cursor (MetaMonitor         *monitor,
       set_crtc_cursor (data->in_cursor_renderer_native, crtc, NULL);
     }
 
+  if (meta_gpu_kms_is_atomic (gpu_kms))
+    {
+      g_autoptr (GError) local_error = NULL;
+      gboolean updated;
+
+      meta_gpu_kms_lock_cursor (gpu_kms);
+      updated = meta_gpu_kms_update_cursor (gpu_kms, crtc, &local_error);
+      meta_gpu_kms_unlock_cursor (gpu_kms);
+
+      if (!updated &&
+          !g_error_matches (local_error, G_IO_ERROR,
+                            G_IO_ERROR_PERMISSION_DENIED))
+        {
+          MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data;
+
+          cursor_renderer_gpu_data =
+            meta_cursor_renderer_native_gpu_data_from_gpu (gpu_kms);
+          disable_hw_cursor (cursor_renderer_native,
+                             cursor_renderer_gpu_data,
+                             local_error->message);
+        }
+    }
+
   return TRUE;
 }
 
@@ -391,6 +571,7 @@ update_hw_cursor (MetaCursorRendererNative *native,
   GList *logical_monitors;
   GList *l;
   ClutterRect rect;
+  ClutterPoint position;
   gboolean painted = FALSE;
 
   if (cursor_sprite)
@@ -398,6 +579,41 @@ update_hw_cursor (MetaCursorRendererNative *native,
   else
     rect = (ClutterRect) { 0 };
 
+  g_mutex_lock (&priv->input_lock);
+
+  position = meta_cursor_renderer_get_position (renderer);
+  priv->input_cursor_rect = rect;
+  priv->input_cursor_rect.origin.x -= position.x;
+  priv->input_cursor_rect.origin.y -= position.y;
+  g_array_set_size (priv->input_crtcs, 0);
+
+  /* The input thread may already have moved the cursor past the position
+   * of the motion event being handled, don't move it back */
+  if (cursor_sprite && priv->has_input_position)
+    {
+      rect.origin.x += priv->input_x - position.x;
+      rect.origin.y += priv->input_y - position.y;
+    }
+
+  /* A device that fell back from atomic to legacy mode setting has none
+   * of the cursor state set through the atomic cursor plane */
+  for (l = meta_monitor_manager_get_gpus (monitor_manager); l; l = l->next)
+    {
+      MetaGpuKms *gpu_kms = l->data;
+      MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data;
+
+      cursor_renderer_gpu_data =
+        meta_cursor_renderer_native_gpu_data_from_gpu (gpu_kms);
+      if (!cursor_renderer_gpu_data)
+        continue;
+
+      if (cursor_renderer_gpu_data->atomic != meta_gpu_kms_is_atomic (gpu_kms))
+        {
+          cursor_renderer_gpu_data->atomic = meta_gpu_kms_is_atomic (gpu_kms);
+          priv->hw_state_invalidated = TRUE;
+        }
+    }
+
   logical_monitors =
     meta_monitor_manager_get_logical_monitors (monitor_manager);
   for (l = logical_monitors; l; l = l->next)
@@ -436,6 +652,8 @@ update_hw_cursor (MetaCursorRendererNative *native,
       painted = painted || data.out_painted;
     }
 
+  g_mutex_unlock (&priv->input_lock);
+
   priv->hw_state_invalidated = FALSE;
 
   if (painted)
@@ -1148,6 +1366,111 @@ meta_cursor_renderer_native_class_init (MetaCursorRendererNativeClass *klass)
     g_quark_from_static_string ("-meta-cursor-renderer-native-gpu-data");
 }
 
+/**
+ * meta_cursor_renderer_native_set_input_position:
+ * @native: a #MetaCursorRendererNative
+ * @x: the new X coordinate of the pointer
+ * @y: the new Y coordinate of the pointer
+ *
+ * Moves the cursor planes showing the cursor along with the pointer,
+ * without waiting for the motion event to reach the main loop. May be
+ * called from the input thread. Moving the cursor onto another CRTC, or
+ * into a gap between monitors, is left to the regular update once the
+ * motion event is handled.
+ *
+ * The new position is only recorded in the CRTC cursor state. It goes
+ * along with the next stage flip, and is committed on its own only while
+ * no flip is scheduled and the CRTC has no commit in flight, see
+ * meta_gpu_kms_update_cursor(); positions recorded meanwhile are folded
+ * into a single commit once the CRTC is idle again.
+ */
+void
+meta_cursor_renderer_native_set_input_position (MetaCursorRendererNative *native,
+                                                float                     x,
+                                                float                     y)
+{
+  MetaCursorRendererNativePrivate *priv =
+    meta_cursor_renderer_native_get_instance_private (native);
+  gboolean on_crtc = FALSE;
+  unsigned int i;
+
+  g_mutex_lock (&priv->input_lock);
+
+  priv->input_x = x;
+  priv->input_y = y;
+  priv->has_input_position = TRUE;
+
+  for (i = 0; i < priv->input_crtcs->len; i++)
+    {
+      MetaCursorInputCrtc *input_crtc =
+        &g_array_index (priv->input_crtcs, MetaCursorInputCrtc, i);
+      ClutterRect *crtc_rect = &input_crtc->crtc_rect;
+
+      if (x >= crtc_rect->origin.x &&
+          x < crtc_rect->origin.x + crtc_rect->size.width &&
+          y >= crtc_rect->origin.y &&
+          y < crtc_rect->origin.y + crtc_rect->size.height)
+        {
+          on_crtc = TRUE;
+          break;
+        }
+    }
+
+  /* The pointer will be constrained back onto a monitor */
+  if (!on_crtc)
+    {
+      g_mutex_unlock (&priv->input_lock);
+      return;
+    }
+
+  for (i = 0; i < priv->input_crtcs->len; i++)
+    {
+      MetaCursorInputCrtc *input_crtc =
+        &g_array_index (priv->input_crtcs, MetaCursorInputCrtc, i);
+      MetaGpuKms *gpu_kms = input_crtc->gpu_kms;
+      ClutterRect cursor_rect;
+      float crtc_cursor_x, crtc_cursor_y;
+
+      cursor_rect = priv->input_cursor_rect;
+      cursor_rect.origin.x += x;
+      cursor_rect.origin.y += y;
+
+      if (!clutter_rect_intersection (&input_crtc->crtc_rect,
+                                      &cursor_rect,
+                                      NULL))
+        continue;
+
+      crtc_cursor_x = (cursor_rect.origin.x -
+                       input_crtc->crtc_rect.origin.x) * input_crtc->scale;
+      crtc_cursor_y = (cursor_rect.origin.y -
+                       input_crtc->crtc_rect.origin.y) * input_crtc->scale;
+
+      meta_gpu_kms_lock_cursor (gpu_kms);
+
+      /* The device may have fallen back to legacy mode setting since */
+      if (meta_gpu_kms_is_atomic (gpu_kms))
+        {
+          meta_crtc_kms_move_cursor (input_crtc->crtc,
+                                     floorf (crtc_cursor_x),
+                                     floorf (crtc_cursor_y));
+
+          /* Held back while the CRTC is busy; failures are dealt with when
+           * the main loop updates the cursor */
+          meta_gpu_kms_update_cursor (gpu_kms, input_crtc->crtc, NULL);
+        }
+
+      meta_gpu_kms_unlock_cursor (gpu_kms);
+    }
+
+  g_mutex_unlock (&priv->input_lock);
+}
+
+static void
+input_crtc_clear (MetaCursorInputCrtc *input_crtc)
+{
+  g_object_unref (input_crtc->crtc);
+}
+
 static void
 force_update_hw_cursor (MetaCursorRendererNative *native)
 {
@@ -1189,6 +1512,7 @@ init_hw_cursor_support (MetaCursorRendererNative *cursor_renderer_native)
 
       cursor_renderer_gpu_data =
         meta_create_cursor_renderer_native_gpu_data (gpu_kms);
+      cursor_renderer_gpu_data->atomic = meta_gpu_kms_is_atomic (gpu_kms);
 
       kms_fd = meta_gpu_kms_get_fd (gpu_kms);
       if (drmGetCap (kms_fd, DRM_CAP_CURSOR_WIDTH, &width) == 0 &&
@@ -1233,4 +1557,11 @@ meta_cursor_renderer_native_new (MetaBackend *backend)
 static void
 meta_cursor_renderer_native_init (MetaCursorRendererNative *native)
 {
+  MetaCursorRendererNativePrivate *priv =
+    meta_cursor_renderer_native_get_instance_private (native);
+
+  g_mutex_init (&priv->input_lock);
+  priv->input_crtcs = g_array_new (FALSE, FALSE, sizeof (MetaCursorInputCrtc));
+  g_array_set_clear_func (priv->input_crtcs,
+                          (GDestroyNotify) input_crtc_clear);
 }
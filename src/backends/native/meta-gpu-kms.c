@@ -76,6 +76,20 @@ struct _MetaGpuKms
 
   gboolean resources_init_failed_before;
 
+  /* Whether the device is driven with atomic mode setting. This is
+   * decided for the whole device; legacy mode setting, page flip and
+   * cursor ioctls are only used when it is FALSE. */
+  gboolean atomic;
+  /* Whether an atomic commit has succeeded; until then, a commit failing
+   * with an error meaning "unsupported" makes us fall back to legacy */
+  gboolean atomic_committed;
+  /* Whether the stage is about to flip; cursor plane changes then wait
+   * to go along with that flip */
+  gboolean flip_scheduled;
+  /* The cursor plane is also moved from the input thread; protects the
+   * CRTC cursor plane and commit state, flip_scheduled and atomic */
+  GMutex cursor_lock;
+
   MetaGpuKmsFlag flags;
 };
 
@@ -135,6 +149,246 @@ get_crtc_drm_connectors (MetaGpu       *gpu,
   *connectors = (uint32_t *) g_array_free (connectors_array, FALSE);
 }
 
+static void
+disable_atomic (MetaGpuKms *gpu_kms)
+{
+  /* Dropping the atomic capability also drops universal planes */
+  drmSetClientCap (gpu_kms->fd, DRM_CLIENT_CAP_ATOMIC, 0);
+  drmSetClientCap (gpu_kms->fd, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1);
+
+  g_mutex_lock (&gpu_kms->cursor_lock);
+  gpu_kms->atomic = FALSE;
+  g_mutex_unlock (&gpu_kms->cursor_lock);
+}
+
+/*
+ * Called when an atomic commit failed with @ret. Only errors meaning the
+ * driver doesn't support what we do, on a device where no atomic commit
+ * has succeeded yet, switch the device over to legacy mode setting;
+ * anything else is an error like with the legacy ioctls.
+ *
+ * Returns TRUE if the operation should be retried with legacy ioctls.
+ */
+static gboolean
+maybe_fall_back_to_legacy (MetaGpuKms *gpu_kms,
+                           int         ret)
+{
+  if (gpu_kms->atomic_committed)
+    return FALSE;
+
+  if (ret != -EINVAL && ret != -EOPNOTSUPP)
+    return FALSE;
+
+  g_warning ("Atomic mode setting failed on %s, "
+             "falling back to legacy mode setting: %s",
+             gpu_kms->file_path, g_strerror (-ret));
+  disable_atomic (gpu_kms);
+
+  return TRUE;
+}
+
+static MetaCrtc *
+find_crtc_by_id (MetaGpu  *gpu,
+                 uint32_t  crtc_id)
+{
+  GList *l;
+
+  for (l = meta_gpu_get_crtcs (gpu); l; l = l->next)
+    {
+      MetaCrtc *crtc = l->data;
+
+      if (crtc->crtc_id == crtc_id)
+        return crtc;
+    }
+
+  return NULL;
+}
+
+static uint32_t
+get_connector_current_crtc_id (int      kms_fd,
+                               uint32_t connector_id)
+{
+  drmModeConnector *connector;
+  drmModeEncoder *encoder;
+  uint32_t crtc_id = 0;
+
+  connector = drmModeGetConnectorCurrent (kms_fd, connector_id);
+  if (!connector)
+    return 0;
+
+  if (connector->encoder_id)
+    {
+      encoder = drmModeGetEncoder (kms_fd, connector->encoder_id);
+      if (encoder)
+        {
+          crtc_id = encoder->crtc_id;
+          drmModeFreeEncoder (encoder);
+        }
+    }
+
+  drmModeFreeConnector (connector);
+
+  return crtc_id;
+}
+
+static uint32_t
+get_connector_crtc_id_prop_id (int      kms_fd,
+                               uint32_t connector_id)
+{
+  drmModeObjectPropertiesPtr props;
+  uint32_t prop_id = 0;
+  unsigned int i;
+
+  props = drmModeObjectGetProperties (kms_fd, connector_id,
+                                      DRM_MODE_OBJECT_CONNECTOR);
+  if (!props)
+    return 0;
+
+  for (i = 0; i < props->count_props && !prop_id; i++)
+    {
+      drmModePropertyPtr prop;
+
+      prop = drmModeGetProperty (kms_fd, props->props[i]);
+      if (!prop)
+        continue;
+
+      if (strcmp (prop->name, "CRTC_ID") == 0)
+        prop_id = prop->prop_id;
+
+      drmModeFreeProperty (prop);
+    }
+
+  drmModeFreeObjectProperties (props);
+
+  return prop_id;
+}
+
+static gboolean
+is_connector_in_list (uint32_t      connector_id,
+                      uint32_t     *connectors,
+                      unsigned int  n_connectors)
+{
+  unsigned int i;
+
+  for (i = 0; i < n_connectors; i++)
+    {
+      if (connectors[i] == connector_id)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static int
+apply_crtc_mode_atomic (MetaGpuKms            *gpu_kms,
+                        MetaCrtc              *crtc,
+                        const drmModeModeInfo *mode,
+                        uint32_t              *connectors,
+                        unsigned int           n_connectors,
+                        int                    x,
+                        int                    y,
+                        uint32_t               fb_id)
+{
+  MetaGpu *gpu = META_GPU (gpu_kms);
+  drmModeAtomicReq *req;
+  uint32_t mode_blob_id = 0;
+  uint32_t *left_crtc_ids;
+  unsigned int n_left_crtcs = 0;
+  unsigned int i;
+  int ret;
+
+  if (mode)
+    {
+      ret = drmModeCreatePropertyBlob (gpu_kms->fd, mode, sizeof (*mode),
+                                       &mode_blob_id);
+      if (ret != 0)
+        return ret;
+    }
+
+  req = drmModeAtomicAlloc ();
+  if (!req)
+    {
+      if (mode_blob_id)
+        drmModeDestroyPropertyBlob (gpu_kms->fd, mode_blob_id);
+      return -ENOMEM;
+    }
+
+  g_mutex_lock (&gpu_kms->cursor_lock);
+
+  meta_crtc_kms_add_mode_set_to_request (crtc, req, mode_blob_id, mode,
+                                         x, y, fb_id);
+
+  /* Route the connectors; ones that moved here from another CRTC may
+   * leave that one without connectors, in which case it has to be
+   * disabled in the same commit. */
+  left_crtc_ids = g_new0 (uint32_t, gpu_kms->n_connectors);
+  for (i = 0; i < gpu_kms->n_connectors; i++)
+    {
+      uint32_t connector_id = gpu_kms->connectors[i]->connector_id;
+      uint32_t current_crtc_id;
+      uint32_t prop_id;
+
+      current_crtc_id = get_connector_current_crtc_id (gpu_kms->fd,
+                                                       connector_id);
+      prop_id = get_connector_crtc_id_prop_id (gpu_kms->fd, connector_id);
+      if (!prop_id)
+        continue;
+
+      if (is_connector_in_list (connector_id, connectors, n_connectors))
+        {
+          drmModeAtomicAddProperty (req, connector_id, prop_id,
+                                    crtc->crtc_id);
+
+          if (current_crtc_id && current_crtc_id != crtc->crtc_id)
+            left_crtc_ids[n_left_crtcs++] = current_crtc_id;
+        }
+      else if (current_crtc_id == crtc->crtc_id)
+        {
+          drmModeAtomicAddProperty (req, connector_id, prop_id, 0);
+        }
+    }
+
+  for (i = 0; i < n_left_crtcs; i++)
+    {
+      MetaCrtc *left_crtc;
+      gboolean still_used = FALSE;
+      unsigned int j;
+
+      for (j = 0; j < gpu_kms->n_connectors && !still_used; j++)
+        {
+          uint32_t connector_id = gpu_kms->connectors[j]->connector_id;
+
+          if (is_connector_in_list (connector_id, connectors, n_connectors))
+            continue;
+
+          still_used =
+            get_connector_current_crtc_id (gpu_kms->fd,
+                                           connector_id) == left_crtc_ids[i];
+        }
+
+      left_crtc = find_crtc_by_id (gpu, left_crtc_ids[i]);
+      if (!still_used && left_crtc)
+        meta_crtc_kms_add_mode_set_to_request (left_crtc, req,
+                                               0, NULL, 0, 0, 0);
+    }
+  g_free (left_crtc_ids);
+
+  ret = drmModeAtomicCommit (gpu_kms->fd, req,
+                             DRM_MODE_ATOMIC_ALLOW_MODESET, NULL);
+  drmModeAtomicFree (req);
+
+  g_mutex_unlock (&gpu_kms->cursor_lock);
+
+  /* The committed state holds its own reference to the blob */
+  if (mode_blob_id)
+    drmModeDestroyPropertyBlob (gpu_kms->fd, mode_blob_id);
+
+  if (ret == 0)
+    gpu_kms->atomic_committed = TRUE;
+
+  return ret;
+}
+
 gboolean
 meta_gpu_kms_apply_crtc_mode (MetaGpuKms *gpu_kms,
                               MetaCrtc   *crtc,
@@ -155,6 +409,35 @@ meta_gpu_kms_apply_crtc_mode (MetaGpuKms *gpu_kms,
   else
     mode = NULL;
 
+  if (gpu_kms->atomic)
+    {
+      int ret;
+
+      ret = apply_crtc_mode_atomic (gpu_kms, crtc, mode,
+                                    connectors, n_connectors,
+                                    x, y, fb_id);
+      if (ret == 0)
+        {
+          g_free (connectors);
+          return TRUE;
+        }
+
+      if (!maybe_fall_back_to_legacy (gpu_kms, ret))
+        {
+          if (mode)
+            g_warning ("Failed to set CRTC mode %s: %s",
+                       crtc->current_mode->name, g_strerror (-ret));
+          else
+            g_warning ("Failed to disable CRTC: %s", g_strerror (-ret));
+          g_free (connectors);
+          return FALSE;
+        }
+
+      /* The rotation wasn't applied when the transform was set, as it
+       * was meant to be part of the atomic commit */
+      meta_crtc_kms_apply_transform (crtc);
+    }
+
   if (drmModeSetCrtc (kms_fd,
                       crtc->crtc_id,
                       fb_id,
@@ -176,16 +459,18 @@ meta_gpu_kms_apply_crtc_mode (MetaGpuKms *gpu_kms,
 }
 
 static void
-invoke_flip_closure (GClosure   *flip_closure,
-                     MetaGpuKms *gpu_kms,
-                     MetaCrtc   *crtc,
-                     int64_t     page_flip_time_ns)
+invoke_flip_closure (GClosure     *flip_closure,
+                     MetaGpuKms   *gpu_kms,
+                     MetaCrtc     *crtc,
+                     int64_t       page_flip_time_ns,
+                     unsigned int  sequence)
 {
   GValue params[] = {
     G_VALUE_INIT,
     G_VALUE_INIT,
     G_VALUE_INIT,
     G_VALUE_INIT,
+    G_VALUE_INIT,
   };
 
   g_value_init (&params[0], G_TYPE_POINTER);
@@ -196,7 +481,9 @@ invoke_flip_closure (GClosure   *flip_closure,
   g_value_set_object (&params[2], crtc);
   g_value_init (&params[3], G_TYPE_INT64);
   g_value_set_int64 (&params[3], page_flip_time_ns);
-  g_closure_invoke (flip_closure, NULL, 4, params, NULL);
+  g_value_init (&params[4], G_TYPE_UINT);
+  g_value_set_uint (&params[4], sequence);
+  g_closure_invoke (flip_closure, NULL, 5, params, NULL);
 }
 
 gboolean
@@ -257,6 +544,287 @@ meta_gpu_kms_flip_closure_container_free (MetaGpuKmsFlipClosureContainer *closur
   g_free (closure_container);
 }
 
+/**
+ * meta_gpu_kms_is_atomic:
+ * @gpu_kms: a #MetaGpuKms
+ *
+ * Returns TRUE if the device is driven with atomic mode setting. Mode
+ * sets, page flips and the cursor then all go through atomic commits,
+ * and the legacy ioctls must not be used.
+ */
+gboolean
+meta_gpu_kms_is_atomic (MetaGpuKms *gpu_kms)
+{
+  return gpu_kms->atomic;
+}
+
+static int
+commit_atomic_flip (MetaGpuKms *gpu_kms,
+                    MetaCrtc   *crtc,
+                    uint32_t    fb_id,
+                    gboolean    with_overlay,
+                    uint32_t    flags,
+                    void       *user_data)
+{
+  drmModeAtomicReq *req;
+  int ret;
+
+  req = drmModeAtomicAlloc ();
+  if (!req)
+    return -ENOMEM;
+
+  meta_crtc_kms_add_flip_to_request (crtc, req, fb_id, with_overlay);
+  ret = drmModeAtomicCommit (gpu_kms->fd, req, flags, user_data);
+  drmModeAtomicFree (req);
+
+  return ret;
+}
+
+static int
+flip_crtc_atomic (MetaGpuKms                     *gpu_kms,
+                  MetaCrtc                       *crtc,
+                  uint32_t                        fb_id,
+                  MetaGpuKmsFlipClosureContainer *closure_container)
+{
+  gboolean with_overlay;
+  int ret;
+
+  with_overlay = meta_crtc_kms_has_overlay_assignment (crtc);
+
+  /* The flip carries along pending cursor plane state */
+  g_mutex_lock (&gpu_kms->cursor_lock);
+
+  /* Whether a plane configuration works is up to the driver; validate it
+   * first, and composite this frame as usual if it doesn't. */
+  if (with_overlay)
+    {
+      ret = commit_atomic_flip (gpu_kms, crtc, fb_id, TRUE,
+                                DRM_MODE_ATOMIC_TEST_ONLY, NULL);
+      if (ret != 0)
+        {
+          g_debug ("Overlay plane configuration rejected: %s",
+                   g_strerror (-ret));
+          with_overlay = FALSE;
+        }
+    }
+
+  ret = commit_atomic_flip (gpu_kms, crtc, fb_id, with_overlay,
+                            (DRM_MODE_ATOMIC_NONBLOCK |
+                             DRM_MODE_PAGE_FLIP_EVENT),
+                            closure_container);
+  if (ret == 0)
+    {
+      meta_crtc_kms_flip_committed (crtc, with_overlay);
+      gpu_kms->atomic_committed = TRUE;
+    }
+
+  g_mutex_unlock (&gpu_kms->cursor_lock);
+
+  return ret;
+}
+
+static int
+commit_cursor_atomic (MetaGpuKms *gpu_kms,
+                      MetaCrtc   *crtc)
+{
+  MetaGpuKmsFlipClosureContainer *closure_container;
+  drmModeAtomicReq *req;
+  int ret;
+
+  req = drmModeAtomicAlloc ();
+  if (!req)
+    return -ENOMEM;
+
+  if (!meta_crtc_kms_add_cursor_to_request (crtc, req))
+    {
+      drmModeAtomicFree (req);
+      return 0;
+    }
+
+  /* A closure container without a closure; its event only tells us when
+   * the CRTC is ready for the next commit. */
+  closure_container = g_new0 (MetaGpuKmsFlipClosureContainer, 1);
+  closure_container->gpu_kms = gpu_kms;
+  closure_container->crtc = crtc;
+
+  ret = drmModeAtomicCommit (gpu_kms->fd, req,
+                             (DRM_MODE_ATOMIC_NONBLOCK |
+                              DRM_MODE_PAGE_FLIP_EVENT),
+                             closure_container);
+  drmModeAtomicFree (req);
+
+  if (ret == 0)
+    {
+      meta_crtc_kms_cursor_committed (crtc);
+      gpu_kms->atomic_committed = TRUE;
+    }
+  else
+    {
+      g_free (closure_container);
+    }
+
+  return ret;
+}
+
+/**
+ * meta_gpu_kms_update_cursor:
+ * @gpu_kms: a #MetaGpuKms
+ * @crtc: the #MetaCrtc whose cursor plane changed
+ * @error: return location for a #GError
+ *
+ * Commits the cursor plane state set with meta_crtc_kms_set_cursor() and
+ * meta_crtc_kms_move_cursor(). Only valid on atomic devices, with the
+ * cursor lock held.
+ *
+ * A cursor-only commit holds the CRTC until the next vblank, and would
+ * make a stage flip in the meantime fail with EBUSY. So the state is only
+ * committed on its own when @crtc has no commit in flight and no stage
+ * flip is scheduled; otherwise it goes along with the next flip, or is
+ * committed once the CRTC is idle again.
+ *
+ * Returns: %FALSE if the cursor plane state was rejected
+ */
+gboolean
+meta_gpu_kms_update_cursor (MetaGpuKms  *gpu_kms,
+                            MetaCrtc    *crtc,
+                            GError     **error)
+{
+  int ret;
+
+  g_return_val_if_fail (gpu_kms->atomic, FALSE);
+
+  if (gpu_kms->flip_scheduled || meta_crtc_kms_is_commit_pending (crtc))
+    return TRUE;
+
+  ret = commit_cursor_atomic (gpu_kms, crtc);
+  if (ret == -EBUSY)
+    return TRUE;
+  else if (ret != 0)
+    {
+      g_set_error (error, G_IO_ERROR,
+                   g_io_error_from_errno (-ret),
+                   "Cursor plane commit failed: %s", g_strerror (-ret));
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * meta_gpu_kms_lock_cursor:
+ * @gpu_kms: a #MetaGpuKms
+ *
+ * Takes the lock protecting the cursor plane state, which is also updated
+ * from the input thread. It must be held around meta_crtc_kms_set_cursor(),
+ * meta_crtc_kms_move_cursor() and meta_gpu_kms_update_cursor().
+ */
+void
+meta_gpu_kms_lock_cursor (MetaGpuKms *gpu_kms)
+{
+  g_mutex_lock (&gpu_kms->cursor_lock);
+}
+
+/**
+ * meta_gpu_kms_unlock_cursor:
+ * @gpu_kms: a #MetaGpuKms
+ *
+ * Releases the lock taken with meta_gpu_kms_lock_cursor().
+ */
+void
+meta_gpu_kms_unlock_cursor (MetaGpuKms *gpu_kms)
+{
+  g_mutex_unlock (&gpu_kms->cursor_lock);
+}
+
+/**
+ * meta_gpu_kms_set_flip_scheduled:
+ * @gpu_kms: a #MetaGpuKms
+ * @scheduled: whether a stage flip is scheduled
+ *
+ * Tells whether the stage is about to flip. While it is, cursor plane
+ * changes are not committed on their own, see meta_gpu_kms_update_cursor().
+ */
+void
+meta_gpu_kms_set_flip_scheduled (MetaGpuKms *gpu_kms,
+                                 gboolean    scheduled)
+{
+  g_mutex_lock (&gpu_kms->cursor_lock);
+  gpu_kms->flip_scheduled = scheduled;
+  g_mutex_unlock (&gpu_kms->cursor_lock);
+}
+
+/**
+ * meta_gpu_kms_flush_cursors:
+ * @gpu_kms: a #MetaGpuKms
+ *
+ * Commits cursor plane changes that were held back, on every CRTC that is
+ * idle, unless a stage flip is scheduled that will carry them.
+ */
+void
+meta_gpu_kms_flush_cursors (MetaGpuKms *gpu_kms)
+{
+  GList *l;
+
+  g_mutex_lock (&gpu_kms->cursor_lock);
+
+  if (!gpu_kms->atomic || gpu_kms->flip_scheduled)
+    {
+      g_mutex_unlock (&gpu_kms->cursor_lock);
+      return;
+    }
+
+  for (l = meta_gpu_get_crtcs (META_GPU (gpu_kms)); l; l = l->next)
+    {
+      MetaCrtc *crtc = l->data;
+      g_autoptr (GError) error = NULL;
+
+      if (!crtc->current_mode || !meta_crtc_kms_is_cursor_dirty (crtc))
+        continue;
+
+      if (!meta_gpu_kms_update_cursor (gpu_kms, crtc, &error))
+        g_warning ("Failed to update cursor plane: %s", error->message);
+    }
+
+  g_mutex_unlock (&gpu_kms->cursor_lock);
+}
+
+/**
+ * meta_gpu_kms_test_flip_crtc:
+ * @gpu_kms: a #MetaGpuKms
+ * @crtc: the #MetaCrtc to flip
+ * @fb_id: the framebuffer to flip to
+ *
+ * Checks whether flipping @crtc to @fb_id would be accepted, without
+ * flipping. This requires atomic mode setting; without it, nothing can
+ * be validated up front and %FALSE is returned.
+ *
+ * Returns: %TRUE if the flip would be accepted
+ */
+gboolean
+meta_gpu_kms_test_flip_crtc (MetaGpuKms *gpu_kms,
+                             MetaCrtc   *crtc,
+                             uint32_t    fb_id)
+{
+  int ret;
+
+  if (!gpu_kms->atomic)
+    return FALSE;
+
+  /* The request includes the cursor plane state */
+  g_mutex_lock (&gpu_kms->cursor_lock);
+  ret = commit_atomic_flip (gpu_kms, crtc, fb_id, FALSE,
+                            DRM_MODE_ATOMIC_TEST_ONLY, NULL);
+  g_mutex_unlock (&gpu_kms->cursor_lock);
+
+  if (ret != 0)
+    {
+      g_debug ("Flip to framebuffer %u rejected: %s", fb_id, g_strerror (-ret));
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
 gboolean
 meta_gpu_kms_flip_crtc (MetaGpuKms  *gpu_kms,
                         MetaCrtc    *crtc,
@@ -286,17 +854,34 @@ meta_gpu_kms_flip_crtc (MetaGpuKms  *gpu_kms,
                                                       crtc,
                                                       flip_closure);
 
+  if (gpu_kms->atomic)
+    {
+      ret = flip_crtc_atomic (gpu_kms, crtc, fb_id, closure_container);
+
+      /* Errors, including EBUSY while the previous flip is pending and
+       * EACCES while we don't hold DRM master, are handled by the caller
+       * like those of the legacy ioctl. */
+      if (ret == 0 || !maybe_fall_back_to_legacy (gpu_kms, ret))
+        goto out;
+    }
+
   ret = drmModePageFlip (kms_fd,
                          crtc->crtc_id,
                          fb_id,
                          DRM_MODE_PAGE_FLIP_EVENT,
                          closure_container);
+  if (ret == 0)
+    meta_crtc_kms_flipped_legacy (crtc);
+
+out:
   if (ret != 0)
     {
       meta_gpu_kms_flip_closure_container_free (closure_container);
       g_set_error (error, G_IO_ERROR,
                    g_io_error_from_errno (-ret),
-                   "drmModePageFlip failed: %s", g_strerror (-ret));
+                   "%s failed: %s",
+                   gpu_kms->atomic ? "Atomic page flip" : "drmModePageFlip",
+                   g_strerror (-ret));
       return FALSE;
     }
 
@@ -332,11 +917,28 @@ page_flip_handler (int           fd,
   MetaGpuKms *gpu_kms = closure_container->gpu_kms;
   struct timeval page_flip_time = {sec, usec};
 
-  invoke_flip_closure (flip_closure,
-                       gpu_kms,
-                       closure_container->crtc,
-                       timeval_to_nanoseconds (&page_flip_time));
-  meta_gpu_kms_flip_closure_container_free (closure_container);
+  g_mutex_lock (&gpu_kms->cursor_lock);
+  meta_crtc_kms_commit_completed (closure_container->crtc);
+  g_mutex_unlock (&gpu_kms->cursor_lock);
+
+  /* Cursor plane commits have no closure */
+  if (flip_closure)
+    {
+      invoke_flip_closure (flip_closure,
+                           gpu_kms,
+                           closure_container->crtc,
+                           timeval_to_nanoseconds (&page_flip_time),
+                           frame);
+      meta_gpu_kms_flip_closure_container_free (closure_container);
+    }
+  else
+    {
+      g_free (closure_container);
+    }
+
+  /* Commit cursor changes held back while the CRTC was busy, unless the
+   * flip closure scheduled the next frame, which carries them instead */
+  meta_gpu_kms_flush_cursors (gpu_kms);
 }
 
 gboolean
@@ -877,6 +1479,22 @@ meta_gpu_kms_can_have_outputs (MetaGpuKms *gpu_kms)
   return gpu_kms->n_connectors > 0;
 }
 
+static gboolean
+can_use_atomic (MetaGpuKms *gpu_kms)
+{
+  GList *l;
+
+  for (l = meta_gpu_get_crtcs (META_GPU (gpu_kms)); l; l = l->next)
+    {
+      MetaCrtc *crtc = l->data;
+
+      if (!meta_crtc_kms_supports_atomic_mode_set (crtc))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 MetaGpuKms *
 meta_gpu_kms_new (MetaMonitorManagerKms  *monitor_manager_kms,
                   const char             *kms_file_path,
@@ -907,8 +1525,19 @@ meta_gpu_kms_new (MetaMonitorManagerKms  *monitor_manager_kms,
 
   drmSetClientCap (gpu_kms->fd, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1);
 
+  if (!g_getenv ("MUTTER_DEBUG_DISABLE_ATOMIC_KMS"))
+    gpu_kms->atomic = drmSetClientCap (gpu_kms->fd,
+                                       DRM_CLIENT_CAP_ATOMIC, 1) == 0;
+
   meta_gpu_kms_read_current (META_GPU (gpu_kms), NULL);
 
+  if (gpu_kms->atomic && !can_use_atomic (gpu_kms))
+    {
+      g_message ("Not all CRTCs of %s support atomic mode setting, "
+                 "using legacy mode setting", kms_file_path);
+      disable_atomic (gpu_kms);
+    }
+
   source = g_source_new (&kms_event_funcs, sizeof (MetaKmsSource));
   kms_source = (MetaKmsSource *) source;
   kms_source->fd_tag = g_source_add_unix_fd (source,
@@ -936,6 +1565,8 @@ meta_gpu_kms_finalize (GObject *object)
     meta_launcher_close_restricted (launcher, gpu_kms->fd);
   g_clear_pointer (&gpu_kms->file_path, g_free);
 
+  g_mutex_clear (&gpu_kms->cursor_lock);
+
   g_source_destroy (gpu_kms->source);
 
   free_resources (gpu_kms);
@@ -950,6 +1581,8 @@ meta_gpu_kms_init (MetaGpuKms *gpu_kms)
 
   gpu_kms->fd = -1;
   gpu_kms->id = ++id;
+
+  g_mutex_init (&gpu_kms->cursor_lock);
 }
 
 static void
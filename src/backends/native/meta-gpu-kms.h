@@ -64,6 +64,21 @@ gboolean meta_gpu_kms_apply_crtc_mode (MetaGpuKms *gpu_kms,
 
 gboolean meta_gpu_kms_can_have_outputs (MetaGpuKms *gpu_kms);
 
+gboolean meta_gpu_kms_is_atomic (MetaGpuKms *gpu_kms);
+
+void meta_gpu_kms_lock_cursor (MetaGpuKms *gpu_kms);
+
+void meta_gpu_kms_unlock_cursor (MetaGpuKms *gpu_kms);
+
+gboolean meta_gpu_kms_update_cursor (MetaGpuKms  *gpu_kms,
+                                     MetaCrtc    *crtc,
+                                     GError     **error);
+
+void meta_gpu_kms_set_flip_scheduled (MetaGpuKms *gpu_kms,
+                                      gboolean    scheduled);
+
+void meta_gpu_kms_flush_cursors (MetaGpuKms *gpu_kms);
+
 gboolean meta_gpu_kms_is_crtc_active (MetaGpuKms *gpu_kms,
                                       MetaCrtc   *crtc);
 
@@ -76,6 +91,10 @@ gboolean meta_gpu_kms_flip_crtc (MetaGpuKms  *gpu_kms,
                                  GClosure    *flip_closure,
                                  GError     **error);
 
+gboolean meta_gpu_kms_test_flip_crtc (MetaGpuKms *gpu_kms,
+                                      MetaCrtc   *crtc,
+                                      uint32_t    fb_id);
+
 gboolean meta_gpu_kms_wait_for_flip (MetaGpuKms *gpu_kms,
                                      GError    **error);
 
@@ -59,7 +59,10 @@ meta_input_settings_native_set_send_events (MetaInputSettings        *settings,
   libinput_device = clutter_evdev_input_device_get_libinput_device (device);
   if (!libinput_device)
     return;
+
+  clutter_evdev_lock_libinput ();
   libinput_device_config_send_events_set_mode (libinput_device, libinput_mode);
+  clutter_evdev_unlock_libinput ();
 }
 
 static void
@@ -84,8 +87,11 @@ meta_input_settings_native_set_speed (MetaInputSettings  *settings,
   libinput_device = clutter_evdev_input_device_get_libinput_device (device);
   if (!libinput_device)
     return;
+
+  clutter_evdev_lock_libinput ();
   libinput_device_config_accel_set_speed (libinput_device,
                                           CLAMP (speed, -1, 1));
+  clutter_evdev_unlock_libinput ();
 }
 
 static void
@@ -99,8 +105,10 @@ meta_input_settings_native_set_left_handed (MetaInputSettings  *settings,
   if (!libinput_device)
     return;
 
+  clutter_evdev_lock_libinput ();
   if (libinput_device_config_left_handed_is_available (libinput_device))
     libinput_device_config_left_handed_set (libinput_device, enabled);
+  clutter_evdev_unlock_libinput ();
 }
 
 static void
@@ -114,11 +122,13 @@ meta_input_settings_native_set_tap_enabled (MetaInputSettings  *settings,
   if (!libinput_device)
     return;
 
+  clutter_evdev_lock_libinput ();
   if (libinput_device_config_tap_get_finger_count (libinput_device) > 0)
     libinput_device_config_tap_set_enabled (libinput_device,
                                             enabled ?
                                             LIBINPUT_CONFIG_TAP_ENABLED :
                                             LIBINPUT_CONFIG_TAP_DISABLED);
+  clutter_evdev_unlock_libinput ();
 }
 
 static void
@@ -132,11 +142,13 @@ meta_input_settings_native_set_tap_and_drag_enabled (MetaInputSettings  *setting
   if (!libinput_device)
     return;
 
+  clutter_evdev_lock_libinput ();
   if (libinput_device_config_tap_get_finger_count (libinput_device) > 0)
     libinput_device_config_tap_set_drag_enabled (libinput_device,
                                                  enabled ?
                                                  LIBINPUT_CONFIG_DRAG_ENABLED :
                                                  LIBINPUT_CONFIG_DRAG_DISABLED);
+  clutter_evdev_unlock_libinput ();
 }
 
 static void
@@ -151,11 +163,13 @@ meta_input_settings_native_set_disable_while_typing (MetaInputSettings  *setting
   if (!libinput_device)
     return;
 
+  clutter_evdev_lock_libinput ();
   if (libinput_device_config_dwt_is_available (libinput_device))
     libinput_device_config_dwt_set_enabled (libinput_device,
                                             enabled ?
                                             LIBINPUT_CONFIG_DWT_ENABLED :
                                             LIBINPUT_CONFIG_DWT_DISABLED);
+  clutter_evdev_unlock_libinput ();
 }
 
 static void
@@ -169,9 +183,11 @@ meta_input_settings_native_set_invert_scroll (MetaInputSettings  *settings,
   if (!libinput_device)
     return;
 
+  clutter_evdev_lock_libinput ();
   if (libinput_device_config_scroll_has_natural_scroll (libinput_device))
     libinput_device_config_scroll_set_natural_scroll_enabled (libinput_device,
                                                               inverted);
+  clutter_evdev_unlock_libinput ();
 }
 
 static gboolean
@@ -203,10 +219,12 @@ meta_input_settings_native_set_edge_scroll (MetaInputSettings            *settin
   libinput_device = clutter_evdev_input_device_get_libinput_device (device);
 
   method = edge_scrolling_enabled ? LIBINPUT_CONFIG_SCROLL_EDGE : LIBINPUT_CONFIG_SCROLL_NO_SCROLL;
+  clutter_evdev_lock_libinput ();
   current = libinput_device_config_scroll_get_method (libinput_device);
   current &= ~LIBINPUT_CONFIG_SCROLL_EDGE;
 
   device_set_scroll_method (libinput_device, current | method);
+  clutter_evdev_unlock_libinput ();
 }
 
 static void
@@ -220,10 +238,12 @@ meta_input_settings_native_set_two_finger_scroll (MetaInputSettings            *
   libinput_device = clutter_evdev_input_device_get_libinput_device (device);
 
   method = two_finger_scroll_enabled ? LIBINPUT_CONFIG_SCROLL_2FG : LIBINPUT_CONFIG_SCROLL_NO_SCROLL;
+  clutter_evdev_lock_libinput ();
   current = libinput_device_config_scroll_get_method (libinput_device);
   current &= ~LIBINPUT_CONFIG_SCROLL_2FG;
 
   device_set_scroll_method (libinput_device, current | method);
+  clutter_evdev_unlock_libinput ();
 }
 
 static gboolean
@@ -231,12 +251,17 @@ meta_input_settings_native_has_two_finger_scroll (MetaInputSettings  *settings,
                                                   ClutterInputDevice *device)
 {
   struct libinput_device *libinput_device;
+  uint32_t methods;
 
   libinput_device = clutter_evdev_input_device_get_libinput_device (device);
   if (!libinput_device)
     return FALSE;
 
-  return libinput_device_config_scroll_get_methods (libinput_device) & LIBINPUT_CONFIG_SCROLL_2FG;
+  clutter_evdev_lock_libinput ();
+  methods = libinput_device_config_scroll_get_methods (libinput_device);
+  clutter_evdev_unlock_libinput ();
+
+  return methods & LIBINPUT_CONFIG_SCROLL_2FG;
 }
 
 static void
@@ -268,10 +293,10 @@ meta_input_settings_native_set_scroll_button (MetaInputSettings  *settings,
       method = LIBINPUT_CONFIG_SCROLL_ON_BUTTON_DOWN;
     }
 
-  if (!device_set_scroll_method (libinput_device, method))
-    return;
-
-  libinput_device_config_scroll_set_button (libinput_device, evcode);
+  clutter_evdev_lock_libinput ();
+  if (device_set_scroll_method (libinput_device, method))
+    libinput_device_config_scroll_set_button (libinput_device, evcode);
+  clutter_evdev_unlock_libinput ();
 }
 
 static void
@@ -289,7 +314,9 @@ meta_input_settings_native_set_click_method (MetaInputSettings           *settin
   switch (mode)
     {
     case G_DESKTOP_TOUCHPAD_CLICK_METHOD_DEFAULT:
+      clutter_evdev_lock_libinput ();
       click_method = libinput_device_config_click_get_default_method (libinput_device);
+      clutter_evdev_unlock_libinput ();
       break;
     case G_DESKTOP_TOUCHPAD_CLICK_METHOD_NONE:
       click_method = LIBINPUT_CONFIG_CLICK_METHOD_NONE;
@@ -305,7 +332,9 @@ meta_input_settings_native_set_click_method (MetaInputSettings           *settin
       return;
   }
 
+  clutter_evdev_lock_libinput ();
   device_set_click_method (libinput_device, click_method);
+  clutter_evdev_unlock_libinput ();
 }
 
 static void
@@ -329,6 +358,8 @@ set_device_accel_profile (ClutterInputDevice         *device,
 
   libinput_device = clutter_evdev_input_device_get_libinput_device (device);
 
+  clutter_evdev_lock_libinput ();
+
   switch (profile)
     {
     case G_DESKTOP_POINTER_ACCEL_PROFILE_FLAT:
@@ -353,6 +384,8 @@ set_device_accel_profile (ClutterInputDevice         *device,
 
   libinput_device_config_accel_set_profile (libinput_device,
                                             libinput_profile);
+
+  clutter_evdev_unlock_libinput ();
 }
 
 static gboolean
@@ -367,7 +400,9 @@ has_udev_property (ClutterInputDevice *device,
   if (!libinput_device)
     return FALSE;
 
+  clutter_evdev_lock_libinput ();
   udev_device = libinput_device_get_udev_device (libinput_device);
+  clutter_evdev_unlock_libinput ();
 
   if (!udev_device)
     return FALSE;
@@ -501,11 +536,13 @@ meta_input_settings_native_set_tablet_area (MetaInputSettings  *settings,
                        0., scale_y, offset_y };
 
   libinput_device = clutter_evdev_input_device_get_libinput_device (device);
-  if (!libinput_device ||
-      !libinput_device_config_calibration_has_matrix (libinput_device))
+  if (!libinput_device)
     return;
 
-  libinput_device_config_calibration_set_matrix (libinput_device, matrix);
+  clutter_evdev_lock_libinput ();
+  if (libinput_device_config_calibration_has_matrix (libinput_device))
+    libinput_device_config_calibration_set_matrix (libinput_device, matrix);
+  clutter_evdev_unlock_libinput ();
 }
 
 static void
@@ -62,6 +62,7 @@
 #include "backends/native/meta-monitor-manager-kms.h"
 #include "backends/native/meta-renderer-native-gles3.h"
 #include "backends/native/meta-renderer-native.h"
+#include "backends/native/meta-scanout-kms.h"
 #include "meta-marshal.h"
 #include "cogl/cogl.h"
 #include "core/boxes-private.h"
@@ -153,6 +154,14 @@ typedef struct _MetaOnscreenNativeSecondaryGpuState
   struct {
     MetaDumbBuffer *dumb_fb;
     MetaDumbBuffer dumb_fbs[2];
+
+    /* What changed since each dumb buffer was last copied to, or NULL if
+     * it has to be copied to in full. */
+    cairo_region_t *stale_regions[2];
+
+    int64_t n_copies;
+    int64_t copy_time_us;
+    uint64_t copied_bytes;
   } cpu;
 
   int pending_flips;
@@ -172,6 +181,11 @@ typedef struct _MetaOnscreenNative
     uint32_t next_fb_id;
     struct gbm_bo *current_bo;
     struct gbm_bo *next_bo;
+
+    /* Set instead of the buffer objects when a client buffer is scanned
+     * out directly; the framebuffer IDs are then owned by these. */
+    MetaScanoutKms *current_scanout;
+    MetaScanoutKms *next_scanout;
   } gbm;
 
 #ifdef HAVE_EGL_DEVICE
@@ -195,6 +209,10 @@ typedef struct _MetaOnscreenNative
 
   MetaRendererView *view;
   int total_pending_flips;
+
+  gboolean is_scanning_out;
+  int64_t n_direct_scanouts;
+  int64_t n_composited_frames;
 } MetaOnscreenNative;
 
 struct _MetaRendererNative
@@ -737,10 +755,25 @@ secondary_gpu_state_free (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_sta
   free_next_secondary_bo (gpu_kms, secondary_gpu_state);
   g_clear_pointer (&secondary_gpu_state->gbm.surface, gbm_surface_destroy);
 
+  if (secondary_gpu_state->cpu.n_copies > 0)
+    {
+      g_debug ("Secondary GPU CPU copy: %" G_GINT64_FORMAT " frames, "
+               "%" G_GINT64_FORMAT " us and %" G_GUINT64_FORMAT " bytes "
+               "per frame on average",
+               secondary_gpu_state->cpu.n_copies,
+               secondary_gpu_state->cpu.copy_time_us /
+               secondary_gpu_state->cpu.n_copies,
+               secondary_gpu_state->cpu.copied_bytes /
+               secondary_gpu_state->cpu.n_copies);
+    }
+
   for (i = 0; i < G_N_ELEMENTS (secondary_gpu_state->cpu.dumb_fbs); i++)
     {
       MetaDumbBuffer *dumb_fb = &secondary_gpu_state->cpu.dumb_fbs[i];
 
+      g_clear_pointer (&secondary_gpu_state->cpu.stale_regions[i],
+                       cairo_region_destroy);
+
       if (dumb_fb->fb_id)
         release_dumb_fb (dumb_fb, gpu_kms);
     }
@@ -1006,7 +1039,13 @@ free_current_bo (CoglOnscreen *onscreen)
 
   kms_fd = meta_gpu_kms_get_fd (render_gpu);
 
-  if (onscreen_native->gbm.current_fb_id)
+  if (onscreen_native->gbm.current_scanout)
+    {
+      meta_scanout_kms_end_use (onscreen_native->gbm.current_scanout);
+      g_clear_object (&onscreen_native->gbm.current_scanout);
+      onscreen_native->gbm.current_fb_id = 0;
+    }
+  else if (onscreen_native->gbm.current_fb_id)
     {
       drmModeRmFB (kms_fd, onscreen_native->gbm.current_fb_id);
       onscreen_native->gbm.current_fb_id = 0;
@@ -1331,6 +1370,9 @@ meta_onscreen_native_swap_drm_fb (CoglOnscreen *onscreen)
   onscreen_native->gbm.current_bo = onscreen_native->gbm.next_bo;
   onscreen_native->gbm.next_bo = NULL;
 
+  onscreen_native->gbm.current_scanout = onscreen_native->gbm.next_scanout;
+  onscreen_native->gbm.next_scanout = NULL;
+
   g_hash_table_foreach (onscreen_native->secondary_gpu_states,
                         (GHFunc) swap_secondary_drm_fb,
                         NULL);
@@ -1341,6 +1383,7 @@ on_crtc_flipped (GClosure         *closure,
                  MetaGpuKms       *gpu_kms,
                  MetaCrtc         *crtc,
                  int64_t           page_flip_time_ns,
+                 unsigned int      sequence,
                  MetaRendererView *view)
 {
   ClutterStageView *stage_view = CLUTTER_STAGE_VIEW (view);
@@ -1368,6 +1411,12 @@ on_crtc_flipped (GClosure         *closure,
     {
       frame_info->presentation_time = page_flip_time_ns;
       frame_info->refresh_rate = refresh_rate;
+      frame_info->sequence = sequence;
+
+      /* Page flip events carry the kernel's CLOCK_MONOTONIC timestamp of
+       * the vblank the flip completed on. */
+      frame_info->flags |= (COGL_FRAME_INFO_FLAG_HW_CLOCK |
+                            COGL_FRAME_INFO_FLAG_VSYNC);
     }
 
   if (gpu_kms != render_gpu)
@@ -1448,7 +1497,13 @@ flip_closure_destroyed (MetaRendererView *view)
   switch (renderer_gpu_data->mode)
     {
     case META_RENDERER_NATIVE_MODE_GBM:
-      if (onscreen_native->gbm.next_fb_id)
+      if (onscreen_native->gbm.next_scanout)
+        {
+          meta_scanout_kms_end_use (onscreen_native->gbm.next_scanout);
+          g_clear_object (&onscreen_native->gbm.next_scanout);
+          onscreen_native->gbm.next_fb_id = 0;
+        }
+      else if (onscreen_native->gbm.next_fb_id)
         {
           int kms_fd;
 
@@ -2060,7 +2115,7 @@ meta_onscreen_native_flip_crtcs (CoglOnscreen *onscreen)
   flip_closure = g_cclosure_new (G_CALLBACK (on_crtc_flipped),
                                  g_object_ref (view),
                                  (GClosureNotify) flip_closure_destroyed);
-  g_closure_set_marshal (flip_closure, meta_marshal_VOID__OBJECT_OBJECT_INT64);
+  g_closure_set_marshal (flip_closure, meta_marshal_VOID__OBJECT_OBJECT_INT64_UINT);
 
   power_save_mode = meta_monitor_manager_get_power_save_mode (monitor_manager);
   if (power_save_mode == META_POWER_SAVE_ON)
@@ -2320,68 +2375,175 @@ cogl_pixel_format_from_drm_format (uint32_t               drm_format,
   return TRUE;
 }
 
+static int
+get_drm_format_bytes_per_pixel (uint32_t drm_format)
+{
+  switch (drm_format)
+    {
+    case DRM_FORMAT_RGB565:
+      return 2;
+    default:
+      return 4;
+    }
+}
+
+static gboolean
+copy_shared_framebuffer_rect_cpu (CoglFramebuffer             *framebuffer,
+                                  MetaDumbBuffer              *dumb_fb,
+                                  CoglPixelFormat              cogl_format,
+                                  const cairo_rectangle_int_t *rect)
+{
+  CoglContext *cogl_context = framebuffer->context;
+  int bpp = get_drm_format_bytes_per_pixel (dumb_fb->drm_format);
+  uint8_t *target_data;
+  CoglBitmap *dumb_bitmap;
+  gboolean ret;
+
+  target_data = ((uint8_t *) dumb_fb->map +
+                 rect->y * dumb_fb->stride_bytes +
+                 rect->x * bpp);
+
+  dumb_bitmap = cogl_bitmap_new_for_data (cogl_context,
+                                          rect->width,
+                                          rect->height,
+                                          cogl_format,
+                                          dumb_fb->stride_bytes,
+                                          target_data);
+
+  ret = cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                  rect->x,
+                                                  rect->y,
+                                                  COGL_READ_PIXELS_COLOR_BUFFER,
+                                                  dumb_bitmap);
+
+  cogl_object_unref (dumb_bitmap);
+
+  return ret;
+}
+
 static void
 copy_shared_framebuffer_cpu (CoglOnscreen                        *onscreen,
                              MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
-                             MetaRendererNativeGpuData           *renderer_gpu_data)
+                             MetaRendererNativeGpuData           *renderer_gpu_data,
+                             const int                           *rectangles,
+                             int                                  n_rectangles)
 {
   CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
-  CoglContext *cogl_context = framebuffer->context;
   int width, height;
-  uint8_t *target_data;
-  int target_stride_bytes;
-  uint32_t target_fb_id;
-  uint32_t target_drm_format;
+  cairo_rectangle_int_t fb_rect;
   MetaDumbBuffer *next_dumb_fb;
   MetaDumbBuffer *current_dumb_fb;
-  CoglBitmap *dumb_bitmap;
+  int next_index, i;
+  cairo_region_t *damage;
+  cairo_region_t *copy_region;
   CoglPixelFormat cogl_format;
+  int64_t start_time_us;
+  int bpp;
   gboolean ret;
 
   width = cogl_framebuffer_get_width (framebuffer);
   height = cogl_framebuffer_get_height (framebuffer);
+  fb_rect = (cairo_rectangle_int_t) { .width = width, .height = height };
 
   current_dumb_fb = secondary_gpu_state->cpu.dumb_fb;
   if (current_dumb_fb == &secondary_gpu_state->cpu.dumb_fbs[0])
-    next_dumb_fb = &secondary_gpu_state->cpu.dumb_fbs[1];
+    next_index = 1;
   else
-    next_dumb_fb = &secondary_gpu_state->cpu.dumb_fbs[0];
+    next_index = 0;
+  next_dumb_fb = &secondary_gpu_state->cpu.dumb_fbs[next_index];
   secondary_gpu_state->cpu.dumb_fb = next_dumb_fb;
 
-  g_assert (width == secondary_gpu_state->cpu.dumb_fb->width);
-  g_assert (height == secondary_gpu_state->cpu.dumb_fb->height);
+  g_assert (width == next_dumb_fb->width);
+  g_assert (height == next_dumb_fb->height);
 
-  target_data = secondary_gpu_state->cpu.dumb_fb->map;
-  target_stride_bytes = secondary_gpu_state->cpu.dumb_fb->stride_bytes;
-  target_fb_id = secondary_gpu_state->cpu.dumb_fb->fb_id;
-  target_drm_format = secondary_gpu_state->cpu.dumb_fb->drm_format;
-
-  ret = cogl_pixel_format_from_drm_format (target_drm_format,
+  ret = cogl_pixel_format_from_drm_format (next_dumb_fb->drm_format,
                                            &cogl_format,
                                            NULL);
   g_assert (ret);
 
-  dumb_bitmap = cogl_bitmap_new_for_data (cogl_context,
-                                          width,
-                                          height,
-                                          cogl_format,
-                                          target_stride_bytes,
-                                          target_data);
+  /* Swapping without damage means the whole frame changed. */
+  if (n_rectangles > 0)
+    {
+      damage = cairo_region_create_rectangles ((cairo_rectangle_int_t *) rectangles,
+                                               n_rectangles);
+      cairo_region_intersect_rectangle (damage, &fb_rect);
+    }
+  else
+    {
+      damage = NULL;
+    }
+
+  /* The dumb buffer we copy to was last updated two frames ago, so it
+   * needs everything that changed since then, not only this frame's
+   * damage. */
+  if (damage && secondary_gpu_state->cpu.stale_regions[next_index])
+    {
+      copy_region =
+        cairo_region_copy (secondary_gpu_state->cpu.stale_regions[next_index]);
+      cairo_region_union (copy_region, damage);
+    }
+  else
+    {
+      copy_region = cairo_region_create_rectangle (&fb_rect);
+    }
 
-  if (!cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
-                                                 0 /* x */,
-                                                 0 /* y */,
-                                                 COGL_READ_PIXELS_COLOR_BUFFER,
-                                                 dumb_bitmap))
-    g_warning ("Failed to CPU-copy to a secondary GPU output");
+  start_time_us = g_get_monotonic_time ();
+  bpp = get_drm_format_bytes_per_pixel (next_dumb_fb->drm_format);
 
-  cogl_object_unref (dumb_bitmap);
+  for (i = 0; i < cairo_region_num_rectangles (copy_region); i++)
+    {
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (copy_region, i, &rect);
+
+      if (!copy_shared_framebuffer_rect_cpu (framebuffer,
+                                             next_dumb_fb,
+                                             cogl_format,
+                                             &rect))
+        {
+          g_warning ("Failed to CPU-copy to a secondary GPU output");
+          break;
+        }
 
-  secondary_gpu_state->gbm.next_fb_id = target_fb_id;
+      secondary_gpu_state->cpu.copied_bytes +=
+        (uint64_t) rect.width * rect.height * bpp;
+    }
+
+  secondary_gpu_state->cpu.copy_time_us +=
+    g_get_monotonic_time () - start_time_us;
+  secondary_gpu_state->cpu.n_copies++;
+
+  cairo_region_destroy (copy_region);
+
+  for (i = 0; i < (int) G_N_ELEMENTS (secondary_gpu_state->cpu.stale_regions); i++)
+    {
+      cairo_region_t **stale_region =
+        &secondary_gpu_state->cpu.stale_regions[i];
+
+      if (i == next_index)
+        {
+          g_clear_pointer (stale_region, cairo_region_destroy);
+          *stale_region = cairo_region_create ();
+        }
+      else if (!damage)
+        {
+          g_clear_pointer (stale_region, cairo_region_destroy);
+        }
+      else if (*stale_region)
+        {
+          cairo_region_union (*stale_region, damage);
+        }
+    }
+
+  g_clear_pointer (&damage, cairo_region_destroy);
+
+  secondary_gpu_state->gbm.next_fb_id = next_dumb_fb->fb_id;
 }
 
 static void
-update_secondary_gpu_state_pre_swap_buffers (CoglOnscreen *onscreen)
+update_secondary_gpu_state_pre_swap_buffers (CoglOnscreen *onscreen,
+                                             const int    *rectangles,
+                                             int           n_rectangles)
 {
   CoglOnscreenEGL *onscreen_egl = onscreen->winsys;
   MetaOnscreenNative *onscreen_native = onscreen_egl->platform;
@@ -2404,7 +2566,9 @@ update_secondary_gpu_state_pre_swap_buffers (CoglOnscreen *onscreen)
         case META_SHARED_FRAMEBUFFER_COPY_MODE_CPU:
           copy_shared_framebuffer_cpu (onscreen,
                                        secondary_gpu_state,
-                                       renderer_gpu_data);
+                                       renderer_gpu_data,
+                                       rectangles,
+                                       n_rectangles);
           break;
         }
     }
@@ -2445,6 +2609,28 @@ update_secondary_gpu_state_post_swap_buffers (CoglOnscreen *onscreen,
     }
 }
 
+static void
+count_presented_frame (MetaOnscreenNative *onscreen_native,
+                       gboolean            is_direct_scanout)
+{
+  if (is_direct_scanout)
+    onscreen_native->n_direct_scanouts++;
+  else
+    onscreen_native->n_composited_frames++;
+
+  if (is_direct_scanout == onscreen_native->is_scanning_out)
+    return;
+
+  onscreen_native->is_scanning_out = is_direct_scanout;
+
+  g_debug ("%s direct scanout on view %p (%" G_GINT64_FORMAT " frames "
+           "scanned out directly, %" G_GINT64_FORMAT " composited so far)",
+           is_direct_scanout ? "Started" : "Stopped",
+           onscreen_native->view,
+           onscreen_native->n_direct_scanouts,
+           onscreen_native->n_composited_frames);
+}
+
 static void
 meta_onscreen_native_swap_buffers_with_damage (CoglOnscreen *onscreen,
                                                const int    *rectangles,
@@ -2468,13 +2654,19 @@ meta_onscreen_native_swap_buffers_with_damage (CoglOnscreen *onscreen,
   /*
    * Wait for the flip callback before continuing, as we might have started the
    * animation earlier due to the animation being driven by some other monitor.
+   * The stage holds back painting views whose previous frame is still
+   * pending, so this should only ever block when that tracking is bypassed.
    */
   wait_for_pending_flips (onscreen);
 
   frame_info = g_queue_peek_tail (&onscreen->pending_frame_infos);
   frame_info->global_frame_counter = renderer_native->frame_counter;
 
-  update_secondary_gpu_state_pre_swap_buffers (onscreen);
+  count_presented_frame (onscreen_native, FALSE);
+
+  update_secondary_gpu_state_pre_swap_buffers (onscreen,
+                                               rectangles,
+                                               n_rectangles);
 
   parent_vtable->onscreen_swap_buffers_with_damage (onscreen,
                                                     rectangles,
@@ -2527,6 +2719,111 @@ meta_onscreen_native_swap_buffers_with_damage (CoglOnscreen *onscreen,
     _cogl_winsys_egl_ensure_current (cogl_display);
 }
 
+typedef struct _TestScanoutData
+{
+  uint32_t fb_id;
+  gboolean can_scanout;
+} TestScanoutData;
+
+static void
+test_scanout_crtc (MetaLogicalMonitor *logical_monitor,
+                   MetaCrtc           *crtc,
+                   gpointer            user_data)
+{
+  TestScanoutData *data = user_data;
+  MetaGpuKms *gpu_kms = META_GPU_KMS (meta_crtc_get_gpu (crtc));
+
+  if (!data->can_scanout)
+    return;
+
+  if (!meta_gpu_kms_test_flip_crtc (gpu_kms, crtc, data->fb_id))
+    data->can_scanout = FALSE;
+}
+
+static gboolean
+meta_onscreen_native_direct_scanout (CoglOnscreen  *onscreen,
+                                     CoglScanout   *scanout,
+                                     GError       **error)
+{
+  CoglOnscreenEGL *onscreen_egl = onscreen->winsys;
+  MetaOnscreenNative *onscreen_native = onscreen_egl->platform;
+  MetaRendererNative *renderer_native = onscreen_native->renderer_native;
+  MetaMonitorManager *monitor_manager =
+    META_MONITOR_MANAGER (renderer_native->monitor_manager_kms);
+  MetaGpuKms *render_gpu = onscreen_native->render_gpu;
+  MetaRendererNativeGpuData *renderer_gpu_data;
+  MetaLogicalMonitor *logical_monitor;
+  MetaScanoutKms *scanout_kms;
+  CoglFrameInfo *frame_info;
+  TestScanoutData data;
+
+  if (!META_IS_SCANOUT_KMS (scanout))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "Unsupported scanout buffer type");
+      return FALSE;
+    }
+
+  scanout_kms = META_SCANOUT_KMS (scanout);
+  renderer_gpu_data = meta_renderer_native_get_gpu_data (renderer_native,
+                                                         render_gpu);
+
+  /* Outputs on other GPUs would need a copy of the buffer, which would
+   * defeat the purpose of not compositing it. */
+  if (renderer_gpu_data->mode != META_RENDERER_NATIVE_MODE_GBM ||
+      meta_scanout_kms_get_gpu_kms (scanout_kms) != render_gpu ||
+      g_hash_table_size (onscreen_native->secondary_gpu_states) > 0)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "Direct scanout not possible on this view");
+      return FALSE;
+    }
+
+  if (onscreen_native->pending_set_crtc ||
+      meta_monitor_manager_get_power_save_mode (monitor_manager) !=
+      META_POWER_SAVE_ON)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "Direct scanout not possible without active CRTCs");
+      return FALSE;
+    }
+
+  wait_for_pending_flips (onscreen);
+
+  data = (TestScanoutData) {
+    .fb_id = meta_scanout_kms_get_fb_id (scanout_kms),
+    .can_scanout = TRUE,
+  };
+  logical_monitor = meta_renderer_view_get_logical_monitor (onscreen_native->view);
+  meta_logical_monitor_foreach_crtc (logical_monitor, test_scanout_crtc, &data);
+  if (!data.can_scanout)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Scanout buffer rejected by KMS");
+      return FALSE;
+    }
+
+  frame_info = g_queue_peek_tail (&onscreen->pending_frame_infos);
+  frame_info->global_frame_counter = renderer_native->frame_counter;
+  frame_info->flags |= COGL_FRAME_INFO_FLAG_ZERO_COPY;
+
+  count_presented_frame (onscreen_native, TRUE);
+
+  g_warn_if_fail (onscreen_native->gbm.next_bo == NULL &&
+                  onscreen_native->gbm.next_fb_id == 0);
+
+  /* The client buffer must not be released until the page flip that
+   * replaces it has completed, see free_current_bo(). */
+  onscreen_native->gbm.next_scanout = g_object_ref (scanout_kms);
+  onscreen_native->gbm.next_fb_id = data.fb_id;
+  meta_scanout_kms_begin_use (scanout_kms);
+
+  onscreen_native->pending_queue_swap_notify_frame_count = renderer_native->frame_counter;
+  meta_onscreen_native_flip_crtcs (onscreen);
+
+  return TRUE;
+}
+
 static gboolean
 meta_renderer_native_init_egl_context (CoglContext *cogl_context,
                                        GError     **error)
@@ -3052,6 +3349,15 @@ meta_renderer_native_release_onscreen (CoglOnscreen *onscreen)
 
   onscreen_native = onscreen_egl->platform;
 
+  if (onscreen_native->n_direct_scanouts > 0)
+    {
+      g_debug ("Released view %p: %" G_GINT64_FORMAT " frames scanned out "
+               "directly, %" G_GINT64_FORMAT " composited",
+               onscreen_native->view,
+               onscreen_native->n_direct_scanouts,
+               onscreen_native->n_composited_frames);
+    }
+
   g_list_free_full (onscreen_native->pending_page_flip_retries,
                     (GDestroyNotify) retry_page_flip_data_free);
   if (onscreen_native->retry_page_flips_source)
@@ -3311,6 +3617,7 @@ get_native_cogl_winsys_vtable (CoglRenderer *cogl_renderer)
       vtable.onscreen_swap_region = NULL;
       vtable.onscreen_swap_buffers_with_damage =
         meta_onscreen_native_swap_buffers_with_damage;
+      vtable.onscreen_direct_scanout = meta_onscreen_native_direct_scanout;
 
       vtable.context_get_clock_time = meta_renderer_native_get_clock_time;
 
@@ -3561,6 +3868,53 @@ meta_renderer_native_get_frame_counter (MetaRendererNative *renderer_native)
   return renderer_native->frame_counter;
 }
 
+MetaGpuKms *
+meta_renderer_native_get_primary_gpu (MetaRendererNative *renderer_native)
+{
+  return renderer_native->primary_gpu_kms;
+}
+
+/**
+ * meta_renderer_native_is_scanout_modifier:
+ * @renderer_native: a #MetaRendererNative
+ * @format: a DRM pixel format
+ * @modifier: a DRM format modifier
+ *
+ * Returns whether buffers with the given format and modifier could be put
+ * on the primary plane of any CRTC of the primary GPU, as far as is known
+ * up front.
+ */
+gboolean
+meta_renderer_native_is_scanout_modifier (MetaRendererNative *renderer_native,
+                                          uint32_t            format,
+                                          uint64_t            modifier)
+{
+  MetaGpu *gpu = META_GPU (renderer_native->primary_gpu_kms);
+  GList *l;
+
+  if (!renderer_native->use_modifiers)
+    return FALSE;
+
+  for (l = meta_gpu_get_crtcs (gpu); l; l = l->next)
+    {
+      MetaCrtc *crtc = l->data;
+      GArray *crtc_mods;
+      unsigned int i;
+
+      crtc_mods = meta_crtc_kms_get_modifiers (crtc, format);
+      if (!crtc_mods)
+        continue;
+
+      for (i = 0; i < crtc_mods->len; i++)
+        {
+          if (g_array_index (crtc_mods, uint64_t, i) == modifier)
+            return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
 static void
 meta_renderer_native_get_property (GObject    *object,
                                    guint       prop_id,
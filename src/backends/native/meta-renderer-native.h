@@ -71,4 +71,10 @@ void meta_renderer_native_finish_frame (MetaRendererNative *renderer_native);
 
 int64_t meta_renderer_native_get_frame_counter (MetaRendererNative *renderer_native);
 
+MetaGpuKms * meta_renderer_native_get_primary_gpu (MetaRendererNative *renderer_native);
+
+gboolean meta_renderer_native_is_scanout_modifier (MetaRendererNative *renderer_native,
+                                                   uint32_t            format,
+                                                   uint64_t            modifier);
+
 #endif /* META_RENDERER_NATIVE_H */
@@ -0,0 +1,256 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2019 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+/*
+ * A client buffer imported as a KMS framebuffer, so that it can be flipped
+ * to directly instead of being composited into the stage framebuffer.
+ */
+
+#include "config.h"
+
+#include "backends/native/meta-scanout-kms.h"
+
+#include <drm_fourcc.h>
+#include <errno.h>
+#include <gio/gio.h>
+#include <xf86drmMode.h>
+
+#ifndef DRM_FORMAT_MOD_INVALID
+#define DRM_FORMAT_MOD_INVALID ((1ULL << 56) - 1)
+#endif
+
+struct _MetaScanoutKms
+{
+  GObject parent;
+
+  MetaGpuKms *gpu_kms;
+  struct gbm_bo *bo;
+  uint32_t fb_id;
+
+  int use_count;
+};
+
+enum
+{
+  RELEASED,
+
+  N_SIGNALS
+};
+
+static guint signals[N_SIGNALS];
+
+static void
+cogl_scanout_iface_init (CoglScanoutInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (MetaScanoutKms, meta_scanout_kms, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (COGL_TYPE_SCANOUT,
+                                                cogl_scanout_iface_init))
+
+static gboolean
+add_framebuffer (MetaScanoutKms  *scanout_kms,
+                 GError         **error)
+{
+  struct gbm_bo *bo = scanout_kms->bo;
+  int kms_fd = meta_gpu_kms_get_fd (scanout_kms->gpu_kms);
+  uint32_t handles[4] = { 0, };
+  uint32_t strides[4] = { 0, };
+  uint32_t offsets[4] = { 0, };
+  uint64_t modifiers[4] = { 0, };
+  uint64_t modifier;
+  int n_planes;
+  int ret;
+  int i;
+
+  modifier = gbm_bo_get_modifier (bo);
+  n_planes = gbm_bo_get_plane_count (bo);
+  for (i = 0; i < n_planes; i++)
+    {
+      handles[i] = gbm_bo_get_handle_for_plane (bo, i).u32;
+      strides[i] = gbm_bo_get_stride_for_plane (bo, i);
+      offsets[i] = gbm_bo_get_offset (bo, i);
+      modifiers[i] = modifier;
+    }
+
+  if (modifier != DRM_FORMAT_MOD_INVALID)
+    {
+      ret = drmModeAddFB2WithModifiers (kms_fd,
+                                        gbm_bo_get_width (bo),
+                                        gbm_bo_get_height (bo),
+                                        gbm_bo_get_format (bo),
+                                        handles,
+                                        strides,
+                                        offsets,
+                                        modifiers,
+                                        &scanout_kms->fb_id,
+                                        DRM_MODE_FB_MODIFIERS);
+    }
+  else
+    {
+      ret = drmModeAddFB2 (kms_fd,
+                           gbm_bo_get_width (bo),
+                           gbm_bo_get_height (bo),
+                           gbm_bo_get_format (bo),
+                           handles,
+                           strides,
+                           offsets,
+                           &scanout_kms->fb_id,
+                           0);
+    }
+
+  if (ret != 0)
+    {
+      g_set_error (error, G_IO_ERROR,
+                   g_io_error_from_errno (errno),
+                   "Failed to add framebuffer: %s", g_strerror (errno));
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * meta_scanout_kms_new:
+ * @gpu_kms: the #MetaGpuKms the buffer object was created or imported on
+ * @bo: the buffer object to scan out
+ * @error: return location for a #GError
+ *
+ * Creates a scanout buffer for @bo, taking ownership of @bo on success.
+ *
+ * Returns: (transfer full): a new #MetaScanoutKms, or %NULL on failure
+ */
+MetaScanoutKms *
+meta_scanout_kms_new (MetaGpuKms     *gpu_kms,
+                      struct gbm_bo  *bo,
+                      GError        **error)
+{
+  MetaScanoutKms *scanout_kms;
+
+  scanout_kms = g_object_new (META_TYPE_SCANOUT_KMS, NULL);
+  scanout_kms->gpu_kms = gpu_kms;
+  scanout_kms->bo = bo;
+
+  if (!add_framebuffer (scanout_kms, error))
+    {
+      scanout_kms->bo = NULL;
+      g_object_unref (scanout_kms);
+      return NULL;
+    }
+
+  return scanout_kms;
+}
+
+MetaGpuKms *
+meta_scanout_kms_get_gpu_kms (MetaScanoutKms *scanout_kms)
+{
+  return scanout_kms->gpu_kms;
+}
+
+uint32_t
+meta_scanout_kms_get_fb_id (MetaScanoutKms *scanout_kms)
+{
+  return scanout_kms->fb_id;
+}
+
+/**
+ * meta_scanout_kms_begin_use:
+ * @scanout_kms: a #MetaScanoutKms
+ *
+ * Marks @scanout_kms as queued for or being scanned out. Every call must be
+ * paired with a call to meta_scanout_kms_end_use() once KMS has flipped
+ * away from the buffer.
+ */
+void
+meta_scanout_kms_begin_use (MetaScanoutKms *scanout_kms)
+{
+  scanout_kms->use_count++;
+}
+
+/**
+ * meta_scanout_kms_end_use:
+ * @scanout_kms: a #MetaScanoutKms
+ *
+ * Undoes a meta_scanout_kms_begin_use(), emitting #MetaScanoutKms::released
+ * once KMS no longer uses the buffer at all.
+ */
+void
+meta_scanout_kms_end_use (MetaScanoutKms *scanout_kms)
+{
+  g_return_if_fail (scanout_kms->use_count > 0);
+
+  scanout_kms->use_count--;
+  if (scanout_kms->use_count == 0)
+    g_signal_emit (scanout_kms, signals[RELEASED], 0);
+}
+
+gboolean
+meta_scanout_kms_is_in_use (MetaScanoutKms *scanout_kms)
+{
+  return scanout_kms->use_count > 0;
+}
+
+static void
+meta_scanout_kms_finalize (GObject *object)
+{
+  MetaScanoutKms *scanout_kms = META_SCANOUT_KMS (object);
+
+  if (scanout_kms->fb_id)
+    {
+      int kms_fd = meta_gpu_kms_get_fd (scanout_kms->gpu_kms);
+
+      drmModeRmFB (kms_fd, scanout_kms->fb_id);
+    }
+
+  g_clear_pointer (&scanout_kms->bo, gbm_bo_destroy);
+
+  G_OBJECT_CLASS (meta_scanout_kms_parent_class)->finalize (object);
+}
+
+static void
+cogl_scanout_iface_init (CoglScanoutInterface *iface)
+{
+}
+
+static void
+meta_scanout_kms_init (MetaScanoutKms *scanout_kms)
+{
+}
+
+static void
+meta_scanout_kms_class_init (MetaScanoutKmsClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = meta_scanout_kms_finalize;
+
+  /**
+   * MetaScanoutKms::released:
+   *
+   * Emitted when KMS has flipped away from the buffer, i.e. when it is no
+   * longer queued for or being scanned out on any CRTC.
+   */
+  signals[RELEASED] =
+    g_signal_new ("released",
+                  G_TYPE_FROM_CLASS (object_class),
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL, NULL,
+                  G_TYPE_NONE, 0);
+}
@@ -0,0 +1,49 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2019 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#ifndef META_SCANOUT_KMS_H
+#define META_SCANOUT_KMS_H
+
+#include <gbm.h>
+#include <glib-object.h>
+
+#include "backends/native/meta-gpu-kms.h"
+#include "cogl/cogl.h"
+
+#define META_TYPE_SCANOUT_KMS (meta_scanout_kms_get_type ())
+G_DECLARE_FINAL_TYPE (MetaScanoutKms, meta_scanout_kms,
+                      META, SCANOUT_KMS, GObject)
+
+MetaScanoutKms * meta_scanout_kms_new (MetaGpuKms     *gpu_kms,
+                                       struct gbm_bo  *bo,
+                                       GError        **error);
+
+MetaGpuKms * meta_scanout_kms_get_gpu_kms (MetaScanoutKms *scanout_kms);
+
+uint32_t meta_scanout_kms_get_fb_id (MetaScanoutKms *scanout_kms);
+
+void meta_scanout_kms_begin_use (MetaScanoutKms *scanout_kms);
+
+void meta_scanout_kms_end_use (MetaScanoutKms *scanout_kms);
+
+gboolean meta_scanout_kms_is_in_use (MetaScanoutKms *scanout_kms);
+
+#endif /* META_SCANOUT_KMS_H */
@@ -27,6 +27,8 @@
 #include "backends/native/meta-stage-native.h"
 
 #include "backends/meta-backend-private.h"
+#include "backends/meta-monitor-manager-private.h"
+#include "backends/native/meta-gpu-kms.h"
 #include "backends/native/meta-renderer-native.h"
 #include "meta/meta-backend.h"
 #include "meta/meta-monitor-manager.h"
@@ -34,6 +36,8 @@
 
 static GQuark quark_view_frame_closure  = 0;
 
+static ClutterStageWindowInterface *clutter_stage_window_parent_iface = NULL;
+
 struct _MetaStageNative
 {
   ClutterStageCogl parent;
@@ -42,6 +46,8 @@ struct _MetaStageNative
 
   int64_t presented_frame_counter_sync;
   int64_t presented_frame_counter_complete;
+
+  guint flush_cursors_id;
 };
 
 static void
@@ -52,6 +58,12 @@ G_DEFINE_TYPE_WITH_CODE (MetaStageNative, meta_stage_native,
                          G_IMPLEMENT_INTERFACE (CLUTTER_TYPE_STAGE_WINDOW,
                                                 clutter_stage_window_iface_init))
 
+typedef struct _FrameClosureData
+{
+  MetaStageNative *stage_native;
+  ClutterStageView *stage_view;
+} FrameClosureData;
+
 static void
 frame_cb (CoglOnscreen  *onscreen,
           CoglFrameEvent frame_event,
@@ -59,14 +71,36 @@ frame_cb (CoglOnscreen  *onscreen,
           void          *user_data)
 
 {
-  MetaStageNative *stage_native = user_data;
+  FrameClosureData *closure_data = user_data;
+  MetaStageNative *stage_native = closure_data->stage_native;
   ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_native);
   int64_t global_frame_counter;
   int64_t presented_frame_counter;
   ClutterFrameInfo clutter_frame_info;
+  ClutterFrameInfoFlag flags = CLUTTER_FRAME_INFO_FLAG_NONE;
+
+  if (cogl_frame_info_is_hw_clock (frame_info))
+    flags |= CLUTTER_FRAME_INFO_FLAG_HW_CLOCK;
+  if (cogl_frame_info_is_zero_copy (frame_info))
+    flags |= CLUTTER_FRAME_INFO_FLAG_ZERO_COPY;
+  if (cogl_frame_info_is_vsync (frame_info))
+    flags |= CLUTTER_FRAME_INFO_FLAG_VSYNC;
 
   global_frame_counter = cogl_frame_info_get_global_frame_counter (frame_info);
 
+  clutter_frame_info = (ClutterFrameInfo) {
+    .frame_counter = global_frame_counter,
+    .refresh_rate = cogl_frame_info_get_refresh_rate (frame_info),
+    .presentation_time = cogl_frame_info_get_presentation_time (frame_info),
+    .flags = flags,
+    .sequence = cogl_frame_info_get_sequence (frame_info),
+  };
+
+  _clutter_stage_cogl_view_presented (stage_cogl,
+                                      closure_data->stage_view,
+                                      frame_event,
+                                      &clutter_frame_info);
+
   switch (frame_event)
     {
     case COGL_FRAME_EVENT_SYNC:
@@ -84,12 +118,6 @@ frame_cb (CoglOnscreen  *onscreen,
   if (global_frame_counter <= presented_frame_counter)
     return;
 
-  clutter_frame_info = (ClutterFrameInfo) {
-    .frame_counter = global_frame_counter,
-    .refresh_rate = cogl_frame_info_get_refresh_rate (frame_info),
-    .presentation_time = cogl_frame_info_get_presentation_time (frame_info)
-  };
-
   _clutter_stage_cogl_presented (stage_cogl, frame_event, &clutter_frame_info);
 }
 
@@ -100,18 +128,23 @@ ensure_frame_callback (MetaStageNative  *stage_native,
   CoglFramebuffer *framebuffer;
   CoglOnscreen *onscreen;
   CoglClosure *closure;
+  FrameClosureData *closure_data;
 
   closure = g_object_get_qdata (G_OBJECT (stage_view),
                                 quark_view_frame_closure);
   if (closure)
     return;
 
+  closure_data = g_new0 (FrameClosureData, 1);
+  closure_data->stage_native = stage_native;
+  closure_data->stage_view = stage_view;
+
   framebuffer = clutter_stage_view_get_onscreen (stage_view);
   onscreen = COGL_ONSCREEN (framebuffer);
   closure = cogl_onscreen_add_frame_callback (onscreen,
                                               frame_cb,
-                                              stage_native,
-                                              NULL);
+                                              closure_data,
+                                              g_free);
   g_object_set_qdata (G_OBJECT (stage_view),
                       quark_view_frame_closure,
                       closure);
@@ -139,6 +172,9 @@ meta_stage_native_rebuild_views (MetaStageNative *stage_native)
   MetaRenderer *renderer = meta_backend_get_renderer (backend);
   ClutterActor *stage = meta_backend_get_stage (backend);
 
+  /* The frames pending on the old views will not be reported */
+  _clutter_stage_cogl_reset_pending_frames (CLUTTER_STAGE_COGL (stage_native));
+
   meta_renderer_rebuild_views (renderer);
   meta_renderer_native_queue_modes_reset (META_RENDERER_NATIVE (renderer));
   clutter_stage_update_resource_scales (CLUTTER_STAGE (stage));
@@ -197,6 +233,61 @@ meta_stage_native_get_frame_counter (ClutterStageWindow *stage_window)
   return meta_renderer_native_get_frame_counter (renderer_native);
 }
 
+static void
+set_flips_scheduled (gboolean scheduled)
+{
+  MetaBackend *backend = meta_get_backend ();
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+  GList *l;
+
+  for (l = meta_monitor_manager_get_gpus (monitor_manager); l; l = l->next)
+    meta_gpu_kms_set_flip_scheduled (META_GPU_KMS (l->data), scheduled);
+}
+
+static gboolean
+flush_cursors_idle (gpointer user_data)
+{
+  MetaStageNative *stage_native = user_data;
+  MetaBackend *backend = meta_get_backend ();
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+  GList *l;
+
+  stage_native->flush_cursors_id = 0;
+
+  for (l = meta_monitor_manager_get_gpus (monitor_manager); l; l = l->next)
+    meta_gpu_kms_flush_cursors (META_GPU_KMS (l->data));
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+meta_stage_native_schedule_update (ClutterStageWindow *stage_window,
+                                   int                 sync_delay)
+{
+  set_flips_scheduled (TRUE);
+
+  clutter_stage_window_parent_iface->schedule_update (stage_window,
+                                                      sync_delay);
+}
+
+static void
+meta_stage_native_clear_update_time (ClutterStageWindow *stage_window)
+{
+  MetaStageNative *stage_native = META_STAGE_NATIVE (stage_window);
+
+  clutter_stage_window_parent_iface->clear_update_time (stage_window);
+
+  set_flips_scheduled (FALSE);
+
+  /* The master clock schedules the next update right away if there is
+   * more to draw; only commit held back cursor changes if it didn't. */
+  if (!stage_native->flush_cursors_id)
+    stage_native->flush_cursors_id = g_idle_add (flush_cursors_idle,
+                                                 stage_native);
+}
+
 static void
 meta_stage_native_finish_frame (ClutterStageWindow *stage_window)
 {
@@ -206,16 +297,36 @@ meta_stage_native_finish_frame (ClutterStageWindow *stage_window)
   meta_renderer_native_finish_frame (META_RENDERER_NATIVE (renderer));
 }
 
+static void
+meta_stage_native_dispose (GObject *object)
+{
+  MetaStageNative *stage_native = META_STAGE_NATIVE (object);
+
+  if (stage_native->flush_cursors_id)
+    {
+      g_source_remove (stage_native->flush_cursors_id);
+      stage_native->flush_cursors_id = 0;
+    }
+
+  G_OBJECT_CLASS (meta_stage_native_parent_class)->dispose (object);
+}
+
 static void
 meta_stage_native_init (MetaStageNative *stage_native)
 {
   stage_native->presented_frame_counter_sync = -1;
   stage_native->presented_frame_counter_complete = -1;
+
+  CLUTTER_STAGE_COGL (stage_native)->paces_views = TRUE;
 }
 
 static void
 meta_stage_native_class_init (MetaStageNativeClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = meta_stage_native_dispose;
+
   quark_view_frame_closure =
     g_quark_from_static_string ("-meta-native-stage-view-frame-closure");
 }
@@ -223,6 +334,10 @@ meta_stage_native_class_init (MetaStageNativeClass *klass)
 static void
 clutter_stage_window_iface_init (ClutterStageWindowInterface *iface)
 {
+  clutter_stage_window_parent_iface = g_type_interface_peek_parent (iface);
+
+  iface->schedule_update = meta_stage_native_schedule_update;
+  iface->clear_update_time = meta_stage_native_clear_update_time;
   iface->can_clip_redraws = meta_stage_native_can_clip_redraws;
   iface->get_geometry = meta_stage_native_get_geometry;
   iface->get_views = meta_stage_native_get_views;
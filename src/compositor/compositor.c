@@ -57,11 +57,16 @@
 #include <X11/extensions/shape.h>
 #include <X11/extensions/Xcomposite.h>
 
+#include "backends/meta-backend-private.h"
 #include "backends/meta-dnd-private.h"
+#include "backends/meta-logical-monitor.h"
+#include "backends/meta-renderer.h"
+#include "backends/meta-stage-private.h"
 #include "backends/x11/meta-backend-x11.h"
 #include "clutter/clutter-mutter.h"
 #include "clutter/x11/clutter-x11.h"
 #include "compositor/meta-sync-ring.h"
+#include "compositor/meta-texture-tower.h"
 #include "compositor/meta-window-actor-x11.h"
 #include "compositor/meta-window-actor-wayland.h"
 #include "compositor/meta-window-actor-private.h"
@@ -83,6 +88,8 @@
 #include "x11/meta-x11-display-private.h"
 
 #ifdef HAVE_WAYLAND
+#include "compositor/meta-surface-actor-wayland.h"
+#include "wayland/meta-wayland-presentation-time.h"
 #include "wayland/meta-wayland-private.h"
 #endif
 
@@ -507,6 +514,12 @@ meta_compositor_manage (MetaCompositor *compositor)
                     G_CALLBACK (on_presented),
                     compositor);
 
+#ifdef HAVE_WAYLAND
+  g_signal_connect (compositor->stage, "view-presented",
+                    G_CALLBACK (on_view_presented),
+                    compositor);
+#endif
+
   /* We use connect_after() here to accomodate code in GNOME Shell that,
    * when benchmarking drawing performance, connects to ::after-paint
    * and calls glFinish(). The timing information from that will be
@@ -571,6 +584,26 @@ meta_compositor_manage (MetaCompositor *compositor)
   compositor->plugin_mgr = meta_plugin_manager_new (compositor);
 }
 
+/**
+ * meta_compositor_redirect_x11_windows:
+ * @compositor: a #MetaCompositor
+ *
+ * Takes the compositing manager selection and redirects the windows of
+ * an X11 display that was opened after meta_compositor_manage(), as
+ * happens when Xwayland is started on demand.
+ */
+void
+meta_compositor_redirect_x11_windows (MetaCompositor *compositor)
+{
+  MetaDisplay *display = compositor->display;
+
+  if (!display->x11_display)
+    return;
+
+  meta_x11_display_set_cm_selection (display->x11_display);
+  redirect_windows (display->x11_display);
+}
+
 void
 meta_compositor_unmanage (MetaCompositor *compositor)
 {
@@ -1155,6 +1188,118 @@ on_presented (ClutterStage     *stage,
     }
 }
 
+#ifdef HAVE_WAYLAND
+static void
+on_view_presented (ClutterStage     *stage,
+                   ClutterStageView *view,
+                   ClutterFrameInfo *frame_info,
+                   MetaCompositor   *compositor)
+{
+  MetaWaylandCompositor *wayland_compositor;
+
+  if (!meta_is_wayland_compositor ())
+    return;
+
+  wayland_compositor = meta_wayland_compositor_get_default ();
+  meta_wayland_compositor_present_frame_callbacks (wayland_compositor,
+                                                   view, frame_info);
+  meta_wayland_presentation_time_present_feedbacks (wayland_compositor,
+                                                    view, frame_info);
+}
+#endif
+
+#ifdef HAVE_WAYLAND
+/*
+ * The Wayland counterpart of unredirecting: when the top window is a
+ * Wayland client covering a whole monitor with nothing else on top, try
+ * to present its buffer directly instead of compositing it.
+ */
+static void
+maybe_assign_scanout (MetaCompositor *compositor)
+{
+  MetaBackend *backend = meta_get_backend ();
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  MetaWindowActor *window_actor = compositor->top_window_actor;
+  MetaWindow *window;
+  MetaLogicalMonitor *logical_monitor;
+  MetaSurfaceActor *surface_actor;
+  MetaWaylandSurface *surface;
+  MetaRendererView *view;
+  ClutterStageView *stage_view;
+  CoglFramebuffer *framebuffer;
+  CoglScanout *scanout;
+  ClutterRect monitor_rect;
+  float x, y, width, height;
+
+  if (!window_actor ||
+      compositor->disable_unredirect_count > 0 ||
+      compositor->switch_workspace_in_progress > 0 ||
+      meta_window_actor_is_destroyed (window_actor) ||
+      meta_window_actor_effect_in_progress (window_actor) ||
+      !clutter_actor_is_mapped (CLUTTER_ACTOR (window_actor)) ||
+      clutter_actor_get_paint_opacity (CLUTTER_ACTOR (window_actor)) != 255)
+    return;
+
+  window = meta_window_actor_get_meta_window (window_actor);
+  if (meta_window_get_client_type (window) != META_WINDOW_CLIENT_TYPE_WAYLAND)
+    return;
+
+  logical_monitor = meta_window_get_main_logical_monitor (window);
+  if (!logical_monitor)
+    return;
+
+  surface_actor = meta_window_actor_get_surface (window_actor);
+  if (!META_IS_SURFACE_ACTOR_WAYLAND (surface_actor))
+    return;
+
+  surface =
+    meta_surface_actor_wayland_get_surface (META_SURFACE_ACTOR_WAYLAND (surface_actor));
+  if (!surface)
+    return;
+
+  clutter_actor_get_transformed_position (CLUTTER_ACTOR (surface_actor), &x, &y);
+  clutter_actor_get_transformed_size (CLUTTER_ACTOR (surface_actor),
+                                      &width, &height);
+  if (x != logical_monitor->rect.x ||
+      y != logical_monitor->rect.y ||
+      width != logical_monitor->rect.width ||
+      height != logical_monitor->rect.height)
+    return;
+
+  clutter_rect_init (&monitor_rect,
+                     logical_monitor->rect.x, logical_monitor->rect.y,
+                     logical_monitor->rect.width, logical_monitor->rect.height);
+  if (meta_stage_has_visible_overlays (META_STAGE (compositor->stage),
+                                       &monitor_rect))
+    return;
+
+  view = meta_renderer_get_view_from_logical_monitor (renderer,
+                                                      logical_monitor);
+  if (!view)
+    return;
+
+  stage_view = CLUTTER_STAGE_VIEW (view);
+  framebuffer = clutter_stage_view_get_framebuffer (stage_view);
+  if (framebuffer != clutter_stage_view_get_onscreen (stage_view) ||
+      !cogl_is_onscreen (framebuffer))
+    return;
+
+  scanout = meta_wayland_surface_try_acquire_scanout (surface,
+                                                      COGL_ONSCREEN (framebuffer));
+  if (!scanout)
+    return;
+
+  clutter_stage_view_assign_next_scanout (stage_view, scanout);
+  g_object_unref (scanout);
+
+  /* The surface won't be painted if the scanout goes through, but the
+   * client still needs to know it made it to the screen. */
+  meta_surface_actor_wayland_queue_frame_callbacks (META_SURFACE_ACTOR_WAYLAND (surface_actor),
+                                                    stage_view);
+  meta_wayland_presentation_time_queue_feedbacks (surface, stage_view);
+}
+#endif /* HAVE_WAYLAND */
+
 static gboolean
 meta_pre_paint_func (gpointer data)
 {
@@ -1180,6 +1325,11 @@ meta_pre_paint_func (gpointer data)
       set_unredirected_window (compositor, NULL);
     }
 
+#ifdef HAVE_WAYLAND
+  if (meta_is_wayland_compositor ())
+    maybe_assign_scanout (compositor);
+#endif
+
   for (l = compositor->windows; l; l = l->next)
     meta_window_actor_pre_paint (l->data);
 
@@ -1230,6 +1380,8 @@ meta_post_paint_func (gpointer data)
       compositor->frame_has_updated_xsurfaces = FALSE;
     }
 
+  meta_texture_tower_report_frame_stats ();
+
   status = cogl_get_graphics_reset_status (compositor->context);
   switch (status)
     {
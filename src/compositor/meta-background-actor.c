@@ -502,9 +502,16 @@ meta_background_actor_paint (ClutterActor *actor)
   ClutterActorBox actor_box;
   cairo_rectangle_int_t actor_pixel_rect;
   CoglFramebuffer *fb;
+  cairo_region_t *clip_region;
   int i;
 
-  if ((self->clip_region && cairo_region_is_empty (self->clip_region)))
+  /* The clip region only applies to our position on the stage */
+  if (clutter_actor_is_in_clone_paint (actor))
+    clip_region = NULL;
+  else
+    clip_region = self->clip_region;
+
+  if ((clip_region && cairo_region_is_empty (clip_region)))
     return;
 
   clutter_actor_get_content_box (actor, &actor_box);
@@ -524,15 +531,15 @@ meta_background_actor_paint (ClutterActor *actor)
 
   /* Now figure out what to actually paint.
    */
-  if (self->clip_region != NULL)
+  if (clip_region != NULL)
     {
-      int n_rects = cairo_region_num_rectangles (self->clip_region);
+      int n_rects = cairo_region_num_rectangles (clip_region);
       if (n_rects <= MAX_RECTS)
         {
            for (i = 0; i < n_rects; i++)
              {
                cairo_rectangle_int_t rect;
-               cairo_region_get_rectangle (self->clip_region, i, &rect);
+               cairo_region_get_rectangle (clip_region, i, &rect);
 
                if (!gdk_rectangle_intersect (&actor_pixel_rect, &rect, &rect))
                  continue;
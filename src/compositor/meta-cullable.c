@@ -191,9 +191,11 @@ meta_cullable_cull_out (MetaCullable   *cullable,
  * @cullable: The #MetaCullable
  *
  * Actors that copied data in their cull_out() implementation can now
- * reset their data, as the paint is now over. Additional paints may be
- * done by #ClutterClone or similar, and they should not be affected by
- * the culling operation.
+ * reset their data, as it is about to be recomputed. #MetaWindowGroup
+ * keeps the culling applied across paints for as long as it stays valid,
+ * so paints done by #ClutterClone or similar, which should not be
+ * affected by the culling operation, have to ignore the copied data
+ * themselves; see clutter_actor_is_in_clone_paint().
  */
 void
 meta_cullable_reset_culling (MetaCullable *cullable)
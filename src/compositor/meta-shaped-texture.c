@@ -780,11 +780,18 @@ meta_shaped_texture_paint (ClutterActor *actor)
   MetaShapedTexture *stex = META_SHAPED_TEXTURE (actor);
   CoglTexture *paint_tex;
   CoglFramebuffer *fb;
+  cairo_region_t *clip_region;
 
   if (!stex->texture)
     return;
 
-  if (stex->clip_region && cairo_region_is_empty (stex->clip_region))
+  /* The clip region only applies to our position on the stage */
+  if (clutter_actor_is_in_clone_paint (actor))
+    clip_region = NULL;
+  else
+    clip_region = stex->clip_region;
+
+  if (clip_region && cairo_region_is_empty (clip_region))
     return;
 
   if (!CLUTTER_ACTOR_IS_REALIZED (CLUTTER_ACTOR (stex)))
@@ -841,7 +848,7 @@ meta_shaped_texture_paint (ClutterActor *actor)
     return;
 
   fb = cogl_get_draw_framebuffer ();
-  do_paint (META_SHAPED_TEXTURE (actor), fb, paint_tex, stex->clip_region);
+  do_paint (META_SHAPED_TEXTURE (actor), fb, paint_tex, clip_region);
 }
 
 static void
@@ -30,10 +30,14 @@
 
 #include "backends/meta-backend-private.h"
 #include "backends/meta-logical-monitor.h"
+#include "backends/meta-renderer.h"
+#include "clutter/clutter-mutter.h"
 #include "cogl/cogl-wayland-server.h"
 #include "compositor/meta-shaped-texture-private.h"
 #include "compositor/region-utils.h"
+#include "core/window-private.h"
 #include "wayland/meta-wayland-buffer.h"
+#include "wayland/meta-wayland-presentation-time.h"
 #include "wayland/meta-wayland-private.h"
 #include "wayland/meta-window-wayland.h"
 
@@ -43,8 +47,14 @@ struct _MetaSurfaceActorWayland
 
   MetaWaylandSurface *surface;
   struct wl_list frame_callback_list;
+
+  int64_t last_frame_callbacks_time_us;
+  guint obscured_frame_callbacks_id;
 };
 
+/* Fully obscured surfaces are told to draw a frame at most this often. */
+#define OBSCURED_FRAME_CALLBACK_INTERVAL_US (G_USEC_PER_SEC)
+
 G_DEFINE_TYPE (MetaSurfaceActorWayland,
                meta_surface_actor_wayland,
                META_TYPE_SURFACE_ACTOR)
@@ -158,19 +168,188 @@ meta_surface_actor_wayland_get_preferred_height  (ClutterActor *actor,
     *natural_height_p *= scale;
 }
 
+/**
+ * meta_surface_actor_wayland_queue_frame_callbacks:
+ * @self: a #MetaSurfaceActorWayland
+ * @view: (nullable): the #ClutterStageView the surface is presented on
+ *
+ * Queues the pending frame callbacks of the surface to be sent once
+ * @view is presented, or once the current paint is done if @view is
+ * %NULL. This normally happens when the actor is painted, but has to be
+ * done explicitly when the surface is presented without being painted.
+ */
+void
+meta_surface_actor_wayland_queue_frame_callbacks (MetaSurfaceActorWayland *self,
+                                                  ClutterStageView        *view)
+{
+  MetaWaylandCompositor *compositor;
+  MetaWaylandFrameCallback *cb;
+
+  if (!self->surface)
+    return;
+
+  if (wl_list_empty (&self->frame_callback_list))
+    return;
+
+  if (view)
+    {
+      wl_list_for_each (cb, &self->frame_callback_list, link)
+        cb->view = g_object_ref (view);
+    }
+
+  compositor = self->surface->compositor;
+  wl_list_insert_list (&compositor->frame_callbacks, &self->frame_callback_list);
+  wl_list_init (&self->frame_callback_list);
+
+  self->last_frame_callbacks_time_us = g_get_monotonic_time ();
+}
+
+static ClutterStageView *
+get_primary_view (MetaSurfaceActorWayland *self)
+{
+  MetaBackend *backend = meta_get_backend ();
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  MetaWindow *window;
+  MetaLogicalMonitor *logical_monitor;
+
+  window = meta_wayland_surface_get_toplevel_window (self->surface);
+  if (!window)
+    return NULL;
+
+  logical_monitor = meta_window_get_main_logical_monitor (window);
+  if (!logical_monitor)
+    return NULL;
+
+  return CLUTTER_STAGE_VIEW (
+    meta_renderer_get_view_from_logical_monitor (renderer, logical_monitor));
+}
+
+/*
+ * Makes sure @view repaints the part of the actor it shows, so that frame
+ * callbacks held back for it get sent. Returns FALSE if the actor isn't on
+ * @view at all.
+ */
+static gboolean
+queue_redraw_on_view (MetaSurfaceActorWayland *self,
+                      ClutterStageView        *view)
+{
+  ClutterActor *actor = CLUTTER_ACTOR (self);
+  ClutterActorBox box;
+  cairo_rectangle_int_t actor_rect;
+  cairo_rectangle_int_t view_layout;
+  cairo_rectangle_int_t redraw_clip;
+
+  clutter_actor_get_transformed_position (actor, &box.x1, &box.y1);
+  clutter_actor_get_transformed_size (actor, &box.x2, &box.y2);
+  box.x2 += box.x1;
+  box.y2 += box.y1;
+  clutter_actor_box_clamp_to_pixel (&box);
+
+  actor_rect = (cairo_rectangle_int_t) {
+    .x = box.x1,
+    .y = box.y1,
+    .width = box.x2 - box.x1,
+    .height = box.y2 - box.y1,
+  };
+  clutter_stage_view_get_layout (view, &view_layout);
+
+  if (!meta_rectangle_intersect (&actor_rect, &view_layout, &redraw_clip))
+    return FALSE;
+
+  clutter_actor_queue_redraw_with_clip (clutter_actor_get_stage (actor),
+                                        &redraw_clip);
+  return TRUE;
+}
+
+static void
+send_frame_callbacks (MetaSurfaceActorWayland *self)
+{
+  MetaWaylandFrameCallback *cb, *next;
+  uint32_t time_ms = g_get_monotonic_time () / 1000;
+
+  wl_list_for_each_safe (cb, next, &self->frame_callback_list, link)
+    {
+      wl_callback_send_done (cb->resource, time_ms);
+      wl_resource_destroy (cb->resource);
+    }
+
+  self->last_frame_callbacks_time_us = g_get_monotonic_time ();
+}
+
+static gboolean
+obscured_frame_callbacks_timeout (gpointer user_data)
+{
+  MetaSurfaceActorWayland *self = user_data;
+
+  self->obscured_frame_callbacks_id = 0;
+  send_frame_callbacks (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+maybe_throttle_frame_callbacks (MetaSurfaceActorWayland *self)
+{
+  int64_t next_time_us;
+  int64_t now_us;
+
+  if (!meta_surface_actor_is_obscured (META_SURFACE_ACTOR (self)))
+    {
+      if (self->obscured_frame_callbacks_id)
+        {
+          g_source_remove (self->obscured_frame_callbacks_id);
+          self->obscured_frame_callbacks_id = 0;
+        }
+      return FALSE;
+    }
+
+  now_us = g_get_monotonic_time ();
+  next_time_us = (self->last_frame_callbacks_time_us +
+                  OBSCURED_FRAME_CALLBACK_INTERVAL_US);
+  if (now_us >= next_time_us)
+    return FALSE;
+
+  /* Nothing of the surface is visible, so don't have the client draw at
+   * the pace of whatever else is being painted. */
+  if (!self->obscured_frame_callbacks_id)
+    {
+      self->obscured_frame_callbacks_id =
+        g_timeout_add ((next_time_us - now_us) / 1000,
+                       obscured_frame_callbacks_timeout,
+                       self);
+    }
+
+  return TRUE;
+}
+
 static void
 meta_surface_actor_wayland_paint (ClutterActor *actor)
 {
   MetaSurfaceActorWayland *self = META_SURFACE_ACTOR_WAYLAND (actor);
+  ClutterActor *stage;
+  ClutterStageView *view;
 
-  if (self->surface)
+  stage = clutter_actor_get_stage (actor);
+  view = stage ? clutter_stage_get_current_view (CLUTTER_STAGE (stage)) : NULL;
+
+  if (self->surface && !wl_list_empty (&self->frame_callback_list) &&
+      !maybe_throttle_frame_callbacks (self))
     {
-      MetaWaylandCompositor *compositor = self->surface->compositor;
+      ClutterStageView *primary_view = NULL;
+
+      if (view)
+        primary_view = get_primary_view (self);
 
-      wl_list_insert_list (&compositor->frame_callbacks, &self->frame_callback_list);
-      wl_list_init (&self->frame_callback_list);
+      /* Tie the client to the refresh cycle of the output it is mostly on,
+       * not to every view that happens to show some of it. */
+      if (!primary_view || primary_view == view ||
+          !queue_redraw_on_view (self, primary_view))
+        meta_surface_actor_wayland_queue_frame_callbacks (self, view);
     }
 
+  if (self->surface && view)
+    meta_wayland_presentation_time_queue_feedbacks (self->surface, view);
+
   CLUTTER_ACTOR_CLASS (meta_surface_actor_wayland_parent_class)->paint (actor);
 }
 
@@ -182,6 +361,12 @@ meta_surface_actor_wayland_dispose (GObject *object)
   MetaShapedTexture *stex =
     meta_surface_actor_get_texture (META_SURFACE_ACTOR (self));
 
+  if (self->obscured_frame_callbacks_id)
+    {
+      g_source_remove (self->obscured_frame_callbacks_id);
+      self->obscured_frame_callbacks_id = 0;
+    }
+
   meta_shaped_texture_set_texture (stex, NULL);
   if (self->surface)
     {
@@ -27,6 +27,7 @@
 
 #include "compositor/meta-texture-rectangle.h"
 #include "compositor/meta-texture-tower.h"
+#include "meta/util.h"
 
 #ifndef M_LOG2E
 #define M_LOG2E 1.4426950408889634074
@@ -48,6 +49,24 @@
 #define TEXTURE_FORMAT COGL_PIXEL_FORMAT_ARGB_8888_PRE
 #endif
 
+/* Averages a 4x4 block of the source texture using four bilinear
+ * samples, so that a level can be generated from the level two steps
+ * below it in a single pass.
+ */
+static const char *downsample_4x_glsl_declarations =
+"uniform vec2 pixel_step;\n";
+#define SAMPLE(offx, offy) \
+  "cogl_texel += texture2D (cogl_sampler, cogl_tex_coord.st + pixel_step * " \
+  "vec2 (" G_STRINGIFY (offx) ", " G_STRINGIFY (offy) "));\n"
+static const char *downsample_4x_glsl_shader =
+"  cogl_texel = vec4 (0.0);\n"
+  SAMPLE (-1.0, -1.0)
+  SAMPLE (+1.0, -1.0)
+  SAMPLE (-1.0, +1.0)
+  SAMPLE (+1.0, +1.0)
+"  cogl_texel *= 0.25;\n";
+#undef SAMPLE
+
 typedef struct
 {
   guint16 x1;
@@ -62,9 +81,19 @@ struct _MetaTextureTower
   CoglTexture *textures[MAX_TEXTURE_LEVELS];
   CoglOffscreen *fbos[MAX_TEXTURE_LEVELS];
   Box invalid[MAX_TEXTURE_LEVELS];
-  CoglPipeline *pipeline_template;
+  CoglPipeline *pipelines[MAX_TEXTURE_LEVELS];
 };
 
+/* Shared between all towers; the per-level pipelines are copies of
+ * these, so they all end up using the same GL programs.
+ */
+static CoglPipeline *downsample_2x_template;
+static CoglPipeline *downsample_4x_template;
+
+/* Accumulated since the last meta_texture_tower_report_frame_stats() */
+static unsigned int frame_n_revalidated_levels;
+static int64_t frame_revalidate_time_us;
+
 /**
  * meta_texture_tower_new:
  *
@@ -94,9 +123,6 @@ meta_texture_tower_free (MetaTextureTower *tower)
 {
   g_return_if_fail (tower != NULL);
 
-  if (tower->pipeline_template != NULL)
-    cogl_object_unref (tower->pipeline_template);
-
   meta_texture_tower_set_base_texture (tower, NULL);
 
   g_slice_free (MetaTextureTower, tower);
@@ -138,6 +164,12 @@ meta_texture_tower_set_base_texture (MetaTextureTower *tower,
               cogl_object_unref (tower->fbos[i]);
               tower->fbos[i] = NULL;
             }
+
+          if (tower->pipelines[i] != NULL)
+            {
+              cogl_object_unref (tower->pipelines[i]);
+              tower->pipelines[i] = NULL;
+            }
         }
 
       cogl_object_unref (tower->textures[0]);
@@ -381,57 +413,168 @@ texture_tower_create_texture (MetaTextureTower *tower,
   tower->invalid[level].y2 = height;
 }
 
+static gboolean
+texture_tower_level_is_invalid (MetaTextureTower *tower,
+                                int               level)
+{
+  return (tower->invalid[level].x2 != tower->invalid[level].x1 &&
+          tower->invalid[level].y2 != tower->invalid[level].y1);
+}
+
+static CoglContext *
+get_cogl_context (void)
+{
+  return clutter_backend_get_cogl_context (clutter_get_default_backend ());
+}
+
+/* Levels are normally generated from the level just below; when that
+ * is possible with a shader, every other level is skipped, halving the
+ * number of offscreen passes needed to reach a small level. Only the
+ * levels created by the tower itself are used as 4x sources, since the
+ * shader can't sample rectangle or sliced textures.
+ */
+static int
+texture_tower_get_source_level (MetaTextureTower *tower,
+                                int               level)
+{
+  CoglTexture *source_texture;
+
+  if (level < 3)
+    return level - 1;
+
+  if (!cogl_has_feature (get_cogl_context (), COGL_FEATURE_ID_GLSL))
+    return level - 1;
+
+  source_texture = tower->textures[level - 2];
+  if (meta_texture_rectangle_check (source_texture) ||
+      cogl_texture_is_sliced (source_texture))
+    return level - 1;
+
+  return level - 2;
+}
+
+static CoglPipeline *
+texture_tower_get_pipeline (MetaTextureTower *tower,
+                            int               level,
+                            int               source_level)
+{
+  CoglContext *ctx;
+  CoglPipeline *pipeline;
+
+  if (tower->pipelines[level])
+    return tower->pipelines[level];
+
+  ctx = get_cogl_context ();
+
+  if (level - source_level == 1)
+    {
+      if (G_UNLIKELY (downsample_2x_template == NULL))
+        {
+          downsample_2x_template = cogl_pipeline_new (ctx);
+          cogl_pipeline_set_blend (downsample_2x_template,
+                                   "RGBA = ADD (SRC_COLOR, 0)", NULL);
+        }
+
+      pipeline = cogl_pipeline_copy (downsample_2x_template);
+    }
+  else
+    {
+      CoglTexture *source_texture = tower->textures[source_level];
+      float pixel_step[2];
+      int pixel_step_uniform;
+
+      if (G_UNLIKELY (downsample_4x_template == NULL))
+        {
+          CoglSnippet *snippet;
+
+          downsample_4x_template = cogl_pipeline_new (ctx);
+          cogl_pipeline_set_blend (downsample_4x_template,
+                                   "RGBA = ADD (SRC_COLOR, 0)", NULL);
+
+          snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_TEXTURE_LOOKUP,
+                                      downsample_4x_glsl_declarations,
+                                      NULL);
+          cogl_snippet_set_replace (snippet, downsample_4x_glsl_shader);
+          cogl_pipeline_add_layer_snippet (downsample_4x_template, 0, snippet);
+          cogl_object_unref (snippet);
+
+          cogl_pipeline_set_layer_null_texture (downsample_4x_template,
+                                                0, COGL_TEXTURE_TYPE_2D);
+        }
+
+      pipeline = cogl_pipeline_copy (downsample_4x_template);
+
+      /* Sampling one source texel away from the center of each
+       * destination texel, so every bilinear sample averages a 2x2
+       * block of the source. */
+      pixel_step[0] = 1.0f / cogl_texture_get_width (source_texture);
+      pixel_step[1] = 1.0f / cogl_texture_get_height (source_texture);
+      pixel_step_uniform = cogl_pipeline_get_uniform_location (pipeline,
+                                                               "pixel_step");
+      cogl_pipeline_set_uniform_float (pipeline, pixel_step_uniform,
+                                       2, 1, pixel_step);
+    }
+
+  cogl_pipeline_set_layer_texture (pipeline, 0, tower->textures[source_level]);
+  tower->pipelines[level] = pipeline;
+
+  return pipeline;
+}
+
 static void
 texture_tower_revalidate (MetaTextureTower *tower,
                           int               level)
 {
-  CoglTexture *source_texture = tower->textures[level - 1];
+  int source_level = texture_tower_get_source_level (tower, level);
+  CoglTexture *source_texture = tower->textures[source_level];
   int source_texture_width = cogl_texture_get_width (source_texture);
   int source_texture_height = cogl_texture_get_height (source_texture);
   CoglTexture *dest_texture = tower->textures[level];
   int dest_texture_width = cogl_texture_get_width (dest_texture);
   int dest_texture_height = cogl_texture_get_height (dest_texture);
   Box *invalid = &tower->invalid[level];
+  float scale = 1 << (level - source_level);
   CoglFramebuffer *fb;
   CoglError *catch_error = NULL;
   CoglPipeline *pipeline;
 
-  if (tower->fbos[level] == NULL)
-    tower->fbos[level] = cogl_offscreen_new_with_texture (dest_texture);
+  if (source_level > 0 &&
+      texture_tower_level_is_invalid (tower, source_level))
+    texture_tower_revalidate (tower, source_level);
 
-  fb = COGL_FRAMEBUFFER (tower->fbos[level]);
-
-  if (!cogl_framebuffer_allocate (fb, &catch_error))
+  if (tower->fbos[level] == NULL)
     {
-      cogl_error_free (catch_error);
-      return;
-    }
+      tower->fbos[level] = cogl_offscreen_new_with_texture (dest_texture);
 
-  cogl_framebuffer_orthographic (fb, 0, 0, dest_texture_width, dest_texture_height, -1., 1.);
+      fb = COGL_FRAMEBUFFER (tower->fbos[level]);
+      if (!cogl_framebuffer_allocate (fb, &catch_error))
+        {
+          cogl_error_free (catch_error);
+          cogl_object_unref (tower->fbos[level]);
+          tower->fbos[level] = NULL;
+          return;
+        }
 
-  if (!tower->pipeline_template)
-    {
-      CoglContext *ctx =
-        clutter_backend_get_cogl_context (clutter_get_default_backend ());
-      tower->pipeline_template = cogl_pipeline_new (ctx);
-      cogl_pipeline_set_blend (tower->pipeline_template, "RGBA = ADD (SRC_COLOR, 0)", NULL);
+      cogl_framebuffer_orthographic (fb, 0, 0,
+                                     dest_texture_width, dest_texture_height,
+                                     -1., 1.);
     }
 
-  pipeline = cogl_pipeline_copy (tower->pipeline_template);
-  cogl_pipeline_set_layer_texture (pipeline, 0, tower->textures[level - 1]);
+  fb = COGL_FRAMEBUFFER (tower->fbos[level]);
+  pipeline = texture_tower_get_pipeline (tower, level, source_level);
 
   cogl_framebuffer_draw_textured_rectangle (fb, pipeline,
                                             invalid->x1, invalid->y1,
                                             invalid->x2, invalid->y2,
-                                            (2. * invalid->x1) / source_texture_width,
-                                            (2. * invalid->y1) / source_texture_height,
-                                            (2. * invalid->x2) / source_texture_width,
-                                            (2. * invalid->y2) / source_texture_height);
-
-  cogl_object_unref (pipeline);
+                                            (scale * invalid->x1) / source_texture_width,
+                                            (scale * invalid->y1) / source_texture_height,
+                                            (scale * invalid->x2) / source_texture_width,
+                                            (scale * invalid->y2) / source_texture_height);
 
   tower->invalid[level].x1 = tower->invalid[level].x2 = 0;
   tower->invalid[level].y1 = tower->invalid[level].y2 = 0;
+
+  frame_n_revalidated_levels++;
 }
 
 /**
@@ -467,11 +610,13 @@ meta_texture_tower_get_paint_texture (MetaTextureTower *tower)
   level = MIN (level, tower->n_levels - 1);
 
   if (tower->textures[level] == NULL ||
-      (tower->invalid[level].x2 != tower->invalid[level].x1 &&
-       tower->invalid[level].y2 != tower->invalid[level].y1))
+      texture_tower_level_is_invalid (tower, level))
     {
+      int64_t start_time_us;
       int i;
 
+      start_time_us = g_get_monotonic_time ();
+
       for (i = 1; i <= level; i++)
        {
          /* Use "floor" convention here to be consistent with the NPOT texture extension */
@@ -482,13 +627,34 @@ meta_texture_tower_get_paint_texture (MetaTextureTower *tower)
            texture_tower_create_texture (tower, i, texture_width, texture_height);
        }
 
-      for (i = 1; i <= level; i++)
-       {
-         if (tower->invalid[level].x2 != tower->invalid[level].x1 &&
-             tower->invalid[level].y2 != tower->invalid[level].y1)
-           texture_tower_revalidate (tower, i);
-       }
+      /* Only the levels actually needed as sources are brought up to
+       * date; the others stay invalid until they get painted. */
+      if (level > 0)
+        texture_tower_revalidate (tower, level);
+
+      frame_revalidate_time_us += g_get_monotonic_time () - start_time_us;
    }
 
   return tower->textures[level];
 }
+
+/**
+ * meta_texture_tower_report_frame_stats:
+ *
+ * Logs how many tower levels were regenerated since the previous call,
+ * and the CPU time spent doing so, to the compositor debug topic, then
+ * resets the counters. Meant to be called once per frame.
+ */
+void
+meta_texture_tower_report_frame_stats (void)
+{
+  if (frame_n_revalidated_levels == 0)
+    return;
+
+  meta_topic (META_DEBUG_COMPOSITOR,
+              "Texture towers: updated %u levels in %" G_GINT64_FORMAT " us\n",
+              frame_n_revalidated_levels, frame_revalidate_time_us);
+
+  frame_n_revalidated_levels = 0;
+  frame_revalidate_time_us = 0;
+}
@@ -62,6 +62,8 @@ void              meta_texture_tower_update_area       (MetaTextureTower *tower,
                                                         int               height);
 CoglTexture      *meta_texture_tower_get_paint_texture (MetaTextureTower *tower);
 
+void              meta_texture_tower_report_frame_stats (void);
+
 G_END_DECLS
 
 #endif /* __META_TEXTURE_TOWER_H__ */
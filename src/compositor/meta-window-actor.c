@@ -667,9 +667,15 @@ meta_window_actor_paint (ClutterActor *actor)
     {
       MetaShadowParams params;
       cairo_rectangle_int_t shape_bounds;
-      cairo_region_t *clip = priv->shadow_clip;
+      cairo_region_t *clip;
       MetaWindow *window = priv->window;
 
+      /* The shadow clip only applies to our position on the stage */
+      if (clutter_actor_is_in_clone_paint (actor))
+        clip = NULL;
+      else
+        clip = priv->shadow_clip;
+
       meta_window_actor_get_shape_bounds (self, &shape_bounds);
       meta_window_actor_get_shadow_params (self, appears_focused, &params);
 
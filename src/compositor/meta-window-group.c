@@ -23,6 +23,16 @@ struct _MetaWindowGroup
   ClutterActor parent;
 
   MetaDisplay *display;
+
+  /* The result of the last culling pass is kept applied to the children
+   * until something below us queues a redraw, or the region it was
+   * computed for changes. This lets all stage views painted in a frame
+   * share it. Across frames, it only survives when none of the windows
+   * changed and the redraw clip is the same, e.g. for full stage redraws
+   * caused by actors above the windows. */
+  gboolean culling_valid;
+  cairo_rectangle_int_t culled_visible_rect;
+  cairo_rectangle_int_t culled_clip_rect;
 };
 
 static void cullable_iface_init (MetaCullableInterface *iface);
@@ -57,76 +67,76 @@ meta_window_group_paint (ClutterActor *actor)
   cairo_region_t *clip_region;
   cairo_region_t *unobscured_region;
   cairo_rectangle_int_t visible_rect, clip_rect;
-  int paint_x_origin, paint_y_origin;
-  int screen_width, screen_height;
 
   MetaWindowGroup *window_group = META_WINDOW_GROUP (actor);
   ClutterActor *stage = clutter_actor_get_stage (actor);
 
-  meta_display_get_size (window_group->display, &screen_width, &screen_height);
-
-  /* Normally we expect an actor to be drawn at it's position on the screen.
-   * However, if we're inside the paint of a ClutterClone, that won't be the
-   * case and we need to compensate. We look at the position of the window
-   * group under the current model-view matrix and the position of the actor.
-   * If they are both simply integer translations, then we can compensate
-   * easily, otherwise we give up.
-   *
-   * Possible cleanup: work entirely in paint space - we can compute the
-   * combination of the model-view matrix with the local matrix for each child
-   * actor and get a total transformation for that actor for how we are
-   * painting currently, and never worry about how actors are positioned
-   * on the stage.
+  /* The culling state applied to the children describes how they are
+   * seen at their position on the stage. Painting inside a ClutterClone
+   * puts them elsewhere, and the children ignore their culling state
+   * while being painted from a clone, so just paint normally.
    */
   if (clutter_actor_is_in_clone_paint (actor))
     {
-      CoglFramebuffer *fb;
-
-      fb = cogl_get_draw_framebuffer ();
-      if (!meta_actor_painting_untransformed (fb,
-                                              screen_width,
-                                              screen_height,
-                                              &paint_x_origin,
-                                              &paint_y_origin) ||
-          !meta_actor_is_untransformed (actor, NULL, NULL))
-        {
-          CLUTTER_ACTOR_CLASS (meta_window_group_parent_class)->paint (actor);
-          return;
-        }
-    }
-  else
-    {
-      paint_x_origin = 0;
-      paint_y_origin = 0;
+      CLUTTER_ACTOR_CLASS (meta_window_group_parent_class)->paint (actor);
+      return;
     }
 
   visible_rect.x = visible_rect.y = 0;
   visible_rect.width = clutter_actor_get_width (CLUTTER_ACTOR (stage));
   visible_rect.height = clutter_actor_get_height (CLUTTER_ACTOR (stage));
 
-  unobscured_region = cairo_region_create_rectangle (&visible_rect);
-
   /* Get the clipped redraw bounds from Clutter so that we can avoid
    * painting shadows on windows that don't need to be painted in this
    * frame. In the case of a multihead setup with mismatched monitor
    * sizes, we could intersect this with an accurate union of the
    * monitors to avoid painting shadows that are visible only in the
-   * holes. */
+   * holes. The bounds cover the whole stage redraw, not only the view
+   * being painted, so the same culling serves every view. */
   clutter_stage_get_redraw_clip_bounds (CLUTTER_STAGE (stage),
                                         &clip_rect);
 
-  clip_region = cairo_region_create_rectangle (&clip_rect);
+  if (!window_group->culling_valid ||
+      !gdk_rectangle_equal (&visible_rect,
+                            &window_group->culled_visible_rect) ||
+      !gdk_rectangle_equal (&clip_rect,
+                            &window_group->culled_clip_rect))
+    {
+      meta_cullable_reset_culling (META_CULLABLE (window_group));
+
+      unobscured_region = cairo_region_create_rectangle (&visible_rect);
+      clip_region = cairo_region_create_rectangle (&clip_rect);
 
-  cairo_region_translate (clip_region, -paint_x_origin, -paint_y_origin);
+      meta_cullable_cull_out (META_CULLABLE (window_group),
+                              unobscured_region, clip_region);
 
-  meta_cullable_cull_out (META_CULLABLE (window_group), unobscured_region, clip_region);
+      cairo_region_destroy (unobscured_region);
+      cairo_region_destroy (clip_region);
 
-  cairo_region_destroy (unobscured_region);
-  cairo_region_destroy (clip_region);
+      window_group->culled_visible_rect = visible_rect;
+      window_group->culled_clip_rect = clip_rect;
+      window_group->culling_valid = TRUE;
+    }
 
   CLUTTER_ACTOR_CLASS (meta_window_group_parent_class)->paint (actor);
+}
+
+static gboolean
+meta_window_group_queue_redraw (ClutterActor       *actor,
+                                ClutterActor       *leaf_that_queued,
+                                ClutterPaintVolume *paint_volume)
+{
+  MetaWindowGroup *window_group = META_WINDOW_GROUP (actor);
+
+  /* Clutter propagates at least one redraw per frame from every child
+   * that changes, be it its stacking, geometry, opacity or contents.
+   * Content updates may come with a new opaque region, which doesn't
+   * queue a redraw of its own, so any of them invalidates the culling. */
+  window_group->culling_valid = FALSE;
 
-  meta_cullable_reset_culling (META_CULLABLE (window_group));
+  return CLUTTER_ACTOR_CLASS (meta_window_group_parent_class)->queue_redraw (actor,
+                                                                            leaf_that_queued,
+                                                                            paint_volume);
 }
 
 /* Adapted from clutter_actor_update_default_paint_volume() */
@@ -191,6 +201,7 @@ meta_window_group_class_init (MetaWindowGroupClass *klass)
   ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
 
   actor_class->paint = meta_window_group_paint;
+  actor_class->queue_redraw = meta_window_group_queue_redraw;
   actor_class->get_paint_volume = meta_window_group_get_paint_volume;
   actor_class->get_preferred_width = meta_window_group_get_preferred_width;
   actor_class->get_preferred_height = meta_window_group_get_preferred_height;
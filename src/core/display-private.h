@@ -270,6 +270,9 @@ struct _MetaDisplayClass
 
 gboolean      meta_display_open                (void);
 
+gboolean meta_display_init_x11 (MetaDisplay  *display,
+                                GError      **error);
+
 void meta_display_manage_all_windows (MetaDisplay *display);
 void meta_display_unmanage_windows   (MetaDisplay *display,
                                       guint32      timestamp);
@@ -50,6 +50,7 @@
 #include "backends/meta-stage-private.h"
 #include "backends/x11/meta-backend-x11.h"
 #include "clutter/x11/clutter-x11.h"
+#include "compositor/compositor-private.h"
 #include "core/bell.h"
 #include "core/boxes-private.h"
 #include "core/display-private.h"
@@ -71,6 +72,7 @@
 #include "meta/prefs.h"
 #include "x11/meta-startup-notification-x11.h"
 #include "x11/meta-x11-display-private.h"
+#include "x11/window-props.h"
 #include "x11/window-x11.h"
 #include "x11/xprops.h"
 
@@ -790,6 +792,49 @@ meta_display_open (void)
   return TRUE;
 }
 
+/**
+ * meta_display_init_x11:
+ * @display: a #MetaDisplay
+ * @error: return location for a #GError
+ *
+ * Opens the X11 display of a @display that was opened without one, which
+ * is the case when Xwayland is started on demand, once the X server is
+ * ready to accept connections. Windows the X11 clients already created
+ * are managed and redirected right away.
+ *
+ * Returns: %TRUE if the X11 display was opened
+ */
+gboolean
+meta_display_init_x11 (MetaDisplay  *display,
+                       GError      **error)
+{
+  MetaX11Display *x11_display;
+
+  g_return_val_if_fail (display->x11_display == NULL, FALSE);
+
+  if (!meta_x11_init_gdk_display (error))
+    return FALSE;
+
+  x11_display = meta_x11_display_new (display, error);
+  if (!x11_display)
+    return FALSE;
+
+  display->x11_display = x11_display;
+  g_signal_emit (display, display_signals[X11_DISPLAY_OPENED], 0);
+
+  meta_x11_display_restore_active_workspace (x11_display);
+  meta_x11_display_create_guard_window (x11_display);
+
+  meta_compositor_redirect_x11_windows (display->compositor);
+  meta_display_manage_all_windows (display);
+
+  if (!display->focus_window)
+    meta_x11_display_focus_the_no_focus_window (x11_display,
+                                                x11_display->timestamp);
+
+  return TRUE;
+}
+
 static gint
 ptrcmp (gconstpointer a, gconstpointer b)
 {
@@ -2383,7 +2428,8 @@ meta_display_manage_all_windows (MetaDisplay *display)
 {
   guint64 *_children;
   guint64 *children;
-  int n_children, i;
+  Window *xwindows;
+  int n_children, n_xwindows, i;
 
   meta_stack_freeze (display->stack);
   meta_stack_tracker_get_stack (display->stack_tracker, &_children, &n_children);
@@ -2391,13 +2437,31 @@ meta_display_manage_all_windows (MetaDisplay *display)
   /* Copy the stack as it will be modified as part of the loop */
   children = g_memdup (_children, sizeof (guint64) * n_children);
 
+  /* Get the properties of all windows at once, instead of window by
+   * window while managing them. */
+  xwindows = g_new (Window, n_children);
+  n_xwindows = 0;
   for (i = 0; i < n_children; ++i)
     {
-      g_assert (META_STACK_ID_IS_X11 (children[i]));
+      if (META_STACK_ID_IS_X11 (children[i]))
+        xwindows[n_xwindows++] = (Window) children[i];
+    }
+  meta_x11_display_prefetch_initial_properties (display->x11_display,
+                                                xwindows, n_xwindows);
+  g_free (xwindows);
+
+  for (i = 0; i < n_children; ++i)
+    {
+      /* The X11 display may be opened after Wayland windows were mapped. */
+      if (!META_STACK_ID_IS_X11 (children[i]))
+        continue;
+
       meta_window_x11_new (display, children[i], TRUE,
                            META_COMP_EFFECT_NONE);
     }
 
+  meta_x11_display_discard_prefetched_properties (display->x11_display);
+
   g_free (children);
   meta_stack_thaw (display->stack);
 }
@@ -34,6 +34,15 @@ META_EXPORT_TEST
 void meta_override_compositor_configuration (MetaCompositorType compositor_type,
                                              GType              backend_gtype);
 
+typedef enum _MetaX11DisplayPolicy
+{
+  META_X11_DISPLAY_POLICY_MANDATORY,
+  META_X11_DISPLAY_POLICY_ON_DEMAND,
+  META_X11_DISPLAY_POLICY_DISABLED,
+} MetaX11DisplayPolicy;
+
+MetaX11DisplayPolicy meta_get_x11_display_policy (void);
+
 gboolean meta_should_autostart_x11_display (void);
 
 #endif /* META_MAIN_PRIVATE_H */
@@ -592,7 +592,8 @@ meta_init (void)
   meta_clutter_init ();
 
 #ifdef HAVE_WAYLAND
-  /* Bring up Wayland. This also launches Xwayland and sets DISPLAY as well... */
+  /* Bring up Wayland. This also launches Xwayland, unless it is started on
+   * demand, and sets DISPLAY as well... */
   if (meta_is_wayland_compositor ())
     meta_wayland_init ();
 #endif
@@ -733,15 +734,33 @@ prefs_changed_callback (MetaPreference pref,
     }
 }
 
-gboolean
-meta_should_autostart_x11_display (void)
+MetaX11DisplayPolicy
+meta_get_x11_display_policy (void)
 {
   MetaBackend *backend = meta_get_backend ();
-  gboolean wants_x11 = TRUE;
+
+  if (META_IS_BACKEND_X11_CM (backend))
+    return META_X11_DISPLAY_POLICY_MANDATORY;
 
 #ifdef HAVE_WAYLAND
-  wants_x11 = !opt_no_x11;
+  if (opt_no_x11)
+    return META_X11_DISPLAY_POLICY_DISABLED;
+
+  if (meta_is_wayland_compositor ())
+    {
+      MetaSettings *settings = meta_backend_get_settings (backend);
+
+      if (meta_settings_is_experimental_feature_enabled (settings,
+                                                         META_EXPERIMENTAL_FEATURE_XWAYLAND_ON_DEMAND))
+        return META_X11_DISPLAY_POLICY_ON_DEMAND;
+    }
 #endif
 
-  return META_IS_BACKEND_X11_CM (backend) || wants_x11;
+  return META_X11_DISPLAY_POLICY_MANDATORY;
+}
+
+gboolean
+meta_should_autostart_x11_display (void)
+{
+  return meta_get_x11_display_policy () == META_X11_DISPLAY_POLICY_MANDATORY;
 }
@@ -548,6 +548,96 @@ meta_wayland_buffer_process_damage (MetaWaylandBuffer *buffer,
     }
 }
 
+/**
+ * meta_wayland_buffer_try_acquire_scanout:
+ * @buffer: a #MetaWaylandBuffer
+ * @onscreen: the #CoglOnscreen the buffer would be presented on
+ *
+ * Returns: (transfer full) (nullable): a #CoglScanout presenting @buffer
+ * directly on @onscreen, or %NULL if the buffer can't be presented that way
+ */
+CoglScanout *
+meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer *buffer,
+                                         CoglOnscreen      *onscreen)
+{
+  switch (buffer->type)
+    {
+    case META_WAYLAND_BUFFER_TYPE_DMA_BUF:
+      return meta_wayland_dma_buf_try_acquire_scanout (buffer, onscreen);
+    case META_WAYLAND_BUFFER_TYPE_SHM:
+    case META_WAYLAND_BUFFER_TYPE_EGL_IMAGE:
+#ifdef HAVE_WAYLAND_EGLSTREAM
+    case META_WAYLAND_BUFFER_TYPE_EGL_STREAM:
+#endif
+    case META_WAYLAND_BUFFER_TYPE_UNKNOWN:
+      return NULL;
+    }
+
+  g_assert_not_reached ();
+  return NULL;
+}
+
+static gboolean
+meta_wayland_buffer_is_scanned_out (MetaWaylandBuffer *buffer)
+{
+  switch (buffer->type)
+    {
+    case META_WAYLAND_BUFFER_TYPE_DMA_BUF:
+      return meta_wayland_dma_buf_is_scanned_out (buffer->dma_buf.dma_buf);
+    case META_WAYLAND_BUFFER_TYPE_SHM:
+    case META_WAYLAND_BUFFER_TYPE_EGL_IMAGE:
+#ifdef HAVE_WAYLAND_EGLSTREAM
+    case META_WAYLAND_BUFFER_TYPE_EGL_STREAM:
+#endif
+    case META_WAYLAND_BUFFER_TYPE_UNKNOWN:
+      return FALSE;
+    }
+
+  g_assert_not_reached ();
+  return FALSE;
+}
+
+/**
+ * meta_wayland_buffer_send_release:
+ * @buffer: a #MetaWaylandBuffer
+ *
+ * Sends wl_buffer.release for @buffer, unless KMS is still scanning it
+ * out, in which case the release is held back until the page flip
+ * replacing it has completed.
+ */
+void
+meta_wayland_buffer_send_release (MetaWaylandBuffer *buffer)
+{
+  g_return_if_fail (buffer->resource);
+
+  if (meta_wayland_buffer_is_scanned_out (buffer))
+    {
+      buffer->release_deferred = TRUE;
+      return;
+    }
+
+  wl_buffer_send_release (buffer->resource);
+}
+
+/**
+ * meta_wayland_buffer_send_deferred_release:
+ * @buffer: a #MetaWaylandBuffer
+ *
+ * Sends the wl_buffer.release held back by meta_wayland_buffer_send_release(),
+ * if any. Called once the buffer is no longer being scanned out.
+ */
+void
+meta_wayland_buffer_send_deferred_release (MetaWaylandBuffer *buffer)
+{
+  if (!buffer->release_deferred)
+    return;
+
+  buffer->release_deferred = FALSE;
+
+  if (buffer->resource)
+    wl_buffer_send_release (buffer->resource);
+}
+
 static void
 meta_wayland_buffer_finalize (GObject *object)
 {
@@ -53,6 +53,10 @@ struct _MetaWaylandBuffer
 
   gboolean is_y_inverted;
 
+  /* Set when wl_buffer.release was held back because the buffer was
+   * still being scanned out directly. */
+  gboolean release_deferred;
+
   MetaWaylandBufferType type;
 
   struct {
@@ -89,5 +93,9 @@ gboolean                meta_wayland_buffer_is_y_inverted       (MetaWaylandBuff
 void                    meta_wayland_buffer_process_damage      (MetaWaylandBuffer     *buffer,
                                                                  CoglTexture           *texture,
                                                                  cairo_region_t        *region);
+CoglScanout *           meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer     *buffer,
+                                                                 CoglOnscreen          *onscreen);
+void                    meta_wayland_buffer_send_release        (MetaWaylandBuffer     *buffer);
+void                    meta_wayland_buffer_send_deferred_release (MetaWaylandBuffer   *buffer);
 
 #endif /* META_WAYLAND_BUFFER_H */
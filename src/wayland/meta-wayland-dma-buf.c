@@ -30,6 +30,7 @@
 #include "wayland/meta-wayland-dma-buf.h"
 
 #include <drm_fourcc.h>
+#include <errno.h>
 
 #include "backends/meta-backend-private.h"
 #include "backends/meta-egl-ext.h"
@@ -41,6 +42,11 @@
 #include "wayland/meta-wayland-private.h"
 #include "wayland/meta-wayland-versions.h"
 
+#ifdef HAVE_NATIVE_BACKEND
+#include "backends/native/meta-renderer-native.h"
+#include "backends/native/meta-scanout-kms.h"
+#endif
+
 #include "linux-dmabuf-unstable-v1-server-protocol.h"
 
 #ifndef DRM_FORMAT_MOD_INVALID
@@ -61,6 +67,9 @@ struct _MetaWaylandDmaBufBuffer
   int fds[META_WAYLAND_DMA_BUF_MAX_FDS];
   int offsets[META_WAYLAND_DMA_BUF_MAX_FDS];
   unsigned int strides[META_WAYLAND_DMA_BUF_MAX_FDS];
+
+  CoglScanout *scanout;
+  gboolean scanout_import_failed;
 };
 
 G_DEFINE_TYPE (MetaWaylandDmaBufBuffer, meta_wayland_dma_buf_buffer, G_TYPE_OBJECT);
@@ -217,6 +226,146 @@ meta_wayland_dma_buf_buffer_attach (MetaWaylandBuffer  *buffer,
   return TRUE;
 }
 
+#ifdef HAVE_NATIVE_BACKEND
+static CoglScanout *
+import_scanout (MetaWaylandDmaBufBuffer  *dma_buf,
+                MetaGpuKms               *gpu_kms,
+                GError                  **error)
+{
+  struct gbm_device *gbm_device;
+  struct gbm_import_fd_modifier_data import_data = { 0, };
+  struct gbm_bo *bo;
+  MetaScanoutKms *scanout_kms;
+  int n_planes = 0;
+  int i;
+
+  gbm_device = meta_gbm_device_from_gpu (gpu_kms);
+  if (!gbm_device)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "No GBM device to import the buffer with");
+      return NULL;
+    }
+
+  for (i = 0; i < META_WAYLAND_DMA_BUF_MAX_FDS; i++)
+    {
+      if (dma_buf->fds[i] == -1)
+        break;
+
+      import_data.fds[i] = dma_buf->fds[i];
+      import_data.strides[i] = dma_buf->strides[i];
+      import_data.offsets[i] = dma_buf->offsets[i];
+      n_planes++;
+    }
+
+  import_data.width = dma_buf->width;
+  import_data.height = dma_buf->height;
+  import_data.format = dma_buf->drm_format;
+  import_data.num_fds = n_planes;
+  import_data.modifier = dma_buf->drm_modifier;
+
+  bo = gbm_bo_import (gbm_device, GBM_BO_IMPORT_FD_MODIFIER,
+                      &import_data, GBM_BO_USE_SCANOUT);
+  if (!bo)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "gbm_bo_import failed: %s", g_strerror (errno));
+      return NULL;
+    }
+
+  scanout_kms = meta_scanout_kms_new (gpu_kms, bo, error);
+  if (!scanout_kms)
+    {
+      gbm_bo_destroy (bo);
+      return NULL;
+    }
+
+  return COGL_SCANOUT (scanout_kms);
+}
+
+static void
+on_scanout_released (MetaScanoutKms    *scanout_kms,
+                     MetaWaylandBuffer *buffer)
+{
+  meta_wayland_buffer_send_deferred_release (buffer);
+}
+#endif /* HAVE_NATIVE_BACKEND */
+
+/**
+ * meta_wayland_dma_buf_try_acquire_scanout:
+ * @buffer: a #MetaWaylandBuffer backed by a dma-buf
+ * @onscreen: the #CoglOnscreen the buffer would be presented on
+ *
+ * Returns a #CoglScanout presenting the buffer as is on @onscreen, if the
+ * buffer matches it and could be imported as a framebuffer. The import is
+ * kept around for as long as the buffer, since clients usually cycle
+ * through the same few buffers. Releasing @buffer to the client is held
+ * back while KMS is scanning it out.
+ *
+ * Returns: (transfer full) (nullable): a #CoglScanout, or %NULL
+ */
+CoglScanout *
+meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer *buffer,
+                                          CoglOnscreen      *onscreen)
+{
+#ifdef HAVE_NATIVE_BACKEND
+  MetaWaylandDmaBufBuffer *dma_buf = buffer->dma_buf.dma_buf;
+  MetaBackend *backend = meta_get_backend ();
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
+
+  if (!META_IS_RENDERER_NATIVE (renderer))
+    return NULL;
+
+  /* Scanout has no way of flipping the buffer vertically. */
+  if (!dma_buf->is_y_inverted)
+    return NULL;
+
+  if (cogl_framebuffer_get_width (framebuffer) != dma_buf->width ||
+      cogl_framebuffer_get_height (framebuffer) != dma_buf->height)
+    return NULL;
+
+  if (!dma_buf->scanout && !dma_buf->scanout_import_failed)
+    {
+      MetaRendererNative *renderer_native = META_RENDERER_NATIVE (renderer);
+      MetaGpuKms *gpu_kms;
+      GError *error = NULL;
+
+      gpu_kms = meta_renderer_native_get_primary_gpu (renderer_native);
+      dma_buf->scanout = import_scanout (dma_buf, gpu_kms, &error);
+      if (!dma_buf->scanout)
+        {
+          g_debug ("Failed to import buffer for scanout: %s", error->message);
+          g_error_free (error);
+          dma_buf->scanout_import_failed = TRUE;
+          return NULL;
+        }
+
+      g_signal_connect_object (dma_buf->scanout, "released",
+                               G_CALLBACK (on_scanout_released),
+                               buffer, 0);
+    }
+
+  if (!dma_buf->scanout)
+    return NULL;
+
+  return g_object_ref (dma_buf->scanout);
+#else
+  return NULL;
+#endif
+}
+
+gboolean
+meta_wayland_dma_buf_is_scanned_out (MetaWaylandDmaBufBuffer *dma_buf)
+{
+#ifdef HAVE_NATIVE_BACKEND
+  return (dma_buf->scanout &&
+          meta_scanout_kms_is_in_use (META_SCANOUT_KMS (dma_buf->scanout)));
+#else
+  return FALSE;
+#endif
+}
+
 static void
 buffer_params_add (struct wl_client   *client,
                    struct wl_resource *resource,
@@ -482,6 +631,47 @@ static const struct zwp_linux_dmabuf_v1_interface dma_buf_implementation =
   dma_buf_handle_create_buffer_params,
 };
 
+static int
+prefer_scanout_modifiers (uint32_t      format,
+                          EGLuint64KHR *modifiers,
+                          int           n_modifiers)
+{
+#ifdef HAVE_NATIVE_BACKEND
+  MetaBackend *backend = meta_get_backend ();
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  MetaRendererNative *renderer_native;
+  int n_scanout_modifiers = 0;
+  int i;
+
+  if (!META_IS_RENDERER_NATIVE (renderer))
+    return n_modifiers;
+
+  renderer_native = META_RENDERER_NATIVE (renderer);
+
+  for (i = 0; i < n_modifiers; i++)
+    {
+      if (meta_renderer_native_is_scanout_modifier (renderer_native, format,
+                                                    modifiers[i]))
+        n_scanout_modifiers++;
+    }
+
+  if (n_scanout_modifiers == 0 || n_scanout_modifiers == n_modifiers)
+    return n_modifiers;
+
+  n_scanout_modifiers = 0;
+  for (i = 0; i < n_modifiers; i++)
+    {
+      if (meta_renderer_native_is_scanout_modifier (renderer_native, format,
+                                                    modifiers[i]))
+        modifiers[n_scanout_modifiers++] = modifiers[i];
+    }
+
+  return n_scanout_modifiers;
+#else
+  return n_modifiers;
+#endif
+}
+
 static void
 send_modifiers (struct wl_resource *resource,
                 uint32_t            format)
@@ -523,6 +713,12 @@ send_modifiers (struct wl_resource *resource,
       return;
     }
 
+  /* Buffers are only ever imported for scanout on the primary plane of
+   * the primary GPU; as long as any of the modifiers work there, only
+   * advertise those, so that fullscreen clients end up with buffers that
+   * don't need to be composited. */
+  num_modifiers = prefer_scanout_modifiers (format, modifiers, num_modifiers);
+
   for (i = 0; i < num_modifiers; i++)
     {
       zwp_linux_dmabuf_v1_send_modifier (resource, format,
@@ -584,6 +780,8 @@ meta_wayland_dma_buf_buffer_finalize (GObject *object)
   MetaWaylandDmaBufBuffer *dma_buf = META_WAYLAND_DMA_BUF_BUFFER (object);
   int i;
 
+  g_clear_object (&dma_buf->scanout);
+
   for (i = 0; i < META_WAYLAND_DMA_BUF_MAX_FDS; i++)
     {
       if (dma_buf->fds[i] != -1)
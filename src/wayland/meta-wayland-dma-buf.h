@@ -50,4 +50,11 @@ meta_wayland_dma_buf_buffer_attach (MetaWaylandBuffer  *buffer,
 MetaWaylandDmaBufBuffer *
 meta_wayland_dma_buf_from_buffer (MetaWaylandBuffer *buffer);
 
+CoglScanout *
+meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer *buffer,
+                                          CoglOnscreen      *onscreen);
+
+gboolean
+meta_wayland_dma_buf_is_scanned_out (MetaWaylandDmaBufBuffer *dma_buf);
+
 #endif /* META_WAYLAND_DMA_BUF_H */
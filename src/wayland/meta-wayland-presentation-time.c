@@ -0,0 +1,333 @@
+/*
+ * Wayland Support
+ *
+ * Copyright (C) 2019 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+/*
+ * Implements the stable presentation-time protocol. Feedback requested
+ * with a wl_surface.commit follows the committed content: it waits on the
+ * surface until the content is painted, then on the compositor until the
+ * view it was painted on is presented, at which point the page flip
+ * timestamp of that view is sent. Content that is replaced by a later
+ * commit before being painted is reported as discarded.
+ */
+
+#include "config.h"
+
+#include "wayland/meta-wayland-presentation-time.h"
+
+#include <time.h>
+
+#include "backends/meta-backend-private.h"
+#include "backends/meta-logical-monitor.h"
+#include "backends/meta-renderer-view.h"
+#include "backends/meta-renderer.h"
+#include "wayland/meta-wayland-outputs.h"
+#include "wayland/meta-wayland-private.h"
+#include "wayland/meta-wayland-surface.h"
+#include "wayland/meta-wayland-versions.h"
+
+#include "presentation-time-server-protocol.h"
+
+static void
+wp_presentation_feedback_destructor (struct wl_resource *resource)
+{
+  MetaWaylandPresentationFeedback *feedback =
+    wl_resource_get_user_data (resource);
+
+  wl_list_remove (&feedback->link);
+  g_clear_object (&feedback->view);
+  g_free (feedback);
+}
+
+static void
+discard_feedback (MetaWaylandPresentationFeedback *feedback)
+{
+  wp_presentation_feedback_send_discarded (feedback->resource);
+  wl_resource_destroy (feedback->resource);
+}
+
+void
+meta_wayland_presentation_time_discard_feedbacks (struct wl_list *feedbacks)
+{
+  MetaWaylandPresentationFeedback *feedback, *next;
+
+  wl_list_for_each_safe (feedback, next, feedbacks, link)
+    discard_feedback (feedback);
+}
+
+void
+meta_wayland_presentation_time_discard_surface (MetaWaylandCompositor *compositor,
+                                                MetaWaylandSurface    *surface)
+{
+  MetaWaylandPresentationFeedback *feedback, *next;
+
+  meta_wayland_presentation_time_discard_feedbacks (&surface->presentation_feedback_list);
+
+  wl_list_for_each_safe (feedback, next, &compositor->presentation_feedbacks, link)
+    {
+      if (feedback->surface == surface)
+        discard_feedback (feedback);
+    }
+}
+
+/**
+ * meta_wayland_presentation_time_queue_feedbacks:
+ * @surface: a #MetaWaylandSurface
+ * @view: the #ClutterStageView the surface is painted on
+ *
+ * Hands the presentation feedback of the current content of @surface
+ * over to the compositor, to be sent once @view is presented. Called
+ * when the surface is painted, or scanned out, on @view.
+ */
+void
+meta_wayland_presentation_time_queue_feedbacks (MetaWaylandSurface *surface,
+                                                ClutterStageView   *view)
+{
+  MetaWaylandCompositor *compositor = surface->compositor;
+  MetaWaylandPresentationFeedback *feedback;
+
+  if (wl_list_empty (&surface->presentation_feedback_list))
+    return;
+
+  wl_list_for_each (feedback, &surface->presentation_feedback_list, link)
+    feedback->view = g_object_ref (view);
+
+  wl_list_insert_list (compositor->presentation_feedbacks.prev,
+                       &surface->presentation_feedback_list);
+  wl_list_init (&surface->presentation_feedback_list);
+}
+
+/**
+ * meta_wayland_presentation_time_from_frame_info:
+ * @frame_info: a #ClutterFrameInfo
+ *
+ * Returns: the presentation time of the frame on CLOCK_MONOTONIC, in
+ *   nanoseconds
+ */
+int64_t
+meta_wayland_presentation_time_from_frame_info (ClutterFrameInfo *frame_info)
+{
+  ClutterBackend *clutter_backend;
+  CoglContext *cogl_context;
+  int64_t now_cogl_ns;
+  int64_t now_ns;
+
+  now_ns = g_get_monotonic_time () * 1000;
+
+  if (frame_info->flags & CLUTTER_FRAME_INFO_FLAG_HW_CLOCK)
+    return frame_info->presentation_time;
+
+  if (frame_info->presentation_time == 0)
+    return now_ns;
+
+  /* Translate from the Cogl clock, which has an unspecified base. */
+  clutter_backend = clutter_get_default_backend ();
+  cogl_context = clutter_backend_get_cogl_context (clutter_backend);
+  now_cogl_ns = cogl_get_clock_time (cogl_context);
+
+  return now_ns + (frame_info->presentation_time - now_cogl_ns);
+}
+
+static MetaWaylandOutput *
+get_output_for_view (MetaWaylandCompositor *compositor,
+                     ClutterStageView      *view)
+{
+  MetaLogicalMonitor *logical_monitor;
+
+  if (!META_IS_RENDERER_VIEW (view))
+    return NULL;
+
+  logical_monitor =
+    meta_renderer_view_get_logical_monitor (META_RENDERER_VIEW (view));
+  if (!logical_monitor)
+    return NULL;
+
+  return g_hash_table_lookup (compositor->outputs,
+                              &logical_monitor->winsys_id);
+}
+
+static void
+send_sync_output (MetaWaylandPresentationFeedback *feedback,
+                  MetaWaylandOutput               *output)
+{
+  struct wl_client *client = wl_resource_get_client (feedback->resource);
+  GList *l;
+
+  if (!output)
+    return;
+
+  for (l = output->resources; l; l = l->next)
+    {
+      struct wl_resource *output_resource = l->data;
+
+      if (wl_resource_get_client (output_resource) == client)
+        wp_presentation_feedback_send_sync_output (feedback->resource,
+                                                   output_resource);
+    }
+}
+
+/**
+ * meta_wayland_presentation_time_present_feedbacks:
+ * @compositor: the #MetaWaylandCompositor
+ * @view: the #ClutterStageView that was presented
+ * @frame_info: the #ClutterFrameInfo of the presented frame
+ *
+ * Sends the presented event to all feedback waiting for @view.
+ */
+void
+meta_wayland_presentation_time_present_feedbacks (MetaWaylandCompositor *compositor,
+                                                  ClutterStageView      *view,
+                                                  ClutterFrameInfo      *frame_info)
+{
+  MetaBackend *backend = meta_get_backend ();
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  MetaWaylandPresentationFeedback *feedback, *next;
+  MetaWaylandOutput *output;
+  int64_t time_ns;
+  uint64_t time_s;
+  uint32_t refresh_ns;
+  uint64_t sequence;
+  uint32_t flags;
+
+  if (wl_list_empty (&compositor->presentation_feedbacks))
+    return;
+
+  output = get_output_for_view (compositor, view);
+
+  time_ns = meta_wayland_presentation_time_from_frame_info (frame_info);
+  time_s = time_ns / G_GINT64_CONSTANT (1000000000);
+
+  if (frame_info->refresh_rate > 1.0f)
+    refresh_ns = (uint32_t) (1000000000.0 / frame_info->refresh_rate);
+  else
+    refresh_ns = 0;
+
+  sequence = frame_info->sequence;
+
+  flags = 0;
+  if (frame_info->flags & CLUTTER_FRAME_INFO_FLAG_VSYNC)
+    flags |= WP_PRESENTATION_FEEDBACK_KIND_VSYNC;
+  if (frame_info->flags & CLUTTER_FRAME_INFO_FLAG_HW_CLOCK)
+    flags |= (WP_PRESENTATION_FEEDBACK_KIND_HW_CLOCK |
+              WP_PRESENTATION_FEEDBACK_KIND_HW_COMPLETION);
+  if (frame_info->flags & CLUTTER_FRAME_INFO_FLAG_ZERO_COPY)
+    flags |= WP_PRESENTATION_FEEDBACK_KIND_ZERO_COPY;
+
+  wl_list_for_each_safe (feedback, next, &compositor->presentation_feedbacks, link)
+    {
+      if (feedback->view != view)
+        {
+          /* The view was painted on but torn down before presenting. */
+          if (!meta_renderer_has_view (renderer, feedback->view))
+            discard_feedback (feedback);
+          continue;
+        }
+
+      send_sync_output (feedback, output);
+      wp_presentation_feedback_send_presented (feedback->resource,
+                                               (uint32_t) (time_s >> 32),
+                                               (uint32_t) time_s,
+                                               (uint32_t) (time_ns % G_GINT64_CONSTANT (1000000000)),
+                                               refresh_ns,
+                                               (uint32_t) (sequence >> 32),
+                                               (uint32_t) sequence,
+                                               flags);
+      wl_resource_destroy (feedback->resource);
+    }
+}
+
+static void
+wp_presentation_destroy (struct wl_client   *client,
+                         struct wl_resource *resource)
+{
+  wl_resource_destroy (resource);
+}
+
+static void
+wp_presentation_feedback (struct wl_client   *client,
+                          struct wl_resource *resource,
+                          struct wl_resource *surface_resource,
+                          uint32_t            callback_id)
+{
+  MetaWaylandSurface *surface = wl_resource_get_user_data (surface_resource);
+  MetaWaylandPresentationFeedback *feedback;
+
+  feedback = g_new0 (MetaWaylandPresentationFeedback, 1);
+  feedback->surface = surface;
+  feedback->resource = wl_resource_create (client,
+                                           &wp_presentation_feedback_interface,
+                                           wl_resource_get_version (resource),
+                                           callback_id);
+  wl_resource_set_implementation (feedback->resource,
+                                  NULL,
+                                  feedback,
+                                  wp_presentation_feedback_destructor);
+
+  if (!surface)
+    {
+      wl_list_init (&feedback->link);
+      discard_feedback (feedback);
+      return;
+    }
+
+  wl_list_insert (surface->pending->presentation_feedback_list.prev,
+                  &feedback->link);
+}
+
+static const struct wp_presentation_interface
+meta_wayland_presentation_interface = {
+  wp_presentation_destroy,
+  wp_presentation_feedback,
+};
+
+static void
+wp_presentation_bind (struct wl_client *client,
+                      void             *data,
+                      uint32_t          version,
+                      uint32_t          id)
+{
+  struct wl_resource *resource;
+
+  resource = wl_resource_create (client,
+                                 &wp_presentation_interface,
+                                 version,
+                                 id);
+  wl_resource_set_implementation (resource,
+                                  &meta_wayland_presentation_interface,
+                                  data,
+                                  NULL);
+
+  /* Page flip timestamps and g_get_monotonic_time() share this clock. */
+  wp_presentation_send_clock_id (resource, CLOCK_MONOTONIC);
+}
+
+void
+meta_wayland_presentation_time_init (MetaWaylandCompositor *compositor)
+{
+  wl_list_init (&compositor->presentation_feedbacks);
+
+  if (wl_global_create (compositor->wayland_display,
+                        &wp_presentation_interface,
+                        META_WP_PRESENTATION_VERSION,
+                        compositor,
+                        wp_presentation_bind) == NULL)
+    g_error ("Failed to register a global wp_presentation object");
+}
@@ -40,18 +40,38 @@ typedef struct
   struct wl_list link;
   struct wl_resource *resource;
   MetaWaylandSurface *surface;
+
+  /* The view whose presentation the callback is sent on, or NULL to send
+   * it once painting is done. */
+  ClutterStageView *view;
 } MetaWaylandFrameCallback;
 
+typedef struct _MetaXWaylandWmGate MetaXWaylandWmGate;
+
 typedef struct
 {
   int display_index;
   char *lock_file;
   int abstract_fd;
   int unix_fd;
+  struct wl_display *wayland_display;
   struct wl_client *client;
   struct wl_resource *xserver_resource;
   char *display_name;
 
+  /* Xwayland is only spawned once an X11 client connects to one of the
+   * listening sockets, which are watched until then. */
+  gboolean on_demand;
+  guint abstract_fd_watch_id;
+  guint unix_fd_watch_id;
+
+  /* Xwayland only listens on the sockets once a window manager claims
+   * WM_S0. When started on demand, our end of the window manager
+   * connection passed with -wm holds X11 clients off until the X11
+   * display is opened. */
+  int wm_fd;
+  MetaXWaylandWmGate *wm_gate;
+
   GCancellable *xserver_died_cancellable;
   GSubprocess *proc;
   GMainLoop *init_loop;
@@ -68,6 +88,10 @@ struct _MetaWaylandCompositor
   GHashTable *outputs;
   struct wl_list frame_callbacks;
 
+  /* Presentation feedback of painted content, waiting for its view to be
+   * presented. */
+  struct wl_list presentation_feedbacks;
+
   MetaXWaylandManager xwayland_manager;
 
   MetaWaylandSeat *seat;
@@ -46,6 +46,7 @@
 #include "wayland/meta-wayland-legacy-xdg-shell.h"
 #include "wayland/meta-wayland-outputs.h"
 #include "wayland/meta-wayland-pointer.h"
+#include "wayland/meta-wayland-presentation-time.h"
 #include "wayland/meta-wayland-private.h"
 #include "wayland/meta-wayland-region.h"
 #include "wayland/meta-wayland-seat.h"
@@ -387,12 +388,47 @@ meta_wayland_surface_get_buffer (MetaWaylandSurface *surface)
   return surface->buffer_ref.buffer;
 }
 
+/**
+ * meta_wayland_surface_try_acquire_scanout:
+ * @surface: a #MetaWaylandSurface
+ * @onscreen: the #CoglOnscreen the surface would be presented on
+ *
+ * Returns a #CoglScanout presenting the current buffer of @surface in
+ * place of the contents of @onscreen. This is only possible when the
+ * buffer alone makes up what the surface looks like, i.e. without
+ * subsurfaces, buffer transforms or viewport cropping and scaling.
+ *
+ * Returns: (transfer full) (nullable): a #CoglScanout, or %NULL
+ */
+CoglScanout *
+meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface *surface,
+                                          CoglOnscreen       *onscreen)
+{
+  MetaWaylandBuffer *buffer = surface->buffer_ref.buffer;
+
+  if (!buffer || !buffer->resource)
+    return NULL;
+
+  if (surface->subsurfaces ||
+      surface->buffer_transform != META_MONITOR_TRANSFORM_NORMAL ||
+      surface->viewport.has_src_rect ||
+      surface->viewport.has_dst_size)
+    return NULL;
+
+  return meta_wayland_buffer_try_acquire_scanout (buffer, onscreen);
+}
+
 void
 meta_wayland_surface_ref_buffer_use_count (MetaWaylandSurface *surface)
 {
   g_return_if_fail (surface->buffer_ref.buffer);
   g_warn_if_fail (surface->buffer_ref.buffer->resource);
 
+  /* A release still held back from an earlier commit of the same buffer
+   * is covered by the one this use will end with. */
+  if (surface->buffer_ref.use_count == 0)
+    surface->buffer_ref.buffer->release_deferred = FALSE;
+
   surface->buffer_ref.use_count++;
 }
 
@@ -408,7 +444,7 @@ meta_wayland_surface_unref_buffer_use_count (MetaWaylandSurface *surface)
   g_return_if_fail (buffer);
 
   if (surface->buffer_ref.use_count == 0 && buffer->resource)
-    wl_buffer_send_release (buffer->resource);
+    meta_wayland_buffer_send_release (buffer);
 }
 
 static void
@@ -437,6 +473,7 @@ pending_state_init (MetaWaylandPendingState *state)
   state->surface_damage = cairo_region_create ();
   state->buffer_damage = cairo_region_create ();
   wl_list_init (&state->frame_callback_list);
+  wl_list_init (&state->presentation_feedback_list);
 
   state->has_new_geometry = FALSE;
   state->has_new_min_size = FALSE;
@@ -465,6 +502,8 @@ pending_state_destroy (MetaWaylandPendingState *state)
     }
   wl_list_for_each_safe (cb, next, &state->frame_callback_list, link)
     wl_resource_destroy (cb->resource);
+
+  meta_wayland_presentation_time_discard_feedbacks (&state->presentation_feedback_list);
 }
 
 static void
@@ -502,6 +541,12 @@ merge_pending_state (MetaWaylandPendingState *from,
 
   wl_list_insert_list (&to->frame_callback_list, &from->frame_callback_list);
 
+  /* Cached content replaced before it was ever applied. */
+  if (from->newly_attached)
+    meta_wayland_presentation_time_discard_feedbacks (&to->presentation_feedback_list);
+  wl_list_insert_list (&to->presentation_feedback_list,
+                       &from->presentation_feedback_list);
+
   cairo_region_union (to->surface_damage, from->surface_damage);
   cairo_region_union (to->buffer_damage, from->buffer_damage);
   cairo_region_destroy (from->surface_damage);
@@ -798,6 +843,13 @@ meta_wayland_surface_apply_pending_state (MetaWaylandSurface      *surface,
         surface->input_region = NULL;
     }
 
+  /* New content replaces whatever was committed but not painted yet. */
+  if (pending->newly_attached)
+    meta_wayland_presentation_time_discard_feedbacks (&surface->presentation_feedback_list);
+  wl_list_insert_list (&surface->presentation_feedback_list,
+                       &pending->presentation_feedback_list);
+  wl_list_init (&pending->presentation_feedback_list);
+
   if (surface->role)
     {
       meta_wayland_surface_role_commit (surface->role, pending);
@@ -934,6 +986,7 @@ destroy_frame_callback (struct wl_resource *callback_resource)
     wl_resource_get_user_data (callback_resource);
 
   wl_list_remove (&callback->link);
+  g_clear_object (&callback->view);
   g_slice_free (MetaWaylandFrameCallback, callback);
 }
 
@@ -1332,6 +1385,7 @@ wl_surface_destructor (struct wl_resource *resource)
     cairo_region_destroy (surface->input_region);
 
   meta_wayland_compositor_destroy_frame_callbacks (compositor, surface);
+  meta_wayland_presentation_time_discard_surface (compositor, surface);
 
   g_hash_table_foreach (surface->outputs_to_destroy_notify_id, surface_output_disconnect_signal, surface);
   g_hash_table_unref (surface->outputs_to_destroy_notify_id);
@@ -1381,6 +1435,7 @@ meta_wayland_surface_create (MetaWaylandCompositor *compositor,
   wl_resource_set_implementation (surface->resource, &meta_wayland_wl_surface_interface, surface, wl_surface_destructor);
 
   wl_list_init (&surface->pending_frame_callback_list);
+  wl_list_init (&surface->presentation_feedback_list);
 
   sync_drag_dest_funcs (surface);
 
@@ -96,6 +96,9 @@ struct _MetaWaylandPendingState
   /* wl_surface.frame */
   struct wl_list frame_callback_list;
 
+  /* wp_presentation.feedback */
+  struct wl_list presentation_feedback_list;
+
   MetaRectangle new_geometry;
   gboolean has_new_geometry;
 
@@ -165,6 +168,9 @@ struct _MetaWaylandSurface
    */
   struct wl_list pending_frame_callback_list;
 
+  /* Presentation feedback for the current content, until it is painted. */
+  struct wl_list presentation_feedback_list;
+
   /* Intermediate state for when no role has been assigned. */
   struct {
     MetaWaylandBuffer *buffer;
@@ -241,6 +247,9 @@ gboolean            meta_wayland_surface_assign_role (MetaWaylandSurface *surfac
 
 MetaWaylandBuffer  *meta_wayland_surface_get_buffer (MetaWaylandSurface *surface);
 
+CoglScanout        *meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface *surface,
+                                                              CoglOnscreen       *onscreen);
+
 void                meta_wayland_surface_ref_buffer_use_count (MetaWaylandSurface *surface);
 
 void                meta_wayland_surface_unref_buffer_use_count (MetaWaylandSurface *surface);
@@ -130,12 +130,17 @@ meta_wayland_tablet_pad_group_has_button (MetaWaylandTabletPadGroup *group,
       struct libinput_device *libinput_device;
       struct libinput_tablet_pad_mode_group *mode_group;
       guint n_group;
+      gboolean has_button;
 
       libinput_device = clutter_evdev_input_device_get_libinput_device (group->pad->device);
       n_group = g_list_index (group->pad->groups, group);
+
+      clutter_evdev_lock_libinput ();
       mode_group = libinput_device_tablet_pad_get_mode_group (libinput_device, n_group);
+      has_button = libinput_tablet_pad_mode_group_has_button (mode_group, button);
+      clutter_evdev_unlock_libinput ();
 
-      return libinput_tablet_pad_mode_group_has_button (mode_group, button);
+      return has_button;
     }
   else
 #endif
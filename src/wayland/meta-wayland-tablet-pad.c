@@ -79,7 +79,11 @@ group_rings_strips (MetaWaylandTabletPad *pad)
       struct libinput_tablet_pad_mode_group *mode_group = NULL;
 
       if (libinput_device)
-        mode_group = libinput_device_tablet_pad_get_mode_group (libinput_device, n_group);
+        {
+          clutter_evdev_lock_libinput ();
+          mode_group = libinput_device_tablet_pad_get_mode_group (libinput_device, n_group);
+          clutter_evdev_unlock_libinput ();
+        }
 #endif
 
       for (n_elem = 0, l = pad->rings; l; l = l->next)
@@ -154,7 +158,9 @@ meta_wayland_tablet_pad_new (ClutterInputDevice    *device,
       struct libinput_device *libinput_device;
 
       libinput_device = clutter_evdev_input_device_get_libinput_device (device);
+      clutter_evdev_lock_libinput ();
       pad->n_buttons = libinput_device_tablet_pad_get_num_buttons (libinput_device);
+      clutter_evdev_unlock_libinput ();
     }
 #endif
 
@@ -31,6 +31,8 @@
 #include "clutter/clutter.h"
 #include "clutter/wayland/clutter-wayland-compositor.h"
 #include "clutter/wayland/clutter-wayland-surface.h"
+#include "backends/meta-backend-private.h"
+#include "backends/meta-renderer.h"
 #include "core/main-private.h"
 #include "wayland/meta-wayland-data-device.h"
 #include "wayland/meta-wayland-dma-buf.h"
@@ -38,6 +40,7 @@
 #include "wayland/meta-wayland-inhibit-shortcuts-dialog.h"
 #include "wayland/meta-wayland-inhibit-shortcuts.h"
 #include "wayland/meta-wayland-outputs.h"
+#include "wayland/meta-wayland-presentation-time.h"
 #include "wayland/meta-wayland-private.h"
 #include "wayland/meta-wayland-region.h"
 #include "wayland/meta-wayland-seat.h"
@@ -194,18 +197,54 @@ meta_wayland_compositor_update (MetaWaylandCompositor *compositor,
 void
 meta_wayland_compositor_paint_finished (MetaWaylandCompositor *compositor)
 {
+  MetaBackend *backend = meta_get_backend ();
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
   gint64 current_time = g_get_monotonic_time ();
+  MetaWaylandFrameCallback *callback, *next;
 
-  while (!wl_list_empty (&compositor->frame_callbacks))
+  wl_list_for_each_safe (callback, next, &compositor->frame_callbacks, link)
     {
-      MetaWaylandFrameCallback *callback =
-        wl_container_of (compositor->frame_callbacks.next, callback, link);
+      /* Callbacks tied to a view wait for it to be presented, unless the
+       * view went away in the meantime. */
+      if (callback->view && meta_renderer_has_view (renderer, callback->view))
+        continue;
 
       wl_callback_send_done (callback->resource, current_time / 1000);
       wl_resource_destroy (callback->resource);
     }
 }
 
+/**
+ * meta_wayland_compositor_present_frame_callbacks:
+ * @compositor: the #MetaWaylandCompositor instance
+ * @view: the #ClutterStageView that was presented
+ * @frame_info: the #ClutterFrameInfo of the presented frame
+ *
+ * Sends the frame callbacks of the surfaces that were painted on @view,
+ * timestamped with the time @view was presented.
+ */
+void
+meta_wayland_compositor_present_frame_callbacks (MetaWaylandCompositor *compositor,
+                                                 ClutterStageView      *view,
+                                                 ClutterFrameInfo      *frame_info)
+{
+  MetaWaylandFrameCallback *callback, *next;
+  int64_t presentation_time_ns;
+
+  presentation_time_ns =
+    meta_wayland_presentation_time_from_frame_info (frame_info);
+
+  wl_list_for_each_safe (callback, next, &compositor->frame_callbacks, link)
+    {
+      if (callback->view != view)
+        continue;
+
+      wl_callback_send_done (callback->resource,
+                             presentation_time_ns / 1000000);
+      wl_resource_destroy (callback->resource);
+    }
+}
+
 /**
  * meta_wayland_compositor_handle_event:
  * @compositor: the #MetaWaylandCompositor instance
@@ -398,6 +437,7 @@ meta_wayland_init (void)
   meta_wayland_pointer_constraints_init (compositor);
   meta_wayland_xdg_foreign_init (compositor);
   meta_wayland_dma_buf_init (compositor);
+  meta_wayland_presentation_time_init (compositor);
   meta_wayland_keyboard_shortcuts_inhibit_init (compositor);
   meta_wayland_surface_inhibit_shortcuts_dialog_init ();
   meta_wayland_text_input_init (compositor);
@@ -413,9 +453,9 @@ meta_wayland_init (void)
   meta_wayland_eglstream_controller_init (compositor);
 #endif
 
-  if (meta_should_autostart_x11_display ())
+  if (meta_get_x11_display_policy () != META_X11_DISPLAY_POLICY_DISABLED)
     {
-      if (!meta_xwayland_start (&compositor->xwayland_manager, compositor->wayland_display))
+      if (!meta_xwayland_init (&compositor->xwayland_manager, compositor->wayland_display))
         g_error ("Failed to start X Wayland");
     }
 
@@ -438,7 +478,7 @@ meta_wayland_init (void)
       compositor->display_name = g_strdup (display_name);
     }
 
-  if (meta_should_autostart_x11_display ())
+  if (meta_get_x11_display_policy () != META_X11_DISPLAY_POLICY_DISABLED)
     set_gnome_env ("DISPLAY", meta_wayland_get_xwayland_display_name (compositor));
 
   set_gnome_env ("WAYLAND_DISPLAY", meta_wayland_get_wayland_display_name (compositor));
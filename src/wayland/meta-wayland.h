@@ -64,6 +64,10 @@ void                    meta_wayland_compositor_set_input_focus (MetaWaylandComp
 META_EXPORT_TEST
 void                    meta_wayland_compositor_paint_finished  (MetaWaylandCompositor *compositor);
 
+void                    meta_wayland_compositor_present_frame_callbacks (MetaWaylandCompositor *compositor,
+                                                                         ClutterStageView      *view,
+                                                                         ClutterFrameInfo      *frame_info);
+
 META_EXPORT_TEST
 void                    meta_wayland_compositor_destroy_frame_callbacks (MetaWaylandCompositor *compositor,
                                                                          MetaWaylandSurface    *surface);
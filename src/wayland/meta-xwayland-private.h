@@ -21,15 +21,17 @@
 #define META_XWAYLAND_PRIVATE_H
 
 #include <glib.h>
+#include <X11/Xlib.h>
 
 #include "wayland/meta-wayland-private.h"
 
 gboolean
-meta_xwayland_start (MetaXWaylandManager *manager,
-                     struct wl_display   *display);
+meta_xwayland_init (MetaXWaylandManager *manager,
+                    struct wl_display   *display);
 
 void
-meta_xwayland_complete_init (MetaDisplay *display);
+meta_xwayland_complete_init (MetaDisplay *display,
+                             Display     *xdisplay);
 
 void
 meta_xwayland_stop (MetaXWaylandManager *manager);
@@ -29,12 +29,21 @@
 #include <errno.h>
 #include <glib-unix.h>
 #include <glib.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <xcb/xcb.h>
 
 #include "compositor/meta-surface-actor-wayland.h"
+#include "core/display-private.h"
+#include "core/main-private.h"
 #include "meta/main.h"
+#include "meta/util.h"
 #include "wayland/meta-wayland-actor-surface.h"
+#include "x11/meta-x11-display-private.h"
+#include "x11/window-x11.h"
 
 enum
 {
@@ -355,10 +364,9 @@ xserver_died (GObject      *source,
     g_warning ("X Wayland crashed; exiting");
   else
     {
-      /* For now we simply abort if we see the server exit.
-       *
-       * In the future X will only be loaded lazily for legacy X support
-       * but for now it's a hard requirement. */
+      /* For now we simply abort if we see the server exit, even if it
+       * was only started on demand: the X11 display can't be torn down
+       * and reopened at runtime yet. */
       g_warning ("Spurious exit of X Wayland server");
     }
 
@@ -438,15 +446,234 @@ choose_xdisplay (MetaXWaylandManager *manager)
   return TRUE;
 }
 
+typedef struct _MetaXWaylandHeldSurfaceId
+{
+  xcb_window_t window;
+  uint32_t surface_id;
+} MetaXWaylandHeldSurfaceId;
+
+/*
+ * While Xwayland is started on demand, X11 clients may connect before
+ * our X11 display is opened. Windows they map before it selects
+ * SubstructureRedirect would never be managed, and the WL_SURFACE_ID
+ * messages Xwayland sends for them would be lost. Until then, this
+ * connection stands in for the window manager: it claims WM_S0, which
+ * makes Xwayland start accepting clients, and redirects the root
+ * window, so that map requests and surface IDs are held here and can be
+ * handed to the X11 display once it is up.
+ */
+struct _MetaXWaylandWmGate
+{
+  xcb_connection_t *connection;
+  xcb_window_t window;
+  xcb_atom_t atom_wl_surface_id;
+
+  GArray *map_requests;
+  GArray *surface_ids;
+};
+
+static xcb_atom_t
+intern_atom (xcb_connection_t *connection,
+             const char       *name)
+{
+  xcb_intern_atom_reply_t *reply;
+  xcb_atom_t atom;
+
+  reply = xcb_intern_atom_reply (connection,
+                                 xcb_intern_atom (connection, FALSE,
+                                                  strlen (name), name),
+                                 NULL);
+  if (!reply)
+    return XCB_ATOM_NONE;
+
+  atom = reply->atom;
+  free (reply);
+
+  return atom;
+}
+
+static void
+meta_xwayland_wm_gate_free (MetaXWaylandWmGate *wm_gate)
+{
+  xcb_disconnect (wm_gate->connection);
+  g_array_free (wm_gate->map_requests, TRUE);
+  g_array_free (wm_gate->surface_ids, TRUE);
+  g_free (wm_gate);
+}
+
+static MetaXWaylandWmGate *
+meta_xwayland_wm_gate_new (int wm_fd)
+{
+  MetaXWaylandWmGate *wm_gate;
+  xcb_screen_t *screen;
+  xcb_atom_t atom_wm_s0;
+  uint32_t event_mask = XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT;
+  xcb_void_cookie_t cookie;
+  xcb_generic_error_t *error;
+
+  wm_gate = g_new0 (MetaXWaylandWmGate, 1);
+  wm_gate->map_requests = g_array_new (FALSE, FALSE, sizeof (xcb_window_t));
+  wm_gate->surface_ids =
+    g_array_new (FALSE, FALSE, sizeof (MetaXWaylandHeldSurfaceId));
+
+  /* xcb takes ownership of the fd */
+  wm_gate->connection = xcb_connect_to_fd (wm_fd, NULL);
+  if (xcb_connection_has_error (wm_gate->connection))
+    goto fail;
+
+  screen = xcb_setup_roots_iterator (xcb_get_setup (wm_gate->connection)).data;
+
+  wm_gate->atom_wl_surface_id = intern_atom (wm_gate->connection,
+                                             "WL_SURFACE_ID");
+  atom_wm_s0 = intern_atom (wm_gate->connection, "WM_S0");
+  if (atom_wm_s0 == XCB_ATOM_NONE)
+    goto fail;
+
+  wm_gate->window = xcb_generate_id (wm_gate->connection);
+  xcb_create_window (wm_gate->connection, XCB_COPY_FROM_PARENT,
+                     wm_gate->window, screen->root,
+                     -1, -1, 1, 1, 0,
+                     XCB_WINDOW_CLASS_INPUT_ONLY, XCB_COPY_FROM_PARENT,
+                     0, NULL);
+
+  cookie = xcb_change_window_attributes_checked (wm_gate->connection,
+                                                 screen->root,
+                                                 XCB_CW_EVENT_MASK,
+                                                 &event_mask);
+  error = xcb_request_check (wm_gate->connection, cookie);
+  if (error)
+    {
+      free (error);
+      goto fail;
+    }
+
+  /* Redirection is in place before Xwayland starts listening */
+  xcb_set_selection_owner (wm_gate->connection, wm_gate->window,
+                           atom_wm_s0, XCB_CURRENT_TIME);
+  xcb_flush (wm_gate->connection);
+
+  return wm_gate;
+
+fail:
+  meta_xwayland_wm_gate_free (wm_gate);
+  return NULL;
+}
+
+static void
+meta_xwayland_wm_gate_drain (MetaXWaylandWmGate *wm_gate)
+{
+  xcb_generic_event_t *event;
+
+  while ((event = xcb_poll_for_event (wm_gate->connection)))
+    {
+      switch (event->response_type & ~0x80)
+        {
+        case XCB_MAP_REQUEST:
+          {
+            xcb_map_request_event_t *map_request =
+              (xcb_map_request_event_t *) event;
+
+            g_array_append_val (wm_gate->map_requests, map_request->window);
+            break;
+          }
+        case XCB_CLIENT_MESSAGE:
+          {
+            xcb_client_message_event_t *client_message =
+              (xcb_client_message_event_t *) event;
+            MetaXWaylandHeldSurfaceId held_surface_id;
+
+            if (client_message->type != wm_gate->atom_wl_surface_id)
+              break;
+
+            held_surface_id.window = client_message->window;
+            held_surface_id.surface_id = client_message->data.data32[0];
+            g_array_append_val (wm_gate->surface_ids, held_surface_id);
+            break;
+          }
+        default:
+          break;
+        }
+
+      free (event);
+    }
+}
+
+static void
+meta_xwayland_wm_gate_replay (MetaXWaylandWmGate *wm_gate,
+                              MetaDisplay        *display)
+{
+  MetaX11Display *x11_display = display->x11_display;
+  unsigned int i;
+
+  for (i = 0; i < wm_gate->map_requests->len; i++)
+    {
+      xcb_window_t xwindow = g_array_index (wm_gate->map_requests,
+                                            xcb_window_t, i);
+
+      if (meta_x11_display_lookup_x_window (x11_display, xwindow))
+        continue;
+
+      meta_window_x11_new (display, xwindow, FALSE,
+                           META_COMP_EFFECT_CREATE);
+    }
+
+  for (i = 0; i < wm_gate->surface_ids->len; i++)
+    {
+      MetaXWaylandHeldSurfaceId *held_surface_id =
+        &g_array_index (wm_gate->surface_ids, MetaXWaylandHeldSurfaceId, i);
+      MetaWindow *window;
+
+      window = meta_x11_display_lookup_x_window (x11_display,
+                                                 held_surface_id->window);
+      if (window)
+        meta_xwayland_handle_wl_surface_id (window,
+                                            held_surface_id->surface_id);
+    }
+}
+
 static void
 xserver_finished_init (MetaXWaylandManager *manager)
 {
+  MetaDisplay *display;
+  g_autoptr (GError) error = NULL;
+
   /* At this point xwayland is all setup to start accepting
    * connections so we can quit the transient initialization mainloop
    * and unblock meta_wayland_init() to continue initializing mutter.
    * */
-  g_main_loop_quit (manager->init_loop);
-  g_clear_pointer (&manager->init_loop, g_main_loop_unref);
+  if (manager->init_loop)
+    {
+      g_main_loop_quit (manager->init_loop);
+      g_clear_pointer (&manager->init_loop, g_main_loop_unref);
+      return;
+    }
+
+  /* When started on demand, the display is already up and running, so
+   * attach the X11 display to it now. Clients are held off until then,
+   * see MetaXWaylandWmGate. */
+  manager->wm_gate = meta_xwayland_wm_gate_new (manager->wm_fd);
+  manager->wm_fd = -1;
+  if (!manager->wm_gate)
+    {
+      g_warning ("Failed to connect to Xwayland as the window manager");
+      meta_exit (META_EXIT_ERROR);
+      return;
+    }
+
+  display = meta_get_display ();
+  if (!meta_display_init_x11 (display, &error))
+    {
+      g_warning ("Failed to open X11 display on demand: %s", error->message);
+      meta_exit (META_EXIT_ERROR);
+      return;
+    }
+
+  /* The server was grabbed in meta_xwayland_complete_init() */
+  XUngrabServer (display->x11_display->xdisplay);
+  XFlush (display->x11_display->xdisplay);
+
+  meta_xwayland_wm_gate_replay (manager->wm_gate, display);
+  g_clear_pointer (&manager->wm_gate, meta_xwayland_wm_gate_free);
 }
 
 static gboolean
@@ -460,37 +687,59 @@ on_displayfd_ready (int          fd,
    * socket when it's ready. We don't care about the data
    * in the socket, just that it wrote something, since
    * that means it's ready. */
+  close (fd);
   xserver_finished_init (manager);
 
   return G_SOURCE_REMOVE;
 }
 
-gboolean
-meta_xwayland_start (MetaXWaylandManager *manager,
-                     struct wl_display   *wl_display)
+static gboolean
+start_xserver (MetaXWaylandManager *manager)
 {
   int xwayland_client_fd[2];
   int displayfd[2];
-  gboolean started = FALSE;
   g_autoptr(GSubprocessLauncher) launcher = NULL;
   GSubprocessFlags flags;
   GError *error = NULL;
-
-  if (!choose_xdisplay (manager))
-    goto out;
+  int wm_fd[2];
+  const char *args[] = {
+    XWAYLAND_PATH, manager->display_name,
+    "-rootless",
+    "-accessx",
+    "-core",
+    "-listen", "4",
+    "-listen", "5",
+    "-displayfd", "6",
+    NULL, NULL, /* -terminate, or -wm 7 */
+    NULL
+  };
+  int i = G_N_ELEMENTS (args) - 3;
 
   /* We want xwayland to be a wayland client so we make a socketpair to setup a
    * wayland protocol connection. */
   if (socketpair (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, xwayland_client_fd) < 0)
     {
       g_warning ("xwayland_client_fd socketpair failed\n");
-      goto out;
+      return FALSE;
     }
 
   if (socketpair (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, displayfd) < 0)
     {
       g_warning ("displayfd socketpair failed\n");
-      goto out;
+      close (xwayland_client_fd[0]);
+      close (xwayland_client_fd[1]);
+      return FALSE;
+    }
+
+  if (manager->on_demand &&
+      socketpair (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, wm_fd) < 0)
+    {
+      g_warning ("wm_fd socketpair failed\n");
+      close (xwayland_client_fd[0]);
+      close (xwayland_client_fd[1]);
+      close (displayfd[0]);
+      close (displayfd[1]);
+      return FALSE;
     }
 
   /* xwayland, please. */
@@ -504,10 +753,17 @@ meta_xwayland_start (MetaXWaylandManager *manager,
 
   launcher = g_subprocess_launcher_new (flags);
 
+  /* Xwayland gets its own copies of the listening sockets; ours stay
+   * open until meta_xwayland_stop(). */
   g_subprocess_launcher_take_fd (launcher, xwayland_client_fd[1], 3);
-  g_subprocess_launcher_take_fd (launcher, manager->abstract_fd, 4);
-  g_subprocess_launcher_take_fd (launcher, manager->unix_fd, 5);
+  g_subprocess_launcher_take_fd (launcher, dup (manager->abstract_fd), 4);
+  g_subprocess_launcher_take_fd (launcher, dup (manager->unix_fd), 5);
   g_subprocess_launcher_take_fd (launcher, displayfd[1], 6);
+  if (manager->on_demand)
+    {
+      g_subprocess_launcher_take_fd (launcher, wm_fd[1], 7);
+      manager->wm_fd = wm_fd[0];
+    }
 
   g_subprocess_launcher_setenv (launcher, "WAYLAND_SOCKET", "3", TRUE);
 
@@ -516,44 +772,119 @@ meta_xwayland_start (MetaXWaylandManager *manager,
    * manager so it won't exit prematurely either. This ensures that Xwayland
    * won't try to reconnect and crash, leaving uninteresting core dumps. We do
    * want core dumps from Xwayland but only if a real bug occurs...
+   *
+   * When started on demand, the client that triggered the start may well
+   * disconnect before the window manager connects, so -terminate is left
+   * out and meta_xwayland_stop() terminates the server instead. Instead,
+   * the X server gets a window manager connection with -wm, and it only
+   * starts accepting clients once that claims WM_S0.
    */
-  manager->proc = g_subprocess_launcher_spawn (launcher, &error,
-                                               XWAYLAND_PATH, manager->display_name,
-                                               "-rootless",
-                                               "-terminate",
-                                               "-accessx",
-                                               "-core",
-                                               "-listen", "4",
-                                               "-listen", "5",
-                                               "-displayfd", "6",
-                                               NULL);
+  if (manager->on_demand)
+    {
+      args[i++] = "-wm";
+      args[i++] = "7";
+    }
+  else
+    {
+      args[i++] = "-terminate";
+    }
+
+  manager->proc = g_subprocess_launcher_spawnv (launcher, args, &error);
   if (!manager->proc)
     {
       g_error ("Failed to spawn Xwayland: %s", error->message);
-      goto out;
+      return FALSE;
     }
 
   manager->xserver_died_cancellable = g_cancellable_new ();
   g_subprocess_wait_async (manager->proc, manager->xserver_died_cancellable,
                            xserver_died, NULL);
   g_unix_fd_add (displayfd[0], G_IO_IN, on_displayfd_ready, manager);
-  manager->client = wl_client_create (wl_display, xwayland_client_fd[0]);
+  manager->client = wl_client_create (manager->wayland_display,
+                                      xwayland_client_fd[0]);
 
-  /* We need to run a mainloop until we know xwayland has a binding
-   * for our xserver interface at which point we can assume it's
-   * ready to start accepting connections. */
-  manager->init_loop = g_main_loop_new (NULL, FALSE);
-  g_main_loop_run (manager->init_loop);
+  return TRUE;
+}
+
+static void
+remove_x11_socket_watches (MetaXWaylandManager *manager)
+{
+  if (manager->abstract_fd_watch_id)
+    {
+      g_source_remove (manager->abstract_fd_watch_id);
+      manager->abstract_fd_watch_id = 0;
+    }
+
+  if (manager->unix_fd_watch_id)
+    {
+      g_source_remove (manager->unix_fd_watch_id);
+      manager->unix_fd_watch_id = 0;
+    }
+}
+
+static gboolean
+on_x11_socket_activity (int          fd,
+                        GIOCondition condition,
+                        gpointer     user_data)
+{
+  MetaXWaylandManager *manager = user_data;
 
-  started = TRUE;
+  /* The first X11 client is connecting. Its connection is left pending
+   * on the listening socket, for Xwayland to accept once it is up. */
+  remove_x11_socket_watches (manager);
 
-out:
-  if (!started)
+  meta_verbose ("X11 client connecting to %s, starting Xwayland\n",
+                manager->display_name);
+
+  if (!start_xserver (manager))
     {
+      g_warning ("Failed to start Xwayland on demand");
+      meta_exit (META_EXIT_ERROR);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+gboolean
+meta_xwayland_init (MetaXWaylandManager *manager,
+                    struct wl_display   *wl_display)
+{
+  manager->wayland_display = wl_display;
+  manager->wm_fd = -1;
+  manager->on_demand =
+    meta_get_x11_display_policy () == META_X11_DISPLAY_POLICY_ON_DEMAND;
+
+  if (!choose_xdisplay (manager))
+    return FALSE;
+
+  if (manager->on_demand)
+    {
+      manager->abstract_fd_watch_id =
+        g_unix_fd_add (manager->abstract_fd, G_IO_IN,
+                       on_x11_socket_activity, manager);
+      manager->unix_fd_watch_id =
+        g_unix_fd_add (manager->unix_fd, G_IO_IN,
+                       on_x11_socket_activity, manager);
+      return TRUE;
+    }
+
+  if (!start_xserver (manager))
+    {
+      close (manager->abstract_fd);
+      close (manager->unix_fd);
       unlink (manager->lock_file);
       g_clear_pointer (&manager->lock_file, g_free);
+      g_clear_pointer (&manager->display_name, g_free);
+      return FALSE;
     }
-  return started;
+
+  /* We need to run a mainloop until we know xwayland has a binding
+   * for our xserver interface at which point we can assume it's
+   * ready to start accepting connections. */
+  manager->init_loop = g_main_loop_new (NULL, FALSE);
+  g_main_loop_run (manager->init_loop);
+
+  return TRUE;
 }
 
 static void
@@ -564,8 +895,28 @@ on_x11_display_closing (MetaDisplay *display)
 
 /* To be called right after connecting */
 void
-meta_xwayland_complete_init (MetaDisplay *display)
+meta_xwayland_complete_init (MetaDisplay *display,
+                             Display     *xdisplay)
 {
+  MetaWaylandCompositor *compositor = meta_wayland_compositor_get_default ();
+  MetaXWaylandManager *manager = &compositor->xwayland_manager;
+
+  /* Take over from the connection holding X11 clients off. The server
+   * stays grabbed until the X11 display redirected the root window and
+   * managed the existing windows; see xserver_finished_init(). Killing
+   * the holding connection from within the grab releases WM_S0 and the
+   * redirection without letting any other client in between. */
+  if (manager->wm_gate)
+    {
+      XGrabServer (xdisplay);
+      XSync (xdisplay, False);
+
+      meta_xwayland_wm_gate_drain (manager->wm_gate);
+
+      XKillClient (xdisplay, manager->wm_gate->window);
+      XSync (xdisplay, False);
+    }
+
   /* We install an X IO error handler in addition to the child watch,
      because after Xlib connects our child watch may not be called soon
      enough, and therefore we won't crash when X exits (and most important
@@ -583,10 +934,27 @@ meta_xwayland_stop (MetaXWaylandManager *manager)
 {
   char path[256];
 
+  remove_x11_socket_watches (manager);
+
+  g_clear_pointer (&manager->wm_gate, meta_xwayland_wm_gate_free);
+  if (manager->wm_fd != -1)
+    {
+      close (manager->wm_fd);
+      manager->wm_fd = -1;
+    }
+
   g_cancellable_cancel (manager->xserver_died_cancellable);
+  if (manager->proc && manager->on_demand)
+    g_subprocess_send_signal (manager->proc, SIGTERM);
   g_clear_object (&manager->proc);
   g_clear_object (&manager->xserver_died_cancellable);
 
+  if (!manager->display_name)
+    return;
+
+  close (manager->abstract_fd);
+  close (manager->unix_fd);
+
   snprintf (path, sizeof path, "/tmp/.X11-unix/X%d", manager->display_index);
   unlink (path);
 
@@ -40,6 +40,7 @@
 #include "meta/meta-x11-errors.h"
 #include "x11/meta-x11-display-private.h"
 #include "x11/meta-startup-notification-x11.h"
+#include "x11/window-props.h"
 #include "x11/window-x11.h"
 #include "x11/xprops.h"
 
@@ -1745,6 +1746,11 @@ meta_x11_display_handle_xevent (MetaX11Display *x11_display,
   meta_spew_event_print (x11_display, event);
 #endif
 
+  /* Property notifications are coalesced until something else happens,
+   * as handling any other event may depend on the properties. */
+  if (event->type != PropertyNotify)
+    meta_x11_display_flush_property_reloads (x11_display);
+
   if (meta_x11_startup_notification_handle_xevent (x11_display, event))
     {
       bypass_gtk = bypass_compositor = TRUE;
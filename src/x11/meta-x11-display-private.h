@@ -111,6 +111,10 @@ struct _MetaX11Display
   MetaWindowPropHooks *prop_hooks_table;
   GHashTable *prop_hooks;
   int n_prop_hooks;
+  GPtrArray *pending_prop_reloads;
+  GHashTable *pending_prop_reloads_set;
+  guint prop_reloads_idle_id;
+  GHashTable *prefetched_props;
 
   /* Managed by group-props.c */
   MetaGroupPropHooks *group_prop_hooks;
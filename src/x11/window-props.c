@@ -8,7 +8,9 @@
  * and take appropriate action given their values.
  *
  * Note that all the meta_window_reload_propert* functions require a
- * round trip to the server.
+ * round trip to the server. Property notifications are instead queued
+ * with meta_window_queue_property_reload(), which coalesces them and
+ * fetches the new values of all queued properties in a single round trip.
  *
  * The guts of this system are in meta_display_init_window_prop_hooks().
  * Reading this function will give you insight into how this all fits
@@ -41,6 +43,7 @@
 #include "x11/window-props.h"
 
 #include <X11/Xatom.h>
+#include <X11/Xlib-xcb.h>
 #include <unistd.h>
 #include <string.h>
 
@@ -80,6 +83,19 @@ struct _MetaWindowPropHooks
   MetaPropHookFlags flags;
 };
 
+typedef struct
+{
+  MetaWindow *window;
+  Window xwindow;
+  Atom property;
+} PendingPropReload;
+
+typedef struct
+{
+  MetaPropValue *values;
+  int n_values;
+} PrefetchedProps;
+
 static void init_prop_value            (MetaWindow          *window,
                                         MetaWindowPropHooks *hooks,
                                         MetaPropValue       *value);
@@ -129,15 +145,159 @@ meta_window_reload_property (MetaWindow      *window,
                                             initial);
 }
 
+static guint
+pending_prop_reload_hash (gconstpointer key)
+{
+  const PendingPropReload *reload = key;
+
+  return (g_direct_hash (reload->window) ^
+          (guint) reload->xwindow ^
+          (guint) reload->property);
+}
+
+static gboolean
+pending_prop_reload_equal (gconstpointer a,
+                           gconstpointer b)
+{
+  const PendingPropReload *reload_a = a;
+  const PendingPropReload *reload_b = b;
+
+  return (reload_a->window == reload_b->window &&
+          reload_a->xwindow == reload_b->xwindow &&
+          reload_a->property == reload_b->property);
+}
+
+static gboolean
+flush_property_reloads_idle (gpointer user_data)
+{
+  MetaX11Display *x11_display = user_data;
+
+  x11_display->prop_reloads_idle_id = 0;
+  meta_x11_display_flush_property_reloads (x11_display);
+
+  return G_SOURCE_REMOVE;
+}
+
 void
-meta_window_load_initial_properties (MetaWindow *window)
+meta_window_queue_property_reload (MetaWindow *window,
+                                   Window      xwindow,
+                                   Atom        property)
 {
-  int i, j;
-  MetaPropValue *values;
-  int n_properties = 0;
   MetaX11Display *x11_display = window->display->x11_display;
+  PendingPropReload key = { window, xwindow, property };
+  PendingPropReload *reload;
+  MetaWindowPropHooks *hooks;
+
+  hooks = find_hooks (x11_display, property);
+  if (!hooks || (hooks->flags & INIT_ONLY))
+    return;
+
+  /* The value is fetched when flushing, so a repeated notification
+   * doesn't need a reload of its own. */
+  if (g_hash_table_contains (x11_display->pending_prop_reloads_set, &key))
+    return;
+
+  reload = g_memdup (&key, sizeof (key));
+  g_ptr_array_add (x11_display->pending_prop_reloads, reload);
+  g_hash_table_add (x11_display->pending_prop_reloads_set, reload);
 
-  values = g_new0 (MetaPropValue, x11_display->n_prop_hooks);
+  if (!x11_display->prop_reloads_idle_id)
+    {
+      /* Run before anything else gets to look at the window again. */
+      x11_display->prop_reloads_idle_id =
+        g_idle_add_full (G_PRIORITY_HIGH,
+                         flush_property_reloads_idle,
+                         x11_display, NULL);
+      g_source_set_name_by_id (x11_display->prop_reloads_idle_id,
+                               "[mutter] flush_property_reloads_idle");
+    }
+}
+
+void
+meta_window_cancel_property_reloads (MetaWindow *window)
+{
+  MetaX11Display *x11_display = window->display->x11_display;
+  GPtrArray *reloads = x11_display->pending_prop_reloads;
+  guint i;
+
+  for (i = reloads->len; i > 0; i--)
+    {
+      PendingPropReload *reload = g_ptr_array_index (reloads, i - 1);
+
+      if (reload->window != window)
+        continue;
+
+      g_hash_table_remove (x11_display->pending_prop_reloads_set, reload);
+      g_ptr_array_remove_index (reloads, i - 1);
+    }
+}
+
+void
+meta_x11_display_flush_property_reloads (MetaX11Display *x11_display)
+{
+  GPtrArray *reloads;
+  MetaPropValue *values;
+  MetaPropValuesRequest **requests;
+  guint i;
+
+  if (x11_display->prop_reloads_idle_id)
+    {
+      g_source_remove (x11_display->prop_reloads_idle_id);
+      x11_display->prop_reloads_idle_id = 0;
+    }
+
+  if (x11_display->pending_prop_reloads->len == 0)
+    return;
+
+  reloads = x11_display->pending_prop_reloads;
+  x11_display->pending_prop_reloads = g_ptr_array_new_with_free_func (g_free);
+  g_hash_table_remove_all (x11_display->pending_prop_reloads_set);
+
+  values = g_new0 (MetaPropValue, reloads->len);
+  requests = g_new0 (MetaPropValuesRequest *, reloads->len);
+
+  /* Get all the requests on the wire before waiting for any reply. */
+  for (i = 0; i < reloads->len; i++)
+    {
+      PendingPropReload *reload = g_ptr_array_index (reloads, i);
+      MetaWindowPropHooks *hooks = find_hooks (x11_display, reload->property);
+
+      g_object_ref (reload->window);
+      init_prop_value (reload->window, hooks, &values[i]);
+      requests[i] = meta_prop_get_values_begin (x11_display, reload->xwindow,
+                                                &values[i], 1);
+    }
+
+  meta_topic (META_DEBUG_SYNC, "Syncing to get %u GetProperty replies in %s\n",
+              reloads->len, G_STRFUNC);
+  XSync (x11_display->xdisplay, False);
+
+  for (i = 0; i < reloads->len; i++)
+    {
+      PendingPropReload *reload = g_ptr_array_index (reloads, i);
+      MetaWindowPropHooks *hooks = find_hooks (x11_display, reload->property);
+
+      meta_prop_get_values_finish (requests[i]);
+
+      /* An earlier reload in this batch may have unmanaged the window */
+      if (!reload->window->unmanaging)
+        reload_prop_value (reload->window, hooks, &values[i], FALSE);
+
+      meta_prop_free_values (&values[i], 1);
+      g_object_unref (reload->window);
+    }
+
+  g_free (requests);
+  g_free (values);
+  g_ptr_array_unref (reloads);
+}
+
+static void
+init_load_init_values (MetaX11Display *x11_display,
+                       MetaWindow     *window,
+                       MetaPropValue  *values)
+{
+  int i, j;
 
   j = 0;
   for (i = 0; i < x11_display->n_prop_hooks; i++)
@@ -145,14 +305,180 @@ meta_window_load_initial_properties (MetaWindow *window)
       MetaWindowPropHooks *hooks = &x11_display->prop_hooks_table[i];
       if (hooks->flags & LOAD_INIT)
         {
-          init_prop_value (window, hooks, &values[j]);
+          /* Prefetching happens before there is a window, and the values
+           * the window doesn't pay attention to are skipped on reload. */
+          if (window)
+            {
+              init_prop_value (window, hooks, &values[j]);
+            }
+          else
+            {
+              values[j].type = hooks->type;
+              values[j].atom = hooks->property;
+            }
           ++j;
         }
     }
-  n_properties = j;
+}
 
-  meta_prop_get_values (window->display->x11_display, window->xwindow,
-                        values, n_properties);
+static int
+count_load_init_hooks (MetaX11Display *x11_display)
+{
+  int i, n = 0;
+
+  for (i = 0; i < x11_display->n_prop_hooks; i++)
+    {
+      if (x11_display->prop_hooks_table[i].flags & LOAD_INIT)
+        n++;
+    }
+
+  return n;
+}
+
+static void
+prefetched_props_free (PrefetchedProps *prefetched)
+{
+  meta_prop_free_values (prefetched->values, prefetched->n_values);
+  g_free (prefetched->values);
+  g_free (prefetched);
+}
+
+void
+meta_x11_display_prefetch_initial_properties (MetaX11Display *x11_display,
+                                              Window         *xwindows,
+                                              int             n_xwindows)
+{
+  xcb_connection_t *xcb_conn = XGetXCBConnection (x11_display->xdisplay);
+  xcb_get_window_attributes_cookie_t *attr_cookies;
+  MetaPropValuesRequest **requests;
+  PrefetchedProps **prefetched;
+  int n_properties;
+  int i;
+
+  if (n_xwindows == 0)
+    return;
+
+  if (!x11_display->prefetched_props)
+    x11_display->prefetched_props =
+      g_hash_table_new_full (NULL, NULL, NULL,
+                             (GDestroyNotify) prefetched_props_free);
+
+  n_properties = count_load_init_hooks (x11_display);
+
+  attr_cookies = g_new0 (xcb_get_window_attributes_cookie_t, n_xwindows);
+  requests = g_new0 (MetaPropValuesRequest *, n_xwindows);
+  prefetched = g_new0 (PrefetchedProps *, n_xwindows);
+
+  for (i = 0; i < n_xwindows; i++)
+    attr_cookies[i] = xcb_get_window_attributes (xcb_conn, xwindows[i]);
+
+  meta_x11_error_trap_push (x11_display);
+
+  for (i = 0; i < n_xwindows; i++)
+    {
+      xcb_get_window_attributes_reply_t *attrs;
+      unsigned long event_mask;
+
+      attrs = xcb_get_window_attributes_reply (xcb_conn, attr_cookies[i], NULL);
+      if (!attrs)
+        continue;
+
+      /* Windows that are not going to be managed right away are left to
+       * the unbatched path. */
+      if (attrs->_class == XCB_WINDOW_CLASS_INPUT_ONLY ||
+          attrs->map_state != XCB_MAP_STATE_VIEWABLE)
+        {
+          free (attrs);
+          continue;
+        }
+
+      /* Select for property changes before reading the properties, as
+       * meta_window_x11_new() does, so that no change goes unnoticed in
+       * between. */
+      event_mask = attrs->your_event_mask | PropertyChangeMask;
+      if (attrs->override_redirect)
+        event_mask |= StructureNotifyMask;
+      XSelectInput (x11_display->xdisplay, xwindows[i], event_mask);
+      free (attrs);
+
+      prefetched[i] = g_new0 (PrefetchedProps, 1);
+      prefetched[i]->values = g_new0 (MetaPropValue, n_properties);
+      prefetched[i]->n_values = n_properties;
+      init_load_init_values (x11_display, NULL, prefetched[i]->values);
+
+      requests[i] = meta_prop_get_values_begin (x11_display, xwindows[i],
+                                                prefetched[i]->values,
+                                                n_properties);
+    }
+
+  /* Popping the trap syncs, after which all replies are in. */
+  meta_x11_error_trap_pop (x11_display);
+
+  for (i = 0; i < n_xwindows; i++)
+    {
+      if (!requests[i])
+        continue;
+
+      meta_prop_get_values_finish (requests[i]);
+      g_hash_table_replace (x11_display->prefetched_props,
+                            GSIZE_TO_POINTER (xwindows[i]),
+                            prefetched[i]);
+    }
+
+  g_free (prefetched);
+  g_free (requests);
+  g_free (attr_cookies);
+}
+
+void
+meta_x11_display_discard_prefetched_properties (MetaX11Display *x11_display)
+{
+  g_clear_pointer (&x11_display->prefetched_props, g_hash_table_unref);
+}
+
+static MetaPropValue *
+steal_prefetched_values (MetaX11Display *x11_display,
+                         Window          xwindow)
+{
+  PrefetchedProps *prefetched;
+  MetaPropValue *values;
+
+  if (!x11_display->prefetched_props)
+    return NULL;
+
+  prefetched = g_hash_table_lookup (x11_display->prefetched_props,
+                                    GSIZE_TO_POINTER (xwindow));
+  if (!prefetched)
+    return NULL;
+
+  g_hash_table_steal (x11_display->prefetched_props,
+                      GSIZE_TO_POINTER (xwindow));
+
+  values = prefetched->values;
+  g_free (prefetched);
+
+  return values;
+}
+
+void
+meta_window_load_initial_properties (MetaWindow *window)
+{
+  int i, j;
+  MetaPropValue *values;
+  int n_properties;
+  MetaX11Display *x11_display = window->display->x11_display;
+
+  n_properties = count_load_init_hooks (x11_display);
+
+  values = steal_prefetched_values (x11_display, window->xwindow);
+  if (!values)
+    {
+      values = g_new0 (MetaPropValue, n_properties);
+      init_load_init_values (x11_display, window, values);
+
+      meta_prop_get_values (window->display->x11_display, window->xwindow,
+                            values, n_properties);
+    }
 
   j = 0;
   for (i = 0; i < x11_display->n_prop_hooks; i++)
@@ -1874,11 +2200,24 @@ meta_x11_display_init_window_prop_hooks (MetaX11Display *x11_display)
       cursor++;
     }
   x11_display->n_prop_hooks = cursor - table;
+
+  x11_display->pending_prop_reloads = g_ptr_array_new_with_free_func (g_free);
+  x11_display->pending_prop_reloads_set =
+    g_hash_table_new (pending_prop_reload_hash, pending_prop_reload_equal);
 }
 
 void
 meta_x11_display_free_window_prop_hooks (MetaX11Display *x11_display)
 {
+  if (x11_display->prop_reloads_idle_id)
+    {
+      g_source_remove (x11_display->prop_reloads_idle_id);
+      x11_display->prop_reloads_idle_id = 0;
+    }
+  g_clear_pointer (&x11_display->pending_prop_reloads_set, g_hash_table_unref);
+  g_clear_pointer (&x11_display->pending_prop_reloads, g_ptr_array_unref);
+  meta_x11_display_discard_prefetched_properties (x11_display);
+
   g_hash_table_unref (x11_display->prop_hooks);
   x11_display->prop_hooks = NULL;
 
@@ -49,6 +49,59 @@ void meta_window_reload_property_from_xwindow (MetaWindow      *window,
                                                Atom             property,
                                                gboolean         initial);
 
+/**
+ * meta_window_queue_property_reload:
+ * @window:     The window the property belongs to.
+ * @xwindow:    The X handle for the window.
+ * @property:   A single X atom.
+ *
+ * Queues a reload of a property after a notification about it. Queued
+ * reloads are coalesced and done in one round trip, either before the
+ * next X event other than a property notification is handled, or at the
+ * next main loop iteration.
+ */
+void meta_window_queue_property_reload (MetaWindow *window,
+                                        Window      xwindow,
+                                        Atom        property);
+
+/**
+ * meta_window_cancel_property_reloads:
+ * @window:     The window.
+ *
+ * Drops the queued property reloads of a window that is going away.
+ */
+void meta_window_cancel_property_reloads (MetaWindow *window);
+
+/**
+ * meta_x11_display_flush_property_reloads:
+ * @x11_display:  The X11 display.
+ *
+ * Does the property reloads queued with meta_window_queue_property_reload().
+ */
+void meta_x11_display_flush_property_reloads (MetaX11Display *x11_display);
+
+/**
+ * meta_x11_display_prefetch_initial_properties:
+ * @x11_display:  The X11 display.
+ * @xwindows:     The X handles of windows about to be managed.
+ * @n_xwindows:   The number of windows.
+ *
+ * Requests the standard properties of all viewable windows in
+ * @xwindows in one round trip, for meta_window_load_initial_properties()
+ * to pick up instead of asking the server itself.
+ */
+void meta_x11_display_prefetch_initial_properties (MetaX11Display *x11_display,
+                                                   Window         *xwindows,
+                                                   int             n_xwindows);
+
+/**
+ * meta_x11_display_discard_prefetched_properties:
+ * @x11_display:  The X11 display.
+ *
+ * Frees the prefetched properties no window picked up.
+ */
+void meta_x11_display_discard_prefetched_properties (MetaX11Display *x11_display);
+
 /**
  * meta_window_load_initial_properties:
  * @window:      The window.
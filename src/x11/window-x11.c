@@ -590,6 +590,7 @@ meta_window_x11_unmanage (MetaWindow *window)
 
   meta_x11_error_trap_push (x11_display);
 
+  meta_window_cancel_property_reloads (window);
   meta_window_x11_destroy_sync_request_alarm (window);
 
   if (window->withdrawn)
@@ -2425,7 +2426,7 @@ process_property_notify (MetaWindow     *window,
         xid = window->user_time_window;
     }
 
-  meta_window_reload_property_from_xwindow (window, xid, event->atom, FALSE);
+  meta_window_queue_property_reload (window, xid, event->atom);
 
   return TRUE;
 }
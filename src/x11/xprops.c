@@ -857,12 +857,37 @@ latin1_to_utf8 (const char *text)
   return g_string_free (str, FALSE);
 }
 
-void
-meta_prop_get_values (MetaX11Display *x11_display,
-                      Window          xwindow,
-                      MetaPropValue  *values,
-                      int             n_values)
+struct _MetaPropValuesRequest
+{
+  MetaX11Display *x11_display;
+  Window xwindow;
+  MetaPropValue *values;
+  int n_values;
+  xcb_get_property_cookie_t *tasks;
+};
+
+/**
+ * meta_prop_get_values_begin:
+ * @x11_display: the #MetaX11Display
+ * @xwindow: the window to get the properties of
+ * @values: (array length=n_values): the values to fill in
+ * @n_values: the number of values
+ *
+ * Sends the GetProperty requests for @values without waiting for the
+ * replies, so that requests for several windows can be in flight at the
+ * same time. @values must stay alive until meta_prop_get_values_finish()
+ * is called on the returned request.
+ *
+ * Returns: (transfer full): the request to pass to
+ *   meta_prop_get_values_finish()
+ */
+MetaPropValuesRequest *
+meta_prop_get_values_begin (MetaX11Display *x11_display,
+                            Window          xwindow,
+                            MetaPropValue  *values,
+                            int             n_values)
 {
+  MetaPropValuesRequest *request;
   int i;
   xcb_get_property_cookie_t *tasks;
   xcb_connection_t *xcb_conn = XGetXCBConnection (x11_display->xdisplay);
@@ -870,11 +895,15 @@ meta_prop_get_values (MetaX11Display *x11_display,
   meta_verbose ("Requesting %d properties of 0x%lx at once\n",
                 n_values, xwindow);
 
-  if (n_values == 0)
-    return;
-
   tasks = g_new0 (xcb_get_property_cookie_t, n_values);
 
+  request = g_new0 (MetaPropValuesRequest, 1);
+  request->x11_display = x11_display;
+  request->xwindow = xwindow;
+  request->values = values;
+  request->n_values = n_values;
+  request->tasks = tasks;
+
   /* Start up tasks. The "values" array can have values
    * with atom == None, which means to ignore that element.
    */
@@ -937,10 +966,26 @@ meta_prop_get_values (MetaX11Display *x11_display,
       ++i;
     }
 
-  /* Get replies for all our tasks */
-  meta_topic (META_DEBUG_SYNC, "Syncing to get %d GetProperty replies in %s\n",
-              n_values, G_STRFUNC);
-  XSync (x11_display->xdisplay, False);
+  return request;
+}
+
+/**
+ * meta_prop_get_values_finish:
+ * @request: (transfer full): a request from meta_prop_get_values_begin()
+ *
+ * Collects the replies of @request into its values, blocking for those
+ * that didn't arrive yet, and frees @request.
+ */
+void
+meta_prop_get_values_finish (MetaPropValuesRequest *request)
+{
+  MetaX11Display *x11_display = request->x11_display;
+  Window xwindow = request->xwindow;
+  MetaPropValue *values = request->values;
+  int n_values = request->n_values;
+  xcb_get_property_cookie_t *tasks = request->tasks;
+  xcb_connection_t *xcb_conn = XGetXCBConnection (x11_display->xdisplay);
+  int i;
 
   /* Collect results, should arrive in order requested */
   i = 0;
@@ -1071,6 +1116,29 @@ meta_prop_get_values (MetaX11Display *x11_display,
     }
 
   g_free (tasks);
+  g_free (request);
+}
+
+void
+meta_prop_get_values (MetaX11Display *x11_display,
+                      Window          xwindow,
+                      MetaPropValue  *values,
+                      int             n_values)
+{
+  MetaPropValuesRequest *request;
+
+  if (n_values == 0)
+    return;
+
+  request = meta_prop_get_values_begin (x11_display, xwindow,
+                                        values, n_values);
+
+  /* Get replies for all our tasks */
+  meta_topic (META_DEBUG_SYNC, "Syncing to get %d GetProperty replies in %s\n",
+              n_values, G_STRFUNC);
+  XSync (x11_display->xdisplay, False);
+
+  meta_prop_get_values_finish (request);
 }
 
 static void
@@ -189,6 +189,19 @@ void meta_prop_get_values (MetaX11Display *x11_display,
 void meta_prop_free_values (MetaPropValue *values,
                             int            n_values);
 
+/* Split version of meta_prop_get_values(), to pipeline the requests of
+ * several windows. The caller is responsible for flushing, or syncing
+ * with, the server in between.
+ */
+typedef struct _MetaPropValuesRequest MetaPropValuesRequest;
+
+MetaPropValuesRequest * meta_prop_get_values_begin (MetaX11Display *x11_display,
+                                                    Window          xwindow,
+                                                    MetaPropValue  *values,
+                                                    int             n_values);
+
+void meta_prop_get_values_finish (MetaPropValuesRequest *request);
+
 #endif
 
 